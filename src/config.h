@@ -12,15 +12,89 @@
 
 // Timing constants
 #define WIFI_CONNECT_TIMEOUT 30000       // 30 seconds
-#define HEARTBEAT_INTERVAL 30000         // 30 seconds
+#define WIFI_FAST_CONNECT_TIMEOUT 4000   // Cached BSSID/channel attempt before falling back to a scan
+#define WIFI_CONNECT_POLL_INTERVAL 50    // Connection status polling while joining
+#define NTP_SYNC_TIMEOUT 10000           // Wait for SNTP before TLS (certificate validity needs the clock)
+#define BOOT_SERIAL_DELAY 100            // Let the USB serial console attach before the banner
+#define HEARTBEAT_INTERVAL 30000         // 30 seconds (starting interval, see below)
 #define REGISTRATION_RETRY_INTERVAL 5000 // 5 seconds (initial retry delay)
 #define STATUS_UPDATE_INTERVAL 60000     // 1 minute
+#define WS_POLL_INTERVAL 20              // 20ms between WebSocket polls (bounds message latency)
+#define WIFI_LOOP_INTERVAL 50            // 50ms captive portal DNS servicing
+#define WIFI_SCAN_INTERVAL 30000         // Background network scan while no client is on the captive portal
+#define WIFI_SCAN_MIN_INTERVAL 5000      // Rate limit for scans asked for by the setup page
+#define WIFI_SCAN_TIMEOUT 15000          // Give up on an async scan that never completes
+#define WIFI_SCAN_MAX_NETWORKS 20        // Networks kept in the scan cache
+#define SETUP_PAGE_MAX_AGE 86400         // Seconds a browser may reuse the setup page (revalidated by ETag)
+#define STATUS_ACK_TIMEOUT 15000         // Resend a status report the server has not acknowledged
+#define STATUS_MAX_UNACKED_RESYNCS 3     // Full reports without an ack before leaving it to the periodic report
+#define STATUS_RSSI_BUCKET 5             // dBm change before RSSI is reported again
+#define STATUS_HEAP_BUCKET 4096          // Bytes of free heap change before it is reported again
+
+// WebSocket supervision (see core/ConnectionSupervisor)
+#define HEARTBEAT_MIN_INTERVAL 10000       // Ping interval right after an overdue pong
+#define HEARTBEAT_MAX_INTERVAL 45000       // Ping interval on a steady link (below common 60s proxy idle timeouts)
+#define HEARTBEAT_STEADY_PONGS 4           // On-time pongs in a row before the interval doubles
+#define HEARTBEAT_MIN_PONG_TIMEOUT 2000    // Floor of the RTT-derived pong deadline
+#define HEARTBEAT_MAX_PONG_TIMEOUT 15000   // Pong deadline before any RTT is known, and its ceiling
+#define HEARTBEAT_MAX_MISSED 3             // Overdue pings in a row before the connection is dropped
+#define WS_RECONNECT_INITIAL_DELAY 1000    // First reconnect wait is random in [BACKOFF_MIN_DELAY, this]
+#define WS_RECONNECT_MAX_DELAY 60000       // Largest reconnect window
+#define WS_PERIODIC_STATUS_INTERVAL 300000 // Full device and lighting status, independent of the heartbeat
+
+// Latency instrumentation (see core/Metrics)
+#define METRICS_SAMPLE_COUNT 32    // Recent samples kept per span for percentiles
+#define METRICS_MAX_ERROR_CODES 12 // Distinct error codes counted
+
+// Logging (see core/Log) - calls above LOG_LEVEL compile away; every platformio.ini env sets it
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#ifndef LOG_LEVEL
+#ifdef DEBUG_LIGHT_CONTROLLER
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#else
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+#endif
+#define LOG_BUFFER_SIZE 4096          // In-RAM ring of recent records (oldest overwritten)
+#define LOG_LINE_SIZE 160             // Longest formatted message kept per record
+#define LOG_TAG_SIZE 12               // Longest module tag kept per record
+#define LOG_DRAIN_TASK_STACK_SIZE 3072
+#define LOG_DRAIN_TASK_PRIORITY 1     // Same as the Arduino loop task - callers never wait on the UART
+#define LOG_FETCH_MAX_ENTRIES 40      // Records per WebSocket "getLogs" reply
+
+// Per-message allocation (see core/MessageArena)
+#define MESSAGE_ARENA_SIZE 8192 // JSON documents of one WebSocket message; reset once it is handled
+
+// Heap and stack health (see core/MemoryTelemetry)
+#define MEMORY_CHECK_INTERVAL 10000            // Heap/stack sample in the main loop
+#define MEMORY_MIN_FREE_HEAP 10000             // Floor for long-lived allocations (WebSocket client)
+#define MEMORY_PORTAL_MIN_FREE_HEAP 15000      // Floor for the captive portal web and DNS servers
+#define MEMORY_TLS_MIN_LARGEST_BLOCK 20000     // mbedTLS needs a ~17 KB contiguous record buffer per session
+#define MEMORY_RESTART_CONSECUTIVE_CHECKS 3    // Fragmented samples in a row before a preemptive soft restart
+#define MEMORY_MAX_FRAGMENTATION_RESTARTS 3    // Back-to-back fragmentation restarts before the device stops restarting
+#define MEMORY_RESTART_STABLE_UPTIME 1800000   // Uptime after which earlier fragmentation restarts no longer count
+#define MEMORY_STACK_WARN_MARGIN 512           // Warn once when a watched task gets this close to its stack end
+#define MEMORY_MAX_WATCHED_TASKS 8             // Loop, lighting, log drain and fan-out workers
+
+// On-device benchmarks (bench build only, see diagnostics/Benchmarks)
+#define BENCH_TASK_STACK_SIZE 8192           // Each case runs on its own task of this size
+#define BENCH_PREF_NAMESPACE "pp_bench"      // Scratch namespace for the Preferences save case
+
+// Backend HTTPS transport (one kept-alive TLS connection shared by REST calls)
+#define SECURE_TRANSPORT_TIMEOUT 10000       // 10 seconds per request
+#define SECURE_TRANSPORT_IDLE_TIMEOUT 70000  // Just under Nginx's default 75s keep-alive window
+#define SECURE_TRANSPORT_MIN_FREE_HEAP 60000 // Close the connection rather than hold its TLS buffers below this
 
 // Network constants with exponential backoff
 #define MAX_WIFI_RETRY_ATTEMPTS 3
 #define INITIAL_RETRY_DELAY 1000      // 1 second initial delay
 #define MAX_RETRY_DELAY 60000         // 60 seconds maximum delay
 #define BACKOFF_MULTIPLIER 2          // Double delay each attempt
+#define BACKOFF_MIN_DELAY 100         // Shortest jittered wait
 #define CAPTIVE_PORTAL_TIMEOUT 300000 // 5 minutes
 
 // Watchdog Timer constants
@@ -31,12 +105,64 @@
 #define LED_DATA_PIN 2
 #define LED_COUNT 10
 
+// Nanoleaf external control (extControl v2) streaming
+#define NANOLEAF_EXT_CONTROL_PORT 60222 // Fixed UDP port used by extControl v2
+#define NANOLEAF_MAX_PANELS 50          // Maximum number of display panels tracked
+#define NANOLEAF_DISCOVERY_TIMEOUT 12000 // Upper bound on one background mDNS run
+#define NANOLEAF_MDNS_QUERY_ATTEMPTS 3   // Back-to-back queries (each waits for responses itself)
+#define NANOLEAF_PROBE_TIMEOUT 1500      // Budget for the concurrent TCP connect probes
+#define NANOLEAF_DISCOVERY_TASK_STACK_SIZE 4096
+#define NANOLEAF_LAYOUT_REVALIDATE_DELAY 3000 // Refresh a cached panel layout this long after loading it
+#define NANOLEAF_LAYOUT_MODE "x"               // Default palette gradient direction ("x", "y", "radial", "index"); customConfig "layout" overrides
+
+// On-device animation engine
+#define ANIMATION_MAX_PIXELS 50           // Frame buffer size (panels/LEDs driven per frame)
+#define ANIMATION_FRAME_INTERVAL 50       // 50ms fixed tick (20 fps)
+#define ANIMATION_FADE_DURATION 1500      // 1.5 seconds cross-fade into a new palette
+#define ANIMATION_PULSE_PERIOD 3000       // 3 seconds per breathing cycle
+#define ANIMATION_WHEEL_STEP 1000         // 1 second per panel step when rotating
+#define ANIMATION_FLOW_PERIOD 8000        // 8 seconds for colors to drift one palette slot
+#define ANIMATION_STATIC_TRANSITION 10    // Device-side transition for static frames (tenths of seconds)
+
+// Lighting task (lighting output runs off the Arduino loop task)
+#define LIGHTING_TASK_STACK_SIZE 8192 // HTTP + JSON on the controller path need a generous stack
+#define LIGHTING_TASK_PRIORITY 1      // Same as the Arduino loop task
+#define LIGHTING_TASK_CORE 0          // Dual-core only: Arduino loop runs on core 1
+
+// Multi-controller fan-out (one palette sent to several lighting systems at once)
+#define LIGHT_MAX_CONTROLLERS 4           // Primary system plus up to three additional ones
+#define LIGHT_FANOUT_TASK_STACK_SIZE 6144 // Per worker - each runs one controller's HTTP + JSON
+
+// Encoded payloads of recently shown palettes (see lighting/PayloadCache)
+#define PAYLOAD_CACHE_BUDGET 4096     // Bytes per controller - a few static effects plus stream frames
+#define PAYLOAD_CACHE_MAX_ENTRIES 8
+
+// Received palettes kept in flash (see lighting/PaletteHistory): newest shown at boot, shuffle replays them
+#define PALETTE_HISTORY_FILE "/palette_history.bin"
+#define PALETTE_HISTORY_CAPACITY 32             // Fixed-size records in the ring (oldest overwritten)
+#define PALETTE_HISTORY_MAX_PENDING 4           // Appends held in RAM until the next batch write
+#define PALETTE_HISTORY_WRITE_DELAY 3000        // Quiet time after the last append before writing the batch
+#define PALETTE_HISTORY_TICK_INTERVAL 1000      // Main-loop history flush and shuffle check
+#define PALETTE_SHUFFLE_DEFAULT_INTERVAL 60000  // Time each shuffled palette stays up
+#define PALETTE_SHUFFLE_MIN_INTERVAL 5000
+
 // WS2812 default configuration
 #define DEFAULT_LED_PIN 2
 #define DEFAULT_NUM_LEDS 10
+#define WS2812_MAX_LEDS 300      // 300 LEDs take 9 ms on the wire - inside one 60 fps frame
+#define WS2812_RMT_CHANNELS 2    // TX channels strips can claim, one each (the C3 has TX channels 0 and 1)
+#define WS2812_RMT_CLOCK_DIV 2   // 80 MHz APB / 2 = 25 ns RMT ticks
+#define WS2812_FRAME_INTERVAL 16 // ~60 fps animation tick for local strips
+
+// WLED (JSON API for probing, realtime UDP for frames)
+#define WLED_REALTIME_PORT 21324  // Default "UDP realtime" port (overridden by /json/info udpport)
+#define WLED_REALTIME_TIMEOUT 255 // Seconds WLED holds a realtime frame; 255 = until the next one
+#define WLED_MAX_LEDS 1500        // Larger strips are only driven up to this LED
+#define WLED_HTTP_TIMEOUT 3000    // /json/info probe
+#define WLED_FRAME_INTERVAL 25    // 40 fps animation tick - one datagram per frame
 
 // Debug flags
-// DEBUG_LIGHT_CONTROLLER is defined in platformio.ini build_flags
+// Log verbosity is LOG_LEVEL, set per environment in platformio.ini build_flags
 #define DEBUG_DEVICE_MANAGER
 #define DEBUG_WIFI_MANAGER
 
@@ -84,4 +210,19 @@ extern void globalFeedWatchdog(); // Function to feed watchdog from anywhere in
 #define PREF_MAC_ADDRESS "mac_addr"
 #define PREF_PAIRING_CODE "pairing_code"
 
+// Consolidated configuration blob (see core/ConfigStore)
+#define CONFIG_STORE_NAMESPACE "pp_config"
+#define CONFIG_STORE_KEY "config"
+
+// Legacy per-key lighting settings, read once for migration
+#define LEGACY_LIGHT_PREF_NAMESPACE "light_config"
+#define LEGACY_PREF_SYSTEM_TYPE "system_type"
+#define LEGACY_PREF_HOST_ADDRESS "host_addr"
+#define LEGACY_PREF_PORT "port"
+#define LEGACY_PREF_AUTH_TOKEN "auth_token"
+#define LEGACY_PREF_CUSTOM_CONFIG "custom_config"
+#define LEGACY_PREF_SETUP_SYSTEM "lighting_system"
+#define LEGACY_PREF_SETUP_HOST "lighting_host"
+#define LEGACY_PREF_SETUP_PORT "lighting_port"
+
 #endif
@@ -0,0 +1,56 @@
+#include "Backoff.h"
+#include "Log.h"
+
+static const char *const LOG_TAG = "backoff";
+
+Backoff::Backoff(const char *name, unsigned long initial, unsigned long maximum, unsigned int multiplier)
+    : name(name), initialDelay(initial), maxDelay(maximum), multiplier(multiplier),
+      ceiling(initial), currentDelay(0), lastAttemptTime(0), attemptCount(0)
+{
+}
+
+bool Backoff::shouldRetry() const
+{
+    return millis() - lastAttemptTime >= currentDelay;
+}
+
+void Backoff::recordAttempt()
+{
+    lastAttemptTime = millis();
+    attemptCount++;
+
+    // Wait at most the current ceiling, then widen the window for the attempt after
+    currentDelay = draw(ceiling);
+    ceiling = min(ceiling * multiplier, maxDelay);
+
+    LOG_I("📡 %s attempt #%d, next retry in %lums", name, attemptCount, currentDelay);
+}
+
+void Backoff::delayFirstAttempt()
+{
+    lastAttemptTime = millis();
+    currentDelay = draw(initialDelay);
+}
+
+void Backoff::reset()
+{
+    ceiling = initialDelay;
+    currentDelay = 0;
+    lastAttemptTime = 0;
+    attemptCount = 0;
+}
+
+unsigned long Backoff::timeUntilRetry() const
+{
+    unsigned long elapsed = millis() - lastAttemptTime;
+    return elapsed >= currentDelay ? 0 : currentDelay - elapsed;
+}
+
+unsigned long Backoff::draw(unsigned long upper) const
+{
+    if (upper <= BACKOFF_MIN_DELAY)
+    {
+        return upper;
+    }
+    return BACKOFF_MIN_DELAY + esp_random() % (upper - BACKOFF_MIN_DELAY + 1);
+}
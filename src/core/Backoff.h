@@ -0,0 +1,68 @@
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+/**
+ * Backoff
+ * Exponential retry delay with full jitter: the ceiling grows by the
+ * multiplier per attempt up to the maximum, and each wait is drawn
+ * uniformly from [BACKOFF_MIN_DELAY, ceiling]. A fleet that lost the same
+ * access point therefore spreads its retries over the whole window instead
+ * of reaching the backend in lockstep.
+ */
+class Backoff
+{
+public:
+    /**
+     * @param name Shown in the retry log line
+     * @param initial Ceiling of the first wait (ms)
+     * @param maximum Largest ceiling (ms)
+     * @param multiplier Ceiling growth per attempt
+     */
+    Backoff(const char *name,
+            unsigned long initial = INITIAL_RETRY_DELAY,
+            unsigned long maximum = MAX_RETRY_DELAY,
+            unsigned int multiplier = BACKOFF_MULTIPLIER);
+
+    /**
+     * Whether the current wait has passed (true before the first attempt)
+     */
+    bool shouldRetry() const;
+
+    /**
+     * Count an attempt and draw the wait before the next one
+     */
+    void recordAttempt();
+
+    /**
+     * Start waiting without counting an attempt - the first retry after a
+     * drop is jittered too, so it does not happen at once everywhere
+     */
+    void delayFirstAttempt();
+
+    void reset();
+
+    /**
+     * Milliseconds until shouldRetry() turns true (0 if it already is)
+     */
+    unsigned long timeUntilRetry() const;
+
+    int getAttemptCount() const { return attemptCount; }
+    unsigned long getCurrentDelay() const { return currentDelay; }
+
+private:
+    const char *name;
+    unsigned long initialDelay;
+    unsigned long maxDelay;
+    unsigned int multiplier;
+    unsigned long ceiling;      // Upper bound of the next draw
+    unsigned long currentDelay; // Drawn wait after lastAttemptTime
+    unsigned long lastAttemptTime;
+    int attemptCount;
+
+    unsigned long draw(unsigned long upper) const;
+};
+
+#endif // BACKOFF_H
@@ -0,0 +1,93 @@
+#include "BinaryProtocol.h"
+#include "Log.h"
+
+static const char *const LOG_TAG = "binproto";
+
+static uint16_t readUint16(const uint8_t *data)
+{
+    return ((uint16_t)data[0] << 8) | data[1];
+}
+
+static uint32_t readUint32(const uint8_t *data)
+{
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+bool BinaryProtocol::isFrame(const uint8_t *data, size_t length)
+{
+    return length >= HEADER_SIZE && data[0] == 'P' && data[1] == 'P';
+}
+
+bool BinaryProtocol::decodePalette(const uint8_t *data, size_t length, ColorPalette &palette)
+{
+    if (!isFrame(data, length))
+    {
+        LOG_E("❌ Binary frame too short or bad magic (%u bytes)", (unsigned)length);
+        return false;
+    }
+
+    if (data[2] != VERSION)
+    {
+        LOG_E("❌ Unsupported binary protocol version: %d", data[2]);
+        return false;
+    }
+
+    if (data[3] != FRAME_TYPE_PALETTE)
+    {
+        LOG_W("⚠ Unsupported binary frame type: %d", data[3]);
+        return false;
+    }
+
+    uint8_t colorCount = data[4];
+    if (colorCount == 0 || colorCount > MAX_COLORS)
+    {
+        LOG_E("❌ Invalid color count in binary frame: %d", colorCount);
+        return false;
+    }
+
+    size_t colorsEnd = HEADER_SIZE + colorCount * 3;
+    if (length < colorsEnd)
+    {
+        LOG_E("❌ Binary frame truncated (%u < %u bytes)", (unsigned)length, (unsigned)colorsEnd);
+        return false;
+    }
+
+    palette = ColorPalette();
+    palette.colorCount = colorCount;
+    palette.animation = animationName(data[5]);
+    palette.duration = readUint16(data + 6);
+    palette.messageId.format("%lu", (unsigned long)readUint32(data + 8));
+
+    const uint8_t *rgb = data + HEADER_SIZE;
+    for (int i = 0; i < colorCount; i++, rgb += 3)
+    {
+        palette.colors[i] = RGBColor(rgb[0], rgb[1], rgb[2]);
+    }
+
+    // Optional sender name trailer
+    if (length > colorsEnd)
+    {
+        size_t nameLength = min((size_t)data[colorsEnd], length - colorsEnd - 1);
+        palette.senderName.assign((const char *)(data + colorsEnd + 1), nameLength);
+    }
+
+    palette.name.format("From %s", palette.senderName.c_str());
+    return true;
+}
+
+const char *BinaryProtocol::animationName(uint8_t animationId)
+{
+    switch (animationId)
+    {
+    case ANIMATION_FADE:
+        return "fade";
+    case ANIMATION_PULSE:
+        return "pulse";
+    case ANIMATION_WHEEL:
+        return "wheel";
+    case ANIMATION_FLOW:
+        return "flow";
+    default:
+        return "static";
+    }
+}
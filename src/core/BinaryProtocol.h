@@ -0,0 +1,60 @@
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <Arduino.h>
+#include "../lighting/LightController.h"
+
+/**
+ * Compact binary WebSocket frames (negotiated in WSClient::registerDevice)
+ *
+ * Palette frame layout (multi-byte fields big-endian):
+ *   0  'P' 'P'        magic
+ *   2  version        BinaryProtocol::VERSION
+ *   3  type           FRAME_TYPE_PALETTE
+ *   4  colorCount     1..MAX_COLORS
+ *   5  animation      AnimationId
+ *   6  duration       uint16, milliseconds
+ *   8  sequence       uint32, used as the message id
+ *  12  colors         colorCount x R G B
+ *   +  nameLength     optional uint8 followed by the sender name (UTF-8)
+ *
+ * JSON remains the fallback for servers that do not send binary frames.
+ */
+class BinaryProtocol
+{
+public:
+    static const uint8_t VERSION = 1;
+    static const size_t HEADER_SIZE = 12;
+
+    enum FrameType : uint8_t
+    {
+        FRAME_TYPE_PALETTE = 1
+    };
+
+    enum AnimationId : uint8_t
+    {
+        ANIMATION_STATIC = 0,
+        ANIMATION_FADE = 1,
+        ANIMATION_PULSE = 2,
+        ANIMATION_WHEEL = 3,
+        ANIMATION_FLOW = 4
+    };
+
+    /**
+     * Check whether a buffer starts with a binary frame header
+     */
+    static bool isFrame(const uint8_t *data, size_t length);
+
+    /**
+     * Decode a palette frame straight into a ColorPalette
+     * @param data Frame bytes
+     * @param length Frame length
+     * @param palette Output palette (name, senderName and messageId are filled in)
+     * @return false if the frame is malformed or not a palette
+     */
+    static bool decodePalette(const uint8_t *data, size_t length, ColorPalette &palette);
+
+    static const char *animationName(uint8_t animationId);
+};
+
+#endif // BINARY_PROTOCOL_H
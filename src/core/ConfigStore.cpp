@@ -0,0 +1,236 @@
+#include "ConfigStore.h"
+#include <stddef.h>
+#include "Log.h"
+
+static const char *const LOG_TAG = "config";
+
+ConfigStore *ConfigStore::instance = nullptr;
+
+ConfigStore *ConfigStore::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new ConfigStore();
+    }
+    return instance;
+}
+
+ConfigStore::ConfigStore() : savedCrc(0), loaded(false), writeCount(0)
+{
+    memset(&current, 0, sizeof(current));
+    mutex = xSemaphoreCreateMutex();
+}
+
+bool ConfigStore::begin()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+
+    if (!loaded)
+    {
+        if (!load())
+        {
+            migrateLegacyKeys();
+            write();
+        }
+        loaded = true;
+    }
+
+    xSemaphoreGive(mutex);
+    return true;
+}
+
+StoredConfig ConfigStore::get()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    StoredConfig snapshot = current;
+    xSemaphoreGive(mutex);
+    return snapshot;
+}
+
+bool ConfigStore::update(const std::function<void(StoredConfig &)> &change)
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+
+    change(current);
+
+    bool success = true;
+    if (crc32(&current, sizeof(current)) != savedCrc)
+    {
+        success = write();
+    }
+
+    xSemaphoreGive(mutex);
+    return success;
+}
+
+void ConfigStore::clear()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+
+    Preferences prefs;
+    if (prefs.begin(CONFIG_STORE_NAMESPACE, false))
+    {
+        prefs.clear();
+        prefs.end();
+    }
+
+    memset(&current, 0, sizeof(current));
+    savedCrc = crc32(&current, sizeof(current));
+
+    xSemaphoreGive(mutex);
+    LOG_I("🗑 Stored configuration cleared");
+}
+
+bool ConfigStore::load()
+{
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_STORE_NAMESPACE, true))
+    {
+        return false; // Namespace does not exist yet
+    }
+
+    Blob blob;
+    memset(&blob, 0, sizeof(blob));
+
+    const size_t headerSize = offsetof(Blob, config);
+    size_t length = prefs.getBytesLength(CONFIG_STORE_KEY);
+    bool valid = length > headerSize && length <= sizeof(blob) &&
+                 prefs.getBytes(CONFIG_STORE_KEY, &blob, length) == length;
+    prefs.end();
+
+    // Accept blobs from builds with fewer fields; the rest stays zeroed
+    if (!valid || blob.version != BLOB_VERSION || blob.size != length - headerSize)
+    {
+        if (length > 0)
+        {
+            LOG_W("⚠️  Stored configuration has an unknown layout - rebuilding");
+        }
+        return false;
+    }
+
+    if (crc32(&blob.config, blob.size) != blob.crc)
+    {
+        LOG_W("⚠️  Stored configuration failed its CRC check - rebuilding");
+        return false;
+    }
+
+    current = blob.config;
+
+    // An older, shorter blob is rewritten in full on the next change
+    savedCrc = blob.size == sizeof(StoredConfig) ? blob.crc : 0;
+    LOG_I("📂 Configuration loaded (%u bytes)", (unsigned)length);
+    return true;
+}
+
+bool ConfigStore::write()
+{
+    Blob blob;
+    blob.version = BLOB_VERSION;
+    blob.size = sizeof(StoredConfig);
+    blob.config = current;
+    blob.crc = crc32(&blob.config, sizeof(blob.config));
+
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_STORE_NAMESPACE, false))
+    {
+        LOG_E("❌ Failed to open configuration namespace");
+        return false;
+    }
+
+    bool success = prefs.putBytes(CONFIG_STORE_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+
+    if (!success)
+    {
+        LOG_E("❌ Failed to write configuration");
+        return false;
+    }
+
+    savedCrc = blob.crc;
+    writeCount++;
+    LOG_I("💾 Configuration saved (%u bytes)", (unsigned)sizeof(blob));
+    return true;
+}
+
+void ConfigStore::migrateLegacyKeys()
+{
+    memset(&current, 0, sizeof(current));
+
+    // Keys written by earlier firmware are read once and left in place, so
+    // flashing an older build still finds its settings
+    String setupSystem;
+    String setupHost;
+    int setupPort = 0;
+
+    Preferences prefs;
+    if (prefs.begin(DEVICE_PREF_NAMESPACE, true))
+    {
+        setField(current.deviceId, prefs.getString(PREF_DEVICE_ID, ""));
+        setField(current.macAddress, prefs.getString(PREF_MAC_ADDRESS, ""));
+        setField(current.pairingCode, prefs.getString(PREF_PAIRING_CODE, ""));
+        current.isProvisioned = prefs.getBool(PREF_IS_PROVISIONED, false);
+
+        setField(current.wifiSsid, prefs.getString(PREF_WIFI_SSID, ""));
+        setField(current.wifiPassword, prefs.getString(PREF_WIFI_PASSWORD, ""));
+        setField(current.serverUrl, prefs.getString(PREF_SERVER_URL, ""));
+
+        setupSystem = prefs.getString(LEGACY_PREF_SETUP_SYSTEM, "");
+        setupHost = prefs.getString(LEGACY_PREF_SETUP_HOST, "");
+        setupPort = prefs.getInt(LEGACY_PREF_SETUP_PORT, 0);
+        prefs.end();
+    }
+
+    String lightingSystem;
+    if (prefs.begin(LEGACY_LIGHT_PREF_NAMESPACE, true))
+    {
+        lightingSystem = prefs.getString(LEGACY_PREF_SYSTEM_TYPE, "");
+        setField(current.lightingSystem, lightingSystem);
+        setField(current.lightingHost, prefs.getString(LEGACY_PREF_HOST_ADDRESS, ""));
+        current.lightingPort = prefs.getInt(LEGACY_PREF_PORT, 0);
+        setField(current.lightingAuthToken, prefs.getString(LEGACY_PREF_AUTH_TOKEN, ""));
+        String customConfig = prefs.getString(LEGACY_PREF_CUSTOM_CONFIG, "");
+        if (customConfig.length() < sizeof(current.lightingCustomConfig))
+        {
+            setField(current.lightingCustomConfig, customConfig);
+        }
+        else
+        {
+            // Truncated JSON would not parse - drop it and let the backend resend it
+            LOG_E("❌ Legacy lighting custom config (%u bytes) does not fit in the config store - not migrated",
+                  customConfig.length());
+        }
+        prefs.end();
+    }
+
+    // A system picked in the setup portal that the controller never saved
+    // itself is the newer choice - same precedence the old loader applied
+    if (setupSystem.length() > 0 && setupSystem != lightingSystem)
+    {
+        setField(current.lightingSystem, setupSystem);
+        setField(current.lightingHost, setupHost);
+        current.lightingPort = setupPort;
+        current.lightingAuthToken[0] = '\0';
+        current.lightingCustomConfig[0] = '\0';
+    }
+
+    if (current.deviceId[0] != '\0' || current.wifiSsid[0] != '\0' || current.lightingSystem[0] != '\0')
+    {
+        LOG_I("🔄 Migrated legacy settings into the configuration store");
+    }
+}
+
+uint32_t ConfigStore::crc32(const void *data, size_t length)
+{
+    // Bitwise CRC-32 - only runs on save/load, so no table is kept in RAM
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,119 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "../config.h"
+
+/**
+ * Persisted device, WiFi and lighting configuration
+ * Plain data with fixed-size fields so it can be stored as one blob
+ */
+struct StoredConfig
+{
+    // Device identity
+    char deviceId[40];
+    char macAddress[18];
+    char pairingCode[12];
+    bool isProvisioned;
+
+    // Network
+    char wifiSsid[33];
+    char wifiPassword[65];
+    char serverUrl[128]; // Empty = DEFAULT_SERVER_URL
+
+    // Lighting system
+    char lightingSystem[24];
+    char lightingHost[64];
+    int32_t lightingPort;
+    char lightingAuthToken[80];
+    char lightingCustomConfig[256]; // Serialized JSON
+
+    // Fields below were appended later - blobs saved before them load zero-filled
+
+    // Last access point joined, for fast reconnects
+    uint8_t wifiBssid[6];
+    uint8_t wifiChannel; // 0 = unknown
+
+    // Lighting systems mirroring the primary one (serialized JSON array)
+    char lightingAdditionalSystems[384];
+};
+
+/**
+ * Config Store
+ * Single owner of persisted configuration. The whole StoredConfig is read
+ * in one getBytes() at boot and written back as one versioned, CRC-checked
+ * blob - and only when its contents actually changed, so repeated saves of
+ * the same settings cost no flash erase cycles. Configuration written by
+ * older firmware as individual keys is migrated on first boot. New fields
+ * are only ever appended to StoredConfig, so shorter blobs from earlier
+ * builds still load.
+ */
+class ConfigStore
+{
+public:
+    static ConfigStore *getInstance();
+
+    /**
+     * Load the blob (or migrate legacy keys) - safe to call more than once
+     * @return true if configuration is available
+     */
+    bool begin();
+
+    /**
+     * Snapshot of the current configuration
+     */
+    StoredConfig get();
+
+    /**
+     * Apply a set of changes as one transaction and persist them if anything changed
+     * @param change Mutator applied to the current configuration under the store lock
+     * @return false if the changed blob could not be written
+     */
+    bool update(const std::function<void(StoredConfig &)> &change);
+
+    /**
+     * Erase all stored configuration
+     */
+    void clear();
+
+    uint32_t getWriteCount() const { return writeCount; }
+
+    // Copy a String into a fixed-size config field
+    template <size_t N>
+    static void setField(char (&field)[N], const String &value)
+    {
+        strlcpy(field, value.c_str(), N);
+    }
+
+private:
+    static ConfigStore *instance;
+    static const uint16_t BLOB_VERSION = 1;
+
+    // On-flash layout: header followed by the config
+    struct Blob
+    {
+        uint16_t version;
+        uint16_t size;
+        uint32_t crc;
+        StoredConfig config;
+    };
+
+    SemaphoreHandle_t mutex;
+    StoredConfig current;
+    uint32_t savedCrc; // CRC of what is on flash - the dirty marker
+    bool loaded;
+    uint32_t writeCount;
+
+    ConfigStore();
+
+    bool load();
+    bool write();
+    void migrateLegacyKeys();
+    static uint32_t crc32(const void *data, size_t length);
+};
+
+#endif // CONFIG_STORE_H
@@ -0,0 +1,178 @@
+#include "ConnectionSupervisor.h"
+#include "Metrics.h"
+#include "Log.h"
+
+static const char *const LOG_TAG = "supervisor";
+
+ConnectionSupervisor::ConnectionSupervisor()
+    : connected(false), everConnected(false),
+      reconnectBackoff("WebSocket reconnect", WS_RECONNECT_INITIAL_DELAY, WS_RECONNECT_MAX_DELAY, BACKOFF_MULTIPLIER),
+      disconnectedAt(0), reconnects(0), lastReconnectMs(0),
+      pingSentAt(0), smoothedRtt(0), rttVariance(0), pongTimeout(HEARTBEAT_MAX_PONG_TIMEOUT),
+      heartbeatInterval(HEARTBEAT_INTERVAL), missedPongs(0), onTimePongs(0), probesSent(0)
+{
+}
+
+void ConnectionSupervisor::onConnected()
+{
+    if (connected)
+    {
+        return;
+    }
+    connected = true;
+
+    if (everConnected && disconnectedAt != 0)
+    {
+        int64_t downtime = esp_timer_get_time() - disconnectedAt;
+        Metrics::getInstance()->record(Metrics::WS_RECONNECT, (uint32_t)min(downtime, (int64_t)UINT32_MAX));
+        lastReconnectMs = (uint32_t)(downtime / 1000);
+        reconnects++;
+        LOG_I("🔗 Reconnected after %lums (%d attempts)", (unsigned long)lastReconnectMs,
+              reconnectBackoff.getAttemptCount() + 1);
+    }
+    everConnected = true;
+    disconnectedAt = 0;
+    reconnectBackoff.reset();
+
+    // The RTT estimate carries over - it is the same server
+    resetHeartbeat();
+}
+
+void ConnectionSupervisor::onDisconnected()
+{
+    if (!connected)
+    {
+        return;
+    }
+    connected = false;
+    pingSentAt = 0;
+    disconnectedAt = esp_timer_get_time();
+
+    // Even the first attempt waits a random slice, so a fleet dropped together does not return together
+    reconnectBackoff.reset();
+    reconnectBackoff.delayFirstAttempt();
+    LOG_I("🔄 First reconnect attempt in %lums", reconnectBackoff.getCurrentDelay());
+}
+
+void ConnectionSupervisor::onPingSent()
+{
+    pingSentAt = esp_timer_get_time();
+}
+
+void ConnectionSupervisor::onPong()
+{
+    if (pingSentAt == 0)
+    {
+        return; // Unsolicited, or answers a ping we already gave up on
+    }
+
+    int64_t rttMicros = esp_timer_get_time() - pingSentAt;
+    pingSentAt = 0;
+
+    if (missedPongs > 0)
+    {
+        // Karn: after a probe it is unclear which ping this answers, so no RTT sample
+        LOG_I("✅ Connection answered after %d probe(s) - kept open", missedPongs);
+        missedPongs = 0;
+        onTimePongs = 0;
+        return;
+    }
+
+    Metrics::getInstance()->record(Metrics::WS_RTT, (uint32_t)min(rttMicros, (int64_t)UINT32_MAX));
+    uint32_t rtt = (uint32_t)(rttMicros / 1000);
+    if (smoothedRtt == 0)
+    {
+        smoothedRtt = max(rtt, 1u);
+        rttVariance = rtt / 2;
+    }
+    else
+    {
+        uint32_t deviation = rtt > smoothedRtt ? rtt - smoothedRtt : smoothedRtt - rtt;
+        rttVariance = (3 * rttVariance + deviation) / 4;
+        smoothedRtt = max((7 * smoothedRtt + rtt) / 8, 1u);
+    }
+    pongTimeout = constrain(smoothedRtt + 4 * rttVariance, (uint32_t)HEARTBEAT_MIN_PONG_TIMEOUT,
+                            (uint32_t)HEARTBEAT_MAX_PONG_TIMEOUT);
+
+    // A steady link needs fewer pings
+    if (++onTimePongs >= HEARTBEAT_STEADY_PONGS && heartbeatInterval < HEARTBEAT_MAX_INTERVAL)
+    {
+        heartbeatInterval = min(heartbeatInterval * 2, (unsigned long)HEARTBEAT_MAX_INTERVAL);
+        onTimePongs = 0;
+        LOG_D("💓 Link steady (RTT %lums) - heartbeat every %lus", (unsigned long)smoothedRtt, heartbeatInterval / 1000);
+    }
+}
+
+ConnectionSupervisor::Health ConnectionSupervisor::check()
+{
+    if (!connected || pingSentAt == 0)
+    {
+        return HEALTHY;
+    }
+
+    uint32_t waited = (uint32_t)((esp_timer_get_time() - pingSentAt) / 1000);
+    if (waited < pongTimeout)
+    {
+        return HEALTHY;
+    }
+
+    missedPongs++;
+    onTimePongs = 0;
+    heartbeatInterval = HEARTBEAT_MIN_INTERVAL;
+
+    if (missedPongs >= HEARTBEAT_MAX_MISSED)
+    {
+        LOG_W("⚠ No pong after %d probes - connection is stale", missedPongs);
+        return STALE;
+    }
+
+    probesSent++;
+    LOG_W("⚠ Pong overdue (%lums, limit %lums) - probing (%d/%d)", (unsigned long)waited,
+          (unsigned long)pongTimeout, missedPongs, HEARTBEAT_MAX_MISSED);
+    return PROBE;
+}
+
+bool ConnectionSupervisor::reconnectDue() const
+{
+    return !connected && reconnectBackoff.shouldRetry();
+}
+
+void ConnectionSupervisor::onReconnectFailed()
+{
+    reconnectBackoff.recordAttempt();
+}
+
+unsigned long ConnectionSupervisor::getReconnectDelay() const
+{
+    if (connected)
+    {
+        return WS_RECONNECT_INITIAL_DELAY; // Only notices a drop; the wait itself is jittered
+    }
+    return max(reconnectBackoff.timeUntilRetry(), (unsigned long)BACKOFF_MIN_DELAY);
+}
+
+void ConnectionSupervisor::statsToJson(JsonObject out) const
+{
+    out["connected"] = connected;
+    out["rttMs"] = smoothedRtt;
+    out["rttVarianceMs"] = rttVariance;
+    out["pongTimeoutMs"] = pongTimeout;
+    out["heartbeatIntervalMs"] = heartbeatInterval;
+    out["missedPongs"] = missedPongs;
+    out["probes"] = probesSent;
+    out["reconnects"] = reconnects;
+    out["lastReconnectMs"] = lastReconnectMs;
+    if (!connected)
+    {
+        out["reconnectAttempts"] = reconnectBackoff.getAttemptCount();
+        out["nextAttemptMs"] = reconnectBackoff.timeUntilRetry();
+    }
+}
+
+void ConnectionSupervisor::resetHeartbeat()
+{
+    pingSentAt = 0;
+    missedPongs = 0;
+    onTimePongs = 0;
+    heartbeatInterval = HEARTBEAT_INTERVAL;
+}
@@ -0,0 +1,85 @@
+#ifndef CONNECTION_SUPERVISOR_H
+#define CONNECTION_SUPERVISOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Backoff.h"
+#include "../config.h"
+
+/**
+ * Connection Supervisor
+ * Liveness and reconnect policy for the backend WebSocket, kept apart from
+ * the socket itself. Pong round-trips feed a smoothed RTT (RFC 6298 style)
+ * that sets how long a ping may go unanswered, and the ping interval
+ * stretches towards HEARTBEAT_MAX_INTERVAL while pongs come back on time.
+ * A late pong first triggers quick probes on the open connection - a
+ * short stall does not cost a new TLS handshake - and only
+ * HEARTBEAT_MAX_MISSED unanswered probes in a row declare it dead.
+ * Reconnects wait on a jittered Backoff.
+ *
+ * Main loop task only (the WebSocket client is polled there).
+ */
+class ConnectionSupervisor
+{
+public:
+    enum Health
+    {
+        HEALTHY, // Nothing to do
+        PROBE,   // Pong overdue - ping again now
+        STALE    // Too many probes unanswered - drop the connection
+    };
+
+    ConnectionSupervisor();
+
+    void onConnected();
+    void onDisconnected(); // Idempotent - the socket reports a drop in several places
+
+    void onPingSent();
+    void onPong();
+    bool awaitingPong() const { return pingSentAt != 0; }
+
+    /**
+     * Look for an overdue pong (health check task)
+     */
+    Health check();
+
+    /**
+     * Interval until the next regular ping
+     */
+    unsigned long getHeartbeatInterval() const { return heartbeatInterval; }
+
+    /**
+     * Whether a reconnect attempt may be made now
+     */
+    bool reconnectDue() const;
+    void onReconnectFailed();
+
+    /**
+     * Time until the next reconnect attempt (a polling interval while connected)
+     */
+    unsigned long getReconnectDelay() const;
+
+    uint32_t getSmoothedRtt() const { return smoothedRtt; } // ms, 0 before the first pong
+    void statsToJson(JsonObject out) const;
+
+private:
+    bool connected;
+    bool everConnected;
+    Backoff reconnectBackoff;
+    int64_t disconnectedAt; // esp_timer time of the drop being recovered from
+    uint32_t reconnects;
+    uint32_t lastReconnectMs;
+
+    int64_t pingSentAt; // 0 = no ping outstanding
+    uint32_t smoothedRtt;
+    uint32_t rttVariance;
+    uint32_t pongTimeout;
+    unsigned long heartbeatInterval;
+    uint8_t missedPongs;
+    uint8_t onTimePongs; // In a row, since the interval last changed
+    uint32_t probesSent;
+
+    void resetHeartbeat();
+};
+
+#endif // CONNECTION_SUPERVISOR_H
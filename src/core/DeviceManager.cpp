@@ -1,10 +1,15 @@
 #include "../lighting/LightManager.h"
 #include "DeviceManager.h"
+#include "ConfigStore.h"
 #include "config.h"
-#include <HTTPClient.h>
-#include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
-#include "../root_ca.h"
+#include <Preferences.h>
+#include "Log.h"
+
+static const char *const LOG_TAG = "device";
+
+// Last palette as kept before the palette history replaced it - only ever erased now
+static const char *const LEGACY_LAST_PALETTE_NAMESPACE = "last_palette";
 
 DeviceManager::DeviceManager() : lastStatusUpdate(0)
 {
@@ -102,7 +107,7 @@ bool DeviceManager::isValidLightingSystemType(const String &systemType)
 
 void DeviceManager::begin()
 {
-    preferences.begin(DEVICE_PREF_NAMESPACE, false);
+    ConfigStore::getInstance()->begin();
 
     // Load existing device info or generate minimal new info
     if (!loadDeviceInfo())
@@ -111,19 +116,19 @@ void DeviceManager::begin()
         saveDeviceInfo();
     }
 
-    Serial.println("📱 DeviceManager initialized");
-    Serial.println("🆔 Device ID: " + deviceInfo.deviceId);
-    Serial.println("📡 MAC Address: " + deviceInfo.macAddress);
-    Serial.println("🔧 Firmware Version: " + deviceInfo.firmwareVersion);
+    LOG_I("📱 DeviceManager initialized");
+    LOG_I("🆔 Device ID: %s", deviceInfo.deviceId.c_str());
+    LOG_I("📡 MAC Address: %s", deviceInfo.macAddress.c_str());
+    LOG_I("🔧 Firmware Version: %s", deviceInfo.firmwareVersion.c_str());
 
     if (deviceInfo.isProvisioned)
     {
-        Serial.println("✅ Device is provisioned");
+        LOG_I("✅ Device is provisioned");
     }
     else
     {
-        Serial.println("⚠ Device needs provisioning");
-        Serial.println("🔑 Pairing Code: " + deviceInfo.pairingCode);
+        LOG_W("⚠ Device needs provisioning");
+        LOG_I("🔑 Pairing Code: %s", deviceInfo.pairingCode.c_str());
     }
 }
 
@@ -136,7 +141,7 @@ void DeviceManager::generateMinimalDeviceInfo()
     deviceInfo.isOnline = false;
     deviceInfo.deviceId = ""; // Will be assigned by server during registration
 
-    Serial.println("🔄 Generated minimal device info (UUID will be assigned by server)");
+    LOG_I("🔄 Generated minimal device info (UUID will be assigned by server)");
 }
 
 void DeviceManager::generateDeviceInfo()
@@ -171,61 +176,71 @@ void DeviceManager::generateDeviceInfo()
         }
     }
 
-    Serial.println("🔄 Generated new device info");
+    LOG_I("🔄 Generated new device info");
 }
 
 bool DeviceManager::saveDeviceInfo()
 {
-    preferences.putString(PREF_DEVICE_ID, deviceInfo.deviceId);
-    preferences.putString(PREF_MAC_ADDRESS, deviceInfo.macAddress);
-    preferences.putBool(PREF_IS_PROVISIONED, deviceInfo.isProvisioned);
+    bool success = ConfigStore::getInstance()->update([this](StoredConfig &stored)
+                                                      {
+        ConfigStore::setField(stored.deviceId, deviceInfo.deviceId);
+        ConfigStore::setField(stored.macAddress, deviceInfo.macAddress);
+        stored.isProvisioned = deviceInfo.isProvisioned;
+
+        // Save server-provided pairing code
+        if (deviceInfo.pairingCode.length() > 0)
+        {
+            ConfigStore::setField(stored.pairingCode, deviceInfo.pairingCode);
+        } });
 
-    // Save server-provided pairing code
-    if (deviceInfo.pairingCode.length() > 0)
+    if (success)
     {
-        preferences.putString(PREF_PAIRING_CODE, deviceInfo.pairingCode);
+        LOG_I("💾 Device info saved");
     }
-
-    Serial.println("💾 Device info saved");
-    return true;
+    else
+    {
+        LOG_E("❌ Failed to save device info");
+    }
+    return success;
 }
 
 bool DeviceManager::loadDeviceInfo()
 {
-    Serial.println("📂 Loading device info from NVS flash storage...");
+    LOG_I("📂 Loading device info from NVS flash storage...");
 
-    String savedDeviceId = preferences.getString(PREF_DEVICE_ID, "");
+    StoredConfig stored = ConfigStore::getInstance()->get();
+    String savedDeviceId = stored.deviceId;
 
     if (savedDeviceId.length() == 0)
     {
-        Serial.println("⚠️  No device ID found in NVS - treating as first boot or NVS data loss");
+        LOG_W("⚠️  No device ID found in NVS - treating as first boot or NVS data loss");
         return false;
     }
 
     deviceInfo.deviceId = savedDeviceId;
-    deviceInfo.macAddress = preferences.getString(PREF_MAC_ADDRESS, WiFi.macAddress());
-    deviceInfo.isProvisioned = preferences.getBool(PREF_IS_PROVISIONED, false);
+    deviceInfo.macAddress = stored.macAddress[0] != '\0' ? String(stored.macAddress) : WiFi.macAddress();
+    deviceInfo.isProvisioned = stored.isProvisioned;
     deviceInfo.firmwareVersion = FIRMWARE_VERSION;
     deviceInfo.isOnline = false;
 
     // Load pairing code from server (stored during registration)
     // Don't generate local pairing codes - server provides authoritative codes
-    deviceInfo.pairingCode = preferences.getString(PREF_PAIRING_CODE, "");
+    deviceInfo.pairingCode = stored.pairingCode;
     if (!deviceInfo.isProvisioned && deviceInfo.pairingCode.length() == 0)
     {
         // No stored pairing code yet - will be assigned during server registration
         deviceInfo.pairingCode = "";
     }
 
-    Serial.println("✅ Device info loaded from NVS");
-    Serial.println("   Device ID: " + deviceInfo.deviceId);
-    Serial.println("   MAC: " + deviceInfo.macAddress);
-    Serial.println("   Pairing Code: " + deviceInfo.pairingCode);
-    Serial.println("   Local Provisioned State: " + String(deviceInfo.isProvisioned ? "YES" : "NO"));
+    LOG_I("✅ Device info loaded from NVS");
+    LOG_I("   Device ID: %s", deviceInfo.deviceId.c_str());
+    LOG_I("   MAC: %s", deviceInfo.macAddress.c_str());
+    LOG_I("   Pairing Code: %s", deviceInfo.pairingCode.c_str());
+    LOG_I("   Local Provisioned State: %s", deviceInfo.isProvisioned ? "YES" : "NO");
 
     if (!deviceInfo.isProvisioned)
     {
-        Serial.println("⚠️  Local NVS shows device NOT provisioned - will verify with backend");
+        LOG_W("⚠️  Local NVS shows device NOT provisioned - will verify with backend");
     }
 
     return true;
@@ -235,47 +250,11 @@ bool DeviceManager::registerMinimalWithServer(const String &serverUrl)
 {
     if (serverUrl.length() == 0)
     {
-        Serial.println("❌ No server URL provided for minimal registration");
+        LOG_E("❌ No server URL provided for minimal registration");
         return false;
     }
 
-    // Convert WebSocket URL to HTTPS URL for registration
-    String httpUrl = serverUrl;
-    httpUrl.replace("ws://", "http://");
-    httpUrl.replace("wss://", "https://");
-
-    // Remove WebSocket port and path, add API endpoint
-    // For HTTPS, Nginx handles routing - no need to specify port 3000
-    int portIndex = httpUrl.lastIndexOf(':');
-    if (portIndex > 8) // After https://
-    {
-        String baseUrl = httpUrl.substring(0, portIndex);
-        // Remove any path after the port
-        int pathIndex = baseUrl.indexOf('/', 8);
-        if (pathIndex > 0)
-        {
-            baseUrl = baseUrl.substring(0, pathIndex);
-        }
-        httpUrl = baseUrl + "/devices/register";
-    }
-    else
-    {
-        // Remove any path
-        int pathIndex = httpUrl.indexOf('/', 8);
-        if (pathIndex > 0)
-        {
-            httpUrl = httpUrl.substring(0, pathIndex);
-        }
-        httpUrl += "/devices/register";
-    }
-
-    // Configure secure client with root CA certificate
-    WiFiClientSecure secureClient;
-    secureClient.setCACert(fallback_root_ca);
-
-    HTTPClient http;
-    http.begin(secureClient, httpUrl);
-    http.addHeader("Content-Type", "application/json");
+    String path = "/devices/register";
 
     // Minimal registration - only required field per backend documentation
     // This significantly reduces memory usage and startup time
@@ -286,25 +265,25 @@ bool DeviceManager::registerMinimalWithServer(const String &serverUrl)
     String payload;
     serializeJson(doc, payload);
 
-    Serial.println("📡 Performing minimal device registration...");
-    Serial.println("🌐 URL: " + httpUrl);
-    Serial.println("📦 Minimal Payload: " + payload);
+    LOG_I("📡 Performing minimal device registration...");
+    LOG_I("🌐 URL: %s%s", SecureTransport::apiBaseFromServerUrl(serverUrl).c_str(), path.c_str());
+    LOG_D("📦 Minimal Payload: %s", payload.c_str());
 
-    int httpResponseCode = http.POST(payload);
+    String response;
+    int httpResponseCode = transport.request(serverUrl, path, "POST", payload, &response);
 
     if (httpResponseCode == 200 || httpResponseCode == 201)
     {
-        String response = http.getString();
-        Serial.println("✅ Minimal device registration successful!");
+        LOG_I("✅ Minimal device registration successful!");
 
         // Only print first 200 chars of response to avoid memory issues
         if (response.length() > 200)
         {
-            Serial.println("📨 Response: " + response.substring(0, 200) + "...");
+            LOG_D("📨 Response: %.200s...", response.c_str());
         }
         else
         {
-            Serial.println("📨 Response: " + response);
+            LOG_D("📨 Response: %s", response.c_str());
         }
 
         // Parse response to get device ID and pairing code
@@ -326,18 +305,18 @@ bool DeviceManager::registerMinimalWithServer(const String &serverUrl)
             if (deviceData["id"].is<String>())
             {
                 deviceInfo.deviceId = deviceData["id"].as<String>();
-                Serial.println("🆔 Server assigned Device UUID: " + deviceInfo.deviceId);
+                LOG_I("🆔 Server assigned Device UUID: %s", deviceInfo.deviceId.c_str());
             }
             else if (deviceData["deviceId"].is<String>())
             {
                 deviceInfo.deviceId = deviceData["deviceId"].as<String>();
-                Serial.println("🆔 Server assigned Device UUID: " + deviceInfo.deviceId);
+                LOG_I("🆔 Server assigned Device UUID: %s", deviceInfo.deviceId.c_str());
             }
 
             if (deviceData["pairingCode"].is<String>())
             {
                 deviceInfo.pairingCode = deviceData["pairingCode"].as<String>();
-                Serial.println("🔑 Server assigned Pairing Code: " + deviceInfo.pairingCode);
+                LOG_I("🔑 Server assigned Pairing Code: %s", deviceInfo.pairingCode.c_str());
             }
 
             // Check if device is already claimed/provisioned - MULTIPLE CHECKS FOR ROBUSTNESS
@@ -348,7 +327,7 @@ bool DeviceManager::registerMinimalWithServer(const String &serverUrl)
             if (deviceData["status"].is<String>())
             {
                 String deviceStatus = deviceData["status"].as<String>();
-                Serial.println("📊 Backend Device Status: " + deviceStatus);
+                LOG_I("📊 Backend Device Status: %s", deviceStatus.c_str());
                 if (deviceStatus == "claimed")
                 {
                     isClaimed = true;
@@ -359,7 +338,7 @@ bool DeviceManager::registerMinimalWithServer(const String &serverUrl)
             if (deviceData["isProvisioned"].is<bool>())
             {
                 bool backendProvisioned = deviceData["isProvisioned"].as<bool>();
-                Serial.println("📊 Backend isProvisioned: " + String(backendProvisioned ? "true" : "false"));
+                LOG_I("📊 Backend isProvisioned: %s", backendProvisioned ? "true" : "false");
                 if (backendProvisioned)
                 {
                     isClaimed = true;
@@ -374,7 +353,7 @@ bool DeviceManager::registerMinimalWithServer(const String &serverUrl)
                 {
                     isClaimed = true;
                     ownerInfo = ownerEmail;
-                    Serial.println("👤 Device Owner Email: " + ownerEmail);
+                    LOG_I("👤 Device Owner Email: %s", ownerEmail.c_str());
                 }
             }
 
@@ -392,7 +371,7 @@ bool DeviceManager::registerMinimalWithServer(const String &serverUrl)
                     {
                         ownerInfo = ownerName;
                     }
-                    Serial.println("👤 Device Owner Name: " + ownerName);
+                    LOG_I("👤 Device Owner Name: %s", ownerName.c_str());
                 }
             }
 
@@ -400,134 +379,91 @@ bool DeviceManager::registerMinimalWithServer(const String &serverUrl)
             if (isClaimed)
             {
                 deviceInfo.isProvisioned = true;
-                Serial.println("✅ Device is CLAIMED - marking as provisioned");
+                LOG_I("✅ Device is CLAIMED - marking as provisioned");
                 if (ownerInfo.length() > 0)
                 {
-                    Serial.println("👤 Claimed by: " + ownerInfo);
+                    LOG_I("👤 Claimed by: %s", ownerInfo.c_str());
                 }
-                Serial.println("🔄 Controller provisioning state restored from backend!");
+                LOG_I("🔄 Controller provisioning state restored from backend!");
             }
             else
             {
                 deviceInfo.isProvisioned = false;
-                Serial.println("📝 Device is NOT claimed - waiting for user pairing");
+                LOG_I("📝 Device is NOT claimed - waiting for user pairing");
             }
 
             // Parse and store lighting configuration from backend (if present)
-            if (deviceData["lightingSystem"].is<String>())
-            {
-                String lightingSystem = deviceData["lightingSystem"].as<String>();
-                if (lightingSystem.length() > 0 && lightingSystem != "null")
-                {
-                    Serial.println("\n💡 Backend returned lighting configuration:");
-                    Serial.println("   System Type: " + lightingSystem);
-
-                    // Store in lighting preferences for LightManager to load
-                    Preferences lightingPrefs;
-                    lightingPrefs.begin("light_config", false);
-
-                    lightingPrefs.putString("system_type", lightingSystem);
-                    Serial.println("   ✅ Saved system type to NVS");
-
-                    if (deviceData["lightingHost"].is<String>())
-                    {
-                        String lightingHost = deviceData["lightingHost"].as<String>();
-                        if (lightingHost.length() > 0 && lightingHost != "null")
-                        {
-                            lightingPrefs.putString("host_addr", lightingHost);
-                            Serial.println("   ✅ Saved host address: " + lightingHost);
-                        }
-                    }
-
-                    if (deviceData["lightingPort"].is<int>())
-                    {
-                        int lightingPort = deviceData["lightingPort"].as<int>();
-                        if (lightingPort > 0)
-                        {
-                            lightingPrefs.putInt("port", lightingPort);
-                            Serial.println("   ✅ Saved port: " + String(lightingPort));
-                        }
-                    }
-
-                    if (deviceData["lightingAuthToken"].is<String>())
-                    {
-                        String authToken = deviceData["lightingAuthToken"].as<String>();
-                        if (authToken.length() > 0 && authToken != "null")
-                        {
-                            lightingPrefs.putString("auth_token", authToken);
-                            Serial.println("   ✅ Saved auth token (length: " + String(authToken.length()) + ")");
-                        }
-                    }
-
-                    lightingPrefs.end();
-                    Serial.println("🔄 Lighting configuration restored from backend!\n");
-                }
-            }
+            storeBackendLightingConfig(deviceData);
         }
 
         saveDeviceInfo();
-        http.end();
         return true;
     }
     else
     {
-        Serial.println("❌ Minimal device registration failed");
-        Serial.println("📊 HTTP Response Code: " + String(httpResponseCode));
+        LOG_E("❌ Minimal device registration failed");
+        LOG_I("📊 HTTP Response Code: %d", httpResponseCode);
         if (httpResponseCode > 0)
         {
-            Serial.println("📨 Response: " + http.getString());
+            LOG_D("📨 Response: %s", response.c_str());
         }
-        http.end();
         return false;
     }
 }
 
-// Full registration with capabilities - should be called after minimal registration and system verification
-bool DeviceManager::registerWithServer(const String &serverUrl)
+void DeviceManager::storeBackendLightingConfig(JsonVariant deviceData)
 {
-    if (serverUrl.length() == 0)
+    if (!deviceData["lightingSystem"].is<String>())
     {
-        Serial.println("❌ No server URL provided for full registration");
-        return false;
+        return;
     }
 
-    // Convert WebSocket URL to HTTPS URL for registration
-    String httpUrl = serverUrl;
-    httpUrl.replace("ws://", "http://");
-    httpUrl.replace("wss://", "https://");
-
-    // Remove WebSocket port and path, add API endpoint
-    // For HTTPS, Nginx handles routing - no need to specify port
-    int portIndex = httpUrl.lastIndexOf(':');
-    if (portIndex > 8) // After https://
+    String lightingSystem = deviceData["lightingSystem"].as<String>();
+    if (lightingSystem.length() == 0 || lightingSystem == "null")
     {
-        String baseUrl = httpUrl.substring(0, portIndex);
-        // Remove any path after the port
-        int pathIndex = baseUrl.indexOf('/', 8);
-        if (pathIndex > 0)
+        return;
+    }
+
+    LOG_I("💡 Backend returned lighting configuration:");
+    LOG_I("   System Type: %s", lightingSystem.c_str());
+
+    String lightingHost = deviceData["lightingHost"].is<String>() ? deviceData["lightingHost"].as<String>() : "";
+    int lightingPort = deviceData["lightingPort"].is<int>() ? deviceData["lightingPort"].as<int>() : 0;
+    String authToken = deviceData["lightingAuthToken"].is<String>() ? deviceData["lightingAuthToken"].as<String>() : "";
+
+    // Store for LightManager to load - one write for all fields
+    ConfigStore::getInstance()->update([&](StoredConfig &stored)
+                                       {
+        ConfigStore::setField(stored.lightingSystem, lightingSystem);
+        if (lightingHost.length() > 0 && lightingHost != "null")
         {
-            baseUrl = baseUrl.substring(0, pathIndex);
+            ConfigStore::setField(stored.lightingHost, lightingHost);
+            LOG_I("   Host address: %s", lightingHost.c_str());
         }
-        httpUrl = baseUrl + "/devices/register";
-    }
-    else
-    {
-        // Remove any path
-        int pathIndex = httpUrl.indexOf('/', 8);
-        if (pathIndex > 0)
+        if (lightingPort > 0)
         {
-            httpUrl = httpUrl.substring(0, pathIndex);
+            stored.lightingPort = lightingPort;
+            LOG_I("   Port: %d", lightingPort);
         }
-        httpUrl += "/devices/register";
-    }
+        if (authToken.length() > 0 && authToken != "null")
+        {
+            ConfigStore::setField(stored.lightingAuthToken, authToken);
+            LOG_I("   Auth token (length: %u)", (unsigned)authToken.length());
+        } });
+
+    LOG_I("🔄 Lighting configuration restored from backend!");
+}
 
-    // Configure secure client with root CA certificate
-    WiFiClientSecure secureClient;
-    secureClient.setCACert(fallback_root_ca);
+// Full registration with capabilities - should be called after minimal registration and system verification
+bool DeviceManager::registerWithServer(const String &serverUrl)
+{
+    if (serverUrl.length() == 0)
+    {
+        LOG_E("❌ No server URL provided for full registration");
+        return false;
+    }
 
-    HTTPClient http;
-    http.begin(secureClient, httpUrl);
-    http.addHeader("Content-Type", "application/json");
+    String path = "/devices/register";
 
     // Prepare registration data according to RegisterDeviceDto schema
     JsonDocument doc;
@@ -540,9 +476,8 @@ bool DeviceManager::registerWithServer(const String &serverUrl)
     doc["ipAddress"] = deviceInfo.ipAddress;
 
     // Include lighting configuration if available
-    Preferences lightingPrefs;
-    lightingPrefs.begin("light_config", true); // Use same namespace as LightManager
-    String lightingSystem = lightingPrefs.getString("system_type", "");
+    StoredConfig stored = ConfigStore::getInstance()->get();
+    String lightingSystem = stored.lightingSystem;
 
     if (lightingSystem.length() > 0)
     {
@@ -550,9 +485,9 @@ bool DeviceManager::registerWithServer(const String &serverUrl)
         {
             doc["lightingSystemType"] = lightingSystem;
 
-            String lightingHost = lightingPrefs.getString("host_addr", "");
-            int lightingPort = lightingPrefs.getInt("port", 0);
-            String authToken = lightingPrefs.getString("auth_token", "");
+            String lightingHost = stored.lightingHost;
+            int lightingPort = stored.lightingPort;
+            String authToken = stored.lightingAuthToken;
 
             if (lightingHost.length() > 0)
             {
@@ -569,42 +504,41 @@ bool DeviceManager::registerWithServer(const String &serverUrl)
                 doc["lightingAuthToken"] = authToken;
             }
 
-            Serial.println("📡 Including lighting configuration in registration:");
-            Serial.println("💡 System: " + lightingSystem);
+            LOG_I("📡 Including lighting configuration in registration:");
+            LOG_I("💡 System: %s", lightingSystem.c_str());
             if (lightingHost.length() > 0)
             {
-                Serial.println("🌐 Host: " + lightingHost + (lightingPort > 0 ? ":" + String(lightingPort) : ""));
+                LOG_I("🌐 Host: %s:%d", lightingHost.c_str(), lightingPort);
             }
         }
         else
         {
-            Serial.println("⚠ Invalid lighting system type '" + lightingSystem + "' - skipping in registration");
-            Serial.println("📋 Valid types: nanoleaf, wled, ws2812, philips_hue");
+            LOG_W("⚠ Invalid lighting system type '%s' - skipping in registration", lightingSystem.c_str());
+            LOG_I("📋 Valid types: nanoleaf, wled, ws2812, philips_hue");
         }
     }
-    lightingPrefs.end();
 
     String payload;
     serializeJson(doc, payload);
 
-    Serial.println("📡 Registering device with server...");
-    Serial.println("🌐 URL: " + httpUrl);
-    Serial.println("📦 Payload: " + payload);
+    LOG_I("📡 Registering device with server...");
+    LOG_I("🌐 URL: %s%s", SecureTransport::apiBaseFromServerUrl(serverUrl).c_str(), path.c_str());
+    LOG_D("📦 Payload: %s", payload.c_str());
 
-    int httpResponseCode = http.POST(payload);
+    String response;
+    int httpResponseCode = transport.request(serverUrl, path, "POST", payload, &response);
 
     if (httpResponseCode == 200 || httpResponseCode == 201)
     {
-        String response = http.getString();
-        Serial.println("✅ Device registered successfully!");
+        LOG_I("✅ Device registered successfully!");
         // Only print first 200 chars of response to avoid memory issues
         if (response.length() > 200)
         {
-            Serial.println("📨 Response: " + response.substring(0, 200) + "...");
+            LOG_D("📨 Response: %.200s...", response.c_str());
         }
         else
         {
-            Serial.println("📨 Response: " + response);
+            LOG_D("📨 Response: %s", response.c_str());
         }
 
         // Parse response to get device ID and pairing code
@@ -625,18 +559,18 @@ bool DeviceManager::registerWithServer(const String &serverUrl)
             if (deviceData["id"].is<String>())
             {
                 deviceInfo.deviceId = deviceData["id"].as<String>();
-                Serial.println("🆔 Server assigned Device ID: " + deviceInfo.deviceId);
+                LOG_I("🆔 Server assigned Device ID: %s", deviceInfo.deviceId.c_str());
             }
             else if (deviceData["deviceId"].is<String>())
             {
                 deviceInfo.deviceId = deviceData["deviceId"].as<String>();
-                Serial.println("🆔 Server assigned Device ID: " + deviceInfo.deviceId);
+                LOG_I("🆔 Server assigned Device ID: %s", deviceInfo.deviceId.c_str());
             }
 
             if (deviceData["pairingCode"].is<String>())
             {
                 deviceInfo.pairingCode = deviceData["pairingCode"].as<String>();
-                Serial.println("🔑 Server assigned Pairing Code: " + deviceInfo.pairingCode);
+                LOG_I("🔑 Server assigned Pairing Code: %s", deviceInfo.pairingCode.c_str());
             }
 
             // Check if device is already claimed/provisioned - MULTIPLE CHECKS FOR ROBUSTNESS
@@ -647,7 +581,7 @@ bool DeviceManager::registerWithServer(const String &serverUrl)
             if (deviceData["status"].is<String>())
             {
                 String deviceStatus = deviceData["status"].as<String>();
-                Serial.println("📊 Backend Device Status: " + deviceStatus);
+                LOG_I("📊 Backend Device Status: %s", deviceStatus.c_str());
                 if (deviceStatus == "claimed")
                 {
                     isClaimed = true;
@@ -658,7 +592,7 @@ bool DeviceManager::registerWithServer(const String &serverUrl)
             if (deviceData["isProvisioned"].is<bool>())
             {
                 bool backendProvisioned = deviceData["isProvisioned"].as<bool>();
-                Serial.println("📊 Backend isProvisioned: " + String(backendProvisioned ? "true" : "false"));
+                LOG_I("📊 Backend isProvisioned: %s", backendProvisioned ? "true" : "false");
                 if (backendProvisioned)
                 {
                     isClaimed = true;
@@ -673,7 +607,7 @@ bool DeviceManager::registerWithServer(const String &serverUrl)
                 {
                     isClaimed = true;
                     ownerInfo = ownerEmail;
-                    Serial.println("👤 Device Owner Email: " + ownerEmail);
+                    LOG_I("👤 Device Owner Email: %s", ownerEmail.c_str());
                 }
             }
 
@@ -691,7 +625,7 @@ bool DeviceManager::registerWithServer(const String &serverUrl)
                     {
                         ownerInfo = ownerName;
                     }
-                    Serial.println("👤 Device Owner Name: " + ownerName);
+                    LOG_I("👤 Device Owner Name: %s", ownerName.c_str());
                 }
             }
 
@@ -699,84 +633,34 @@ bool DeviceManager::registerWithServer(const String &serverUrl)
             if (isClaimed)
             {
                 deviceInfo.isProvisioned = true;
-                Serial.println("✅ Device is CLAIMED - marking as provisioned");
+                LOG_I("✅ Device is CLAIMED - marking as provisioned");
                 if (ownerInfo.length() > 0)
                 {
-                    Serial.println("👤 Claimed by: " + ownerInfo);
+                    LOG_I("👤 Claimed by: %s", ownerInfo.c_str());
                 }
-                Serial.println("🔄 Controller provisioning state restored from backend!");
+                LOG_I("🔄 Controller provisioning state restored from backend!");
             }
             else
             {
                 deviceInfo.isProvisioned = false;
-                Serial.println("📝 Device is NOT claimed - waiting for user pairing");
+                LOG_I("📝 Device is NOT claimed - waiting for user pairing");
             }
 
             // Parse and store lighting configuration from backend (if present)
-            if (deviceData["lightingSystem"].is<String>())
-            {
-                String lightingSystem = deviceData["lightingSystem"].as<String>();
-                if (lightingSystem.length() > 0 && lightingSystem != "null")
-                {
-                    Serial.println("\n💡 Backend returned lighting configuration:");
-                    Serial.println("   System Type: " + lightingSystem);
-
-                    // Store in lighting preferences for LightManager to load
-                    Preferences lightingPrefs;
-                    lightingPrefs.begin("light_config", false);
-
-                    lightingPrefs.putString("system_type", lightingSystem);
-                    Serial.println("   ✅ Saved system type to NVS");
-
-                    if (deviceData["lightingHost"].is<String>())
-                    {
-                        String lightingHost = deviceData["lightingHost"].as<String>();
-                        if (lightingHost.length() > 0 && lightingHost != "null")
-                        {
-                            lightingPrefs.putString("host_addr", lightingHost);
-                            Serial.println("   ✅ Saved host address: " + lightingHost);
-                        }
-                    }
-
-                    if (deviceData["lightingPort"].is<int>())
-                    {
-                        int lightingPort = deviceData["lightingPort"].as<int>();
-                        if (lightingPort > 0)
-                        {
-                            lightingPrefs.putInt("port", lightingPort);
-                            Serial.println("   ✅ Saved port: " + String(lightingPort));
-                        }
-                    }
-
-                    if (deviceData["lightingAuthToken"].is<String>())
-                    {
-                        String authToken = deviceData["lightingAuthToken"].as<String>();
-                        if (authToken.length() > 0 && authToken != "null")
-                        {
-                            lightingPrefs.putString("auth_token", authToken);
-                            Serial.println("   ✅ Saved auth token (length: " + String(authToken.length()) + ")");
-                        }
-                    }
-
-                    lightingPrefs.end();
-                    Serial.println("🔄 Lighting configuration restored from backend!\n");
-                }
-            }
+            storeBackendLightingConfig(deviceData);
         }
 
         saveDeviceInfo();
-        http.end();
         return true;
     }
     else
     {
-        Serial.println("❌ Device registration failed");
-        Serial.println("📊 HTTP Response Code: " + String(httpResponseCode));
+        LOG_E("❌ Device registration failed");
+        LOG_I("📊 HTTP Response Code: %d", httpResponseCode);
         if (httpResponseCode > 0)
         {
-            Serial.println("📨 Response: " + http.getString());
+            LOG_D("📨 Response: %s", response.c_str());
         }
-        http.end();
         return false;
     }
 }
@@ -788,37 +672,7 @@ bool DeviceManager::updateStatus(const String &serverUrl, LightManager *lightMan
         return false;
     }
 
-    // Convert WebSocket URL to HTTPS URL for status update
-    String httpUrl = serverUrl;
-    httpUrl.replace("ws://", "http://");
-    httpUrl.replace("wss://", "https://");
-
-    // Remove WebSocket port and path, add API endpoint
-    // For HTTPS, Nginx handles routing - no need to specify port
-    int portIndex = httpUrl.lastIndexOf(':');
-    if (portIndex > 8) // After https://
-    {
-        String baseUrl = httpUrl.substring(0, portIndex);
-        httpUrl = baseUrl + "/devices/" + deviceInfo.deviceId + "/status";
-    }
-    else
-    {
-        // Remove any path
-        int pathIndex = httpUrl.indexOf('/', 8);
-        if (pathIndex > 0)
-        {
-            httpUrl = httpUrl.substring(0, pathIndex);
-        }
-        httpUrl += "/devices/" + deviceInfo.deviceId + "/status";
-    }
-
-    // Configure secure client with root CA certificate
-    WiFiClientSecure secureClient;
-    secureClient.setCACert(fallback_root_ca);
-
-    HTTPClient http;
-    http.begin(secureClient, httpUrl);
-    http.addHeader("Content-Type", "application/json");
+    String path = "/devices/" + deviceInfo.deviceId + "/status";
 
     // Create status update payload according to UpdateStatusDto schema
     JsonDocument doc;
@@ -842,8 +696,7 @@ bool DeviceManager::updateStatus(const String &serverUrl, LightManager *lightMan
     String payload;
     serializeJson(doc, payload);
 
-    int httpResponseCode = http.PUT(payload);
-    http.end();
+    int httpResponseCode = transport.request(serverUrl, path, "PUT", payload);
 
     if (httpResponseCode == 200)
     {
@@ -858,13 +711,13 @@ bool DeviceManager::updateLightingConfiguration(const String &serverUrl, LightMa
 {
     if (serverUrl.length() == 0 || deviceInfo.deviceId.length() == 0)
     {
-        Serial.println("❌ Cannot update lighting config: No server URL or device ID");
+        LOG_E("❌ Cannot update lighting config: No server URL or device ID");
         return false;
     }
 
     if (!lightManager)
     {
-        Serial.println("❌ Cannot update lighting config: No LightManager provided");
+        LOG_E("❌ Cannot update lighting config: No LightManager provided");
         return false;
     }
 
@@ -872,73 +725,42 @@ bool DeviceManager::updateLightingConfiguration(const String &serverUrl, LightMa
     String systemType = lightManager->getCurrentSystemType();
     if (systemType.length() == 0)
     {
-        Serial.println("⚠️  No lighting system configured, skipping backend update");
+        LOG_W("⚠️  No lighting system configured, skipping backend update");
         return false;
     }
 
-    Serial.println("📤 Sending lighting configuration to backend...");
-    Serial.println("   System Type: " + systemType);
-
-    // Convert WebSocket URL to HTTPS URL
-    String httpUrl = serverUrl;
-    httpUrl.replace("ws://", "http://");
-    httpUrl.replace("wss://", "https://");
-
-    // Build URL: /devices/{id}/lighting
-    int portIndex = httpUrl.lastIndexOf(':');
-    if (portIndex > 8) // After https://
-    {
-        String baseUrl = httpUrl.substring(0, portIndex);
-        httpUrl = baseUrl + "/devices/" + deviceInfo.deviceId + "/lighting";
-    }
-    else
-    {
-        int pathIndex = httpUrl.indexOf('/', 8);
-        if (pathIndex > 0)
-        {
-            httpUrl = httpUrl.substring(0, pathIndex);
-        }
-        httpUrl += "/devices/" + deviceInfo.deviceId + "/lighting";
-    }
-
-    // Configure secure client
-    WiFiClientSecure secureClient;
-    secureClient.setCACert(fallback_root_ca);
+    LOG_I("📤 Sending lighting configuration to backend...");
+    LOG_I("   System Type: %s", systemType.c_str());
 
-    HTTPClient http;
-    http.begin(secureClient, httpUrl);
-    http.addHeader("Content-Type", "application/json");
+    String path = "/devices/" + deviceInfo.deviceId + "/lighting";
 
     // Build payload according to UpdateLightingSystemDto schema
     JsonDocument doc;
     doc["lightingSystemType"] = systemType;
 
-    // Load config from preferences to get current values
-    Preferences lightingPrefs;
-    lightingPrefs.begin("light_config", true);
-
-    String hostAddr = lightingPrefs.getString("host_addr", "");
-    int port = lightingPrefs.getInt("port", 0);
-    String authToken = lightingPrefs.getString("auth_token", "");
+    // Load config from the store to get current values
+    StoredConfig stored = ConfigStore::getInstance()->get();
 
-    lightingPrefs.end();
+    String hostAddr = stored.lightingHost;
+    int port = stored.lightingPort;
+    String authToken = stored.lightingAuthToken;
 
     if (hostAddr.length() > 0)
     {
         doc["lightingHostAddress"] = hostAddr;
-        Serial.println("   Host: " + hostAddr);
+        LOG_I("   Host: %s", hostAddr.c_str());
     }
 
     if (port > 0)
     {
         doc["lightingPort"] = port;
-        Serial.println("   Port: " + String(port));
+        LOG_I("   Port: %d", port);
     }
 
     if (authToken.length() > 0)
     {
         doc["lightingAuthToken"] = authToken;
-        Serial.println("   Auth Token: (length: " + String(authToken.length()) + ")");
+        LOG_I("   Auth Token: (length: %u)", (unsigned)authToken.length());
     }
 
     doc["lightingSystemConfigured"] = true;
@@ -947,25 +769,24 @@ bool DeviceManager::updateLightingConfiguration(const String &serverUrl, LightMa
     String payload;
     serializeJson(doc, payload);
 
-    Serial.println("🌐 PUT " + httpUrl);
+    LOG_I("🌐 PUT %s%s", SecureTransport::apiBaseFromServerUrl(serverUrl).c_str(), path.c_str());
 
-    int httpResponseCode = http.PUT(payload);
+    String response;
+    int httpResponseCode = transport.request(serverUrl, path, "PUT", payload, &response);
 
     if (httpResponseCode == 200)
     {
-        Serial.println("✅ Lighting configuration sent to backend successfully");
-        http.end();
+        LOG_I("✅ Lighting configuration sent to backend successfully");
         return true;
     }
     else
     {
-        Serial.println("❌ Failed to send lighting configuration to backend");
-        Serial.println("📊 HTTP Response Code: " + String(httpResponseCode));
+        LOG_E("❌ Failed to send lighting configuration to backend");
+        LOG_I("📊 HTTP Response Code: %d", httpResponseCode);
         if (httpResponseCode > 0)
         {
-            Serial.println("📨 Response: " + http.getString());
+            LOG_D("📨 Response: %s", response.c_str());
         }
-        http.end();
         return false;
     }
 }
@@ -974,24 +795,25 @@ void DeviceManager::setProvisioned(bool provisioned)
 {
     deviceInfo.isProvisioned = provisioned;
 
-    // Save to NVS with verification
-    size_t written = preferences.putBool(PREF_IS_PROVISIONED, provisioned);
+    // Save to NVS (no write if the state is unchanged)
+    bool saved = ConfigStore::getInstance()->update([provisioned](StoredConfig &stored)
+                                                    { stored.isProvisioned = provisioned; });
 
-    if (written > 0)
+    if (saved)
     {
         if (provisioned)
         {
-            Serial.println("✅ Device marked as provisioned (saved to NVS)");
+            LOG_I("✅ Device marked as provisioned (saved to NVS)");
         }
         else
         {
-            Serial.println("⚠️  Device marked as not provisioned (saved to NVS)");
+            LOG_W("⚠️  Device marked as not provisioned (saved to NVS)");
         }
     }
     else
     {
-        Serial.println("❌ ERROR: Failed to save provisioned state to NVS!");
-        Serial.println("⚠️  This may indicate NVS storage issues");
+        LOG_E("❌ ERROR: Failed to save provisioned state to NVS!");
+        LOG_W("⚠️  This may indicate NVS storage issues");
     }
 }
 
@@ -1000,6 +822,12 @@ bool DeviceManager::isProvisioned()
     return deviceInfo.isProvisioned;
 }
 
+bool DeviceManager::canFastBoot()
+{
+    // Server-assigned IDs are canonical 36-character UUIDs
+    return deviceInfo.isProvisioned && deviceInfo.deviceId.length() == 36;
+}
+
 String DeviceManager::getDeviceId()
 {
     return deviceInfo.deviceId;
@@ -1022,18 +850,31 @@ DeviceInfo DeviceManager::getDeviceInfo()
 
 void DeviceManager::resetDevice()
 {
-    Serial.println("🔄 Resetting device...");
+    LOG_I("🔄 Resetting device...");
 
     // Clear all stored data
-    preferences.clear();
+    ConfigStore::getInstance()->clear();
+    PaletteHistory::erase();
+
+    // Opening read-only first keeps a missing namespace from being created just to clear it
+    Preferences prefs;
+    if (prefs.begin(LEGACY_LAST_PALETTE_NAMESPACE, true))
+    {
+        prefs.end();
+        if (prefs.begin(LEGACY_LAST_PALETTE_NAMESPACE, false))
+        {
+            prefs.clear();
+            prefs.end();
+        }
+    }
 
     // Regenerate device info
     generateDeviceInfo();
     saveDeviceInfo();
 
-    Serial.println("✅ Device reset complete");
-    Serial.println("🆔 New Device ID: " + deviceInfo.deviceId);
-    Serial.println("🔑 New Pairing Code: " + deviceInfo.pairingCode);
+    LOG_I("✅ Device reset complete");
+    LOG_I("🆔 New Device ID: %s", deviceInfo.deviceId.c_str());
+    LOG_I("🔑 New Pairing Code: %s", deviceInfo.pairingCode.c_str());
 }
 
 bool DeviceManager::shouldUpdateStatus()
@@ -1055,3 +896,13 @@ bool DeviceManager::isOnline()
 {
     return deviceInfo.isOnline;
 }
+
+void DeviceManager::closeBackendConnection()
+{
+    transport.close();
+}
+
+SecureTransport::Stats DeviceManager::getTransportStats() const
+{
+    return transport.getStats();
+}
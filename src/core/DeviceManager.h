@@ -17,6 +17,7 @@ class LightManager;
 #include <Preferences.h>
 #include <WiFi.h>
 #include "../config.h"
+#include "SecureTransport.h"
 
 struct DeviceInfo
 {
@@ -32,9 +33,9 @@ struct DeviceInfo
 class DeviceManager
 {
 private:
-    Preferences preferences;
     DeviceInfo deviceInfo;
     unsigned long lastStatusUpdate;
+    SecureTransport transport; // Kept-alive TLS connection shared by all backend REST calls
 
     void generateMinimalDeviceInfo();
     void generateDeviceInfo();
@@ -42,6 +43,7 @@ private:
     bool loadDeviceInfo();
     String generateUUIDFromMAC(const String &macAddress);
     bool isValidLightingSystemType(const String &systemType);
+    void storeBackendLightingConfig(JsonVariant deviceData);
 
 public:
     DeviceManager();
@@ -53,6 +55,11 @@ public:
     bool updateLightingConfiguration(const String &serverUrl, LightManager *lightManager);
     void setProvisioned(bool provisioned);
     bool isProvisioned();
+
+    /**
+     * Whether boot can skip HTTP registration (provisioned, with a server-assigned UUID)
+     */
+    bool canFastBoot();
     String getDeviceId();
     String getMacAddress();
     String getPairingCode();
@@ -64,6 +71,12 @@ public:
     // Status update helpers
     void setOnlineStatus(bool online);
     bool isOnline();
+
+    /**
+     * Drop the backend TLS connection (e.g. before freeing heap for a large operation)
+     */
+    void closeBackendConnection();
+    SecureTransport::Stats getTransportStats() const;
 };
 
 #endif
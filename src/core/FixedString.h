@@ -0,0 +1,105 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+/**
+ * Fixed String
+ * Inline, fixed-capacity replacement for Arduino String. The characters
+ * live inside the object (Capacity includes the terminator), so copying or
+ * assigning never touches the heap. Text that does not fit is cut at the
+ * capacity and truncated() reports it.
+ */
+template <size_t Capacity>
+class FixedString
+{
+    static_assert(Capacity > 1, "FixedString needs room for at least one character");
+
+public:
+    FixedString() : used(0), overflow(false) { buffer[0] = '\0'; }
+    FixedString(const char *text) : FixedString() { assign(text); }
+
+    FixedString &operator=(const char *text) { return assign(text); }
+    FixedString &operator=(const String &text) { return assign(text.c_str(), text.length()); }
+
+    template <size_t OtherCapacity>
+    FixedString &operator=(const FixedString<OtherCapacity> &other)
+    {
+        return assign(other.c_str(), other.length());
+    }
+
+    FixedString &assign(const char *text)
+    {
+        return assign(text, text ? strlen(text) : 0);
+    }
+
+    FixedString &assign(const char *text, size_t textLength)
+    {
+        clear();
+        return append(text, textLength);
+    }
+
+    FixedString &append(const char *text)
+    {
+        return append(text, text ? strlen(text) : 0);
+    }
+
+    FixedString &append(const char *text, size_t textLength)
+    {
+        size_t room = Capacity - 1 - used;
+        if (textLength > room)
+        {
+            textLength = room;
+            overflow = true;
+        }
+
+        memcpy(buffer + used, text, textLength);
+        used += textLength;
+        buffer[used] = '\0';
+        return *this;
+    }
+
+    /**
+     * Replace the contents with printf-style formatted text
+     */
+    FixedString &format(const char *pattern, ...) __attribute__((format(printf, 2, 3)))
+    {
+        va_list args;
+        va_start(args, pattern);
+        int written = vsnprintf(buffer, Capacity, pattern, args);
+        va_end(args);
+
+        if (written < 0)
+        {
+            clear();
+            return *this;
+        }
+        overflow = (size_t)written >= Capacity;
+        used = overflow ? Capacity - 1 : written;
+        return *this;
+    }
+
+    void clear()
+    {
+        used = 0;
+        overflow = false;
+        buffer[0] = '\0';
+    }
+
+    bool operator==(const char *text) const { return text && strcmp(buffer, text) == 0; }
+    bool operator!=(const char *text) const { return !(*this == text); }
+
+    const char *c_str() const { return buffer; }
+    size_t length() const { return used; }
+    bool isEmpty() const { return used == 0; }
+    bool truncated() const { return overflow; }
+    static constexpr size_t capacity() { return Capacity - 1; }
+
+private:
+    char buffer[Capacity];
+    size_t used;
+    bool overflow;
+};
+
+#endif // FIXED_STRING_H
@@ -0,0 +1,232 @@
+#include "Log.h"
+#include "MemoryTelemetry.h"
+
+uint8_t Log::ring[LOG_BUFFER_SIZE];
+size_t Log::head = 0;
+size_t Log::tail = 0;
+size_t Log::used = 0;
+uint32_t Log::firstSequence = 0;
+uint32_t Log::nextSequence = 0;
+uint32_t Log::printedSequence = 0;
+uint32_t Log::cursorSequence = 0;
+size_t Log::cursorOffset = 0;
+TaskHandle_t Log::drainTask = nullptr;
+portMUX_TYPE Log::lock = portMUX_INITIALIZER_UNLOCKED;
+
+void Log::begin()
+{
+    if (drainTask)
+    {
+        return;
+    }
+
+    if (xTaskCreate(drainEntry, "logdrain", LOG_DRAIN_TASK_STACK_SIZE, nullptr,
+                    LOG_DRAIN_TASK_PRIORITY, &drainTask) != pdPASS)
+    {
+        drainTask = nullptr;
+        Serial.println("⚠ Failed to start log drain task - logging synchronously");
+        return;
+    }
+
+    MemoryTelemetry::getInstance()->watchTask(drainTask, LOG_DRAIN_TASK_STACK_SIZE);
+}
+
+void Log::write(uint8_t level, const char *tag, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vwrite(level, tag, format, args);
+    va_end(args);
+}
+
+void Log::vwrite(uint8_t level, const char *tag, const char *format, va_list args)
+{
+    char message[LOG_LINE_SIZE];
+    int written = vsnprintf(message, sizeof(message), format, args);
+    if (written < 0)
+    {
+        return;
+    }
+
+    RecordHeader header;
+    header.timestamp = millis();
+    header.level = level;
+    header.tagLength = strnlen(tag, LOG_TAG_SIZE - 1);
+    header.messageLength = min((size_t)written, sizeof(message) - 1);
+    size_t recordSize = sizeof(header) + header.tagLength + header.messageLength;
+
+    portENTER_CRITICAL(&lock);
+    while (used + recordSize > sizeof(ring))
+    {
+        dropOldest();
+    }
+    copyIn(head, &header, sizeof(header));
+    copyIn(head + sizeof(header), tag, header.tagLength);
+    copyIn(head + sizeof(header) + header.tagLength, message, header.messageLength);
+    head = (head + recordSize) % sizeof(ring);
+    used += recordSize;
+    nextSequence++;
+    portEXIT_CRITICAL(&lock);
+
+    if (drainTask)
+    {
+        xTaskNotifyGive(drainTask);
+    }
+    else
+    {
+        drainSerial();
+    }
+}
+
+bool Log::read(uint32_t &sequence, Entry &entry)
+{
+    portENTER_CRITICAL(&lock);
+    if (sequence < firstSequence)
+    {
+        sequence = firstSequence; // Overwritten already - resume at the oldest record left
+    }
+    if (sequence >= nextSequence)
+    {
+        portEXIT_CRITICAL(&lock);
+        return false;
+    }
+
+    // Records are variable length - walk from the last read position (readers are sequential) or the oldest one
+    bool cursorValid = cursorSequence >= firstSequence && cursorSequence <= sequence;
+    uint32_t s = cursorValid ? cursorSequence : firstSequence;
+    size_t offset = cursorValid ? cursorOffset : tail;
+    RecordHeader header;
+    for (;; s++)
+    {
+        copyOut(offset, &header, sizeof(header));
+        if (s == sequence)
+        {
+            break;
+        }
+        offset = (offset + sizeof(header) + header.tagLength + header.messageLength) % sizeof(ring);
+    }
+    cursorSequence = sequence + 1;
+    cursorOffset = (offset + sizeof(header) + header.tagLength + header.messageLength) % sizeof(ring);
+
+    entry.sequence = sequence;
+    entry.timestamp = header.timestamp;
+    entry.level = header.level;
+    copyOut(offset + sizeof(header), entry.tag, header.tagLength);
+    entry.tag[header.tagLength] = '\0';
+    copyOut(offset + sizeof(header) + header.tagLength, entry.message, header.messageLength);
+    entry.message[header.messageLength] = '\0';
+    portEXIT_CRITICAL(&lock);
+
+    sequence++;
+    return true;
+}
+
+void Log::flush()
+{
+    drainSerial();
+}
+
+void Log::toJson(JsonObject out, uint32_t since, int maxEntries)
+{
+    JsonArray entries = out["entries"].to<JsonArray>();
+    uint32_t sequence = since;
+    uint32_t dropped = 0;
+    Entry entry;
+
+    for (int i = 0; i < maxEntries && read(sequence, entry); i++)
+    {
+        if (i == 0 && entry.sequence > since)
+        {
+            dropped = entry.sequence - since;
+        }
+
+        JsonObject item = entries.add<JsonObject>();
+        item["seq"] = entry.sequence;
+        item["t"] = entry.timestamp;
+        item["level"] = levelName(entry.level);
+        item["tag"] = entry.tag;
+        item["msg"] = entry.message;
+    }
+
+    out["next"] = sequence;
+    out["dropped"] = dropped;
+}
+
+const char *Log::levelName(uint8_t level)
+{
+    switch (level)
+    {
+    case LOG_LEVEL_ERROR:
+        return "error";
+    case LOG_LEVEL_WARN:
+        return "warn";
+    case LOG_LEVEL_INFO:
+        return "info";
+    case LOG_LEVEL_DEBUG:
+        return "debug";
+    default:
+        return "unknown";
+    }
+}
+
+void Log::copyIn(size_t offset, const void *data, size_t length)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    offset %= sizeof(ring);
+    size_t first = min(length, sizeof(ring) - offset);
+    memcpy(ring + offset, bytes, first);
+    memcpy(ring, bytes + first, length - first);
+}
+
+void Log::copyOut(size_t offset, void *data, size_t length)
+{
+    uint8_t *bytes = static_cast<uint8_t *>(data);
+    offset %= sizeof(ring);
+    size_t first = min(length, sizeof(ring) - offset);
+    memcpy(bytes, ring + offset, first);
+    memcpy(bytes + first, ring, length - first);
+}
+
+void Log::dropOldest()
+{
+    RecordHeader header;
+    copyOut(tail, &header, sizeof(header));
+    size_t recordSize = sizeof(header) + header.tagLength + header.messageLength;
+    tail = (tail + recordSize) % sizeof(ring);
+    used -= recordSize;
+    firstSequence++;
+}
+
+void Log::print(const Entry &entry)
+{
+    // Uptime in seconds, level letter (E/W/I/D) and tag - the fields getLogs reports too
+    char level = static_cast<char>(toupper(levelName(entry.level)[0]));
+    Serial.printf("%6lu.%03lu %c [%s] %s\n", (unsigned long)(entry.timestamp / 1000),
+                  (unsigned long)(entry.timestamp % 1000), level, entry.tag, entry.message);
+}
+
+void Log::drainSerial()
+{
+    Entry entry;
+    uint32_t sequence = printedSequence;
+
+    while (read(sequence, entry))
+    {
+        if (entry.sequence != printedSequence)
+        {
+            Serial.printf("⚠ %lu log records dropped before reaching Serial\n",
+                          (unsigned long)(entry.sequence - printedSequence));
+        }
+        print(entry);
+        printedSequence = sequence;
+    }
+}
+
+void Log::drainEntry(void *parameter)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        drainSerial();
+    }
+}
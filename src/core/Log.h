@@ -0,0 +1,121 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <stdarg.h>
+#include "../config.h"
+
+/**
+ * Log
+ * Leveled, printf-style logging into an in-RAM ring buffer. A record is a
+ * small binary header (timestamp, level, tag length, message length)
+ * followed by the tag and message bytes; when the ring is full the oldest
+ * records are overwritten. Writing formats on the caller's stack and copies
+ * under a spinlock, so it is safe from any task and never waits on the
+ * UART. A low-priority drain task prints new records to Serial; the ring
+ * can also be fetched on demand (WebSocket "getLogs").
+ *
+ * Use the LOG_E / LOG_W / LOG_I / LOG_D macros with a LOG_TAG defined in
+ * the translation unit. Levels above LOG_LEVEL expand to nothing - their
+ * arguments are not even evaluated.
+ */
+class Log
+{
+public:
+    struct Entry
+    {
+        uint32_t sequence;  // Monotonic record number
+        uint32_t timestamp; // millis() when written
+        uint8_t level;      // LOG_LEVEL_ERROR .. LOG_LEVEL_DEBUG
+        char tag[LOG_TAG_SIZE];
+        char message[LOG_LINE_SIZE];
+    };
+
+    /**
+     * Start the Serial drain task. Records written before this are printed
+     * synchronously, so boot messages are never held back.
+     */
+    static void begin();
+
+    static void write(uint8_t level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+    static void vwrite(uint8_t level, const char *tag, const char *format, va_list args);
+
+    /**
+     * Copy out the oldest record with a sequence number >= sequence
+     * @param sequence In: first record wanted. Out: the one after the record returned
+     * @param entry Filled with the record
+     * @return false if there is no such record yet
+     */
+    static bool read(uint32_t &sequence, Entry &entry);
+
+    /**
+     * Print every record the drain task has not printed yet (restart path only -
+     * it does not coordinate with the drain task)
+     */
+    static void flush();
+
+    /**
+     * Records from `since` on, oldest first
+     * @param out Object to fill ("entries", "next", "dropped")
+     * @param since First sequence number wanted (0 = everything still buffered)
+     * @param maxEntries Upper bound on entries returned
+     */
+    static void toJson(JsonObject out, uint32_t since, int maxEntries);
+
+    static const char *levelName(uint8_t level);
+
+private:
+    struct RecordHeader
+    {
+        uint32_t timestamp;
+        uint8_t level;
+        uint8_t tagLength;
+        uint16_t messageLength;
+    };
+
+    static uint8_t ring[LOG_BUFFER_SIZE];
+    static size_t head;               // Offset the next record is written at
+    static size_t tail;               // Offset of the oldest record
+    static size_t used;               // Bytes held by records
+    static uint32_t firstSequence;    // Sequence number of the record at tail
+    static uint32_t nextSequence;     // Sequence number the next record gets
+    static uint32_t printedSequence;  // Next record to print to Serial
+    static uint32_t cursorSequence;   // Record after the last one read...
+    static size_t cursorOffset;       // ...and its offset, so sequential reads do not rescan
+    static TaskHandle_t drainTask;
+    static portMUX_TYPE lock;
+
+    static void copyIn(size_t offset, const void *data, size_t length);
+    static void copyOut(size_t offset, void *data, size_t length);
+    static void dropOldest();
+    static void print(const Entry &entry);
+    static void drainSerial();
+    static void drainEntry(void *parameter);
+};
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(...) Log::write(LOG_LEVEL_ERROR, LOG_TAG, __VA_ARGS__)
+#else
+#define LOG_E(...) do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(...) Log::write(LOG_LEVEL_WARN, LOG_TAG, __VA_ARGS__)
+#else
+#define LOG_W(...) do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(...) Log::write(LOG_LEVEL_INFO, LOG_TAG, __VA_ARGS__)
+#else
+#define LOG_I(...) do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(...) Log::write(LOG_LEVEL_DEBUG, LOG_TAG, __VA_ARGS__)
+#else
+#define LOG_D(...) do { } while (0)
+#endif
+
+#endif // LOG_H
@@ -0,0 +1,276 @@
+#include "MemoryTelemetry.h"
+#include "Log.h"
+#include <Preferences.h>
+
+static const char *const LOG_TAG = "memory";
+
+MemoryTelemetry *MemoryTelemetry::instance = nullptr;
+const char *MemoryTelemetry::PREF_NAMESPACE = "mem_health";
+
+MemoryTelemetry *MemoryTelemetry::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new MemoryTelemetry();
+    }
+    return instance;
+}
+
+MemoryTelemetry::MemoryTelemetry()
+    : taskCount(0), fragmentedChecks(0), fragmentationRestarts(0), restartLimitLogged(false)
+{
+    memset(tasks, 0, sizeof(tasks));
+    memset(counters, 0, sizeof(counters));
+
+    Preferences prefs;
+    if (prefs.begin(PREF_NAMESPACE, true))
+    {
+        fragmentationRestarts = prefs.getUChar("restarts", 0);
+        prefs.end();
+    }
+}
+
+MemoryTelemetry::HeapSnapshot MemoryTelemetry::sample()
+{
+    HeapSnapshot snapshot;
+    snapshot.freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    snapshot.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    snapshot.minimumFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    snapshot.fragmentation = snapshot.freeHeap > 0
+                                 ? 100 - (uint8_t)((uint64_t)snapshot.largestBlock * 100 / snapshot.freeHeap)
+                                 : 100;
+    return snapshot;
+}
+
+bool MemoryTelemetry::isHealthy(size_t minFreeHeap, size_t minLargestBlock)
+{
+    HeapSnapshot heap = sample();
+
+    if (heap.freeHeap < minFreeHeap)
+    {
+        LOG_W("⚠️ LOW MEMORY WARNING: %u bytes free (minimum: %u)", (unsigned)heap.freeHeap, (unsigned)minFreeHeap);
+        return false;
+    }
+    if (heap.largestBlock < minLargestBlock)
+    {
+        LOG_W("⚠️ Heap fragmented: largest block %u bytes (needed: %u, %u%% fragmented)",
+              (unsigned)heap.largestBlock, (unsigned)minLargestBlock, heap.fragmentation);
+        return false;
+    }
+    return true;
+}
+
+bool MemoryTelemetry::canOpenTlsSession()
+{
+    return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) >= MEMORY_TLS_MIN_LARGEST_BLOCK;
+}
+
+void MemoryTelemetry::watchTask(TaskHandle_t handle, uint32_t stackSize)
+{
+    if (handle == nullptr)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&lock);
+    bool added = false;
+    bool known = false;
+    for (int i = 0; i < taskCount; i++)
+    {
+        known = known || tasks[i].handle == handle;
+    }
+    if (!known && taskCount < MEMORY_MAX_WATCHED_TASKS)
+    {
+        WatchedTask &task = tasks[taskCount];
+        task.handle = handle;
+        strlcpy(task.name, pcTaskGetName(handle), sizeof(task.name));
+        task.stackSize = stackSize;
+        task.minFree = uxTaskGetStackHighWaterMark(handle);
+        task.warned = false;
+        taskCount++;
+        added = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (!known && !added)
+    {
+        LOG_W("⚠ Stack watch list full - not watching %s", pcTaskGetName(handle));
+    }
+}
+
+void MemoryTelemetry::unwatchTask(TaskHandle_t handle)
+{
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < taskCount; i++)
+    {
+        if (tasks[i].handle == handle)
+        {
+            tasks[i] = tasks[taskCount - 1];
+            taskCount--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void MemoryTelemetry::recordAllocation(Tag tag, int32_t retainedBytes)
+{
+    if (tag < 0 || tag >= TAG_COUNT)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&lock);
+    AllocationCounter &counter = counters[tag];
+    counter.count++;
+    counter.netBytes += retainedBytes;
+    if (retainedBytes > counter.maxRetained)
+    {
+        counter.maxRetained = retainedBytes;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+bool MemoryTelemetry::check()
+{
+    // The mark is read under the lock so unwatchTask() + vTaskDelete() elsewhere cannot race it
+    WatchedTask lowStacks[MEMORY_MAX_WATCHED_TASKS];
+    int lowStackCount = 0;
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < taskCount; i++)
+    {
+        WatchedTask &task = tasks[i];
+        task.minFree = uxTaskGetStackHighWaterMark(task.handle);
+        if (task.minFree < MEMORY_STACK_WARN_MARGIN && !task.warned)
+        {
+            task.warned = true;
+            lowStacks[lowStackCount++] = task;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+
+    for (int i = 0; i < lowStackCount; i++)
+    {
+        LOG_W("⚠️ Task %s stack nearly exhausted: %u of %u bytes never used",
+              lowStacks[i].name, (unsigned)lowStacks[i].minFree, (unsigned)lowStacks[i].stackSize);
+    }
+
+    // Long enough up that earlier fragmentation restarts were not a loop
+    if (fragmentationRestarts > 0 && millis() >= MEMORY_RESTART_STABLE_UPTIME)
+    {
+        fragmentationRestarts = 0;
+        saveFragmentationRestarts();
+    }
+
+    HeapSnapshot heap = sample();
+    if (heap.largestBlock >= MEMORY_TLS_MIN_LARGEST_BLOCK)
+    {
+        fragmentedChecks = 0;
+        return false;
+    }
+
+    if (fragmentedChecks < MEMORY_RESTART_CONSECUTIVE_CHECKS)
+    {
+        fragmentedChecks++;
+        LOG_W("⚠️ Largest free block %u bytes is below the TLS minimum %u (%u free, %u%% fragmented, check %u/%u)",
+              (unsigned)heap.largestBlock, (unsigned)MEMORY_TLS_MIN_LARGEST_BLOCK, (unsigned)heap.freeHeap,
+              heap.fragmentation, fragmentedChecks, (unsigned)MEMORY_RESTART_CONSECUTIVE_CHECKS);
+    }
+    if (fragmentedChecks < MEMORY_RESTART_CONSECUTIVE_CHECKS)
+    {
+        return false;
+    }
+
+    // Restarting again would only repeat the last boots - keep running on what is left
+    if (fragmentationRestarts >= MEMORY_MAX_FRAGMENTATION_RESTARTS)
+    {
+        if (!restartLimitLogged)
+        {
+            restartLimitLogged = true;
+            LOG_E("❌ Heap still fragmented after %u restarts in a row - not restarting again",
+                  (unsigned)fragmentationRestarts);
+        }
+        return false;
+    }
+    return true;
+}
+
+void MemoryTelemetry::recordFragmentationRestart()
+{
+    if (fragmentationRestarts < UINT8_MAX)
+    {
+        fragmentationRestarts++;
+    }
+    saveFragmentationRestarts();
+}
+
+void MemoryTelemetry::saveFragmentationRestarts()
+{
+    Preferences prefs;
+    if (prefs.begin(PREF_NAMESPACE, false))
+    {
+        prefs.putUChar("restarts", fragmentationRestarts);
+        prefs.end();
+    }
+}
+
+void MemoryTelemetry::toJson(JsonObject out)
+{
+    HeapSnapshot heap = sample();
+    JsonObject heapOut = out["heap"].to<JsonObject>();
+    heapOut["free"] = heap.freeHeap;
+    heapOut["largestBlock"] = heap.largestBlock;
+    heapOut["minimumFree"] = heap.minimumFree;
+    heapOut["fragmentation"] = heap.fragmentation;
+
+    portENTER_CRITICAL(&lock);
+    WatchedTask taskSnapshot[MEMORY_MAX_WATCHED_TASKS];
+    int taskSnapshotCount = taskCount;
+    memcpy(taskSnapshot, tasks, sizeof(taskSnapshot));
+    AllocationCounter counterSnapshot[TAG_COUNT];
+    memcpy(counterSnapshot, counters, sizeof(counterSnapshot));
+    portEXIT_CRITICAL(&lock);
+
+    JsonArray tasksOut = out["tasks"].to<JsonArray>();
+    for (int i = 0; i < taskSnapshotCount; i++)
+    {
+        JsonObject task = tasksOut.add<JsonObject>();
+        task["name"] = taskSnapshot[i].name;
+        task["stack"] = taskSnapshot[i].stackSize;
+        task["minFree"] = taskSnapshot[i].minFree;
+    }
+
+    JsonObject allocations = out["allocations"].to<JsonObject>();
+    for (int i = 0; i < TAG_COUNT; i++)
+    {
+        if (counterSnapshot[i].count == 0)
+        {
+            continue;
+        }
+
+        JsonObject counter = allocations[tagName(static_cast<Tag>(i))].to<JsonObject>();
+        counter["count"] = counterSnapshot[i].count;
+        counter["netBytes"] = counterSnapshot[i].netBytes;
+        counter["maxRetained"] = counterSnapshot[i].maxRetained;
+    }
+
+    out["fragmentedChecks"] = fragmentedChecks;
+    out["fragmentationRestarts"] = fragmentationRestarts;
+}
+
+const char *MemoryTelemetry::tagName(Tag tag)
+{
+    switch (tag)
+    {
+    case WS_MESSAGE:
+        return "ws_message";
+    case WS_CONNECT:
+        return "ws_connect";
+    case LIGHT_DISPLAY:
+        return "light_display";
+    case LIGHT_CONFIGURE:
+        return "light_configure";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,156 @@
+#ifndef MEMORY_TELEMETRY_H
+#define MEMORY_TELEMETRY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+#include "../config.h"
+
+/**
+ * Memory Telemetry
+ * Heap and stack health beyond the free-heap total. Free heap alone does
+ * not warn about fragmentation - a TLS handshake needs one contiguous
+ * block of ~17 KB for its record buffer and fails even with plenty of
+ * memory free in small pieces. This tracks the largest free block, the
+ * minimum free heap since boot, a fragmentation ratio, the stack
+ * high-water mark of every watched task and per-path heap deltas
+ * (MemoryScope), and decides when a preemptive soft restart is due.
+ *
+ * Heap sampling is O(1). Stack marks are refreshed by check() only,
+ * under the same spinlock as watch/unwatch, so a task deleted elsewhere
+ * is never inspected. Recording is spinlocked too, so scopes may close on
+ * any task.
+ */
+class MemoryTelemetry
+{
+public:
+    enum Tag
+    {
+        WS_MESSAGE,      // WSClient: handling one text message
+        WS_CONNECT,      // WSClient: WSS connect (TLS session buffers)
+        LIGHT_DISPLAY,   // LightManager: displaying a palette
+        LIGHT_CONFIGURE, // LightManager: switching lighting system
+        TAG_COUNT
+    };
+
+    struct HeapSnapshot
+    {
+        uint32_t freeHeap;     // Bytes free in 8-bit capable heap
+        uint32_t largestBlock; // Biggest single allocation that would succeed
+        uint32_t minimumFree;  // Lowest free heap since boot
+        uint8_t fragmentation; // 0-100: share of free heap not in the largest block
+    };
+
+    static MemoryTelemetry *getInstance();
+
+    static HeapSnapshot sample();
+
+    /**
+     * Check there is room for an allocation (logs a warning when there is not)
+     * @param minFreeHeap Free heap the caller wants left over
+     * @param minLargestBlock Contiguous block the caller needs (0 = do not check)
+     */
+    bool isHealthy(size_t minFreeHeap, size_t minLargestBlock = 0);
+
+    /**
+     * Whether a new TLS session can get its record buffers right now
+     */
+    bool canOpenTlsSession();
+
+    /**
+     * Report a task's stack high-water mark from now on
+     * @param handle Task to watch (must be unwatched before it is deleted)
+     * @param stackSize Stack size it was created with, in bytes
+     */
+    void watchTask(TaskHandle_t handle, uint32_t stackSize);
+    void unwatchTask(TaskHandle_t handle);
+
+    /**
+     * Account for the heap a tagged code path kept (fed by MemoryScope)
+     * @param tag Which path
+     * @param retainedBytes Free heap lost across the path (negative = released)
+     */
+    void recordAllocation(Tag tag, int32_t retainedBytes);
+
+    /**
+     * Periodic check (every MEMORY_CHECK_INTERVAL): samples the heap, warns
+     * about low stacks and counts consecutive fragmented samples
+     * @return true once the heap has been too fragmented for a TLS session
+     *         MEMORY_RESTART_CONSECUTIVE_CHECKS times in a row, unless the
+     *         last MEMORY_MAX_FRAGMENTATION_RESTARTS boots all ended that way
+     */
+    bool check();
+
+    /**
+     * Count a restart triggered by check() (persisted, so a restart loop ends)
+     */
+    void recordFragmentationRestart();
+
+    /**
+     * Write heap, stack and tagged allocation figures
+     * @param out Object to fill ("heap", "tasks", "allocations", "fragmentedChecks")
+     */
+    void toJson(JsonObject out);
+
+    static const char *tagName(Tag tag);
+
+private:
+    static MemoryTelemetry *instance;
+
+    struct WatchedTask
+    {
+        TaskHandle_t handle;
+        char name[16];      // Copied - the task may be gone by the time it is reported
+        uint32_t stackSize; // Bytes
+        uint32_t minFree;   // Stack high-water mark at the last check (bytes never used)
+        bool warned;        // Low-stack warning already logged
+    };
+
+    struct AllocationCounter
+    {
+        uint32_t count;      // Times the path ran
+        int32_t netBytes;    // Heap kept across all runs (a steady climb is a leak)
+        int32_t maxRetained; // Most heap kept by a single run
+    };
+
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    WatchedTask tasks[MEMORY_MAX_WATCHED_TASKS];
+    int taskCount;
+    AllocationCounter counters[TAG_COUNT];
+    uint8_t fragmentedChecks;
+    uint8_t fragmentationRestarts; // Persisted - cleared after MEMORY_RESTART_STABLE_UPTIME
+    bool restartLimitLogged;
+
+    static const char *PREF_NAMESPACE;
+    void saveFragmentationRestarts();
+
+    MemoryTelemetry();
+};
+
+/**
+ * Scoped heap accounting: measures free heap when constructed and records
+ * the difference under its tag when destroyed. Other tasks allocate
+ * meanwhile too, so single figures are noisy - trends over many runs are
+ * what it is for.
+ */
+class MemoryScope
+{
+public:
+    explicit MemoryScope(MemoryTelemetry::Tag tag)
+        : tag(tag), startFree(heap_caps_get_free_size(MALLOC_CAP_8BIT)) {}
+
+    ~MemoryScope()
+    {
+        int32_t retained = (int32_t)startFree - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        MemoryTelemetry::getInstance()->recordAllocation(tag, retained);
+    }
+
+    MemoryScope(const MemoryScope &) = delete;
+    MemoryScope &operator=(const MemoryScope &) = delete;
+
+private:
+    MemoryTelemetry::Tag tag;
+    size_t startFree;
+};
+
+#endif // MEMORY_TELEMETRY_H
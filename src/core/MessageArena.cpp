@@ -0,0 +1,108 @@
+#include "MessageArena.h"
+
+MessageArena::MessageArena()
+    : offset(0), lastBlock(nullptr)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool MessageArena::owns(const void *pointer) const
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(pointer);
+    return bytes >= buffer && bytes < buffer + sizeof(buffer);
+}
+
+void *MessageArena::allocate(size_t size)
+{
+    size_t needed = sizeof(BlockHeader) + alignedSize(size);
+    if (offset + needed > sizeof(buffer))
+    {
+        stats.heapFallbacks++;
+        return malloc(size);
+    }
+
+    BlockHeader *header = reinterpret_cast<BlockHeader *>(buffer + offset);
+    header->size = size;
+    lastBlock = reinterpret_cast<uint8_t *>(header + 1);
+    offset += needed;
+    stats.highWater = max(stats.highWater, offset);
+    return lastBlock;
+}
+
+void MessageArena::deallocate(void *pointer)
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+
+    if (!owns(pointer))
+    {
+        free(pointer);
+        return;
+    }
+
+    // Only the top block can be handed back early - the rest waits for reset()
+    if (pointer == lastBlock)
+    {
+        offset = reinterpret_cast<uint8_t *>(headerOf(pointer)) - buffer;
+        lastBlock = nullptr;
+    }
+}
+
+void *MessageArena::reallocate(void *pointer, size_t newSize)
+{
+    if (pointer == nullptr)
+    {
+        return allocate(newSize);
+    }
+
+    if (!owns(pointer))
+    {
+        return realloc(pointer, newSize);
+    }
+
+    BlockHeader *header = headerOf(pointer);
+    size_t oldSize = header->size;
+
+    // Top block: grow or shrink in place
+    if (pointer == lastBlock)
+    {
+        size_t start = static_cast<uint8_t *>(pointer) - buffer;
+        if (start + alignedSize(newSize) <= sizeof(buffer))
+        {
+            header->size = newSize;
+            offset = start + alignedSize(newSize);
+            stats.highWater = max(stats.highWater, offset);
+            return pointer;
+        }
+    }
+    else if (newSize <= oldSize)
+    {
+        header->size = newSize;
+        return pointer;
+    }
+
+    void *moved = allocate(newSize);
+    if (moved)
+    {
+        memcpy(moved, pointer, min(oldSize, newSize));
+        deallocate(pointer);
+    }
+    return moved;
+}
+
+void MessageArena::reset()
+{
+    offset = 0;
+    lastBlock = nullptr;
+    stats.resets++;
+}
+
+void MessageArena::statsToJson(JsonObject out) const
+{
+    out["capacity"] = sizeof(buffer);
+    out["highWater"] = stats.highWater;
+    out["heapFallbacks"] = stats.heapFallbacks;
+    out["messages"] = stats.resets;
+}
@@ -0,0 +1,63 @@
+#ifndef MESSAGE_ARENA_H
+#define MESSAGE_ARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "../config.h"
+
+/**
+ * Message Arena
+ * Bump allocator behind the JsonDocuments of one WebSocket message. Pools
+ * and strings are carved from a fixed MESSAGE_ARENA_SIZE buffer and
+ * released all at once by reset() when the message has been handled, so a
+ * message leaves no holes in the heap. Only the most recent block can be
+ * grown or freed in place; anything that does not fit falls back to the
+ * heap and is counted.
+ *
+ * Not thread-safe - owned by WSClient and used on the task that polls it.
+ * Every document using the arena must be destroyed before reset().
+ */
+class MessageArena : public ArduinoJson::Allocator
+{
+public:
+    struct Stats
+    {
+        uint32_t resets;        // Messages handled
+        uint32_t heapFallbacks; // Allocations that did not fit (lifetime)
+        size_t highWater;       // Most bytes used by one message
+    };
+
+    MessageArena();
+
+    void *allocate(size_t size) override;
+    void deallocate(void *pointer) override;
+    void *reallocate(void *pointer, size_t newSize) override;
+
+    /**
+     * Release everything allocated since the last reset
+     */
+    void reset();
+
+    size_t used() const { return offset; }
+    const Stats &getStats() const { return stats; }
+    void statsToJson(JsonObject out) const;
+
+private:
+    // Each block is preceded by its size so reallocate() can copy it
+    struct BlockHeader
+    {
+        uint32_t size;
+        uint32_t reserved; // Keeps block data 8-byte aligned
+    };
+
+    alignas(8) uint8_t buffer[MESSAGE_ARENA_SIZE];
+    size_t offset;
+    uint8_t *lastBlock;
+    Stats stats;
+
+    bool owns(const void *pointer) const;
+    static size_t alignedSize(size_t size) { return (size + 7) & ~(size_t)7; }
+    static BlockHeader *headerOf(void *pointer) { return static_cast<BlockHeader *>(pointer) - 1; }
+};
+
+#endif // MESSAGE_ARENA_H
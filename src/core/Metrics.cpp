@@ -0,0 +1,147 @@
+#include "Metrics.h"
+
+Metrics *Metrics::instance = nullptr;
+
+Metrics *Metrics::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new Metrics();
+    }
+    return instance;
+}
+
+Metrics::Metrics()
+{
+    reset();
+}
+
+void Metrics::record(Span span, uint32_t micros)
+{
+    if (span < 0 || span >= SPAN_COUNT)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&lock);
+    Histogram &histogram = histograms[span];
+    histogram.samples[histogram.next] = micros;
+    histogram.next = (histogram.next + 1) % METRICS_SAMPLE_COUNT;
+    histogram.count++;
+    histogram.total += micros;
+    if (micros > histogram.max)
+    {
+        histogram.max = micros;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void Metrics::recordError(uint8_t code)
+{
+    portENTER_CRITICAL(&lock);
+    int index = 0;
+    while (index < errorCodeCount && errors[index].code != code)
+    {
+        index++;
+    }
+
+    if (index < errorCodeCount)
+    {
+        errors[index].count++;
+    }
+    else if (errorCodeCount < METRICS_MAX_ERROR_CODES)
+    {
+        errors[errorCodeCount].code = code;
+        errors[errorCodeCount].count = 1;
+        errorCodeCount++;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void Metrics::toJson(JsonObject out)
+{
+    out["uptimeMs"] = millis();
+
+    JsonObject spans = out["spans"].to<JsonObject>();
+    for (int i = 0; i < SPAN_COUNT; i++)
+    {
+        // Copy under the lock, sort outside it
+        portENTER_CRITICAL(&lock);
+        Histogram snapshot = histograms[i];
+        portEXIT_CRITICAL(&lock);
+
+        if (snapshot.count == 0)
+        {
+            continue;
+        }
+
+        int sampleCount = min(snapshot.count, (uint32_t)METRICS_SAMPLE_COUNT);
+        uint32_t *samples = snapshot.samples;
+        for (int j = 1; j < sampleCount; j++)
+        {
+            uint32_t value = samples[j];
+            int k = j - 1;
+            while (k >= 0 && samples[k] > value)
+            {
+                samples[k + 1] = samples[k];
+                k--;
+            }
+            samples[k + 1] = value;
+        }
+
+        JsonObject span = spans[spanName(static_cast<Span>(i))].to<JsonObject>();
+        span["count"] = snapshot.count;
+        span["meanUs"] = (uint32_t)(snapshot.total / snapshot.count);
+        span["p50Us"] = samples[(sampleCount - 1) / 2];
+        span["p95Us"] = samples[((sampleCount - 1) * 95) / 100];
+        span["maxUs"] = snapshot.max;
+    }
+
+    JsonObject errorCounts = out["errors"].to<JsonObject>();
+    portENTER_CRITICAL(&lock);
+    ErrorCounter errorSnapshot[METRICS_MAX_ERROR_CODES];
+    int errorSnapshotCount = errorCodeCount;
+    memcpy(errorSnapshot, errors, sizeof(errorSnapshot));
+    portEXIT_CRITICAL(&lock);
+
+    for (int i = 0; i < errorSnapshotCount; i++)
+    {
+        errorCounts[String(errorSnapshot[i].code)] = errorSnapshot[i].count;
+    }
+}
+
+void Metrics::reset()
+{
+    portENTER_CRITICAL(&lock);
+    memset(histograms, 0, sizeof(histograms));
+    memset(errors, 0, sizeof(errors));
+    errorCodeCount = 0;
+    portEXIT_CRITICAL(&lock);
+}
+
+const char *Metrics::spanName(Span span)
+{
+    switch (span)
+    {
+    case WIFI_CONNECT:
+        return "wifi_connect";
+    case TLS_HANDSHAKE:
+        return "tls_handshake";
+    case WS_CONNECT:
+        return "ws_connect";
+    case WS_PARSE:
+        return "ws_parse";
+    case DISPLAY_PALETTE:
+        return "display_palette";
+    case NANOLEAF_HTTP:
+        return "nanoleaf_http";
+    case LOOP_ITERATION:
+        return "loop_iteration";
+    case WS_RTT:
+        return "ws_rtt";
+    case WS_RECONNECT:
+        return "ws_reconnect";
+    default:
+        return "unknown";
+    }
+}
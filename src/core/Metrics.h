@@ -0,0 +1,111 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_timer.h>
+#include "../config.h"
+
+/**
+ * Metrics
+ * Process-wide latency and error registry. Each span keeps its last
+ * METRICS_SAMPLE_COUNT durations in a ring (for percentiles over recent
+ * activity) plus lifetime count, total and maximum. Recording is a
+ * spinlocked O(1) write, so it is safe from any task and cheap enough for
+ * the main loop; percentiles are only computed when a snapshot is taken.
+ */
+class Metrics
+{
+public:
+    enum Span
+    {
+        WIFI_CONNECT,    // WiFiManager::connectToWiFi
+        TLS_HANDSHAKE,   // New backend HTTPS connection
+        WS_CONNECT,      // WebSocket (WSS) connect
+        WS_PARSE,        // JSON parsing of a received WebSocket message
+        DISPLAY_PALETTE, // LightManager::displayPalette, controller included
+        NANOLEAF_HTTP,   // One Nanoleaf REST round-trip
+        LOOP_ITERATION,  // Due work in one main loop pass (sleep excluded)
+        WS_RTT,          // WebSocket ping to pong
+        WS_RECONNECT,    // WebSocket drop to connection open again
+        SPAN_COUNT
+    };
+
+    static Metrics *getInstance();
+
+    /**
+     * Record one duration
+     * @param span Which span the sample belongs to
+     * @param micros Duration in microseconds
+     */
+    void record(Span span, uint32_t micros);
+
+    /**
+     * Count one occurrence of an error code (fed by ErrorHandler)
+     */
+    void recordError(uint8_t code);
+
+    /**
+     * Write a snapshot of all spans and error counters
+     * @param out Object to fill ("uptimeMs", "spans", "errors")
+     */
+    void toJson(JsonObject out);
+
+    void reset();
+
+    static const char *spanName(Span span);
+
+private:
+    static Metrics *instance;
+
+    struct Histogram
+    {
+        uint32_t samples[METRICS_SAMPLE_COUNT]; // Ring of recent durations (us)
+        uint8_t next;
+        uint32_t count;
+        uint64_t total;
+        uint32_t max;
+    };
+
+    struct ErrorCounter
+    {
+        uint8_t code;
+        uint32_t count;
+    };
+
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    Histogram histograms[SPAN_COUNT];
+    ErrorCounter errors[METRICS_MAX_ERROR_CODES];
+    int errorCodeCount;
+
+    Metrics();
+};
+
+/**
+ * Scoped timer - records the time from construction to end() or destruction
+ */
+class MetricSpan
+{
+public:
+    explicit MetricSpan(Metrics::Span span) : span(span), startTime(esp_timer_get_time()), active(true) {}
+    ~MetricSpan() { end(); }
+
+    void end()
+    {
+        if (active)
+        {
+            Metrics::getInstance()->record(span, (uint32_t)(esp_timer_get_time() - startTime));
+            active = false;
+        }
+    }
+
+    // Drop the measurement (e.g. the operation did not actually run)
+    void cancel() { active = false; }
+
+private:
+    Metrics::Span span;
+    int64_t startTime;
+    bool active;
+};
+
+#endif // METRICS_H
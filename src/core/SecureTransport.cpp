@@ -0,0 +1,185 @@
+#include "SecureTransport.h"
+#include "Metrics.h"
+#include "MemoryTelemetry.h"
+#include "../root_ca.h"
+#include "Log.h"
+
+static const char *const LOG_TAG = "https";
+
+SecureTransport::SecureTransport() : apiPort(0), lastRequestTime(0)
+{
+    memset(&stats, 0, sizeof(stats));
+    secureClient.setCACert(fallback_root_ca);
+    http.setReuse(true);
+    http.setTimeout(SECURE_TRANSPORT_TIMEOUT);
+}
+
+SecureTransport::~SecureTransport()
+{
+    close();
+}
+
+int SecureTransport::request(const String &serverUrl, const String &path, const char *method,
+                             const String &payload, String *response)
+{
+    String url = getApiBase(serverUrl) + path;
+
+    // The server drops idle keep-alive sockets; don't waste a write discovering that
+    if (secureClient.connected() && millis() - lastRequestTime > SECURE_TRANSPORT_IDLE_TIMEOUT)
+    {
+        close();
+    }
+
+    stats.requests++;
+    bool reusingConnection = secureClient.connected();
+    if (!reusingConnection)
+    {
+        stats.handshakes++;
+    }
+
+    int httpResponseCode = performRequest(url, method, payload);
+
+    if (httpResponseCode < 0 && reusingConnection)
+    {
+        LOG_I("🔌 Backend keep-alive connection dropped, reconnecting");
+        close();
+        stats.retries++;
+        stats.handshakes++;
+        httpResponseCode = performRequest(url, method, payload);
+    }
+
+    // Unread body bytes would be parsed as the next response on a reused socket,
+    // so the body is always consumed even when the caller doesn't want it
+    String body;
+    bool reusable = httpResponseCode > 0;
+    if (reusable)
+    {
+        body = http.getString();
+        int expected = http.getSize();
+        reusable = expected < 0 || body.length() >= static_cast<unsigned int>(expected);
+    }
+
+    if (response != nullptr)
+    {
+        *response = std::move(body);
+    }
+
+    if (reusable)
+    {
+        // Leaves the socket open when the server allowed keep-alive
+        http.end();
+    }
+    else
+    {
+        close();
+    }
+    lastRequestTime = millis();
+
+    // A second TLS session next to the WSS one is only worth it while heap is plentiful
+    if (ESP.getFreeHeap() < SECURE_TRANSPORT_MIN_FREE_HEAP)
+    {
+        close();
+    }
+
+    return httpResponseCode;
+}
+
+int SecureTransport::performRequest(const String &url, const char *method, const String &payload)
+{
+    // Open the TLS session up front so the handshake is timed on its own
+    if (apiPort != 0 && !secureClient.connected())
+    {
+        if (!MemoryTelemetry::getInstance()->canOpenTlsSession())
+        {
+            LOG_W("⚠ Not enough contiguous heap for a TLS session - request skipped");
+            return HTTPC_ERROR_TOO_LESS_RAM;
+        }
+
+        MetricSpan handshakeSpan(Metrics::TLS_HANDSHAKE);
+        if (!secureClient.connect(apiHost.c_str(), apiPort))
+        {
+            handshakeSpan.cancel();
+            return HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+    }
+
+    if (!http.begin(secureClient, url))
+    {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    http.addHeader("Content-Type", "application/json");
+
+    if (strcmp(method, "GET") == 0)
+    {
+        return http.GET();
+    }
+    else if (strcmp(method, "POST") == 0)
+    {
+        return http.POST(payload);
+    }
+    else if (strcmp(method, "PUT") == 0)
+    {
+        return http.PUT(payload);
+    }
+
+    return http.sendRequest(method, payload);
+}
+
+void SecureTransport::close()
+{
+    http.end();
+    secureClient.stop();
+}
+
+bool SecureTransport::isConnected()
+{
+    return secureClient.connected();
+}
+
+SecureTransport::Stats SecureTransport::getStats() const
+{
+    return stats;
+}
+
+const String &SecureTransport::getApiBase(const String &serverUrl)
+{
+    if (apiBase.length() == 0 || serverUrl != cachedServerUrl)
+    {
+        // A different host cannot share the open connection
+        close();
+        cachedServerUrl = serverUrl;
+        apiBase = apiBaseFromServerUrl(serverUrl);
+
+        // The API base is scheme + host only
+        bool isSecure = apiBase.startsWith("https://");
+        apiHost = apiBase.substring(isSecure ? 8 : 7);
+        apiPort = isSecure ? 443 : 0;
+    }
+
+    return apiBase;
+}
+
+String SecureTransport::apiBaseFromServerUrl(const String &serverUrl)
+{
+    // Convert WebSocket URL to HTTP(S) URL
+    String httpUrl = serverUrl;
+    httpUrl.replace("ws://", "http://");
+    httpUrl.replace("wss://", "https://");
+
+    // Remove WebSocket port and path
+    // For HTTPS, Nginx handles routing - no need to specify port
+    int portIndex = httpUrl.lastIndexOf(':');
+    if (portIndex > 8) // After https://
+    {
+        httpUrl = httpUrl.substring(0, portIndex);
+    }
+
+    int pathIndex = httpUrl.indexOf('/', 8);
+    if (pathIndex > 0)
+    {
+        httpUrl = httpUrl.substring(0, pathIndex);
+    }
+
+    return httpUrl;
+}
@@ -0,0 +1,71 @@
+#ifndef SECURE_TRANSPORT_H
+#define SECURE_TRANSPORT_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include "../config.h"
+
+/**
+ * Shared HTTPS transport for backend REST calls
+ *
+ * Keeps one TLS connection to the backend open between requests so that
+ * periodic calls (status updates, registration, lighting config) skip the
+ * full handshake. The connection is dropped when it has been idle longer
+ * than the server's keep-alive window or when heap runs low, and a request
+ * on a socket the server already closed is retried once on a fresh one.
+ */
+class SecureTransport
+{
+public:
+    struct Stats
+    {
+        uint32_t requests;   // Requests issued
+        uint32_t handshakes; // Requests that had to open a new TLS connection
+        uint32_t retries;    // Requests retried after a stale kept-alive socket failed
+    };
+
+    SecureTransport();
+    ~SecureTransport();
+
+    /**
+     * Perform a request against the backend API
+     * @param serverUrl Configured server URL (http(s):// or ws(s)://, any port/path)
+     * @param path API path, e.g. "/devices/register"
+     * @param method "GET", "POST" or "PUT"
+     * @param payload Request body (ignored for GET)
+     * @param response Optional response body output
+     * @return HTTP status code, or a negative HTTPClient error
+     */
+    int request(const String &serverUrl, const String &path, const char *method,
+                const String &payload, String *response = nullptr);
+
+    /**
+     * Close the kept-alive connection and release its TLS buffers
+     */
+    void close();
+
+    bool isConnected();
+    Stats getStats() const;
+
+    /**
+     * Convert a configured server URL into the REST API base (scheme + host)
+     */
+    static String apiBaseFromServerUrl(const String &serverUrl);
+
+private:
+    WiFiClientSecure secureClient;
+    HTTPClient http;
+
+    String cachedServerUrl;
+    String apiBase;
+    String apiHost;
+    uint16_t apiPort; // 0 = let HTTPClient connect (plain HTTP)
+    unsigned long lastRequestTime;
+    Stats stats;
+
+    const String &getApiBase(const String &serverUrl);
+    int performRequest(const String &url, const char *method, const String &payload);
+};
+
+#endif // SECURE_TRANSPORT_H
@@ -0,0 +1,141 @@
+#ifndef SETUP_PAGE_H
+#define SETUP_PAGE_H
+
+#include <Arduino.h>
+
+/**
+ * Captive portal setup page
+ * Static markup kept in flash and sent as-is; the device details come from
+ * /status and the network list from /scan, so the page never changes
+ * between requests of the same firmware and browsers can cache it.
+ */
+static const char SETUP_PAGE_HTML[] PROGMEM = R"rawliteral(<!DOCTYPE html><html><head>
+<meta charset='UTF-8'>
+<meta name='viewport' content='width=device-width, initial-scale=1.0'>
+<title>PalPalette Setup</title>
+<style>
+body { font-family: Arial, sans-serif; margin: 20px; background: #f0f0f0; }
+.container { max-width: 600px; margin: 0 auto; background: white; padding: 20px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }
+h1 { color: #333; text-align: center; margin-bottom: 30px; }
+.form-group { margin-bottom: 20px; }
+label { display: block; margin-bottom: 5px; font-weight: bold; color: #555; }
+input[type='text'], input[type='password'] { width: 100%; padding: 10px; border: 1px solid #ddd; border-radius: 5px; box-sizing: border-box; }
+button { background: #007bff; color: white; padding: 12px 30px; border: none; border-radius: 5px; cursor: pointer; font-size: 16px; width: 100%; }
+button:hover { background: #0056b3; }
+.info { background: #e9ecef; padding: 15px; border-radius: 5px; margin-bottom: 20px; }
+.scan-btn { margin-top: 5px; padding: 5px 10px; font-size: 12px; width: auto; }
+.networks-list { margin-top: 10px; border: 1px solid #ddd; border-radius: 5px; max-height: 200px; overflow-y: auto; display: none; }
+.network-item { padding: 10px; border-bottom: 1px solid #eee; cursor: pointer; display: flex; justify-content: space-between; align-items: center; }
+.network-item:hover { background: #f8f9fa; }
+.network-item:last-child { border-bottom: none; }
+.network-name { font-weight: bold; }
+.network-info { font-size: 12px; color: #666; }
+.signal-strength { font-size: 12px; color: #666; }
+.encrypted { color: #ffc107; }
+.loading { text-align: center; padding: 20px; color: #666; }
+</style>
+<script>
+function selectNetwork(ssid) { document.getElementById('ssid').value = ssid; }
+function showNetworks(networks) {
+  const networksList = document.getElementById('networks-list');
+  networksList.innerHTML = '';
+  networks.forEach(network => {
+    const item = document.createElement('div');
+    item.className = 'network-item';
+    item.onclick = () => selectNetwork(network.ssid);
+    const signalBars = Math.round(network.quality / 25);
+    const signalIcon = '📶'.repeat(Math.max(1, signalBars));
+    const name = document.createElement('div');
+    name.className = 'network-name';
+    name.textContent = (network.encryption ? '🔒 ' : '') + network.ssid;
+    const info = document.createElement('div');
+    info.className = 'network-info';
+    info.textContent = `Signal: ${network.quality}% (${network.rssi} dBm)`;
+    const details = document.createElement('div');
+    details.append(name, info);
+    const signal = document.createElement('div');
+    signal.className = 'signal-strength';
+    signal.textContent = signalIcon;
+    item.append(details, signal);
+    networksList.appendChild(item);
+  });
+}
+function scanNetworks(refresh) {
+  const scanBtn = document.querySelector('.scan-btn');
+  const networksList = document.getElementById('networks-list');
+  scanBtn.disabled = true;
+  scanBtn.textContent = 'Scanning...';
+  networksList.style.display = 'block';
+  if (!networksList.children.length) {
+    networksList.innerHTML = '<div class="loading">Scanning for networks...</div>';
+  }
+  fetch(refresh ? '/scan?refresh=1' : '/scan')
+    .then(response => response.json())
+    .then(data => {
+      const networks = data.networks || [];
+      if (networks.length > 0) {
+        showNetworks(networks);
+      }
+      // The scan runs in the background - ask again until it has finished
+      if (data.scanning) {
+        setTimeout(() => scanNetworks(false), 1500);
+        return;
+      }
+      if (networks.length === 0) {
+        networksList.innerHTML = '<div class="loading">No networks found</div>';
+      }
+      scanBtn.disabled = false;
+      scanBtn.textContent = 'Scan Networks';
+    })
+    .catch(error => {
+      console.error('Error scanning networks:', error);
+      networksList.innerHTML = '<div class="loading">Error scanning networks</div>';
+      scanBtn.disabled = false;
+      scanBtn.textContent = 'Scan Networks';
+    });
+}
+function loadDeviceInfo() {
+  fetch('/status')
+    .then(response => response.json())
+    .then(data => {
+      document.getElementById('mac').textContent = data.macAddress;
+      document.getElementById('firmware').textContent = data.firmwareVersion;
+    })
+    .catch(error => console.error('Error loading device info:', error));
+}
+window.onload = function() { loadDeviceInfo(); scanNetworks(false); };
+</script>
+</head><body>
+<div class='container'>
+<h1>PalPalette Device Setup</h1>
+<div class='info'>
+<strong>Device Information:</strong><br>
+MAC Address: <span id='mac'>...</span><br>
+Firmware: <span id='firmware'>...</span>
+</div>
+<form action='/save' method='post'>
+<div class='form-group'>
+<label for='ssid'>WiFi Network Name (SSID):</label>
+<input type='text' id='ssid' name='ssid' required placeholder='Enter your WiFi network name'>
+<button type='button' onclick='scanNetworks(true)' class='scan-btn'>Scan Networks</button>
+<div id='networks-list' class='networks-list'></div>
+</div>
+<div class='form-group'>
+<label for='password'>WiFi Password:</label>
+<input type='password' id='password' name='password' placeholder='Enter your WiFi password (leave blank if none)'>
+</div>
+<div style='background: #e9f4ff; padding: 15px; border-radius: 5px; margin-bottom: 20px;'>
+<strong>💡 Lighting System Configuration</strong><br>
+Your lighting system will be configured through the PalPalette mobile app after this device is paired.
+Supported systems: WS2812 LED strips, WLED controllers, and Nanoleaf panels.
+</div>
+<button type='submit'>Save Settings & Connect</button>
+</form>
+<div style='margin-top: 30px; text-align: center;'>
+<a href='/status' style='color: #007bff; text-decoration: none;'>Device Status</a> |
+<a href='/reset' onclick='return confirm("This will reset all settings. Continue?")' style='color: #dc3545; text-decoration: none;'>Reset Device</a>
+</div>
+</div>
+</body></html>)rawliteral";
+
+#endif // SETUP_PAGE_H
@@ -0,0 +1,244 @@
+#include "StatusChannel.h"
+#include "WSClient.h"
+#include "DeviceManager.h"
+#include "../lighting/LightManager.h"
+#include "Log.h"
+#include "MemoryTelemetry.h"
+
+static const char *const LOG_TAG = "status";
+
+StatusChannel::StatusChannel(DeviceManager *deviceManager, LightManager *lightManager)
+    : deviceManager(deviceManager), lightManager(lightManager),
+      hasBaseline(false), awaitingAck(false), unackedResyncs(0), sequence(0), sentTime(0)
+{
+    memset(&acked, 0, sizeof(acked));
+    memset(&pending, 0, sizeof(pending));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void StatusChannel::update(WSClient *wsClient, const String &serverUrl)
+{
+    if (wsClient == nullptr || !wsClient->isClientConnected())
+    {
+        // The server's view is unknown once the socket drops - resync fully on reconnect
+        hasBaseline = false;
+        awaitingAck = false;
+        unackedResyncs = 0;
+
+        if (deviceManager->shouldUpdateStatus())
+        {
+            stats.restFallbacks++;
+            if (deviceManager->updateStatus(serverUrl, lightManager))
+            {
+                LOG_I("📊 Device status updated via HTTPS (WebSocket down)");
+            }
+            else
+            {
+                LOG_W("⚠ Device status update failed - backend may not be ready yet");
+            }
+        }
+        return;
+    }
+
+    if (awaitingAck && millis() - sentTime < STATUS_ACK_TIMEOUT)
+    {
+        return;
+    }
+
+    if (!hasBaseline)
+    {
+        if (unackedResyncs < STATUS_MAX_UNACKED_RESYNCS)
+        {
+            send(wsClient, capture(), FIELD_ALL);
+        }
+        else if (unackedResyncs == STATUS_MAX_UNACKED_RESYNCS)
+        {
+            // Likely a server without deviceStatusAck - the periodic full status still reaches it
+            LOG_W("⚠ %u full status reports went unacknowledged - leaving status to the periodic report",
+                  unackedResyncs);
+            unackedResyncs++;
+        }
+        return;
+    }
+
+    // An unacknowledged report is folded into the next delta, since it is diffed against the acked state
+    Snapshot now = capture();
+    uint8_t fields = changedFields(now);
+    if (fields != 0)
+    {
+        send(wsClient, now, fields);
+    }
+}
+
+void StatusChannel::resync(WSClient *wsClient)
+{
+    hasBaseline = false;
+    unackedResyncs = 0;
+    if (wsClient == nullptr || !wsClient->isClientConnected())
+    {
+        return;
+    }
+
+    send(wsClient, capture(), FIELD_ALL);
+}
+
+void StatusChannel::onAck(JsonDocument &doc)
+{
+    if (!awaitingAck)
+    {
+        return;
+    }
+
+    // Older servers do not echo the sequence number; treat those acks as matching
+    JsonVariant ackSequence = doc["data"]["seq"];
+    if (!ackSequence.isNull() && ackSequence.as<uint32_t>() != sequence)
+    {
+        return;
+    }
+
+    acked = pending;
+    hasBaseline = true;
+    awaitingAck = false;
+    unackedResyncs = 0;
+    stats.acks++;
+
+    // Keeps the REST fallback from firing right after a WebSocket report
+    deviceManager->markStatusUpdated();
+}
+
+StatusChannel::Stats StatusChannel::getStats() const
+{
+    return stats;
+}
+
+StatusChannel::Snapshot StatusChannel::capture()
+{
+    Snapshot now;
+    now.isProvisioned = deviceManager->isProvisioned();
+    now.ipAddress = (uint32_t)WiFi.localIP();
+    now.rssi = WiFi.RSSI();
+    MemoryTelemetry::HeapSnapshot heap = MemoryTelemetry::sample();
+    now.freeHeap = heap.freeHeap;
+    now.largestBlock = heap.largestBlock;
+
+    const char *lightingStatus = "error";
+    if (lightManager == nullptr || lightManager->getCurrentSystemType().length() == 0)
+    {
+        lightingStatus = "not_configured";
+    }
+    else if (lightManager->isReady())
+    {
+        lightingStatus = "working";
+    }
+    else if (lightManager->requiresUserAuthentication())
+    {
+        lightingStatus = "authentication_required";
+    }
+    strlcpy(now.lightingStatus, lightingStatus, sizeof(now.lightingStatus));
+
+    return now;
+}
+
+uint8_t StatusChannel::changedFields(const Snapshot &now) const
+{
+    uint8_t fields = 0;
+
+    if (now.isProvisioned != acked.isProvisioned)
+    {
+        fields |= FIELD_PROVISIONED;
+    }
+    if (now.ipAddress != acked.ipAddress)
+    {
+        fields |= FIELD_IP_ADDRESS;
+    }
+    // RSSI and heap jitter constantly - only report moves of a whole bucket
+    if (abs(now.rssi - acked.rssi) >= STATUS_RSSI_BUCKET)
+    {
+        fields |= FIELD_RSSI;
+    }
+    if (abs((int32_t)now.freeHeap - (int32_t)acked.freeHeap) >= STATUS_HEAP_BUCKET ||
+        abs((int32_t)now.largestBlock - (int32_t)acked.largestBlock) >= STATUS_HEAP_BUCKET)
+    {
+        fields |= FIELD_FREE_HEAP;
+    }
+    if (strcmp(now.lightingStatus, acked.lightingStatus) != 0)
+    {
+        fields |= FIELD_LIGHTING;
+    }
+
+    return fields;
+}
+
+void StatusChannel::send(WSClient *wsClient, const Snapshot &now, uint8_t fields)
+{
+    bool full = fields == FIELD_ALL;
+
+    JsonDocument statusDoc;
+    statusDoc["event"] = "deviceStatus";
+    JsonObject data = statusDoc["data"].to<JsonObject>();
+    data["deviceId"] = deviceManager->getDeviceId();
+    data["seq"] = ++sequence;
+
+    if (full)
+    {
+        DeviceInfo deviceInfo = deviceManager->getDeviceInfo();
+        data["isOnline"] = true;
+        data["firmwareVersion"] = deviceInfo.firmwareVersion;
+        data["macAddress"] = deviceInfo.macAddress;
+        data["uptime"] = millis() / 1000;
+    }
+    else
+    {
+        data["delta"] = true;
+    }
+
+    // Fields left out keep the acked value, so sub-bucket drift is still measured against what the server has
+    Snapshot sent = full ? now : acked;
+
+    if (fields & FIELD_PROVISIONED)
+    {
+        data["isProvisioned"] = now.isProvisioned;
+        sent.isProvisioned = now.isProvisioned;
+    }
+    if (fields & FIELD_IP_ADDRESS)
+    {
+        data["ipAddress"] = IPAddress(now.ipAddress).toString();
+        sent.ipAddress = now.ipAddress;
+    }
+    if (fields & FIELD_RSSI)
+    {
+        data["wifiRSSI"] = now.rssi;
+        sent.rssi = now.rssi;
+    }
+    if (fields & FIELD_FREE_HEAP)
+    {
+        data["freeHeap"] = now.freeHeap;
+        data["largestFreeBlock"] = now.largestBlock;
+        sent.freeHeap = now.freeHeap;
+        sent.largestBlock = now.largestBlock;
+    }
+    if (fields & FIELD_LIGHTING)
+    {
+        data["lightingStatus"] = now.lightingStatus;
+        memcpy(sent.lightingStatus, now.lightingStatus, sizeof(sent.lightingStatus));
+    }
+
+    String message;
+    serializeJson(statusDoc, message);
+
+    LOG_D("📤 Sending %s device status: %s", full ? "full" : "delta", message.c_str());
+    wsClient->sendMessage(message);
+
+    pending = sent;
+    awaitingAck = true;
+    sentTime = millis();
+    if (full)
+    {
+        stats.fullReports++;
+        unackedResyncs++;
+    }
+    else
+    {
+        stats.deltaReports++;
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef STATUS_CHANNEL_H
+#define STATUS_CHANNEL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "../config.h"
+
+class WSClient;
+class DeviceManager;
+class LightManager;
+
+/**
+ * Periodic device status reporting over the live WebSocket
+ *
+ * The first report after (re)registration carries the full status; after
+ * the server acknowledges it (deviceStatusAck), only fields that changed
+ * since the last acknowledged report are sent. A server that never acks
+ * gets STATUS_MAX_UNACKED_RESYNCS full reports and is then left to the
+ * periodic full status. The HTTPS status PUT is used only while the
+ * WebSocket is down.
+ */
+class StatusChannel
+{
+public:
+    struct Stats
+    {
+        uint32_t fullReports;   // Full snapshots sent over the WebSocket
+        uint32_t deltaReports;  // Delta reports sent over the WebSocket
+        uint32_t acks;          // deviceStatusAck messages matched to a report
+        uint32_t restFallbacks; // HTTPS status updates while the socket was down
+    };
+
+    StatusChannel(DeviceManager *deviceManager, LightManager *lightManager);
+
+    /**
+     * Report status changes (called every STATUS_CHECK_INTERVAL)
+     * @param wsClient Current WebSocket client, may be nullptr
+     * @param serverUrl Backend URL for the REST fallback
+     */
+    void update(WSClient *wsClient, const String &serverUrl);
+
+    /**
+     * Forget the acknowledged baseline and send a full snapshot now
+     * (after registration, when the server's view of the device is unknown)
+     */
+    void resync(WSClient *wsClient);
+
+    /**
+     * Handle deviceStatusAck from the server
+     */
+    void onAck(JsonDocument &doc);
+
+    Stats getStats() const;
+
+private:
+    enum Field : uint8_t
+    {
+        FIELD_PROVISIONED = 1 << 0,
+        FIELD_IP_ADDRESS = 1 << 1,
+        FIELD_RSSI = 1 << 2,
+        FIELD_FREE_HEAP = 1 << 3,
+        FIELD_LIGHTING = 1 << 4,
+        FIELD_ALL = 0xFF
+    };
+
+    struct Snapshot
+    {
+        bool isProvisioned;
+        uint32_t ipAddress;
+        int rssi;
+        uint32_t freeHeap;
+        uint32_t largestBlock; // Reported with freeHeap - fragmentation shows in the gap
+        char lightingStatus[24];
+    };
+
+    DeviceManager *deviceManager;
+    LightManager *lightManager;
+
+    Snapshot acked;   // Last state the server confirmed
+    Snapshot pending; // Last state sent, awaiting ack
+    bool hasBaseline;
+    bool awaitingAck;
+    uint8_t unackedResyncs; // Full reports sent since the last ack
+    uint32_t sequence;
+    unsigned long sentTime;
+    Stats stats;
+
+    Snapshot capture();
+    uint8_t changedFields(const Snapshot &now) const;
+    void send(WSClient *wsClient, const Snapshot &now, uint8_t fields);
+};
+
+#endif // STATUS_CHANNEL_H
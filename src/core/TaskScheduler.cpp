@@ -0,0 +1,119 @@
+#include "TaskScheduler.h"
+#include "Log.h"
+
+static const char *const LOG_TAG = "sched";
+
+TaskScheduler::TaskScheduler() : taskCount(0)
+{
+}
+
+int TaskScheduler::addTask(const char *name, unsigned long interval, TaskCallback callback, bool enabled)
+{
+    if (taskCount >= MAX_TASKS)
+    {
+        LOG_E("❌ Task scheduler full - cannot add task: %s", name);
+        return INVALID_TASK;
+    }
+
+    Task &task = tasks[taskCount];
+    task.name = name;
+    task.interval = interval;
+    task.lastRun = millis();
+    task.callback = callback;
+    task.enabled = enabled;
+
+    return taskCount++;
+}
+
+void TaskScheduler::setInterval(int taskId, unsigned long interval)
+{
+    if (isValid(taskId))
+    {
+        tasks[taskId].interval = interval;
+    }
+}
+
+void TaskScheduler::setEnabled(int taskId, bool enabled)
+{
+    if (!isValid(taskId) || tasks[taskId].enabled == enabled)
+    {
+        return;
+    }
+
+    tasks[taskId].enabled = enabled;
+
+    // A re-enabled task waits a full interval rather than firing immediately
+    if (enabled)
+    {
+        tasks[taskId].lastRun = millis();
+    }
+}
+
+void TaskScheduler::triggerNow(int taskId)
+{
+    if (isValid(taskId))
+    {
+        tasks[taskId].lastRun = millis() - tasks[taskId].interval;
+    }
+}
+
+void TaskScheduler::runDueTasks()
+{
+    for (int i = 0; i < taskCount; i++)
+    {
+        Task &task = tasks[i];
+        if (!task.enabled)
+        {
+            continue;
+        }
+
+        unsigned long now = millis();
+        if (now - task.lastRun >= task.interval)
+        {
+            task.lastRun = now;
+            task.callback();
+        }
+    }
+}
+
+unsigned long TaskScheduler::msUntilNextDeadline(unsigned long maxWait) const
+{
+    unsigned long now = millis();
+    unsigned long nextDeadline = maxWait;
+
+    for (int i = 0; i < taskCount; i++)
+    {
+        const Task &task = tasks[i];
+        if (!task.enabled)
+        {
+            continue;
+        }
+
+        unsigned long elapsed = now - task.lastRun;
+        if (elapsed >= task.interval)
+        {
+            return 0;
+        }
+
+        nextDeadline = min(nextDeadline, task.interval - elapsed);
+    }
+
+    return nextDeadline;
+}
+
+void TaskScheduler::sleepUntilNextDeadline(unsigned long maxSleep)
+{
+    unsigned long sleepTime = msUntilNextDeadline(maxSleep);
+    if (sleepTime == 0)
+    {
+        yield();
+        return;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(sleepTime));
+}
+
+const char *TaskScheduler::getTaskName(int taskId) const
+{
+    return isValid(taskId) ? tasks[taskId].name : "unknown";
+}
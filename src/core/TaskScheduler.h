@@ -0,0 +1,81 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+#include <functional>
+
+/**
+ * Cooperative Task Scheduler
+ * Runs registered callbacks at fixed intervals from the main loop and lets
+ * the loop task sleep (vTaskDelay) until the earliest deadline instead of
+ * spinning. Callbacks run on the loop task, so they must not block.
+ */
+class TaskScheduler
+{
+public:
+    typedef std::function<void()> TaskCallback;
+
+    static const int MAX_TASKS = 16;
+    static const int INVALID_TASK = -1;
+
+    TaskScheduler();
+
+    /**
+     * Register a periodic task
+     * @param name Short name for diagnostics (must outlive the scheduler)
+     * @param interval Interval between runs in milliseconds
+     * @param callback Function to run
+     * @param enabled Whether the task starts enabled
+     * @return Task id, or INVALID_TASK if the table is full
+     */
+    int addTask(const char *name, unsigned long interval, TaskCallback callback, bool enabled = true);
+
+    /**
+     * Change a task's interval; the next run is measured from its last run
+     */
+    void setInterval(int taskId, unsigned long interval);
+
+    void setEnabled(int taskId, bool enabled);
+
+    /**
+     * Make a task due on the next runDueTasks() call
+     */
+    void triggerNow(int taskId);
+
+    /**
+     * Run every enabled task whose deadline has passed
+     */
+    void runDueTasks();
+
+    /**
+     * Milliseconds until the earliest enabled task is due (0 if one is overdue)
+     * @param maxWait Value returned when no task is enabled
+     */
+    unsigned long msUntilNextDeadline(unsigned long maxWait) const;
+
+    /**
+     * Block the calling task until the next deadline, capped at maxSleep
+     * Lets the idle task run so the CPU can enter its low-power wait
+     */
+    void sleepUntilNextDeadline(unsigned long maxSleep);
+
+    const char *getTaskName(int taskId) const;
+    int getTaskCount() const { return taskCount; }
+
+private:
+    struct Task
+    {
+        const char *name;
+        unsigned long interval;
+        unsigned long lastRun;
+        TaskCallback callback;
+        bool enabled;
+    };
+
+    Task tasks[MAX_TASKS];
+    int taskCount;
+
+    bool isValid(int taskId) const { return taskId >= 0 && taskId < taskCount; }
+};
+
+#endif // TASK_SCHEDULER_H
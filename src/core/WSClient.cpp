@@ -1,10 +1,26 @@
 #include "WSClient.h"
+#include "Log.h"
+#include "MemoryTelemetry.h"
+
+static const char *const LOG_TAG = "ws";
 
 WSClient::WSClient(DeviceManager *devManager, LightManager *lightMgr)
     : deviceManager(devManager), lightManager(lightMgr), isConnected(false),
-      lastHeartbeat(0), lastPongReceived(0), lastConnectionAttempt(0),
-      retryAttempts(0), lastRetryReset(millis())
+      lastPeriodicStatus(0), statusChannel(nullptr)
 {
+    // Filters are built once and reused for every incoming message
+    eventFilter["event"] = true;
+
+    paletteFilter["event"] = true;
+    paletteFilter["messageId"] = true;
+    paletteFilter["senderId"] = true;
+    paletteFilter["senderName"] = true;
+    paletteFilter["timestamp"] = true;
+    paletteFilter["animation"] = true;
+    paletteFilter["colors"][0]["hex"] = true;
+
+    controlFilter["event"] = true;
+    controlFilter["data"] = true;
 }
 
 WSClient::~WSClient()
@@ -12,7 +28,7 @@ WSClient::~WSClient()
     // Proper cleanup of WebSocket connection
     if (isConnected)
     {
-        Serial.println("🔌 WSClient destructor: Cleaning up WebSocket connection");
+        LOG_I("🔌 WSClient destructor: Cleaning up WebSocket connection");
         disconnect();
     }
 }
@@ -25,14 +41,14 @@ void WSClient::begin(const String &url)
         serverUrl = url;
         serverUrl.replace("https://", "wss://");
         serverUrl += "/ws"; // Add WebSocket endpoint path
-        Serial.println("🔄 Converted HTTPS URL to WSS: " + serverUrl);
+        LOG_I("🔄 Converted HTTPS URL to WSS: %s", serverUrl.c_str());
     }
     else if (url.startsWith("http://"))
     {
         serverUrl = url;
         serverUrl.replace("http://", "ws://");
         serverUrl += "/ws"; // Add WebSocket endpoint path
-        Serial.println("🔄 Converted HTTP URL to WS: " + serverUrl);
+        LOG_I("🔄 Converted HTTP URL to WS: %s", serverUrl.c_str());
     }
     else
     {
@@ -43,9 +59,9 @@ void WSClient::begin(const String &url)
     // Configure SSL/TLS if using WSS
     if (serverUrl.startsWith("wss://"))
     {
-        Serial.println("🔒 Configuring secure WebSocket (WSS) with certificate validation");
+        LOG_I("🔒 Configuring secure WebSocket (WSS) with certificate validation");
         client.setCACert(fallback_root_ca);
-        Serial.println("✅ Root CA certificate loaded for WSS");
+        LOG_I("✅ Root CA certificate loaded for WSS");
     }
 
     // Setup WebSocket event callbacks
@@ -55,8 +71,8 @@ void WSClient::begin(const String &url)
     client.onEvent([this](WebsocketsEvent event, String data)
                    { onEventsCallback(event, data); });
 
-    Serial.println("🔌 WebSocket client initialized");
-    Serial.println("🌐 Server URL: " + serverUrl);
+    LOG_I("🔌 WebSocket client initialized");
+    LOG_I("🌐 Server URL: %s", serverUrl.c_str());
 }
 
 bool WSClient::connect()
@@ -68,42 +84,55 @@ bool WSClient::connect()
 
     if (serverUrl.length() == 0)
     {
-        Serial.println("❌ No server URL configured for WebSocket connection");
+        LOG_E("❌ No server URL configured for WebSocket connection");
         return false;
     }
 
-    Serial.println("🔌 Attempting WebSocket connection to: " + serverUrl);
-    Serial.printf("🔧 Free heap before connection: %d bytes\n", ESP.getFreeHeap());
+    LOG_I("🔌 Attempting WebSocket connection to: %s", serverUrl.c_str());
+    LOG_I("🔧 Free heap before connection: %d bytes", ESP.getFreeHeap());
 
-    // Update attempt time before trying to connect
-    lastConnectionAttempt = millis();
+    // A handshake without a contiguous record buffer fails deep inside mbedTLS - skip it, the memory check restarts us
+    if (serverUrl.startsWith("wss://") && !MemoryTelemetry::getInstance()->canOpenTlsSession())
+    {
+        LOG_W("⚠ Not enough contiguous heap for a TLS session - connection deferred");
+        return false;
+    }
 
+    MemoryScope connectScope(MemoryTelemetry::WS_CONNECT);
+    MetricSpan connectSpan(Metrics::WS_CONNECT);
     bool connected = client.connect(serverUrl);
+    if (connected)
+    {
+        connectSpan.end();
+    }
+    else
+    {
+        connectSpan.cancel();
+    }
 
     if (connected)
     {
-        Serial.println("✅ WebSocket connected successfully!");
+        LOG_I("✅ WebSocket connected successfully!");
         isConnected = true;
-
-        // Initialize heartbeat timer
-        lastHeartbeat = millis();
+        supervisor.onConnected();
+        lastPeriodicStatus = millis();
 
         // Register device immediately after connection
         if (registerDevice())
         {
-            Serial.println("📋 Device registration message sent successfully");
+            LOG_I("📋 Device registration message sent successfully");
         }
         else
         {
-            Serial.println("⚠ Device registration message failed to send");
+            LOG_W("⚠ Device registration message failed to send");
         }
 
         return true;
     }
     else
     {
-        Serial.println("❌ WebSocket connection failed");
-        Serial.printf("🔧 Free heap after failed connection: %d bytes\n", ESP.getFreeHeap());
+        LOG_E("❌ WebSocket connection failed");
+        LOG_I("🔧 Free heap after failed connection: %d bytes", ESP.getFreeHeap());
         isConnected = false;
         return false;
     }
@@ -113,8 +142,8 @@ void WSClient::disconnect()
 {
     if (isConnected)
     {
-        Serial.println("🔌 Disconnecting WebSocket...");
-        Serial.printf("🔧 Free heap before disconnect: %d bytes\n", ESP.getFreeHeap());
+        LOG_I("🔌 Disconnecting WebSocket...");
+        LOG_I("🔧 Free heap before disconnect: %d bytes", ESP.getFreeHeap());
 
         // Send close frame properly
         client.close();
@@ -123,10 +152,11 @@ void WSClient::disconnect()
         delay(100);
 
         isConnected = false;
+        supervisor.onDisconnected();
         deviceManager->setOnlineStatus(false);
 
-        Serial.printf("🔧 Free heap after disconnect: %d bytes\n", ESP.getFreeHeap());
-        Serial.println("✅ WebSocket disconnected cleanly");
+        LOG_I("🔧 Free heap after disconnect: %d bytes", ESP.getFreeHeap());
+        LOG_I("✅ WebSocket disconnected cleanly");
     }
 }
 
@@ -138,74 +168,116 @@ bool WSClient::isClientConnected()
     // If client reports unavailable but we think we're connected, update our state
     if (isConnected && !clientAvailable)
     {
-        Serial.println("⚠ WebSocket client reports unavailable - updating connection state");
+        LOG_W("⚠ WebSocket client reports unavailable - updating connection state");
         isConnected = false;
+        supervisor.onDisconnected();
         deviceManager->setOnlineStatus(false);
     }
 
     return isConnected && clientAvailable;
 }
 
-void WSClient::loop()
+void WSClient::poll()
 {
     if (isConnected)
     {
         // Poll for WebSocket messages and events
         client.poll();
+    }
 
-        // Send heartbeat if needed (every 30 seconds per backend requirements)
-        if (shouldSendHeartbeat())
-        {
-            sendHeartbeat();
-        }
+    // Results of lighting work done on the lighting task
+    if (lightManager)
+    {
+        lightManager->dispatchEvents();
+    }
+}
+
+void WSClient::checkConnectionHealth()
+{
+    if (!isConnected)
+    {
+        return;
+    }
 
-        // Check for connection health - if no pong received for too long, assume disconnected
-        // This helps detect silent connection drops
-        unsigned long timeSinceLastPong = millis() - lastPongReceived;
-        unsigned long maxPongWait = HEARTBEAT_INTERVAL * 3; // 90 seconds max without pong
+    switch (supervisor.check())
+    {
+    case ConnectionSupervisor::PROBE:
+        // Keep the TLS session if the link was only stalled
+        client.ping();
+        supervisor.onPingSent();
+        break;
 
-        if (lastPongReceived > 0 && timeSinceLastPong > maxPongWait)
-        {
-            Serial.println("⚠ No pong response for " + String(timeSinceLastPong / 1000) + "s - connection may be stale");
-            Serial.println("🔄 Forcing WebSocket reconnection");
-            disconnect();
-        }
+    case ConnectionSupervisor::STALE:
+        LOG_I("🔄 Forcing WebSocket reconnection");
+        disconnect();
+        break;
+
+    default:
+        break;
     }
-    else
+}
+
+bool WSClient::attemptReconnect()
+{
+    if (isConnected)
     {
-        // Try to reconnect if needed with exponential backoff
-        if (shouldRetryConnection())
-        {
-            Serial.println("🔄 Attempting WebSocket reconnection...");
-            connect();
-        }
+        return true;
+    }
+    if (!supervisor.reconnectDue())
+    {
+        return false;
+    }
+
+    // Straight to the WebSocket - the device is already registered over HTTP
+    LOG_I("🔄 Attempting WebSocket reconnection...");
+    if (connect())
+    {
+        return true;
     }
+
+    supervisor.onReconnectFailed();
+    return false;
+}
+
+unsigned long WSClient::getHeartbeatInterval() const
+{
+    return supervisor.getHeartbeatInterval();
+}
+
+unsigned long WSClient::getReconnectDelay() const
+{
+    return supervisor.getReconnectDelay();
+}
+
+void WSClient::connectionStatsToJson(JsonObject out) const
+{
+    supervisor.statsToJson(out);
 }
 
 void WSClient::sendHeartbeat()
 {
     if (!isClientConnected())
     {
-        Serial.println("⚠ Cannot send heartbeat - WebSocket not connected");
+        LOG_W("⚠ Cannot send heartbeat - WebSocket not connected");
         return;
     }
 
-    // Send WebSocket ping frame
-    client.ping();
-    lastHeartbeat = millis();
-    Serial.println("💓 Heartbeat sent");
+    // An unanswered ping is the health check's to follow up
+    if (!supervisor.awaitingPong())
+    {
+        client.ping();
+        supervisor.onPingSent();
+        LOG_I("💓 Heartbeat sent");
+    }
 
     // Update device online status
     deviceManager->setOnlineStatus(true);
 
-    // Send periodic status updates every 10 heartbeats (roughly every 5 minutes if heartbeat is every 30 seconds)
-    static int heartbeatCount = 0;
-    heartbeatCount++;
-
-    if (heartbeatCount >= 10)
+    // Periodic full status on its own clock - the heartbeat interval varies
+    if (millis() - lastPeriodicStatus >= WS_PERIODIC_STATUS_INTERVAL)
     {
-        heartbeatCount = 0;
-        Serial.println("📊 Sending periodic status updates...");
+        lastPeriodicStatus = millis();
+        LOG_I("📊 Sending periodic status updates...");
         sendDeviceStatus();
         sendLightingSystemStatus();
     }
@@ -215,11 +287,11 @@ bool WSClient::registerDevice()
 {
     if (!isClientConnected())
     {
-        Serial.println("❌ Cannot register device - WebSocket not connected");
+        LOG_E("❌ Cannot register device - WebSocket not connected");
         return false;
     }
 
-    Serial.println("📋 Registering device with WebSocket server...");
+    LOG_I("📋 Registering device with WebSocket server...");
 
     DeviceInfo deviceInfo = deviceManager->getDeviceInfo();
 
@@ -231,6 +303,10 @@ bool WSClient::registerDevice()
     doc["data"]["firmwareVersion"] = deviceInfo.firmwareVersion;
     doc["data"]["isProvisioned"] = deviceInfo.isProvisioned;
 
+    // Opt in to compact binary palette frames; the server keeps using JSON otherwise
+    doc["data"]["supportsBinaryPalette"] = true;
+    doc["data"]["binaryProtocolVersion"] = BinaryProtocol::VERSION;
+
     if (!deviceInfo.isProvisioned)
     {
         doc["data"]["pairingCode"] = deviceInfo.pairingCode;
@@ -241,14 +317,14 @@ bool WSClient::registerDevice()
 
     client.send(message);
 
-    Serial.println("📤 Device registration message sent");
-    Serial.println("🆔 Device ID: " + deviceInfo.deviceId);
-    Serial.println("📡 MAC Address: " + deviceInfo.macAddress);
+    LOG_I("📤 Device registration message sent");
+    LOG_I("🆔 Device ID: %s", deviceInfo.deviceId.c_str());
+    LOG_I("📡 MAC Address: %s", deviceInfo.macAddress.c_str());
 
     if (!deviceInfo.isProvisioned)
     {
-        Serial.println("🔑 Pairing Code: " + deviceInfo.pairingCode);
-        Serial.println("📱 Share this pairing code with the mobile app to claim this device");
+        LOG_I("🔑 Pairing Code: %s", deviceInfo.pairingCode.c_str());
+        LOG_I("📱 Share this pairing code with the mobile app to claim this device");
     }
 
     // Send initial status updates after registration
@@ -266,106 +342,120 @@ void WSClient::sendMessage(const String &message)
     }
 }
 
-bool WSClient::shouldSendHeartbeat()
+void WSClient::onMessageCallback(WebsocketsMessage message)
 {
-    return (millis() - lastHeartbeat) > HEARTBEAT_INTERVAL;
+    LOG_I("📨 WebSocket message received");
+    MemoryScope messageScope(MemoryTelemetry::WS_MESSAGE);
+
+    if (message.isBinary())
+    {
+        handleBinaryMessage(reinterpret_cast<const uint8_t *>(message.c_str()), message.length());
+        return;
+    }
+
+    handleTextMessage(message.c_str(), message.length());
+
+    // Every document of this message is gone - release them in one step
+    messageArena.reset();
 }
 
-bool WSClient::shouldRetryConnection()
+void WSClient::handleTextMessage(const char *text, size_t length)
 {
-    const unsigned long MAX_RETRY_INTERVAL = 30000;    // Max 30 seconds
-    const unsigned long RETRY_RESET_INTERVAL = 300000; // Reset retry count after 5 minutes of failures
+    MetricSpan parseSpan(Metrics::WS_PARSE);
 
-    // Reset retry attempts if we've been disconnected for a long time
-    if (millis() - lastRetryReset > RETRY_RESET_INTERVAL)
+    // First pass: pull out only the event name (filtered, parsed straight from the frame buffer)
+    char event[32];
     {
-        if (retryAttempts > 0)
+        JsonDocument eventDoc(&messageArena);
+        DeserializationError error = deserializeJson(eventDoc, text, length,
+                                                     DeserializationOption::Filter(eventFilter));
+        if (error)
         {
-            Serial.println("🔄 Resetting WebSocket retry attempts after prolonged disconnection");
-            retryAttempts = 0;
+            LOG_E("❌ JSON parsing failed: %s", error.c_str());
+            return;
         }
-        lastRetryReset = millis();
-    }
 
-    unsigned long baseInterval = REGISTRATION_RETRY_INTERVAL;
-    unsigned long exponentialInterval = baseInterval * (1UL << retryAttempts);
-    unsigned long retryInterval = (exponentialInterval < MAX_RETRY_INTERVAL) ? exponentialInterval : MAX_RETRY_INTERVAL;
+        const char *eventName = eventDoc["event"];
+        if (eventName == nullptr)
+        {
+            LOG_W("⚠ Message missing event field");
+            return;
+        }
+        strlcpy(event, eventName, sizeof(event));
+    }
 
-    if ((millis() - lastConnectionAttempt) > retryInterval)
+    // Second pass: keep only the fields this event's handler reads
+    bool isPalette = strcmp(event, "colorPalette") == 0;
+    JsonDocument doc(&messageArena);
+    DeserializationError error = deserializeJson(doc, text, length,
+                                                 DeserializationOption::Filter(isPalette ? paletteFilter : controlFilter));
+    if (error)
     {
-        retryAttempts++;
-        if (retryAttempts > 5)
-            retryAttempts = 5; // Cap at 2^5 = 32 * base interval
-
-        Serial.println("🔄 WebSocket retry attempt #" + String(retryAttempts) +
-                       ", next retry in " + String((retryInterval * 2) / 1000) + "s");
-        return true;
+        LOG_E("❌ JSON parsing failed: %s", error.c_str());
+        return;
     }
 
-    return false;
-}
-
-void WSClient::onMessageCallback(WebsocketsMessage message)
-{
-    Serial.println("📨 WebSocket message received");
+    parseSpan.end();
 
-    // Parse JSON message
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, message.data());
+    // Dispatch by event type
+    LOG_I("📝 Event: %s", event);
 
-    if (error)
+    if (strcmp(event, "colorPalette") == 0)
     {
-        Serial.println("❌ JSON parsing failed: " + String(error.c_str()));
-        return;
+        handleColorPalette(doc);
     }
-
-    // Check message type
-    if (doc["event"].is<String>())
+    else if (strcmp(event, "deviceRegistered") == 0)
     {
-        String event = doc["event"];
-        Serial.println("📝 Event: " + event);
-
-        if (event == "colorPalette")
-        {
-            handleColorPalette(doc);
-        }
-        else if (event == "deviceRegistered")
-        {
-            handleDeviceRegistered(doc);
-        }
-        else if (event == "deviceClaimed")
-        {
-            handleDeviceClaimed(doc);
-        }
-        else if (event == "setupComplete")
-        {
-            handleSetupComplete(doc);
-        }
-        else if (event == "lightingSystemConfig")
-        {
-            handleLightingSystemConfig(doc);
-        }
-        else if (event == "testLightingSystem")
-        {
-            handleTestLightingSystem(doc);
-        }
-        else if (event == "factoryReset")
-        {
-            handleFactoryReset(doc);
-        }
-        else if (event == "deviceStatusAck")
-        {
-            // Backend acknowledges our device status update - this is expected
-            Serial.println("✅ Device status acknowledged by server");
-        }
-        else
+        handleDeviceRegistered(doc);
+    }
+    else if (strcmp(event, "deviceClaimed") == 0)
+    {
+        handleDeviceClaimed(doc);
+    }
+    else if (strcmp(event, "setupComplete") == 0)
+    {
+        handleSetupComplete(doc);
+    }
+    else if (strcmp(event, "lightingSystemConfig") == 0)
+    {
+        handleLightingSystemConfig(doc);
+    }
+    else if (strcmp(event, "testLightingSystem") == 0)
+    {
+        handleTestLightingSystem(doc);
+    }
+    else if (strcmp(event, "setBrightness") == 0)
+    {
+        handleSetBrightness(doc);
+    }
+    else if (strcmp(event, "factoryReset") == 0)
+    {
+        handleFactoryReset(doc);
+    }
+    else if (strcmp(event, "getMetrics") == 0)
+    {
+        handleGetMetrics(doc);
+    }
+    else if (strcmp(event, "getLogs") == 0)
+    {
+        handleGetLogs(doc);
+    }
+    else if (strcmp(event, "shuffleHistory") == 0)
+    {
+        handleShuffleHistory(doc);
+    }
+    else if (strcmp(event, "deviceStatusAck") == 0)
+    {
+        // Backend acknowledges our device status update - this is expected
+        LOG_I("✅ Device status acknowledged by server");
+        if (statusChannel)
         {
-            Serial.println("⚠ Unknown event type: " + event);
+            statusChannel->onAck(doc);
         }
     }
     else
     {
-        Serial.println("⚠ Message missing event field");
+        LOG_W("⚠ Unknown event type: %s", event);
     }
 }
 
@@ -374,398 +464,420 @@ void WSClient::onEventsCallback(WebsocketsEvent event, String data)
     switch (event)
     {
     case WebsocketsEvent::ConnectionOpened:
-        Serial.println("🔗 WebSocket connection opened");
+        LOG_I("🔗 WebSocket connection opened");
         isConnected = true;
-        lastConnectionAttempt = millis(); // Reset retry timer on successful connection
-        lastPongReceived = millis();      // Initialize pong timer to prevent immediate timeout
+        supervisor.onConnected();
 
-        // Reset retry attempts counter - connection is successful
-        retryAttempts = 0;
-        lastRetryReset = millis();
-
-        Serial.println("✅ WebSocket connection established successfully (retry attempts reset)");
+        LOG_I("✅ WebSocket connection established successfully (retry backoff reset)");
         break;
 
     case WebsocketsEvent::ConnectionClosed:
-        Serial.println("🔌 WebSocket connection closed");
+        LOG_I("🔌 WebSocket connection closed");
         if (!data.isEmpty())
         {
-            Serial.println("📄 Close data: " + data);
+            LOG_I("📄 Close data: %s", data.c_str());
         }
 
         // Log memory status when connection closes unexpectedly
-        Serial.printf("💾 Free heap at disconnect: %d bytes\n", ESP.getFreeHeap());
+        LOG_I("💾 Free heap at disconnect: %d bytes", ESP.getFreeHeap());
 
         isConnected = false;
+        supervisor.onDisconnected();
         deviceManager->setOnlineStatus(false);
-
-        // Set retry timer to attempt reconnection
-        lastConnectionAttempt = millis();
         break;
 
     case WebsocketsEvent::GotPing:
-        Serial.println("🏓 Ping received from server");
+        LOG_I("🏓 Ping received from server");
         break;
 
     case WebsocketsEvent::GotPong:
-        Serial.println("🏓 Pong received from server");
-        // Update pong received time to track connection health
-        lastPongReceived = millis();
+        LOG_I("🏓 Pong received from server");
+        // Feeds the RTT estimate and clears any pending probe
+        supervisor.onPong();
         break;
 
     default:
-        Serial.println("❓ Unknown WebSocket event: " + String((int)event));
+        LOG_I("❓ Unknown WebSocket event: %d", (int)event);
         break;
     }
 }
 
-void WSClient::handleColorPalette(JsonDocument &doc)
+void WSClient::handleBinaryMessage(const uint8_t *data, size_t length)
 {
-    Serial.println("\n🎨 ===== COLOR PALETTE RECEIVED =====");
+    LOG_I("📦 Binary frame (%u bytes)", (unsigned)length);
 
-    // Use a temporary legacy palette to extract data from JSON
-    LegacyColorPalette legacyPalette;
+    if (!BinaryProtocol::decodePalette(data, length, currentPalette))
+    {
+        return;
+    }
 
-    // Extract palette data
-    legacyPalette.messageId = doc["messageId"].as<String>();
-    legacyPalette.senderId = doc["senderId"].as<String>();
-    legacyPalette.senderName = doc["senderName"].as<String>();
-    legacyPalette.timestamp = doc["timestamp"];
+    LOG_I("🎨 Binary color palette received!");
+    LOG_I("📧 Message ID: %s", currentPalette.messageId.c_str());
+    LOG_I("👤 From: %s", currentPalette.senderName.c_str());
+    LOG_I("🌈 Number of colors: %d", currentPalette.colorCount);
+
+    displayColorPaletteSerial();
+    displayColorPaletteOnLights();
+}
+
+void WSClient::handleColorPalette(JsonDocument &doc)
+{
+    LOG_I("🎨 ===== COLOR PALETTE RECEIVED =====");
+
+    // Fill the palette straight from the parsed document - fixed-capacity fields, nothing allocated
+    const char *senderName = doc["senderName"] | "";
+    currentPalette = ColorPalette();
+    currentPalette.messageId = doc["messageId"] | "";
+    currentPalette.senderName = senderName;
+    currentPalette.name.format("From %s", senderName);
+    currentPalette.animation = doc["animation"] | "fade";
 
     // Extract colors
     JsonArray colors = doc["colors"];
-    legacyPalette.colorCount = min((int)colors.size(), 10);
+    currentPalette.colorCount = min((int)colors.size(), MAX_COLORS);
 
-    Serial.println("📧 Message ID: " + legacyPalette.messageId);
-    Serial.println("👤 From: " + legacyPalette.senderName + " (" + legacyPalette.senderId + ")");
-    Serial.println("⏰ Timestamp: " + String(legacyPalette.timestamp));
-    Serial.println("🌈 Number of colors: " + String(legacyPalette.colorCount));
-    Serial.println();
+    LOG_I("📧 Message ID: %s", currentPalette.messageId.c_str());
+    LOG_I("👤 From: %s (%s)", currentPalette.senderName.c_str(), doc["senderId"] | "");
+    LOG_I("⏰ Timestamp: %lu", doc["timestamp"] | 0UL);
+    LOG_I("🌈 Number of colors: %d", currentPalette.colorCount);
 
-    Serial.println("🎨 Color Palette:");
-    Serial.println("+---------+----------+");
-    Serial.println("| Color # | Hex Code |");
-    Serial.println("+---------+----------+");
+    LOG_D("🎨 Color Palette:");
+    LOG_D("+---------+----------+");
+    LOG_D("| Color # | Hex Code |");
+    LOG_D("+---------+----------+");
 
-    for (int i = 0; i < legacyPalette.colorCount; i++)
+    for (int i = 0; i < currentPalette.colorCount; i++)
     {
-        String hexColor = colors[i]["hex"];
-        legacyPalette.colors[i] = hexColor;
-
-        // Format output nicely
-        String colorNum = String(i + 1);
-        if (colorNum.length() == 1)
-            colorNum = " " + colorNum;
+        // Decode in place - no intermediate String per color
+        const char *hexColor = colors[i]["hex"] | "#000000";
+        currentPalette.colors[i] = RGBColor::fromHex(hexColor);
 
-        Serial.println("|    " + colorNum + "    |  " + hexColor + "  |");
+        LOG_D("|    %2d    |  %s  |", i + 1, hexColor);
     }
 
-    Serial.println("+---------+----------+");
-    Serial.println();
-
-    // Convert to the current palette format
-    currentPalette = convertToLightPalette(legacyPalette);
+    LOG_D("+---------+----------+");
 
     // Display the palette
     displayColorPaletteSerial();
     displayColorPaletteOnLights();
 
-    Serial.println("🎨 =====================================\n");
+    LOG_D("🎨 =====================================");
 }
 
 void WSClient::handleDeviceRegistered(JsonDocument &doc)
 {
-    Serial.println("\n✅ ===== DEVICE REGISTERED =====");
-    Serial.println("✅ Device successfully registered with server!");
+    LOG_I("✅ ===== DEVICE REGISTERED =====");
+    LOG_I("✅ Device successfully registered with server!");
 
     if (doc["data"]["deviceId"].is<String>())
     {
         String serverDeviceId = doc["data"]["deviceId"].as<String>();
-        Serial.println("🆔 Server confirmed Device ID: " + serverDeviceId);
+        LOG_I("🆔 Server confirmed Device ID: %s", serverDeviceId.c_str());
     }
 
     if (doc["data"]["pairingCode"].is<String>())
     {
         String pairingCode = doc["data"]["pairingCode"].as<String>();
-        Serial.println("🔑 Pairing Code: " + pairingCode);
-        Serial.println("📱 Use this code in the mobile app to claim this device");
+        LOG_I("🔑 Pairing Code: %s", pairingCode.c_str());
+        LOG_I("📱 Use this code in the mobile app to claim this device");
     }
 
-    Serial.println("✅ ================================\n");
+    LOG_I("✅ ================================");
 }
 
 void WSClient::handleDeviceClaimed(JsonDocument &doc)
 {
-    Serial.println("\n🔐 ===== DEVICE CLAIMED =====");
+    LOG_I("🔐 ===== DEVICE CLAIMED =====");
 
     String userEmail = doc["data"]["userEmail"].as<String>();
     String userName = doc["data"]["userName"].as<String>();
 
-    Serial.println("🎉 Device has been successfully claimed!");
-    Serial.println("👤 Owner: " + userName + " (" + userEmail + ")");
+    LOG_I("🎉 Device has been successfully claimed!");
+    LOG_I("👤 Owner: %s (%s)", userName.c_str(), userEmail.c_str());
 
     // Mark device as provisioned
     deviceManager->setProvisioned(true);
 
-    Serial.println("✅ Device is now provisioned and ready to use!");
+    LOG_I("✅ Device is now provisioned and ready to use!");
 
     // Now that device is claimed by a user, we can start lighting system authentication
     if (lightManager && lightManager->requiresUserAuthentication())
     {
-        Serial.println("🔐 Starting lighting system authentication...");
-
-        // This will trigger user notifications (e.g., Nanoleaf button press) via the callback system
-        if (lightManager->authenticateLightingSystem())
-        {
-            Serial.println("✅ Lighting system authentication completed");
+        LOG_I("🔐 Starting lighting system authentication...");
 
-            // Send lighting configuration to backend for persistence
-            if (deviceManager->updateLightingConfiguration(serverUrl, lightManager))
-            {
-                Serial.println("✅ Lighting configuration synced to backend");
-            }
-            else
-            {
-                Serial.println("⚠️  Failed to sync lighting configuration to backend");
-            }
-        }
-        else
-        {
-            Serial.println("⚠ Lighting system authentication failed - can retry later");
-        }
+        // This will trigger user notifications (e.g., Nanoleaf button press) via the callback system;
+        // the outcome arrives in handleLightingRequestDone()
+        lightManager->requestAuthentication();
     }
 
-    Serial.println("🔐 ==============================\n");
+    LOG_I("🔐 ==============================");
 }
 
 void WSClient::handleSetupComplete(JsonDocument &doc)
 {
-    Serial.println("\n🎉 ===== SETUP COMPLETED =====");
+    LOG_I("🎉 ===== SETUP COMPLETED =====");
 
     String status = doc["data"]["status"].as<String>();
 
-    Serial.println("🎉 Device setup completed successfully!");
-    Serial.println("📱 Device is now ready to receive color palettes!");
-    Serial.println("🔗 Status: " + status);
+    LOG_I("🎉 Device setup completed successfully!");
+    LOG_I("📱 Device is now ready to receive color palettes!");
+    LOG_I("🔗 Status: %s", status.c_str());
 
     // Ensure device is marked as provisioned
     deviceManager->setProvisioned(true);
 
-    Serial.println("🎉 ==============================\n");
+    LOG_I("🎉 ==============================");
 }
 
 void WSClient::handleLightingSystemConfig(JsonDocument &doc)
 {
-    Serial.println("\n⚡ ===== LIGHTING SYSTEM CONFIG =====");
+    LOG_I("⚡ ===== LIGHTING SYSTEM CONFIG =====");
 
     if (!lightManager)
     {
-        Serial.println("❌ LightManager not available");
+        LOG_E("❌ LightManager not available");
         return;
     }
 
     String systemType = doc["data"]["systemType"].as<String>();
-    Serial.println("🔧 System Type: " + systemType);
+    LOG_I("🔧 System Type: %s", systemType.c_str());
 
+    // Resolved once - from here on the backend is handled by type and capabilities
+    LightSystemType type = ControllerRegistry::typeFromName(systemType);
+    const char *systemName = nullptr;
+    switch (type)
+    {
+    case LIGHT_SYSTEM_NANOLEAF:
+        systemName = "Nanoleaf";
+        LOG_I("🍃 Configuring Nanoleaf lighting system...");
+        break;
+    case LIGHT_SYSTEM_WLED:
+        systemName = "WLED";
+        LOG_I("🌈 Configuring WLED lighting system...");
+        break;
+    case LIGHT_SYSTEM_WS2812:
+        systemName = "WS2812";
+        LOG_I("💡 Configuring WS2812 lighting system...");
+        LOG_I("📍 Pin: %d", doc["data"]["customConfig"]["pin"] | DEFAULT_LED_PIN);
+        LOG_I("💡 Number of LEDs: %d", doc["data"]["customConfig"]["numLEDs"] | DEFAULT_NUM_LEDS);
+        break;
+    default:
+        LOG_E("❌ Unknown lighting system type: %s", systemType.c_str());
+        break;
+    }
+
+    if (systemName)
+    {
+        configureLightingSystem(type, systemName, systemType, doc["data"].as<JsonObject>());
+    }
+
+    // Further systems that mirror every palette alongside the primary one
+    JsonArrayConst additionalSystems = doc["data"]["additionalSystems"];
+    if (!additionalSystems.isNull())
+    {
+        lightManager->requestAdditionalSystems(additionalSystems);
+    }
+
+    LOG_I("⚡ ==============================");
+}
+
+void WSClient::configureLightingSystem(LightSystemType type, const char *systemName, const String &systemType,
+                                       JsonObject data)
+{
     // Extract configuration parameters
-    String hostAddress = doc["data"]["hostAddress"].as<String>();
-    int port = doc["data"]["port"] | 80; // Default to 80 if not specified
-    String authToken = doc["data"]["authToken"].as<String>();
+    String hostAddress = data["hostAddress"].as<String>();
+    if (hostAddress == "null" || hostAddress == "undefined")
+    {
+        hostAddress = "";
+    }
+    int port = data["port"] | (int)ControllerRegistry::defaultPort(type);
+    String authToken = data["authToken"].as<String>();
+    JsonObject customConfig = data["customConfig"].as<JsonObject>();
+
+    bool networked = ControllerRegistry::hasCapability(type, LIGHT_CAP_NETWORK);
+    bool needsAuth = ControllerRegistry::hasCapability(type, LIGHT_CAP_AUTHENTICATION);
+    bool discover = networked && hostAddress.length() == 0 && ControllerRegistry::hasCapability(type, LIGHT_CAP_DISCOVERY);
+
+    if (discover)
+    {
+        // Configure without host address - let the LightManager use mDNS discovery
+        LOG_I("🔍 No host address provided - using mDNS discovery for %s", systemName);
+        port = 0;
+    }
+    else if (networked)
+    {
+        LOG_I("🌐 Host Address: %s", hostAddress.c_str());
+        LOG_I("🔌 Port: %d", port);
+    }
+    else
+    {
+        // Host and port are not used for directly attached lights
+        hostAddress = "";
+        port = 0;
+    }
 
-    if (systemType == "nanoleaf")
+    if (!needsAuth)
+    {
+        authToken = "";
+    }
+    else if (authToken.length() > 0)
     {
-        Serial.println("🍃 Configuring Nanoleaf lighting system...");
+        LOG_I("🔑 Auth Token: [REDACTED]");
+    }
 
-        // For Nanoleaf, use mDNS discovery if no valid host address is provided
-        if (hostAddress.length() == 0 || hostAddress == "null" || hostAddress == "undefined")
-        {
-            Serial.println("🔍 No host address provided - using mDNS discovery for Nanoleaf");
-            // Configure without host address - let the LightManager use mDNS discovery
-            bool success = lightManager->configure(systemType, "", 0, authToken);
+    if (needsAuth && (discover || authToken.length() == 0))
+    {
+        // Send pre-auth status update so frontend can prompt user
+        JsonDocument statusDoc;
+        statusDoc["event"] = "lightingSystemStatus";
+        JsonObject status = statusDoc["data"].to<JsonObject>();
+        status["deviceId"] = deviceManager->getDeviceId();
+        status["systemType"] = systemType;
+        status["status"] = "authentication_required";
+        status["details"] = String("Press the button on your ") + systemName + " controller.";
+        status["lastTest"] = millis();
+        String msg;
+        serializeJson(statusDoc, msg);
+        LOG_D("📤 Sending pre-auth lighting status: %s", msg.c_str());
+        sendMessage(msg);
+    }
 
-            if (success)
-            {
-                Serial.println("✅ Nanoleaf system configured successfully via mDNS discovery!");
-
-                // Send pre-auth status update so frontend can prompt user
-                {
-                    JsonDocument statusDoc;
-                    statusDoc["event"] = "lightingSystemStatus";
-                    JsonObject data = statusDoc["data"].to<JsonObject>();
-                    data["deviceId"] = deviceManager->getDeviceId();
-                    data["systemType"] = systemType;
-                    data["status"] = "authentication_required";
-                    data["details"] = "Press the button on your Nanoleaf controller.";
-                    data["lastTest"] = millis();
-                    String msg;
-                    serializeJson(statusDoc, msg);
-                    Serial.println("📤 Sending pre-auth lighting status: " + msg);
-                    sendMessage(msg);
-                }
-
-                // Immediately start authentication process (which includes mDNS discovery)
-                Serial.println("🔐 Starting Nanoleaf mDNS discovery and authentication...");
-                Serial.println("🔍 This process will:");
-                Serial.println("   1. Initialize mDNS");
-                Serial.println("   2. Search for Nanoleaf devices on network");
-                Serial.println("   3. Test connectivity to found devices");
-                Serial.println("   4. Attempt authentication (may require button press)");
-                Serial.println("⏳ Please wait, this may take 30-60 seconds...");
-
-                Serial.println("🔬 DEBUG: About to call lightManager->authenticateLightingSystem()");
-                bool authResult = lightManager->authenticateLightingSystem();
-                Serial.println("🔬 DEBUG: lightManager->authenticateLightingSystem() returned: " + String(authResult ? "true" : "false"));
-
-                if (authResult)
-                {
-                    Serial.println("✅ Nanoleaf mDNS discovery and authentication completed successfully!");
-
-                    // Send lighting configuration to backend for persistence
-                    if (deviceManager->updateLightingConfiguration(serverUrl, lightManager))
-                    {
-                        Serial.println("✅ Lighting configuration synced to backend");
-                    }
-                    else
-                    {
-                        Serial.println("⚠️  Failed to sync lighting configuration to backend");
-                    }
-                }
-                else
-                {
-                    Serial.println("⚠ Nanoleaf discovery/authentication failed");
-                    Serial.println("💡 This could mean:");
-                    Serial.println("   - No Nanoleaf devices found on network");
-                    Serial.println("   - Devices found but authentication failed");
-                    Serial.println("   - User action required (press hold button on Nanoleaf)");
-                    Serial.println("   - Network/mDNS configuration issue");
-                }
-
-                // Send status update after authentication attempt
-                sendLightingSystemStatus();
-            }
-            else
-            {
-                Serial.println("❌ Failed to configure Nanoleaf system via mDNS discovery");
-            }
+    // Initialization and pairing talk to the device - the lighting task does that, the result comes back
+    // through handleLightingRequestDone()
+    if (!lightManager->requestConfigure(systemType, hostAddress, port, authToken, customConfig))
+    {
+        LOG_E("❌ Failed to hand %s configuration to the lighting task", systemName);
+        return;
+    }
+
+    if (needsAuth)
+    {
+        // Authentication includes discovery when no host was given
+        LOG_I("🔐 %s %s will follow...", systemName, discover ? "discovery and authentication" : "authentication");
+        LOG_I("⏳ Please wait, this may take %s seconds...", discover ? "30-60" : "10-30");
+    }
+}
+
+void WSClient::handleLightingRequestDone(LightManager::Request request, bool success)
+{
+    String systemType = lightManager->getCurrentSystemType();
+
+    switch (request)
+    {
+    case LightManager::REQUEST_CONFIGURE:
+        if (!success)
+        {
+            LOG_E("❌ Failed to configure lighting system");
+            sendLightingSystemStatus();
+            break;
         }
-        else
+
+        LOG_I("✅ %s system configured successfully!", systemType.c_str());
+
+        // A pairing system reports once authentication has finished too
+        if (!ControllerRegistry::hasCapability(ControllerRegistry::typeFromName(systemType), LIGHT_CAP_AUTHENTICATION))
         {
-            // Use provided host address
-            Serial.println("🌐 Host Address: " + hostAddress);
-            Serial.println("🔌 Port: " + String(port));
-            if (authToken.length() > 0)
-            {
-                Serial.println("🔑 Auth Token: [REDACTED]");
-            }
+            sendLightingSystemStatus();
+        }
+        break;
 
-            bool success = lightManager->configure(systemType, hostAddress, port, authToken);
+    case LightManager::REQUEST_AUTHENTICATE:
+        if (success)
+        {
+            LOG_I("✅ %s authentication completed successfully!", systemType.c_str());
 
-            if (success)
+            // Send lighting configuration to backend for persistence
+            if (deviceManager->updateLightingConfiguration(serverUrl, lightManager))
             {
-                Serial.println("✅ Nanoleaf system configured successfully!");
-
-                // For Nanoleaf, immediately start authentication process (which includes mDNS discovery)
-                Serial.println("🔐 Starting Nanoleaf authentication and discovery...");
-                Serial.println("🔍 This process will validate connection and authenticate");
-                Serial.println("⏳ Please wait, this may take 10-30 seconds...");
-
-                if (lightManager->authenticateLightingSystem())
-                {
-                    Serial.println("✅ Nanoleaf authentication and discovery completed successfully!");
-
-                    // Send lighting configuration to backend for persistence
-                    if (deviceManager->updateLightingConfiguration(serverUrl, lightManager))
-                    {
-                        Serial.println("✅ Lighting configuration synced to backend");
-                    }
-                    else
-                    {
-                        Serial.println("⚠️  Failed to sync lighting configuration to backend");
-                    }
-                }
-                else
-                {
-                    Serial.println("⚠ Nanoleaf authentication failed");
-                    Serial.println("💡 This could mean:");
-                    Serial.println("   - Invalid host address or port");
-                    Serial.println("   - Device not reachable on network");
-                    Serial.println("   - User action required (press hold button on Nanoleaf)");
-                    Serial.println("   - Invalid or expired auth token");
-                }
-
-                // Send status update after authentication attempt
-                sendLightingSystemStatus();
+                LOG_I("✅ Lighting configuration synced to backend");
             }
             else
             {
-                Serial.println("❌ Failed to configure Nanoleaf system");
+                LOG_W("⚠️  Failed to sync lighting configuration to backend");
             }
         }
-    }
-    else if (systemType == "wled")
-    {
-        Serial.println("🌈 Configuring WLED lighting system...");
-
-        Serial.println("🌐 Host Address: " + hostAddress);
-        Serial.println("🔌 Port: " + String(port));
-
-        // Configure WLED system
-        bool success = lightManager->configure(systemType, hostAddress, port);
-
-        if (success)
-        {
-            Serial.println("✅ WLED system configured successfully!");
-        }
         else
         {
-            Serial.println("❌ Failed to configure WLED system");
+            LOG_W("⚠ %s authentication failed - can retry later", systemType.c_str());
+            LOG_I("💡 This could mean:");
+            LOG_I("   - No device found, or the device is not reachable on the network");
+            LOG_I("   - User action required (press hold button on the controller)");
+            LOG_I("   - Invalid or expired auth token");
         }
 
-        // Send status update after WLED configuration
+        // Send status update after the authentication attempt
         sendLightingSystemStatus();
-    }
-    else if (systemType == "ws2812")
-    {
-        Serial.println("💡 Configuring WS2812 lighting system...");
-
-        // For WS2812, we might get pin and numLEDs in customConfig
-        JsonObject customConfig = doc["data"]["customConfig"];
-        int pin = customConfig["pin"] | DEFAULT_LED_PIN;
-        int numLEDs = customConfig["numLEDs"] | DEFAULT_NUM_LEDS;
-
-        Serial.println("📍 Pin: " + String(pin));
-        Serial.println("💡 Number of LEDs: " + String(numLEDs));
-
-        // Configure WS2812 system (host and port are not used for direct GPIO)
-        bool success = lightManager->configure(systemType, "", 0, "", customConfig);
+        break;
 
+    case LightManager::REQUEST_TEST:
         if (success)
         {
-            Serial.println("✅ WS2812 system configured successfully!");
+            LOG_I("✅ Lighting system test passed!");
+
+            // Create a simple test palette
+            LOG_I("💡 Displaying test pattern...");
+            ColorPalette testPalette;
+            testPalette.colorCount = 3;
+            testPalette.colors[0] = RGBColor{255, 0, 0}; // Red
+            testPalette.colors[1] = RGBColor{0, 255, 0}; // Green
+            testPalette.colors[2] = RGBColor{0, 0, 255}; // Blue
+            lightManager->submitPalette(testPalette);
+
+            // Send success response
+            sendMessage("{\"event\":\"lightingSystemTest\",\"data\":{\"deviceId\":\"" +
+                        deviceManager->getDeviceId() + "\",\"success\":true}}");
         }
         else
         {
-            Serial.println("❌ Failed to configure WS2812 system");
+            LOG_E("❌ Lighting system test failed!");
+
+            // Send failure response
+            sendMessage("{\"event\":\"lightingSystemTest\",\"data\":{\"deviceId\":\"" +
+                        deviceManager->getDeviceId() + "\",\"success\":false,\"error\":\"Connection test failed\"}}");
         }
+        break;
 
-        // Send status update after WS2812 configuration
+    case LightManager::REQUEST_ADDITIONAL:
+        if (!success)
+        {
+            LOG_W("⚠ Not every additional lighting system is ready - the others mirror palettes already");
+        }
         sendLightingSystemStatus();
+        break;
     }
-    else
+}
+
+void WSClient::handleSetBrightness(JsonDocument &doc)
+{
+    if (!lightManager)
     {
-        Serial.println("❌ Unknown lighting system type: " + systemType);
+        LOG_W("⚠ No lighting system available, ignoring brightness change");
+        return;
+    }
+
+    int brightness = doc["data"]["brightness"] | -1;
+    if (brightness < 0 || brightness > 100)
+    {
+        LOG_E("❌ Invalid brightness value: %d", brightness);
+        return;
     }
 
-    Serial.println("⚡ ==============================\n");
+    LOG_I("🔆 Brightness change requested: %d%%", brightness);
+
+    // Queued latest-wins: a slider drag collapses into the final value
+    if (!lightManager->submitBrightness(brightness))
+    {
+        LOG_E("❌ Failed to apply brightness change");
+    }
 }
 
 void WSClient::handleTestLightingSystem(JsonDocument &doc)
 {
-    Serial.println("\n🧪 ===== LIGHTING SYSTEM TEST =====");
+    LOG_I("🧪 ===== LIGHTING SYSTEM TEST =====");
 
     if (!lightManager)
     {
-        Serial.println("❌ LightManager not available");
+        LOG_E("❌ LightManager not available");
 
         // Send failure response
         sendMessage("{\"event\":\"lightingSystemTest\",\"data\":{\"deviceId\":\"" +
@@ -774,88 +886,70 @@ void WSClient::handleTestLightingSystem(JsonDocument &doc)
     }
 
     String deviceId = doc["data"]["deviceId"].as<String>();
-    Serial.println("🔍 Testing lighting system for device: " + deviceId);
-
-    // Test the lighting system connection
-    bool testSuccess = lightManager->testConnection();
-
-    if (testSuccess)
-    {
-        Serial.println("✅ Lighting system test passed!");
+    LOG_I("🔍 Testing lighting system for device: %s", deviceId.c_str());
 
-        // Optionally show a test pattern
-        Serial.println("💡 Displaying test pattern...");
-
-        // Create a simple test palette
-        ColorPalette testPalette;
-        testPalette.colorCount = 3;
-        testPalette.colors[0] = RGBColor{255, 0, 0}; // Red
-        testPalette.colors[1] = RGBColor{0, 255, 0}; // Green
-        testPalette.colors[2] = RGBColor{0, 0, 255}; // Blue
-
-        lightManager->displayPalette(testPalette);
-
-        // Send success response
-        sendMessage("{\"event\":\"lightingSystemTest\",\"data\":{\"deviceId\":\"" +
-                    deviceId + "\",\"success\":true}}");
-    }
-    else
+    // The test talks to the device - the lighting task runs it, handleLightingRequestDone() answers
+    if (!lightManager->requestConnectionTest())
     {
-        Serial.println("❌ Lighting system test failed!");
-
-        // Send failure response
         sendMessage("{\"event\":\"lightingSystemTest\",\"data\":{\"deviceId\":\"" +
-                    deviceId + "\",\"success\":false,\"error\":\"Connection test failed\"}}");
+                    deviceManager->getDeviceId() + "\",\"success\":false,\"error\":\"Lighting task unavailable\"}}");
     }
 
-    Serial.println("🧪 ==============================\n");
+    LOG_I("🧪 ==============================");
 }
 
 void WSClient::displayColorPaletteSerial()
 {
-    Serial.println("💡 [LED SIMULATION] Displaying colors on light strip:");
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+    LOG_D("💡 [LED SIMULATION] Displaying colors on light strip:");
 
-    // Create a visual representation using ASCII
-    Serial.print("   Strip: ");
+    // Create a visual representation using ASCII, built up on the stack
+    FixedString<LOG_LINE_SIZE> strip("   Strip: ");
     for (int i = 0; i < currentPalette.colorCount; i++)
     {
-        String hexColor = LightControllerUtils::colorToHex(currentPalette.colors[i]);
-        Serial.print("[" + hexColor + "]");
-        if (i < currentPalette.colorCount - 1)
-        {
-            Serial.print("-");
-        }
+        RGBColor color = currentPalette.colors[i];
+        char swatch[12];
+        snprintf(swatch, sizeof(swatch), i > 0 ? "-[#%02X%02X%02X]" : "[#%02X%02X%02X]", color.r, color.g, color.b);
+        strip.append(swatch);
     }
-    Serial.println();
+    LOG_D("%s", strip.c_str());
 
     // Show RGB values
-    Serial.println("   RGB Values:");
+    LOG_D("   RGB Values:");
     for (int i = 0; i < currentPalette.colorCount; i++)
     {
         RGBColor color = currentPalette.colors[i];
-        Serial.println("   Color " + String(i + 1) + ": RGB(" + String(color.r) + ", " + String(color.g) + ", " + String(color.b) + ")");
+        LOG_D("   Color %d: RGB(%d, %d, %d)", i + 1, color.r, color.g, color.b);
     }
 
-    Serial.println("   💡 Colors displayed for demonstration");
-    Serial.println("   🔧 In production, this would control physical LEDs");
+    LOG_I("   💡 Colors displayed for demonstration");
+    LOG_D("   🔧 In production, this would control physical LEDs");
+#endif
+}
+
+void WSClient::setStatusChannel(StatusChannel *channel)
+{
+    statusChannel = channel;
 }
 
 void WSClient::setLightManager(LightManager *lightMgr)
 {
     lightManager = lightMgr;
-    Serial.println("💡 Light Manager connected to WebSocket client");
+    LOG_I("💡 Light Manager connected to WebSocket client");
 
     // Set up user notification callback
     if (lightManager)
     {
         lightManager->setUserNotificationCallback([this](const String &action, const String &instructions, int timeout)
                                                   { handleUserNotification(action, instructions, timeout); });
+        lightManager->setRequestCallback([this](LightManager::Request request, bool success)
+                                         { handleLightingRequestDone(request, success); });
     }
 }
 
 void WSClient::handleUserNotification(const String &action, const String &instructions, int timeout)
 {
-    Serial.println("🔔 Handling user notification: " + action);
+    LOG_I("🔔 Handling user notification: %s", action.c_str());
 
     // Send notification to backend/mobile app via WebSocket
     if (isClientConnected())
@@ -879,109 +973,78 @@ void WSClient::handleUserNotification(const String &action, const String &instru
         String message;
         serializeJson(notification, message);
 
-        Serial.println("📤 Sending user notification to backend: " + message);
+        LOG_D("📤 Sending user notification to backend: %s", message.c_str());
         sendMessage(message);
     }
     else
     {
-        Serial.println("⚠ WebSocket not connected - cannot send user notification");
+        LOG_W("⚠ WebSocket not connected - cannot send user notification");
         // TODO: Could implement fallback methods here (e.g., temporary AP mode)
     }
 }
 
 void WSClient::displayColorPaletteOnLights()
 {
-    if (!lightManager || !lightManager->isReady())
+    // Logged even when the lights are down - it is what they show once they are back
+    if (lightManager)
     {
-        Serial.println("⚠ No lighting system available, skipping physical display");
+        lightManager->recordPalette(currentPalette);
+    }
+
+    // Readiness is the lighting task's to check - it drops commands a not-ready system cannot take
+    if (!lightManager)
+    {
+        LOG_W("⚠ No lighting system available, skipping physical display");
         return;
     }
 
-    Serial.println("💡 Displaying palette on physical lighting system...");
+    LOG_I("💡 Displaying palette on physical lighting system...");
 
-    // currentPalette is already in the new ColorPalette format
-    // Display on lights
-    if (lightManager->displayPalette(currentPalette))
+    // Hand off to the lighting task so a slow lighting system never stalls WebSocket polling
+    if (lightManager->hasLightingTask())
     {
-        Serial.println("✅ Palette successfully displayed on lights");
+        if (!lightManager->submitPalette(currentPalette))
+        {
+            LOG_E("❌ Failed to queue palette for the lighting task");
+        }
+        return;
     }
-    else
+
+    if (lightManager->displayPalette(currentPalette))
     {
-        Serial.println("❌ Failed to display palette on lights");
+        LOG_I("✅ Palette successfully displayed on lights");
     }
-}
-
-::ColorPalette WSClient::convertToLightPalette(const LegacyColorPalette &legacyPalette)
-{
-    ColorPalette lightPalette;
-
-    // Copy metadata
-    lightPalette.name = "From " + legacyPalette.senderName;
-    lightPalette.messageId = legacyPalette.messageId;
-    lightPalette.senderName = legacyPalette.senderName;
-    lightPalette.colorCount = min(legacyPalette.colorCount, MAX_COLORS);
-
-    // Convert colors from hex strings to RGBColor structs
-    for (int i = 0; i < lightPalette.colorCount; i++)
+    else
     {
-        String hexColor = legacyPalette.colors[i];
-        lightPalette.colors[i] = LightControllerUtils::hexToColor(hexColor);
+        LOG_E("❌ Failed to display palette on lights");
     }
-
-    return lightPalette;
 }
 
 bool WSClient::retryLightingAuthentication()
 {
     if (!lightManager)
     {
-        Serial.println("❌ No light manager available");
+        LOG_E("❌ No light manager available");
         return false;
     }
 
     if (!deviceManager->isProvisioned())
     {
-        Serial.println("❌ Device must be paired with a user before lighting authentication");
+        LOG_E("❌ Device must be paired with a user before lighting authentication");
         return false;
     }
 
-    Serial.println("🔄 Retrying lighting system authentication...");
+    LOG_I("🔄 Retrying lighting system authentication...");
 
-    if (lightManager->authenticateLightingSystem())
-    {
-        Serial.println("✅ Lighting authentication retry successful");
-
-        // Send lighting configuration to backend for persistence
-        if (deviceManager->updateLightingConfiguration(serverUrl, lightManager))
-        {
-            Serial.println("✅ Lighting configuration synced to backend");
-        }
-        else
-        {
-            Serial.println("⚠️  Failed to sync lighting configuration to backend");
-        }
-
-        // Send updated status after successful authentication
-        sendLightingSystemStatus();
-
-        return true;
-    }
-    else
-    {
-        Serial.println("❌ Lighting authentication retry failed");
-
-        // Send status update to show failure
-        sendLightingSystemStatus();
-
-        return false;
-    }
+    // Result (and the status update) through handleLightingRequestDone()
+    return lightManager->requestAuthentication();
 }
 
 void WSClient::sendLightingSystemStatus()
 {
     if (!isClientConnected() || !lightManager)
     {
-        Serial.println("⚠ Cannot send lighting status - WebSocket not connected or no light manager");
+        LOG_W("⚠ Cannot send lighting status - WebSocket not connected or no light manager");
         return;
     }
 
@@ -989,11 +1052,11 @@ void WSClient::sendLightingSystemStatus()
     String systemType = lightManager->getCurrentSystemType();
     if (systemType.length() == 0 || systemType == "none")
     {
-        Serial.println("📋 Skipping lighting system status - no lighting system configured yet");
+        LOG_I("📋 Skipping lighting system status - no lighting system configured yet");
         return;
     }
 
-    Serial.println("📊 Sending lighting system status update...");
+    LOG_I("📊 Sending lighting system status update...");
 
     JsonDocument statusDoc;
     statusDoc["event"] = "lightingSystemStatus";
@@ -1015,16 +1078,9 @@ void WSClient::sendLightingSystemStatus()
     }
     else
     {
-        String s = lightManager->getStatus();
-        if (s == "error" || s == "Error" || s == "failed")
-        {
-            status = "error";
-            details = s;
-        }
-        else
-        {
-            status = s.length() > 0 ? s : "unknown";
-        }
+        // Not asking the controller - its status is a request to the device, and this is the network task
+        status = "error";
+        details = "Lighting system not reachable.";
     }
     data["status"] = status;
     if (details.length() > 0)
@@ -1038,7 +1094,7 @@ void WSClient::sendLightingSystemStatus()
     String message;
     serializeJson(statusDoc, message);
 
-    Serial.println("📤 Sending lighting status: " + message);
+    LOG_D("📤 Sending lighting status: %s", message.c_str());
     sendMessage(message);
 }
 
@@ -1046,11 +1102,17 @@ void WSClient::sendDeviceStatus()
 {
     if (!isClientConnected())
     {
-        Serial.println("⚠ Cannot send device status - WebSocket not connected");
+        LOG_W("⚠ Cannot send device status - WebSocket not connected");
+        return;
+    }
+
+    if (statusChannel)
+    {
+        statusChannel->resync(this);
         return;
     }
 
-    Serial.println("📊 Sending device status update...");
+    LOG_I("📊 Sending device status update...");
 
     DeviceInfo deviceInfo = deviceManager->getDeviceInfo();
 
@@ -1065,18 +1127,81 @@ void WSClient::sendDeviceStatus()
     statusDoc["data"]["macAddress"] = deviceInfo.macAddress;
     statusDoc["data"]["wifiRSSI"] = WiFi.RSSI();
     statusDoc["data"]["freeHeap"] = ESP.getFreeHeap();
+    statusDoc["data"]["largestFreeBlock"] = MemoryTelemetry::sample().largestBlock;
     statusDoc["data"]["uptime"] = millis() / 1000;
 
     String message;
     serializeJson(statusDoc, message);
 
-    Serial.println("📤 Sending device status: " + message);
+    LOG_D("📤 Sending device status: %s", message.c_str());
+    sendMessage(message);
+}
+
+void WSClient::handleGetMetrics(JsonDocument &doc)
+{
+    if (!isClientConnected())
+    {
+        return;
+    }
+
+    JsonDocument response(&messageArena);
+    response["event"] = "metrics";
+    JsonObject data = response["data"].to<JsonObject>();
+    data["deviceId"] = deviceManager->getDeviceId();
+    Metrics::getInstance()->toJson(data);
+    messageArena.statsToJson(data["messageArena"].to<JsonObject>());
+    MemoryTelemetry::getInstance()->toJson(data["memory"].to<JsonObject>());
+    connectionStatsToJson(data["connection"].to<JsonObject>());
+    if (lightManager)
+    {
+        lightManager->controllerStatsToJson(data["controllers"].to<JsonArray>());
+        lightManager->historyToJson(data["paletteHistory"].to<JsonObject>());
+    }
+
+    String message;
+    serializeJson(response, message);
     sendMessage(message);
+
+    LOG_I("📤 Sent metrics snapshot (%u bytes)", (unsigned)message.length());
+}
+
+void WSClient::handleGetLogs(JsonDocument &doc)
+{
+    if (!isClientConnected())
+    {
+        return;
+    }
+
+    // Paged by sequence number: pass the previous reply's "next" as "since" to continue
+    uint32_t since = doc["data"]["since"] | 0UL;
+    int limit = constrain((int)(doc["data"]["limit"] | LOG_FETCH_MAX_ENTRIES), 1, LOG_FETCH_MAX_ENTRIES);
+
+    JsonDocument response(&messageArena);
+    response["event"] = "logs";
+    JsonObject data = response["data"].to<JsonObject>();
+    data["deviceId"] = deviceManager->getDeviceId();
+    Log::toJson(data, since, limit);
+
+    String message;
+    serializeJson(response, message);
+    sendMessage(message);
+}
+
+void WSClient::handleShuffleHistory(JsonDocument &doc)
+{
+    if (!lightManager)
+    {
+        return;
+    }
+
+    bool enabled = doc["data"]["enabled"] | true;
+    uint32_t intervalSeconds = doc["data"]["intervalSeconds"] | (uint32_t)(PALETTE_SHUFFLE_DEFAULT_INTERVAL / 1000);
+    lightManager->setShuffle(enabled, intervalSeconds * 1000);
 }
 
 void WSClient::handleFactoryReset(JsonDocument &doc)
 {
-    Serial.println("🔄 Factory reset command received via WebSocket");
+    LOG_I("🔄 Factory reset command received via WebSocket");
 
     // Send acknowledgment back to backend
     if (isClientConnected())
@@ -1090,7 +1215,7 @@ void WSClient::handleFactoryReset(JsonDocument &doc)
         serializeJson(response, message);
         sendMessage(message);
 
-        Serial.println("📤 Sent factory reset acknowledgment");
+        LOG_I("📤 Sent factory reset acknowledgment");
     }
 
     // Give a moment for the message to be sent
@@ -1105,10 +1230,10 @@ void WSClient::handleFactoryReset(JsonDocument &doc)
     // Also reset lighting system configuration (Nanoleaf auth tokens, etc.)
     if (lightManager)
     {
-        Serial.println("🔄 Resetting lighting system configuration...");
+        LOG_I("🔄 Resetting lighting system configuration...");
         lightManager->resetConfiguration();
     }
 
     // Reset will restart the device, so this code won't be reached
-    Serial.println("🔄 Factory reset initiated, device will restart...");
+    LOG_I("🔄 Factory reset initiated, device will restart...");
 }
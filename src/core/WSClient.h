@@ -4,23 +4,18 @@
 #include <ArduinoWebsockets.h>
 #include <ArduinoJson.h>
 #include "DeviceManager.h"
+#include "BinaryProtocol.h"
+#include "StatusChannel.h"
+#include "Metrics.h"
+#include "MessageArena.h"
+#include "ConnectionSupervisor.h"
 #include "../lighting/LightManager.h"
+#include "../lighting/ControllerRegistry.h"
 #include "../config.h"
 #include "../root_ca.h"
 
 using namespace websockets;
 
-// Legacy struct for backward compatibility
-struct LegacyColorPalette
-{
-    String messageId;
-    String senderId;
-    String senderName;
-    unsigned long timestamp;
-    String colors[10];
-    int colorCount;
-};
-
 class WSClient
 {
 private:
@@ -29,21 +24,36 @@ private:
     LightManager *lightManager;
     String serverUrl;
     bool isConnected;
-    unsigned long lastHeartbeat;
-    unsigned long lastPongReceived;
-    unsigned long lastConnectionAttempt;
-    int retryAttempts;
-    unsigned long lastRetryReset;
+    ConnectionSupervisor supervisor; // Heartbeat timing, liveness and reconnect backoff
+    unsigned long lastPeriodicStatus;
     ColorPalette currentPalette;
+    StatusChannel *statusChannel;
+
+    // Parse filters: event name only, colorPalette fields, and control events ("data" subtree)
+    JsonDocument eventFilter;
+    JsonDocument paletteFilter;
+    JsonDocument controlFilter;
+
+    // Backs the documents of the message being handled; reset after each one
+    MessageArena messageArena;
 
     // Message handlers
+    void handleTextMessage(const char *text, size_t length);
     void handleColorPalette(JsonDocument &doc);
+    void handleBinaryMessage(const uint8_t *data, size_t length);
     void handleDeviceRegistered(JsonDocument &doc);
     void handleDeviceClaimed(JsonDocument &doc);
     void handleSetupComplete(JsonDocument &doc);
     void handleLightingSystemConfig(JsonDocument &doc);
+    void configureLightingSystem(LightSystemType type, const char *systemName, const String &systemType,
+                                 JsonObject data);
+    void handleLightingRequestDone(LightManager::Request request, bool success);
     void handleTestLightingSystem(JsonDocument &doc);
+    void handleSetBrightness(JsonDocument &doc);
     void handleFactoryReset(JsonDocument &doc);
+    void handleGetMetrics(JsonDocument &doc);
+    void handleGetLogs(JsonDocument &doc);
+    void handleShuffleHistory(JsonDocument &doc);
 
     // Connection management
     void onMessageCallback(WebsocketsMessage message);
@@ -59,7 +69,6 @@ private:
     // Utility functions
     void displayColorPaletteSerial();
     void displayColorPaletteOnLights();
-    ColorPalette convertToLightPalette(const LegacyColorPalette &legacyPalette);
 
 public:
     WSClient(DeviceManager *devManager, LightManager *lightMgr = nullptr);
@@ -69,20 +78,41 @@ public:
     bool connect();
     void disconnect();
     bool isClientConnected();
-    void loop();
-    void sendHeartbeat();
+
+    // Scheduled work - main.ino registers each of these with the TaskScheduler
+    void poll();                  // Process incoming frames (short interval)
+    void sendHeartbeat();         // Ping the server (getHeartbeatInterval())
+    void checkConnectionHealth(); // Probe, then drop, connections that stopped answering pings
+    bool attemptReconnect();      // One reconnection attempt if disconnected and the backoff allows
+
+    /**
+     * Delay before the next heartbeat (adapts to how steady the link is)
+     */
+    unsigned long getHeartbeatInterval() const;
+
+    /**
+     * Delay before the next reconnection attempt (jittered exponential backoff)
+     */
+    unsigned long getReconnectDelay() const;
+
+    /**
+     * RTT, heartbeat and reconnect figures
+     */
+    void connectionStatsToJson(JsonObject out) const;
+    uint32_t getSmoothedRtt() const { return supervisor.getSmoothedRtt(); }
+
     bool registerDevice();
     void sendMessage(const String &message);
 
     // Light management
     void setLightManager(LightManager *lightMgr);
 
+    // Periodic status reports go through the channel once attached (deltas + acks)
+    void setStatusChannel(StatusChannel *channel);
+
     // Manual lighting authentication retry (for when initial authentication fails)
+    // Runs on the lighting task; false if it could not be started
     bool retryLightingAuthentication();
-
-    // Status helpers
-    bool shouldSendHeartbeat();
-    bool shouldRetryConnection();
 };
 
 #endif
@@ -1,21 +1,15 @@
 #include "WiFiManager.h"
+#include "ConfigStore.h"
+#include "Metrics.h"
+#include "MemoryTelemetry.h"
+#include "SetupPage.h"
 #include <ArduinoJson.h>
+#include "Log.h"
 
-// Helper function to check memory health before allocations
-static bool isMemoryHealthy()
-{
-    size_t freeHeap = ESP.getFreeHeap();
-    const size_t MIN_SAFE_HEAP = 15000; // 15KB minimum for web server components
-
-    if (freeHeap < MIN_SAFE_HEAP)
-    {
-        Serial.println("⚠️ Insufficient memory for server allocation: " + String(freeHeap) + " bytes free (minimum: " + String(MIN_SAFE_HEAP) + ")");
-        return false;
-    }
-    return true;
-}
+static const char *const LOG_TAG = "wifi";
 
-WiFiManager::WiFiManager() : server(nullptr), dnsServer(nullptr), serverURLCached(false), isAPMode(false), apStartTime(0)
+WiFiManager::WiFiManager() : server(nullptr), dnsServer(nullptr), serverURLCached(false), isAPMode(false), apStartTime(0),
+                             scannedNetworkCount(0), lastScanTime(0), scanStartTime(0), scanInProgress(false), scanRequested(false)
 {
 }
 
@@ -33,20 +27,21 @@ WiFiManager::~WiFiManager()
 
 void WiFiManager::begin()
 {
-    preferences.begin(DEVICE_PREF_NAMESPACE, false);
+    ConfigStore::getInstance()->begin();
 
     // Load saved credentials
-    savedSSID = preferences.getString(PREF_WIFI_SSID, "");
-    savedPassword = preferences.getString(PREF_WIFI_PASSWORD, "");
+    StoredConfig stored = ConfigStore::getInstance()->get();
+    savedSSID = stored.wifiSsid;
+    savedPassword = stored.wifiPassword;
 
-    Serial.println("📶 WiFiManager initialized");
+    LOG_I("📶 WiFiManager initialized");
     if (savedSSID.length() > 0)
     {
-        Serial.println("📝 Found saved WiFi credentials for: " + savedSSID);
+        LOG_I("📝 Found saved WiFi credentials for: %s", savedSSID.c_str());
     }
     else
     {
-        Serial.println("📝 No saved WiFi credentials found");
+        LOG_I("📝 No saved WiFi credentials found");
     }
 }
 
@@ -54,45 +49,85 @@ bool WiFiManager::connectToWiFi()
 {
     if (savedSSID.length() == 0)
     {
-        Serial.println("❌ No WiFi credentials available");
+        LOG_E("❌ No WiFi credentials available");
         return false;
     }
 
-    Serial.println("📶 Attempting to connect to WiFi: " + savedSSID);
+    MetricSpan connectSpan(Metrics::WIFI_CONNECT);
     WiFi.mode(WIFI_STA);
-    WiFi.begin(savedSSID.c_str(), savedPassword.c_str());
 
-    unsigned long startTime = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - startTime < WIFI_CONNECT_TIMEOUT)
+    // Join the last known access point directly - skips the full channel scan
+    StoredConfig stored = ConfigStore::getInstance()->get();
+    if (stored.wifiChannel > 0)
+    {
+        LOG_I("⚡ Fast-connecting to WiFi: %s (channel %d)", savedSSID.c_str(), stored.wifiChannel);
+        WiFi.begin(savedSSID.c_str(), savedPassword.c_str(), stored.wifiChannel, stored.wifiBssid);
+
+        if (waitForConnection(WIFI_FAST_CONNECT_TIMEOUT))
+        {
+            return onConnected();
+        }
+
+        // The AP moved or changed channel - fall back to a normal scan
+        LOG_W("⚠ Fast connect failed, scanning for %s", savedSSID.c_str());
+        WiFi.disconnect();
+    }
+    else
     {
-        delay(500);
-        Serial.print(".");
+        LOG_I("📶 Attempting to connect to WiFi: %s", savedSSID.c_str());
     }
-    Serial.println();
 
-    if (WiFi.status() == WL_CONNECTED)
+    WiFi.begin(savedSSID.c_str(), savedPassword.c_str());
+    if (waitForConnection(WIFI_CONNECT_TIMEOUT))
     {
-        Serial.println("✅ WiFi connected successfully!");
-        Serial.println("📍 IP Address: " + WiFi.localIP().toString());
-        Serial.println("📡 Signal Strength: " + String(WiFi.RSSI()) + " dBm");
-        return true;
+        return onConnected();
     }
-    else
+
+    LOG_E("❌ WiFi connection failed");
+    connectSpan.cancel(); // Timeouts would swamp the connect latency
+    return false;
+}
+
+bool WiFiManager::waitForConnection(unsigned long timeoutMs)
+{
+    unsigned long startTime = millis();
+    while (WiFi.status() != WL_CONNECTED && millis() - startTime < timeoutMs)
     {
-        Serial.println("❌ WiFi connection failed");
-        return false;
+        delay(WIFI_CONNECT_POLL_INTERVAL);
     }
+
+    return WiFi.status() == WL_CONNECTED;
+}
+
+bool WiFiManager::onConnected()
+{
+    LOG_I("✅ WiFi connected successfully!");
+    LOG_I("📍 IP Address: %s", WiFi.localIP().toString().c_str());
+    LOG_I("📡 Signal Strength: %d dBm", WiFi.RSSI());
+
+    // Remember the access point for the next boot (written only if it changed)
+    const uint8_t *bssid = WiFi.BSSID();
+    uint8_t channel = WiFi.channel();
+    if (bssid != nullptr && channel > 0)
+    {
+        ConfigStore::getInstance()->update([&](StoredConfig &stored)
+                                           {
+            memcpy(stored.wifiBssid, bssid, sizeof(stored.wifiBssid));
+            stored.wifiChannel = channel; });
+    }
+
+    return true;
 }
 
 void WiFiManager::startAPMode()
 {
     if (isAPMode)
     {
-        Serial.println("⚠ Already in AP mode");
+        LOG_W("⚠ Already in AP mode");
         return;
     }
 
-    Serial.println("🔄 Starting Access Point mode...");
+    LOG_I("🔄 Starting Access Point mode...");
 
     // Create AP SSID with MAC address suffix for uniqueness
     String macAddr = WiFi.macAddress();
@@ -104,18 +139,21 @@ void WiFiManager::startAPMode()
 
     if (apStarted)
     {
-        Serial.println("✅ Access Point started successfully!");
-        Serial.println("📶 AP SSID: " + apSSID);
-        Serial.println("🔐 AP Password: " + String(DEFAULT_AP_PASSWORD));
-        Serial.println("📍 AP IP: " + WiFi.softAPIP().toString());
+        LOG_I("✅ Access Point started successfully!");
+        LOG_I("📶 AP SSID: %s", apSSID.c_str());
+        LOG_I("🔐 AP Password: %s", DEFAULT_AP_PASSWORD);
+        LOG_I("📍 AP IP: %s", WiFi.softAPIP().toString().c_str());
 
         setupCaptivePortal();
         isAPMode = true;
         apStartTime = millis();
+
+        // First scan starts on the next loop so the list is ready when a phone joins
+        lastScanTime = 0;
     }
     else
     {
-        Serial.println("❌ Failed to start Access Point");
+        LOG_E("❌ Failed to start Access Point");
     }
 }
 
@@ -126,7 +164,7 @@ void WiFiManager::stopAPMode()
         return;
     }
 
-    Serial.println("🔄 Stopping Access Point mode...");
+    LOG_I("🔄 Stopping Access Point mode...");
 
     // Safely cleanup web server
     if (server != nullptr)
@@ -144,12 +182,18 @@ void WiFiManager::stopAPMode()
         dnsServer = nullptr;
     }
 
+    if (scanInProgress)
+    {
+        WiFi.scanDelete();
+        scanInProgress = false;
+    }
+
     // Disconnect AP and cleanup WiFi state
     WiFi.softAPdisconnect(true);
     isAPMode = false;
     apStartTime = 0;
 
-    Serial.println("✅ Access Point stopped and resources cleaned up");
+    LOG_I("✅ Access Point stopped and resources cleaned up");
 }
 
 void WiFiManager::setupCaptivePortal()
@@ -170,9 +214,9 @@ void WiFiManager::setupCaptivePortal()
     }
 
     // Check memory health before allocation
-    if (!isMemoryHealthy())
+    if (!MemoryTelemetry::getInstance()->isHealthy(MEMORY_PORTAL_MIN_FREE_HEAP))
     {
-        Serial.println("❌ Cannot start captive portal due to insufficient memory");
+        LOG_E("❌ Cannot start captive portal due to insufficient memory");
         return;
     }
 
@@ -183,7 +227,7 @@ void WiFiManager::setupCaptivePortal()
     // Verify allocation succeeded
     if (server == nullptr || dnsServer == nullptr)
     {
-        Serial.println("❌ Failed to allocate memory for web server components");
+        LOG_E("❌ Failed to allocate memory for web server components");
         // Cleanup any successful allocation
         if (server != nullptr)
         {
@@ -201,7 +245,7 @@ void WiFiManager::setupCaptivePortal()
     // Start DNS server for captive portal with error checking
     if (!dnsServer->start(53, "*", WiFi.softAPIP()))
     {
-        Serial.println("❌ Failed to start DNS server for captive portal");
+        LOG_E("❌ Failed to start DNS server for captive portal");
         // Cleanup on failure
         delete server;
         server = nullptr;
@@ -226,17 +270,34 @@ void WiFiManager::setupCaptivePortal()
     server->on("/scan", HTTP_GET, [this](AsyncWebServerRequest *request)
                { handleScanNetworks(request); });
 
+    server->on("/metrics", HTTP_GET, [this](AsyncWebServerRequest *request)
+               { handleMetrics(request); });
+
     // Captive portal - redirect all requests to setup page
     server->onNotFound([this](AsyncWebServerRequest *request)
                        { handleRoot(request); });
 
     server->begin();
-    Serial.println("✅ Captive portal web server started successfully");
+    LOG_I("✅ Captive portal web server started successfully");
 }
 
 void WiFiManager::handleRoot(AsyncWebServerRequest *request)
 {
-    request->send(200, "text/html", getSetupPageHTML());
+    // The page only changes with the firmware, so the version doubles as its ETag
+    static const char *const etag = "\"" FIRMWARE_VERSION "\"";
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == etag)
+    {
+        request->send(304);
+        return;
+    }
+
+    // Streamed straight from flash - nothing is built on the heap per request
+    AsyncWebServerResponse *response = request->beginResponse(200, "text/html",
+                                                              reinterpret_cast<const uint8_t *>(SETUP_PAGE_HTML),
+                                                              strlen_P(SETUP_PAGE_HTML));
+    response->addHeader("Cache-Control", "max-age=" + String(SETUP_PAGE_MAX_AGE));
+    response->addHeader("ETag", etag);
+    request->send(response);
 }
 
 void WiFiManager::handleSave(AsyncWebServerRequest *request)
@@ -244,17 +305,17 @@ void WiFiManager::handleSave(AsyncWebServerRequest *request)
     String ssid = "";
     String password = "";
 
-    Serial.println("🔍 DEBUG: Processing captive portal form submission...");
+    LOG_I("🔍 DEBUG: Processing captive portal form submission...");
 
     if (request->hasParam("ssid", true))
     {
         ssid = request->getParam("ssid", true)->value();
-        Serial.println("  - SSID: '" + ssid + "'");
+        LOG_I("  - SSID: '%s'", ssid.c_str());
     }
     if (request->hasParam("password", true))
     {
         password = request->getParam("password", true)->value();
-        Serial.println("  - Password: [hidden]");
+        LOG_I("  - Password: [hidden]");
     }
 
     if (ssid.length() > 0)
@@ -268,6 +329,7 @@ void WiFiManager::handleSave(AsyncWebServerRequest *request)
                       "<p>You can close this window.</p></body></html>");
 
         delay(2000);
+        Log::flush();
         ESP.restart();
     }
     else
@@ -281,13 +343,16 @@ void WiFiManager::handleSave(AsyncWebServerRequest *request)
 
 void WiFiManager::handleStatus(AsyncWebServerRequest *request)
 {
+    StoredConfig stored = ConfigStore::getInstance()->get();
+
     JsonDocument doc;
-    doc["deviceId"] = preferences.getString(PREF_DEVICE_ID, "Not set");
+    doc["deviceId"] = stored.deviceId[0] != '\0' ? stored.deviceId : "Not set";
     doc["macAddress"] = WiFi.macAddress();
     doc["firmwareVersion"] = FIRMWARE_VERSION;
     doc["freeHeap"] = ESP.getFreeHeap();
+    doc["largestFreeBlock"] = MemoryTelemetry::sample().largestBlock;
     doc["uptime"] = millis();
-    doc["isProvisioned"] = preferences.getBool(PREF_IS_PROVISIONED, false);
+    doc["isProvisioned"] = stored.isProvisioned;
 
     String response;
     serializeJson(doc, response);
@@ -302,119 +367,24 @@ void WiFiManager::handleReset(AsyncWebServerRequest *request)
                   "<p>All settings cleared. Device will restart.</p></body></html>");
 
     delay(2000);
+    Log::flush();
     ESP.restart();
 }
 
-String WiFiManager::getSetupPageHTML()
+bool WiFiManager::isConnected()
 {
-    String html = "<!DOCTYPE html><html><head>";
-    html += "<meta charset='UTF-8'>";
-    html += "<meta name='viewport' content='width=device-width, initial-scale=1.0'>";
-    html += "<title>PalPalette Setup</title>";
-    html += "<style>";
-    html += "body { font-family: Arial, sans-serif; margin: 20px; background: #f0f0f0; }";
-    html += ".container { max-width: 600px; margin: 0 auto; background: white; padding: 20px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }";
-    html += "h1 { color: #333; text-align: center; margin-bottom: 30px; }";
-    html += ".form-group { margin-bottom: 20px; }";
-    html += "label { display: block; margin-bottom: 5px; font-weight: bold; color: #555; }";
-    html += "input[type='text'], input[type='password'] { width: 100%; padding: 10px; border: 1px solid #ddd; border-radius: 5px; box-sizing: border-box; }";
-    html += "button { background: #007bff; color: white; padding: 12px 30px; border: none; border-radius: 5px; cursor: pointer; font-size: 16px; width: 100%; }";
-    html += "button:hover { background: #0056b3; }";
-    html += ".info { background: #e9ecef; padding: 15px; border-radius: 5px; margin-bottom: 20px; }";
-    html += ".scan-btn { margin-top: 5px; padding: 5px 10px; font-size: 12px; width: auto; }";
-    html += ".networks-list { margin-top: 10px; border: 1px solid #ddd; border-radius: 5px; max-height: 200px; overflow-y: auto; display: none; }";
-    html += ".network-item { padding: 10px; border-bottom: 1px solid #eee; cursor: pointer; display: flex; justify-content: space-between; align-items: center; }";
-    html += ".network-item:hover { background: #f8f9fa; }";
-    html += ".network-item:last-child { border-bottom: none; }";
-    html += ".network-name { font-weight: bold; }";
-    html += ".network-info { font-size: 12px; color: #666; }";
-    html += ".signal-strength { font-size: 12px; color: #666; }";
-    html += ".encrypted { color: #ffc107; }";
-    html += ".loading { text-align: center; padding: 20px; color: #666; }";
-    html += "</style>";
-    html += "<script>";
-    html += "function selectNetwork(ssid) { document.getElementById('ssid').value = ssid; }";
-    html += "function scanNetworks() {";
-    html += "  const scanBtn = document.querySelector('.scan-btn');";
-    html += "  const networksList = document.getElementById('networks-list');";
-    html += "  scanBtn.disabled = true;";
-    html += "  scanBtn.textContent = 'Scanning...';";
-    html += "  networksList.style.display = 'block';";
-    html += "  networksList.innerHTML = '<div class=\"loading\">Scanning for networks...</div>';";
-    html += "  fetch('/scan')";
-    html += "    .then(response => response.json())";
-    html += "    .then(data => {";
-    html += "      networksList.innerHTML = '';";
-    html += "      if (data.networks && data.networks.length > 0) {";
-    html += "        data.networks.forEach(network => {";
-    html += "          const item = document.createElement('div');";
-    html += "          item.className = 'network-item';";
-    html += "          item.onclick = () => selectNetwork(network.ssid);";
-    html += "          const signalBars = Math.round(network.quality / 25);";
-    html += "          const signalIcon = '📶'.repeat(Math.max(1, signalBars));";
-    html += "          const lockIcon = network.encryption ? '🔒 ' : '';";
-    html += "          item.innerHTML = `";
-    html += "            <div>";
-    html += "              <div class=\"network-name\">${lockIcon}${network.ssid}</div>";
-    html += "              <div class=\"network-info\">Signal: ${network.quality}% (${network.rssi} dBm)</div>";
-    html += "            </div>";
-    html += "            <div class=\"signal-strength\">${signalIcon}</div>`;";
-    html += "          networksList.appendChild(item);";
-    html += "        });";
-    html += "      } else {";
-    html += "        networksList.innerHTML = '<div class=\"loading\">No networks found</div>';";
-    html += "      }";
-    html += "    })";
-    html += "    .catch(error => {";
-    html += "      console.error('Error scanning networks:', error);";
-    html += "      networksList.innerHTML = '<div class=\"loading\">Error scanning networks</div>';";
-    html += "    })";
-    html += "    .finally(() => {";
-    html += "      scanBtn.disabled = false;";
-    html += "      scanBtn.textContent = 'Scan Networks';";
-    html += "    });";
-    html += "}";
-    html += "window.onload = function() { scanNetworks(); };";
-    html += "</script>";
-    html += "</head><body>";
-    html += "<div class='container'>";
-    html += "<h1>PalPalette Device Setup</h1>";
-    html += "<div class='info'>";
-    html += "<strong>Device Information:</strong><br>";
-    html += "MAC Address: " + WiFi.macAddress() + "<br>";
-    html += "Firmware: " + String(FIRMWARE_VERSION);
-    html += "</div>";
-    html += "<form action='/save' method='post'>";
-    html += "<div class='form-group'>";
-    html += "<label for='ssid'>WiFi Network Name (SSID):</label>";
-    html += "<input type='text' id='ssid' name='ssid' required placeholder='Enter your WiFi network name'>";
-    html += "<button type='button' onclick='scanNetworks()' class='scan-btn'>Scan Networks</button>";
-    html += "<div id='networks-list' class='networks-list'></div>";
-    html += "</div>";
-    html += "<div class='form-group'>";
-    html += "<label for='password'>WiFi Password:</label>";
-    html += "<input type='password' id='password' name='password' placeholder='Enter your WiFi password (leave blank if none)'>";
-    html += "</div>";
-    html += "<div style='background: #e9f4ff; padding: 15px; border-radius: 5px; margin-bottom: 20px;'>";
-    html += "<strong>💡 Lighting System Configuration</strong><br>";
-    html += "Your lighting system will be configured through the PalPalette mobile app after this device is paired. ";
-    html += "Supported systems: WS2812 LED strips, WLED controllers, and Nanoleaf panels.";
-    html += "</div>";
-    html += "<button type='submit'>Save Settings & Connect</button>";
-    html += "</form>";
-    html += "<div style='margin-top: 30px; text-align: center;'>";
-    html += "<a href='/status' style='color: #007bff; text-decoration: none;'>Device Status</a> | ";
-    html += "<a href='/reset' onclick='return confirm(\"This will reset all settings. Continue?\")' style='color: #dc3545; text-decoration: none;'>Reset Device</a>";
-    html += "</div>";
-    html += "</div>";
-    html += "</body></html>";
-
-    return html;
+    return WiFi.status() == WL_CONNECTED;
 }
 
-bool WiFiManager::isConnected()
+void WiFiManager::handleMetrics(AsyncWebServerRequest *request)
 {
-    return WiFi.status() == WL_CONNECTED;
+    JsonDocument doc;
+    Metrics::getInstance()->toJson(doc.to<JsonObject>());
+    MemoryTelemetry::getInstance()->toJson(doc["memory"].to<JsonObject>());
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
 }
 
 bool WiFiManager::isInAPMode()
@@ -424,55 +394,51 @@ bool WiFiManager::isInAPMode()
 
 void WiFiManager::saveWiFiCredentials(const String &ssid, const String &password)
 {
-    preferences.putString(PREF_WIFI_SSID, ssid);
-    preferences.putString(PREF_WIFI_PASSWORD, password);
+    ConfigStore::getInstance()->update([&](StoredConfig &stored)
+                                       {
+        ConfigStore::setField(stored.wifiSsid, ssid);
+        ConfigStore::setField(stored.wifiPassword, password);
+        stored.wifiChannel = 0; });
     savedSSID = ssid;
     savedPassword = password;
 
-    Serial.println("💾 WiFi credentials saved for: " + ssid);
+    LOG_I("💾 WiFi credentials saved for: %s", ssid.c_str());
 }
 
 void WiFiManager::saveLightingConfig(const String &systemType, const String &hostAddress, int port)
 {
-    preferences.putString("lighting_system", systemType);
-
-    if (hostAddress.length() > 0)
-    {
-        preferences.putString("lighting_host", hostAddress);
-    }
-    else
-    {
-        preferences.remove("lighting_host");
-    }
-
-    if (port > 0)
-    {
-        preferences.putInt("lighting_port", port);
-    }
-    else
-    {
-        preferences.remove("lighting_port");
-    }
-
-    Serial.println("💡 Lighting configuration saved: " + systemType);
+    // A newly chosen system starts without a token or custom config
+    ConfigStore::getInstance()->update([&](StoredConfig &stored)
+                                       {
+        ConfigStore::setField(stored.lightingSystem, systemType);
+        ConfigStore::setField(stored.lightingHost, hostAddress);
+        stored.lightingPort = max(port, 0);
+        stored.lightingAuthToken[0] = '\0';
+        stored.lightingCustomConfig[0] = '\0'; });
+
+    LOG_I("💡 Lighting configuration saved: %s", systemType.c_str());
     if (hostAddress.length() > 0)
     {
-        Serial.println("🌐 Host: " + hostAddress + (port > 0 ? ":" + String(port) : ""));
+        LOG_I("🌐 Host: %s:%d", hostAddress.c_str(), port);
     }
 }
 
 void WiFiManager::clearWiFiCredentials()
 {
-    preferences.remove(PREF_WIFI_SSID);
-    preferences.remove(PREF_WIFI_PASSWORD);
-    preferences.remove(PREF_SERVER_URL);
-    preferences.remove(PREF_DEVICE_ID);
-    preferences.remove(PREF_IS_PROVISIONED);
+    ConfigStore::getInstance()->update([](StoredConfig &stored)
+                                       {
+        stored.wifiSsid[0] = '\0';
+        stored.wifiPassword[0] = '\0';
+        stored.wifiChannel = 0;
+        stored.serverUrl[0] = '\0';
+        stored.deviceId[0] = '\0';
+        stored.isProvisioned = false; });
+    serverURLCached = false;
 
     savedSSID = "";
     savedPassword = "";
 
-    Serial.println("🗑 WiFi credentials and device settings cleared");
+    LOG_I("🗑 WiFi credentials and device settings cleared");
 }
 
 String WiFiManager::getSSID()
@@ -503,15 +469,17 @@ void WiFiManager::loop()
     if (isAPMode && dnsServer != nullptr)
     {
         dnsServer->processNextRequest();
+        updateNetworkScan();
 
         // Check for AP timeout with proper error handling
         if (millis() - apStartTime > CAPTIVE_PORTAL_TIMEOUT)
         {
-            Serial.println("⏰ Captive portal timeout reached, cleaning up and restarting...");
+            LOG_I("⏰ Captive portal timeout reached, cleaning up and restarting...");
 
             // Proper cleanup before restart
             stopAPMode();
             delay(1000); // Give time for cleanup
+            Log::flush();
             ESP.restart();
         }
     }
@@ -524,11 +492,12 @@ bool WiFiManager::hasStoredCredentials()
 
 void WiFiManager::setServerURL(const String &url)
 {
-    preferences.putString(PREF_SERVER_URL, url);
+    ConfigStore::getInstance()->update([&](StoredConfig &stored)
+                                       { ConfigStore::setField(stored.serverUrl, url); });
     // Update cache with new value
     cachedServerURL = url;
     serverURLCached = true;
-    Serial.println("💾 Server URL saved: " + url);
+    LOG_I("💾 Server URL saved: %s", url.c_str());
 }
 
 String WiFiManager::getServerURL()
@@ -539,17 +508,18 @@ String WiFiManager::getServerURL()
         return cachedServerURL;
     }
 
-    // Load from preferences once
-    if (!preferences.isKey(PREF_SERVER_URL))
+    // Load from the config store once
+    StoredConfig stored = ConfigStore::getInstance()->get();
+    if (stored.serverUrl[0] == '\0')
     {
         // Key doesn't exist, use default
         cachedServerURL = DEFAULT_SERVER_URL;
-        Serial.println("📝 No saved server URL found, using default: " + cachedServerURL);
+        LOG_I("📝 No saved server URL found, using default: %s", cachedServerURL.c_str());
     }
     else
     {
-        cachedServerURL = preferences.getString(PREF_SERVER_URL, DEFAULT_SERVER_URL);
-        Serial.println("📝 Loaded server URL from preferences: " + cachedServerURL);
+        cachedServerURL = stored.serverUrl;
+        LOG_I("📝 Loaded server URL from config store: %s", cachedServerURL.c_str());
     }
 
     serverURLCached = true;
@@ -563,88 +533,160 @@ bool WiFiManager::isCaptivePortalHealthy()
 
 void WiFiManager::handleScanNetworks(AsyncWebServerRequest *request)
 {
-    Serial.println("🔍 Scanning for WiFi networks...");
-
-    String networks = scanAvailableNetworks();
-    request->send(200, "application/json", networks);
+    // Never scan here - a blocking scan would stall the web server task for seconds.
+    // With nothing cached yet (a phone joined before the first background scan) a plain load asks too.
+    if (request->hasParam("refresh") || lastScanTime == 0)
+    {
+        scanRequested = true;
+    }
+    request->send(200, "application/json", scanResultsToJson());
 }
 
-String WiFiManager::scanAvailableNetworks()
+void WiFiManager::updateNetworkScan()
 {
-    // Start WiFi scan
-    int networkCount = WiFi.scanNetworks();
+    unsigned long now = millis();
 
-    JsonDocument doc;
-    JsonArray networksArray = doc["networks"].to<JsonArray>();
+    if (scanInProgress)
+    {
+        int16_t result = WiFi.scanComplete();
+        if (result == WIFI_SCAN_RUNNING && now - scanStartTime < WIFI_SCAN_TIMEOUT)
+        {
+            return;
+        }
 
-    if (networkCount == 0)
+        if (result >= 0)
+        {
+            collectScanResults(result);
+        }
+        else
+        {
+            LOG_W("⚠ Network scan %s", result == WIFI_SCAN_RUNNING ? "timed out" : "failed");
+        }
+
+        WiFi.scanDelete();
+        scanInProgress = false;
+        lastScanTime = max(now, 1UL);
+        return;
+    }
+
+    // A scan takes the radio off the AP channel and drops connected phones, so
+    // the periodic refresh only runs while nobody is on the setup page
+    bool due = WiFi.softAPgetStationNum() == 0 &&
+               (lastScanTime == 0 || now - lastScanTime >= WIFI_SCAN_INTERVAL);
+    if (!due && !(scanRequested && (lastScanTime == 0 || now - lastScanTime >= WIFI_SCAN_MIN_INTERVAL)))
     {
-        Serial.println("No networks found");
+        return;
     }
-    else
+
+    scanRequested = false;
+    if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED)
     {
-        Serial.println("Found " + String(networkCount) + " networks:");
+        LOG_W("⚠ Could not start network scan");
+        lastScanTime = max(now, 1UL); // Retry on the next interval
+        return;
+    }
+
+    scanInProgress = true;
+    scanStartTime = now;
+    LOG_D("🔍 Network scan started");
+}
+
+void WiFiManager::collectScanResults(int resultCount)
+{
+    // Built off to the side, then swapped in, so /scan never sees a half-filled list
+    ScannedNetwork found[WIFI_SCAN_MAX_NETWORKS];
+    int foundCount = 0;
 
-        // Sort networks by signal strength (RSSI)
-        for (int i = 0; i < networkCount - 1; i++)
+    for (int i = 0; i < resultCount; i++)
+    {
+        String ssid = WiFi.SSID(i);
+
+        // Skip hidden networks (empty SSID)
+        if (ssid.length() == 0)
         {
-            for (int j = i + 1; j < networkCount; j++)
-            {
-                if (WiFi.RSSI(i) < WiFi.RSSI(j))
-                {
-                    // Swap networks (we need to track indices since WiFi library doesn't provide direct sorting)
-                    // We'll just iterate in RSSI order when building the JSON
-                }
-            }
+            continue;
         }
 
-        // Build JSON array of unique networks (remove duplicates by SSID)
-        for (int i = 0; i < networkCount; i++)
-        {
-            String ssid = WiFi.SSID(i);
-            int32_t rssi = WiFi.RSSI(i);
-            wifi_auth_mode_t encryption = WiFi.encryptionType(i);
+        int8_t rssi = (int8_t)constrain(WiFi.RSSI(i), -128, 0);
+        bool encrypted = WiFi.encryptionType(i) != WIFI_AUTH_OPEN;
 
-            // Skip hidden networks (empty SSID)
-            if (ssid.length() == 0)
+        // One entry per SSID (mesh and multi-AP setups repeat it), keeping the strongest
+        int existing = -1;
+        for (int j = 0; j < foundCount && existing < 0; j++)
+        {
+            if (strcmp(found[j].ssid, ssid.c_str()) == 0)
             {
-                continue;
+                existing = j;
             }
+        }
 
-            // Check for duplicates
-            bool isDuplicate = false;
-            for (JsonVariant network : networksArray)
+        if (existing >= 0)
+        {
+            if (rssi <= found[existing].rssi)
             {
-                if (network["ssid"].as<String>() == ssid)
-                {
-                    // If we found a duplicate, keep the one with stronger signal
-                    if (rssi > network["rssi"].as<int32_t>())
-                    {
-                        network["rssi"] = rssi;
-                        network["encryption"] = (encryption != WIFI_AUTH_OPEN);
-                    }
-                    isDuplicate = true;
-                    break;
-                }
+                continue;
             }
+            // Take it out and re-insert below at its new position
+            memmove(found + existing, found + existing + 1, (foundCount - existing - 1) * sizeof(ScannedNetwork));
+            foundCount--;
+        }
 
-            // Add new network if not duplicate
-            if (!isDuplicate)
-            {
-                JsonObject network = networksArray.add<JsonObject>();
-                network["ssid"] = ssid;
-                network["rssi"] = rssi;
-                network["encryption"] = (encryption != WIFI_AUTH_OPEN);
-                network["quality"] = constrain(2 * (rssi + 100), 0, 100); // Convert RSSI to quality percentage
-
-                Serial.println("  " + ssid + " (" + String(rssi) + " dBm) " +
-                               (encryption != WIFI_AUTH_OPEN ? "[Encrypted]" : "[Open]"));
-            }
+        // Insertion sort, strongest first; when full the weakest falls off the end
+        int position = foundCount;
+        while (position > 0 && found[position - 1].rssi < rssi)
+        {
+            position--;
+        }
+        if (position >= WIFI_SCAN_MAX_NETWORKS)
+        {
+            continue;
         }
+
+        int moved = min(foundCount, WIFI_SCAN_MAX_NETWORKS - 1) - position;
+        memmove(found + position + 1, found + position, moved * sizeof(ScannedNetwork));
+        strlcpy(found[position].ssid, ssid.c_str(), sizeof(found[position].ssid));
+        found[position].rssi = rssi;
+        found[position].encrypted = encrypted;
+        foundCount = min(foundCount + 1, WIFI_SCAN_MAX_NETWORKS);
+    }
+
+    portENTER_CRITICAL(&scanLock);
+    memcpy(scannedNetworks, found, foundCount * sizeof(ScannedNetwork));
+    scannedNetworkCount = foundCount;
+    portEXIT_CRITICAL(&scanLock);
+
+    LOG_I("📶 Scan found %d networks (%d unique)", resultCount, foundCount);
+    for (int i = 0; i < foundCount; i++)
+    {
+        LOG_D("  %s (%d dBm) %s", found[i].ssid, found[i].rssi, found[i].encrypted ? "[Encrypted]" : "[Open]");
     }
+}
 
-    // Clean up scan results
-    WiFi.scanDelete();
+String WiFiManager::scanResultsToJson()
+{
+    ScannedNetwork networks[WIFI_SCAN_MAX_NETWORKS];
+    portENTER_CRITICAL(&scanLock);
+    int networkCount = scannedNetworkCount;
+    memcpy(networks, scannedNetworks, networkCount * sizeof(ScannedNetwork));
+    unsigned long scannedAt = lastScanTime;
+    bool scanning = scanInProgress || scanRequested;
+    portEXIT_CRITICAL(&scanLock);
+
+    JsonDocument doc;
+    JsonArray networksArray = doc["networks"].to<JsonArray>();
+    for (int i = 0; i < networkCount; i++)
+    {
+        JsonObject network = networksArray.add<JsonObject>();
+        network["ssid"] = networks[i].ssid;
+        network["rssi"] = networks[i].rssi;
+        network["encryption"] = networks[i].encrypted;
+        network["quality"] = constrain(2 * (networks[i].rssi + 100), 0, 100); // Convert RSSI to quality percentage
+    }
+    doc["scanning"] = scanning; // The page polls again until this clears
+    if (scannedAt != 0)
+    {
+        doc["age"] = millis() - scannedAt;
+    }
 
     String result;
     serializeJson(doc, result);
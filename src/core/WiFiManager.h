@@ -5,13 +5,11 @@
 #include <WiFiAP.h>
 #include <ESPAsyncWebServer.h>
 #include <DNSServer.h>
-#include <Preferences.h>
 #include "../config.h"
 
 class WiFiManager
 {
 private:
-    Preferences preferences;
     AsyncWebServer *server;
     DNSServer *dnsServer;
     String savedSSID;
@@ -21,14 +19,33 @@ private:
     bool isAPMode;
     unsigned long apStartTime;
 
+    // Captive portal scan cache - filled on the wifiLoop task, read by /scan on the web server task
+    struct ScannedNetwork
+    {
+        char ssid[33];
+        int8_t rssi;
+        bool encrypted;
+    };
+    ScannedNetwork scannedNetworks[WIFI_SCAN_MAX_NETWORKS]; // Strongest first, one per SSID
+    int scannedNetworkCount;
+    unsigned long lastScanTime; // When the cache was filled, 0 = never
+    unsigned long scanStartTime;
+    bool scanInProgress;
+    volatile bool scanRequested; // Set by /scan?refresh=1, or by any /scan while nothing is cached
+    portMUX_TYPE scanLock = portMUX_INITIALIZER_UNLOCKED;
+
     void setupCaptivePortal();
     void handleRoot(AsyncWebServerRequest *request);
     void handleSave(AsyncWebServerRequest *request);
     void handleStatus(AsyncWebServerRequest *request);
     void handleReset(AsyncWebServerRequest *request);
     void handleScanNetworks(AsyncWebServerRequest *request);
-    String getSetupPageHTML();
-    String scanAvailableNetworks();
+    void handleMetrics(AsyncWebServerRequest *request);
+    void updateNetworkScan();
+    void collectScanResults(int resultCount);
+    String scanResultsToJson();
+    bool waitForConnection(unsigned long timeoutMs);
+    bool onConnected();
 
 public:
     WiFiManager();
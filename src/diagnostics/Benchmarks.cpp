@@ -0,0 +1,357 @@
+#include "Benchmarks.h"
+
+#ifdef PALPALETTE_BENCHMARKS
+
+#include <ArduinoJson.h>
+#include <Preferences.h>
+#include <esp_timer.h>
+#include "../core/ConfigStore.h"
+#include "../lighting/ColorMath.h"
+#include "../lighting/LightController.h"
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+#include "../lighting/controllers/NanoleafController.h"
+#endif
+
+// Results are folded into this so the compiler cannot drop the work
+static volatile uint32_t benchSink = 0;
+
+static SemaphoreHandle_t caseDone = nullptr;
+
+// Allocation counting: the bench env links with --wrap=malloc/calloc/realloc,
+// and new, String and ArduinoJson all allocate through those. Only calls made
+// by the task being measured are counted.
+extern "C" void *__real_malloc(size_t size);
+extern "C" void *__real_calloc(size_t count, size_t size);
+extern "C" void *__real_realloc(void *ptr, size_t size);
+
+static volatile TaskHandle_t countedTask = nullptr;
+static volatile uint32_t allocationCount = 0;
+
+static inline void countAllocation()
+{
+    if (countedTask != nullptr && xTaskGetCurrentTaskHandle() == countedTask)
+    {
+        allocationCount++;
+    }
+}
+
+extern "C" void *__wrap_malloc(size_t size)
+{
+    countAllocation();
+    return __real_malloc(size);
+}
+
+extern "C" void *__wrap_calloc(size_t count, size_t size)
+{
+    countAllocation();
+    return __real_calloc(count, size);
+}
+
+extern "C" void *__wrap_realloc(void *ptr, size_t size)
+{
+    countAllocation();
+    return __real_realloc(ptr, size);
+}
+
+static const char *SAMPLE_PALETTE_JSON =
+    "{\"event\":\"colorPalette\",\"messageId\":\"6f1c2a9e-3b1d-4c55-9a0e-2f7d8c4b1a60\","
+    "\"senderId\":\"1d2e3f40-5a6b-7c8d-9e0f-a1b2c3d4e5f6\",\"senderName\":\"Bench\","
+    "\"timestamp\":1760000000000,\"animation\":\"fade\",\"colors\":["
+    "{\"hex\":\"#FF5733\"},{\"hex\":\"#33FF57\"},{\"hex\":\"#3357FF\"},{\"hex\":\"#F1C40F\"},"
+    "{\"hex\":\"#8E44AD\"},{\"hex\":\"#1ABC9C\"},{\"hex\":\"#E67E22\"},{\"hex\":\"#2C3E50\"}]}";
+
+// A 50-pixel frame (the largest Nanoleaf layout), as one animation step
+static RGBColor batchFrom[50];
+static RGBColor batchTo[50];
+static RGBColor batchOut[50];
+
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+struct StaticDataContext
+{
+    NanoleafController *controller;
+    int panelCount;
+    ColorPalette palette;
+};
+#endif
+
+void Benchmarks::runAll()
+{
+    Serial.println("\n⏱ Running benchmarks (" + String(ESP.getCpuFreqMHz()) + " MHz)...");
+
+    if (!caseDone)
+    {
+        caseDone = xSemaphoreCreateBinary();
+    }
+
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+    // One controller shared by the Nanoleaf cases - never initialized, so no network traffic
+    NanoleafController *controller = new NanoleafController();
+    StaticDataContext staticCases[3] = {{controller, 1}, {controller, 10}, {controller, 50}};
+    for (StaticDataContext &context : staticCases)
+    {
+        context.palette.colorCount = 5;
+        for (int i = 0; i < context.palette.colorCount; i++)
+        {
+            context.palette.colors[i] = RGBColor(i * 50, 255 - i * 50, 128);
+        }
+    }
+#endif
+
+    for (int i = 0; i < 50; i++)
+    {
+        batchFrom[i] = RGBColor(i * 5, 255 - i * 5, 64);
+        batchTo[i] = RGBColor(200, i * 5, 255 - i * 5);
+    }
+
+    Case cases[] = {
+        {"RGBColor::fromHex", nullptr, runFromHex, nullptr, 1000},
+        {"hexToColor", nullptr, runHexToColor, nullptr, 1000},
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+        {"rgbToHsb", nullptr, runRgbToHsb, controller, 1000},
+#endif
+        {"hsv2rgb", nullptr, runHsv2Rgb, nullptr, 1000},
+        {"ColorMath::rgbToHsb", nullptr, runColorMathRgbToHsb, nullptr, 1000},
+        {"ColorMath::hsvToRgb", nullptr, runColorMathHsvToRgb, nullptr, 1000},
+        {"blend/50 batch", nullptr, runBlendBatch, nullptr, 500},
+        {"gamma/50 batch", nullptr, runGammaBatch, nullptr, 500},
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+        {"staticColorData/1", setupStaticColorData, runStaticColorData, &staticCases[0], 200},
+        {"staticColorData/10", setupStaticColorData, runStaticColorData, &staticCases[1], 200},
+        {"staticColorData/50", setupStaticColorData, runStaticColorData, &staticCases[2], 100},
+        {"setStaticColors/50", setupStaticColorData, runSetStaticColors, &staticCases[2], 20},
+#endif
+        {"paletteJsonParse", nullptr, runPaletteParse, nullptr, 100},
+        {"prefsLoad", nullptr, runPreferencesLoad, nullptr, 50},
+        {"prefsSave", nullptr, runPreferencesSave, nullptr, 10},
+    };
+
+    Serial.println("  case                  iters   cycles/op    best   us/op  heap delta  allocs/op  peak stack");
+    for (Case &benchCase : cases)
+    {
+        runCase(benchCase);
+        printResult(benchCase);
+        globalFeedWatchdog();
+    }
+
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+    delete controller;
+#endif
+
+    Preferences prefs;
+    if (prefs.begin(BENCH_PREF_NAMESPACE, false))
+    {
+        prefs.clear();
+        prefs.end();
+    }
+
+    Serial.println("✅ Benchmarks complete\n");
+}
+
+void Benchmarks::runCase(Case &benchCase)
+{
+    memset(&benchCase.result, 0, sizeof(benchCase.result));
+
+    if (xTaskCreate(taskEntry, "bench", BENCH_TASK_STACK_SIZE, &benchCase, 1, nullptr) != pdPASS)
+    {
+        Serial.println("❌ Failed to start benchmark task for " + String(benchCase.name));
+        return;
+    }
+
+    xSemaphoreTake(caseDone, portMAX_DELAY);
+}
+
+void Benchmarks::taskEntry(void *parameter)
+{
+    Case &benchCase = *static_cast<Case *>(parameter);
+    Result &result = benchCase.result;
+
+    if (benchCase.setup)
+    {
+        benchCase.setup(benchCase.context);
+    }
+
+    // First call warms caches and any lazy allocation
+    benchCase.run(benchCase.context);
+
+    uint32_t heapBefore = ESP.getFreeHeap();
+    allocationCount = 0;
+    countedTask = xTaskGetCurrentTaskHandle();
+    uint64_t totalCycles = 0;
+    uint32_t minCycles = UINT32_MAX;
+    int64_t startMicros = esp_timer_get_time();
+
+    for (uint32_t i = 0; i < benchCase.iterations; i++)
+    {
+        uint32_t start = ESP.getCycleCount();
+        benchCase.run(benchCase.context);
+        uint32_t cycles = ESP.getCycleCount() - start;
+
+        totalCycles += cycles;
+        minCycles = min(minCycles, cycles);
+    }
+
+    int64_t elapsedMicros = esp_timer_get_time() - startMicros;
+    countedTask = nullptr;
+
+    result.iterations = benchCase.iterations;
+    result.meanCycles = totalCycles / benchCase.iterations;
+    result.minCycles = minCycles;
+    result.meanMicros = elapsedMicros / benchCase.iterations;
+    result.heapDelta = (int32_t)ESP.getFreeHeap() - (int32_t)heapBefore;
+    result.allocations = allocationCount;
+    result.peakStack = BENCH_TASK_STACK_SIZE - uxTaskGetStackHighWaterMark(nullptr);
+
+    xSemaphoreGive(caseDone);
+    vTaskDelete(nullptr);
+}
+
+void Benchmarks::printResult(const Case &benchCase)
+{
+    const Result &result = benchCase.result;
+    Serial.printf("  %-20s %6lu %11lu %7lu %7lu %11ld %10.2f %11lu\n",
+                  benchCase.name,
+                  (unsigned long)result.iterations,
+                  (unsigned long)result.meanCycles,
+                  (unsigned long)result.minCycles,
+                  (unsigned long)result.meanMicros,
+                  (long)result.heapDelta,
+                  result.iterations > 0 ? (double)result.allocations / result.iterations : 0.0,
+                  (unsigned long)result.peakStack);
+}
+
+void Benchmarks::runFromHex(void *context)
+{
+    benchSink += RGBColor::fromHex("#3A7BD5").g;
+}
+
+void Benchmarks::runHexToColor(void *context)
+{
+    static const String hex = "#3A7BD5";
+    benchSink += LightControllerUtils::hexToColor(hex).g;
+}
+
+void Benchmarks::runRgbToHsb(void *context)
+{
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+    NanoleafController *controller = static_cast<NanoleafController *>(context);
+    benchSink += controller->rgbToHsb(RGBColor(58, 123, 213)).h;
+#endif
+}
+
+void Benchmarks::runHsv2Rgb(void *context)
+{
+    benchSink += LightControllerUtils::hsv2rgb(215.0f, 0.73f, 0.84f).b;
+}
+
+void Benchmarks::runColorMathRgbToHsb(void *context)
+{
+    benchSink += ColorMath::rgbToHsb(RGBColor(58, 123, 213)).h;
+}
+
+void Benchmarks::runColorMathHsvToRgb(void *context)
+{
+    benchSink += ColorMath::hsvToRgb(215, 186, 214).b;
+}
+
+void Benchmarks::runBlendBatch(void *context)
+{
+    ColorMath::blend(batchFrom, batchTo, batchOut, 50, 100);
+    benchSink += batchOut[0].r;
+}
+
+void Benchmarks::runGammaBatch(void *context)
+{
+    ColorMath::gamma(batchTo, batchOut, 50);
+    benchSink += batchOut[0].r;
+}
+
+void Benchmarks::setupStaticColorData(void *context)
+{
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+    StaticDataContext *staticContext = static_cast<StaticDataContext *>(context);
+    NanoleafController *controller = staticContext->controller;
+
+    // Synthetic layout: panels on a 5-wide grid, 100 units apart
+    controller->panelCount = staticContext->panelCount;
+    for (int i = 0; i < controller->panelCount; i++)
+    {
+        controller->panels[i].panelId = 1000 + i;
+        controller->panels[i].x = (i % 5) * 100;
+        controller->panels[i].y = (i / 5) * 100;
+        controller->panels[i].o = 0;
+        controller->panels[i].shapeType = 7;
+    }
+    controller->buildSpatialMap();
+#endif
+}
+
+void Benchmarks::runStaticColorData(void *context)
+{
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+    StaticDataContext *staticContext = static_cast<StaticDataContext *>(context);
+    benchSink += staticContext->controller->createStaticColorData(staticContext->palette);
+#endif
+}
+
+void Benchmarks::runSetStaticColors(void *context)
+{
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+    // The whole setStaticColors path on a cache miss - the controller has no
+    // host, so the HTTP client gives up before anything goes on the wire
+    StaticDataContext *staticContext = static_cast<StaticDataContext *>(context);
+    staticContext->controller->payloadCache.clear();
+    benchSink += staticContext->controller->setStaticColors(staticContext->palette);
+#endif
+}
+
+void Benchmarks::runPaletteParse(void *context)
+{
+    // Same work as WSClient: parse the frame, then decode each color in place
+    JsonDocument doc;
+    if (deserializeJson(doc, SAMPLE_PALETTE_JSON))
+    {
+        return;
+    }
+
+    ColorPalette palette;
+    JsonArray colors = doc["colors"];
+    palette.colorCount = min((int)colors.size(), MAX_COLORS);
+    for (int i = 0; i < palette.colorCount; i++)
+    {
+        palette.colors[i] = RGBColor::fromHex(colors[i]["hex"] | "#000000");
+    }
+    benchSink += palette.colorCount;
+}
+
+void Benchmarks::runPreferencesLoad(void *context)
+{
+    // The boot-time read: open the namespace and fetch the config blob
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_STORE_NAMESPACE, true))
+    {
+        return;
+    }
+
+    // Room for the blob header in front of the config
+    uint8_t blob[sizeof(StoredConfig) + 16];
+    benchSink += prefs.getBytes(CONFIG_STORE_KEY, blob, sizeof(blob));
+    prefs.end();
+}
+
+void Benchmarks::runPreferencesSave(void *context)
+{
+    // A changed blob each time, so every iteration really writes
+    static StoredConfig config;
+    config.lightingPort++;
+
+    Preferences prefs;
+    if (!prefs.begin(BENCH_PREF_NAMESPACE, false))
+    {
+        return;
+    }
+
+    benchSink += prefs.putBytes("config", &config, sizeof(config));
+    prefs.end();
+}
+
+#endif // PALPALETTE_BENCHMARKS
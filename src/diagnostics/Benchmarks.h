@@ -0,0 +1,73 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#ifdef PALPALETTE_BENCHMARKS
+
+#include <Arduino.h>
+#include "../config.h"
+
+/**
+ * On-device microbenchmarks (bench build only: -DPALPALETTE_BENCHMARKS)
+ *
+ * Each case runs on a fresh FreeRTOS task so its peak stack use can be read
+ * from the task's high-water mark. Per case it reports CPU cycles per
+ * operation (mean and best), wall time per operation, the free-heap change
+ * across the run, heap allocations per operation (malloc/calloc/realloc
+ * calls from the case's task, counted through linker wraps) and the peak
+ * stack. No network access is needed; the Preferences cases use a scratch
+ * namespace.
+ */
+class Benchmarks
+{
+public:
+    /**
+     * Run every case and print a results table to Serial
+     */
+    static void runAll();
+
+private:
+    struct Result
+    {
+        uint32_t iterations;
+        uint32_t meanCycles;
+        uint32_t minCycles;
+        uint32_t meanMicros;
+        int32_t heapDelta;
+        uint32_t allocations;
+        uint32_t peakStack;
+    };
+
+    struct Case
+    {
+        const char *name;
+        void (*setup)(void *context);
+        void (*run)(void *context);
+        void *context;
+        uint32_t iterations;
+        Result result;
+    };
+
+    static void runCase(Case &benchCase);
+    static void taskEntry(void *parameter);
+    static void printResult(const Case &benchCase);
+
+    // Case bodies
+    static void runFromHex(void *context);
+    static void runHexToColor(void *context);
+    static void runRgbToHsb(void *context);
+    static void runHsv2Rgb(void *context);
+    static void runColorMathRgbToHsb(void *context);
+    static void runColorMathHsvToRgb(void *context);
+    static void runBlendBatch(void *context);
+    static void runGammaBatch(void *context);
+    static void setupStaticColorData(void *context);
+    static void runStaticColorData(void *context);
+    static void runSetStaticColors(void *context);
+    static void runPaletteParse(void *context);
+    static void runPreferencesLoad(void *context);
+    static void runPreferencesSave(void *context);
+};
+
+#endif // PALPALETTE_BENCHMARKS
+
+#endif // BENCHMARKS_H
@@ -0,0 +1,269 @@
+#include "AnimationEngine.h"
+#include "ColorMath.h"
+#include "../core/Log.h"
+
+static const char *const LOG_TAG = "anim";
+
+// Lowest brightness reached by the pulse effect (0-255)
+static const uint8_t PULSE_MIN_LEVEL = 48;
+
+AnimationEngine::AnimationEngine()
+    : controller(nullptr), effect(EFFECT_STATIC), running(false), hasFrame(false),
+      pixelCount(0), startTime(0), lastFrameTime(0), frameInterval(ANIMATION_FRAME_INTERVAL)
+{
+}
+
+AnimationEngine::Effect AnimationEngine::effectFromName(const char *name)
+{
+    if (strcmp(name, "fade") == 0)
+        return EFFECT_FADE;
+    if (strcmp(name, "pulse") == 0)
+        return EFFECT_PULSE;
+    if (strcmp(name, "wheel") == 0)
+        return EFFECT_WHEEL;
+    if (strcmp(name, "flow") == 0)
+        return EFFECT_FLOW;
+
+    return EFFECT_STATIC;
+}
+
+const char *AnimationEngine::effectToName(Effect effect)
+{
+    switch (effect)
+    {
+    case EFFECT_FADE:
+        return "fade";
+    case EFFECT_PULSE:
+        return "pulse";
+    case EFFECT_WHEEL:
+        return "wheel";
+    case EFFECT_FLOW:
+        return "flow";
+    default:
+        return "static";
+    }
+}
+
+bool AnimationEngine::start(const ColorPalette &palette, LightController *controller)
+{
+    if (!controller || palette.colorCount <= 0)
+    {
+        return false;
+    }
+
+    int count = min(controller->getPixelCount(), ANIMATION_MAX_PIXELS);
+    if (count <= 0 || !controller->beginStreaming())
+    {
+        return false;
+    }
+
+    // A different target invalidates what we think the lights are showing
+    if (controller != this->controller || count != pixelCount)
+    {
+        hasFrame = false;
+    }
+
+    this->controller = controller;
+    this->palette = palette;
+    this->palette.colorCount = min(palette.colorCount, MAX_COLORS);
+    pixelCount = count;
+    effect = effectFromName(palette.animation.c_str());
+    frameInterval = controller->getFrameInterval() > 0 ? controller->getFrameInterval() : ANIMATION_FRAME_INTERVAL;
+
+    // Fade starts from whatever is currently displayed (black if unknown)
+    for (int i = 0; i < pixelCount; i++)
+    {
+        fadeFrom[i] = hasFrame ? currentFrame[i] : RGBColor();
+    }
+
+    // Lay the palette out along the controller's physical layout when it has one
+    const uint16_t *positions = controller->getPixelPositions();
+    if (positions)
+    {
+        SpatialMap::fillGradient(positions, pixelCount, this->palette, targetFrame);
+        for (int i = 0; i < pixelCount; i++)
+        {
+            pixelOrder[i] = ((uint32_t)positions[i] * (pixelCount - 1) + 32767) / 65535;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < pixelCount; i++)
+        {
+            targetFrame[i] = this->palette.colors[i % this->palette.colorCount];
+            pixelOrder[i] = i;
+        }
+    }
+
+    running = true;
+    startTime = millis();
+    lastFrameTime = startTime;
+
+    LOG_I("🎬 Animation started: %s on %d pixels", effectToName(effect), pixelCount);
+    return renderFrame(startTime);
+}
+
+void AnimationEngine::stop()
+{
+    running = false;
+}
+
+void AnimationEngine::reset()
+{
+    running = false;
+    hasFrame = false;
+    controller = nullptr;
+    pixelCount = 0;
+}
+
+void AnimationEngine::loop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    unsigned long now = millis();
+    if (now - lastFrameTime < frameInterval)
+    {
+        return;
+    }
+
+    // Keep a fixed cadence but never try to catch up on missed frames
+    lastFrameTime += frameInterval;
+    if (now - lastFrameTime >= frameInterval)
+    {
+        lastFrameTime = now;
+    }
+
+    renderFrame(now);
+}
+
+bool AnimationEngine::renderFrame(unsigned long now)
+{
+    unsigned long elapsed = now - startTime;
+    computeFrame(elapsed);
+
+    int transitionTime = 1; // Let the device smooth between ticks
+    if (effect == EFFECT_STATIC)
+    {
+        transitionTime = ANIMATION_STATIC_TRANSITION;
+    }
+    else if (effect == EFFECT_WHEEL)
+    {
+        transitionTime = ANIMATION_WHEEL_STEP / 200; // Half a step
+    }
+
+    if (!pushChangedPixels(transitionTime))
+    {
+        LOG_E("❌ Animation frame failed - stopping animation");
+        running = false;
+        hasFrame = false;
+        return false;
+    }
+
+    // One-shot effects are done once the final frame is out
+    if (effect == EFFECT_STATIC || (effect == EFFECT_FADE && elapsed >= ANIMATION_FADE_DURATION))
+    {
+        running = false;
+    }
+
+    return true;
+}
+
+void AnimationEngine::computeFrame(unsigned long elapsed)
+{
+    int colorCount = palette.colorCount;
+
+    switch (effect)
+    {
+    case EFFECT_FADE:
+    {
+        uint8_t amount = elapsed >= ANIMATION_FADE_DURATION ? 255 : (elapsed * 255) / ANIMATION_FADE_DURATION;
+        ColorMath::blend(fadeFrom, targetFrame, nextFrame, pixelCount, amount);
+        break;
+    }
+
+    case EFFECT_PULSE:
+    {
+        // Triangle wave starting at full brightness: 255 -> 0 -> 255
+        uint32_t phase = ((elapsed % ANIMATION_PULSE_PERIOD) * 512) / ANIMATION_PULSE_PERIOD;
+        uint8_t wave = phase < 256 ? 255 - phase : phase - 256;
+        uint8_t level = PULSE_MIN_LEVEL + (((255 - PULSE_MIN_LEVEL) * wave) >> 8);
+        ColorMath::scale(targetFrame, nextFrame, pixelCount, level);
+        break;
+    }
+
+    case EFFECT_WHEEL:
+    {
+        // Rotate the palette one panel per step, in spatial order
+        uint32_t step = elapsed / ANIMATION_WHEEL_STEP;
+        for (int i = 0; i < pixelCount; i++)
+        {
+            nextFrame[i] = palette.colors[(pixelOrder[i] + step) % colorCount];
+        }
+        break;
+    }
+
+    case EFFECT_FLOW:
+    {
+        // Spread the whole palette across the panels and let it drift (8.8 fixed point)
+        uint32_t cycle = (uint32_t)ANIMATION_FLOW_PERIOD * colorCount;
+        uint32_t offset = ((elapsed % cycle) * 256) / ANIMATION_FLOW_PERIOD;
+        uint32_t spacing = ((uint32_t)colorCount * 256) / pixelCount;
+
+        for (int i = 0; i < pixelCount; i++)
+        {
+            nextFrame[i] = paletteColorAt(offset + pixelOrder[i] * spacing);
+        }
+        break;
+    }
+
+    case EFFECT_STATIC:
+    default:
+        for (int i = 0; i < pixelCount; i++)
+        {
+            nextFrame[i] = targetFrame[i];
+        }
+        break;
+    }
+}
+
+bool AnimationEngine::pushChangedPixels(int transitionTime)
+{
+    int changed = 0;
+    for (int i = 0; i < pixelCount; i++)
+    {
+        if (!hasFrame || nextFrame[i] != currentFrame[i])
+        {
+            changedIndices[changed] = i;
+            changedColors[changed] = nextFrame[i];
+            changed++;
+        }
+    }
+
+    if (changed == 0)
+    {
+        return true; // Nothing to send this tick
+    }
+
+    if (!controller->streamPixels(changedIndices, changedColors, changed, transitionTime))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < changed; i++)
+    {
+        currentFrame[changedIndices[i]] = changedColors[i];
+    }
+    hasFrame = true;
+
+    return true;
+}
+
+RGBColor AnimationEngine::paletteColorAt(uint32_t position) const
+{
+    int index = (position >> 8) % palette.colorCount;
+    int next = (index + 1) % palette.colorCount;
+    return ColorMath::blend(palette.colors[index], palette.colors[next], position & 0xFF);
+}
@@ -0,0 +1,90 @@
+#ifndef ANIMATION_ENGINE_H
+#define ANIMATION_ENGINE_H
+
+#include "LightController.h"
+#include "SpatialMap.h"
+#include "../config.h"
+
+/**
+ * Animation Engine
+ * Frame scheduler owned by LightManager that renders palette effects
+ * (fade, pulse, wheel, flow) on the device itself. Frames are computed
+ * with fixed-point math on a fixed tick and only the pixels that changed
+ * since the previous frame are pushed to the controller, so a frame
+ * costs a single non-blocking streamPixels() call.
+ */
+class AnimationEngine
+{
+public:
+    enum Effect
+    {
+        EFFECT_STATIC,
+        EFFECT_FADE,
+        EFFECT_PULSE,
+        EFFECT_WHEEL,
+        EFFECT_FLOW
+    };
+
+    AnimationEngine();
+
+    /**
+     * Start rendering a palette on a streaming-capable controller
+     * The first frame is sent immediately
+     * @param palette Palette to animate (palette.animation selects the effect)
+     * @param controller Target controller
+     * @return false if the controller cannot stream per-pixel frames
+     */
+    bool start(const ColorPalette &palette, LightController *controller);
+
+    /**
+     * Stop the running effect, keeping the last frame on the lights
+     */
+    void stop();
+
+    /**
+     * Forget the last frame (lights were turned off or the controller changed)
+     */
+    void reset();
+
+    /**
+     * Render the next frame if the tick is due - never blocks
+     */
+    void loop();
+
+    bool isRunning() const { return running; }
+
+    /**
+     * Tick of the running animation (the controller's own, or ANIMATION_FRAME_INTERVAL)
+     */
+    unsigned long getFrameInterval() const { return frameInterval; }
+    Effect getEffect() const { return effect; }
+
+    static Effect effectFromName(const char *name);
+    static const char *effectToName(Effect effect);
+
+private:
+    LightController *controller;
+    ColorPalette palette;
+    Effect effect;
+    bool running;
+    bool hasFrame; // currentFrame reflects what the lights are showing
+    int pixelCount;
+    unsigned long startTime;
+    unsigned long lastFrameTime;
+    unsigned long frameInterval;
+
+    RGBColor currentFrame[ANIMATION_MAX_PIXELS];
+    RGBColor fadeFrom[ANIMATION_MAX_PIXELS];
+    RGBColor targetFrame[ANIMATION_MAX_PIXELS]; // Palette laid out across the pixels, computed once per start()
+    uint8_t pixelOrder[ANIMATION_MAX_PIXELS];   // Spatial rank of each pixel (index order without a layout)
+    RGBColor nextFrame[ANIMATION_MAX_PIXELS];
+    int changedIndices[ANIMATION_MAX_PIXELS];
+    RGBColor changedColors[ANIMATION_MAX_PIXELS];
+
+    bool renderFrame(unsigned long now);
+    void computeFrame(unsigned long elapsed);
+    bool pushChangedPixels(int transitionTime);
+    RGBColor paletteColorAt(uint32_t position) const;
+};
+
+#endif // ANIMATION_ENGINE_H
@@ -0,0 +1,265 @@
+#ifndef COLOR_MATH_H
+#define COLOR_MATH_H
+
+#include "LightController.h"
+
+/**
+ * Color Math
+ * Integer color kernels for the per-frame paths. The ESP32-C3 has no FPU,
+ * so every float operation is a software routine; these use only integer
+ * multiplies, shifts and compile-time tables instead. Each kernel matches
+ * the float function it replaces within +/-1 LSB, and each has a batch form
+ * that transforms a whole pixel array in one call.
+ *
+ * Tables (generated by constexpr functions, stored once in flash):
+ * - reciprocals: ceil(2^32 / d), turning division by d < 256 into a multiply
+ * - gamma: 8-bit gamma 2.2 correction
+ */
+namespace ColorMath
+{
+    // Hue/saturation/brightness on the Nanoleaf scale (h 0-359, s and b 0-100)
+    struct HSB
+    {
+        uint16_t h;
+        uint8_t s;
+        uint8_t b;
+    };
+
+    namespace detail
+    {
+        template <typename T, size_t N>
+        struct Table
+        {
+            T values[N];
+            constexpr const T &operator[](size_t index) const { return values[index]; }
+        };
+
+        constexpr Table<uint32_t, 256> makeReciprocals()
+        {
+            Table<uint32_t, 256> table{};
+            for (uint32_t d = 2; d < 256; d++)
+            {
+                table.values[d] = (uint32_t)((0x100000000ULL + d - 1) / d);
+            }
+            return table;
+        }
+
+        // x^0.2 by Newton iteration (x in [0, 1]) - constexpr has no pow()
+        constexpr double fifthRoot(double x)
+        {
+            double y = 1.0;
+            for (int i = 0; i < 40 && x > 0.0; i++)
+            {
+                double y4 = y * y * y * y;
+                y = (4.0 * y + x / y4) / 5.0;
+            }
+            return x > 0.0 ? y : 0.0;
+        }
+
+        constexpr Table<uint8_t, 256> makeGamma()
+        {
+            Table<uint8_t, 256> table{};
+            for (int i = 0; i < 256; i++)
+            {
+                double x = i / 255.0;
+                table.values[i] = (uint8_t)(x * x * fifthRoot(x) * 255.0 + 0.5); // x^2.2
+            }
+            return table;
+        }
+    }
+
+    inline constexpr detail::Table<uint32_t, 256> kReciprocal = detail::makeReciprocals();
+
+    // Hue fixed point: 1/256 degree, so animated hues do not step in whole degrees
+    inline constexpr uint32_t kHueScale = 256;
+    inline constexpr uint32_t kHueSectorSize = 60 * kHueScale;
+    inline constexpr uint32_t kHueFull = 360 * kHueScale;
+    inline constexpr detail::Table<uint8_t, 256> kGamma = detail::makeGamma();
+
+    /**
+     * Exact floor(n / d) for 1 <= d <= 255 and n < 2^24, without a divide
+     */
+    inline uint32_t divide(uint32_t n, uint8_t d)
+    {
+        return d == 1 ? n : (uint32_t)(((uint64_t)n * kReciprocal[d]) >> 32);
+    }
+
+    /**
+     * HSV to RGB with sub-degree hue (matches LightControllerUtils' float formula within 1 LSB)
+     * @param hue Hue in 1/kHueScale degree (0 to kHueFull - 1, larger values wrap)
+     * @param s Saturation (0-255)
+     * @param v Value (0-255)
+     */
+    inline RGBColor hsvToRgbFine(uint32_t hue, uint8_t s, uint8_t v)
+    {
+        if (hue >= kHueFull)
+        {
+            hue %= kHueFull;
+        }
+
+        // 60 * (1 - |(h / 60) mod 2 - 1|) in hue units: how far the ramping channel has come
+        uint32_t t = hue % (2 * kHueSectorSize);
+        uint32_t ramp = kHueSectorSize - (t > kHueSectorSize ? t - kHueSectorSize : kHueSectorSize - t);
+
+        // Work in units of 1/65025 so each channel is a single divide by 255
+        uint32_t chroma = (uint32_t)v * s;
+        uint32_t offset = (uint32_t)v * 255 - chroma;
+        uint8_t high = divide(chroma + offset, 255);
+        uint8_t mid = divide(divide((chroma * ramp) / kHueScale, 60) + offset, 255);
+        uint8_t low = divide(offset, 255);
+
+        switch (hue / kHueSectorSize)
+        {
+        case 0:
+            return RGBColor(high, mid, low);
+        case 1:
+            return RGBColor(mid, high, low);
+        case 2:
+            return RGBColor(low, high, mid);
+        case 3:
+            return RGBColor(low, mid, high);
+        case 4:
+            return RGBColor(mid, low, high);
+        default:
+            return RGBColor(high, low, mid);
+        }
+    }
+
+    /**
+     * HSV to RGB for whole-degree hues
+     * @param h Hue in degrees (0-359, larger values wrap)
+     * @param s Saturation (0-255)
+     * @param v Value (0-255)
+     */
+    inline RGBColor hsvToRgb(uint16_t h, uint8_t s, uint8_t v)
+    {
+        return hsvToRgbFine((uint32_t)(h % 360) * kHueScale, s, v);
+    }
+
+    /**
+     * RGB to Nanoleaf HSB (matches the float conversion it replaced)
+     */
+    inline HSB rgbToHsb(const RGBColor &rgb)
+    {
+        uint8_t high = max(rgb.r, max(rgb.g, rgb.b));
+        uint8_t low = min(rgb.r, min(rgb.g, rgb.b));
+        uint8_t delta = high - low;
+
+        HSB hsb;
+        hsb.b = divide(high * 100, 255);
+        hsb.s = high == 0 ? 0 : divide(delta * 100, high);
+
+        if (delta == 0)
+        {
+            hsb.h = 0;
+            return hsb;
+        }
+
+        // Offsets keep every numerator positive, so the divide floors like the float cast did
+        int32_t numerator;
+        if (high == rgb.r)
+        {
+            numerator = 60 * (rgb.g - rgb.b) + (rgb.g < rgb.b ? 360 * delta : 0);
+        }
+        else if (high == rgb.g)
+        {
+            numerator = 60 * (rgb.b - rgb.r) + 120 * delta;
+        }
+        else
+        {
+            numerator = 60 * (rgb.r - rgb.g) + 240 * delta;
+        }
+
+        hsb.h = divide(numerator, delta);
+        if (hsb.h >= 360)
+        {
+            hsb.h -= 360;
+        }
+        return hsb;
+    }
+
+    /**
+     * Linear interpolation (matches LightControllerUtils::interpolateColor)
+     * @param factor Position between the colors, 0 = color1, 65535 = just short of color2
+     */
+    inline RGBColor interpolate(const RGBColor &color1, const RGBColor &color2, uint16_t factor)
+    {
+        // Arithmetic shift floors negative steps, as the float-to-int truncation of c1 + step did
+        return RGBColor(color1.r + (((color2.r - color1.r) * (int32_t)factor) >> 16),
+                        color1.g + (((color2.g - color1.g) * (int32_t)factor) >> 16),
+                        color1.b + (((color2.b - color1.b) * (int32_t)factor) >> 16));
+    }
+
+    /**
+     * Blend using 8-bit fixed point (0 = color1, 255 = color2; both endpoints exact)
+     */
+    inline RGBColor blend(const RGBColor &color1, const RGBColor &color2, uint8_t amount)
+    {
+        uint16_t weight = amount + (amount >> 7);
+        uint16_t inverse = 256 - weight;
+        return RGBColor((color1.r * inverse + color2.r * weight) >> 8,
+                        (color1.g * inverse + color2.g * weight) >> 8,
+                        (color1.b * inverse + color2.b * weight) >> 8);
+    }
+
+    /**
+     * Scale by 8-bit level (0 = off, 255 = unchanged)
+     */
+    inline RGBColor scale(const RGBColor &color, uint8_t level)
+    {
+        uint16_t factor = level + 1;
+        return RGBColor((color.r * factor) >> 8, (color.g * factor) >> 8, (color.b * factor) >> 8);
+    }
+
+    /**
+     * Scale by 16-bit level (matches LightControllerUtils::adjustBrightness)
+     * @param level Brightness, 0 = off, 65535 = just below unchanged
+     */
+    inline RGBColor scale16(const RGBColor &color, uint16_t level)
+    {
+        return RGBColor((color.r * (uint32_t)level) >> 16,
+                        (color.g * (uint32_t)level) >> 16,
+                        (color.b * (uint32_t)level) >> 16);
+    }
+
+    inline RGBColor gamma(const RGBColor &color)
+    {
+        return RGBColor(kGamma[color.r], kGamma[color.g], kGamma[color.b]);
+    }
+
+    // Batch forms - one call per frame instead of one per pixel; out may alias the input
+
+    inline void blend(const RGBColor *from, const RGBColor *to, RGBColor *out, int count, uint8_t amount)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            out[i] = blend(from[i], to[i], amount);
+        }
+    }
+
+    inline void scale(const RGBColor *in, RGBColor *out, int count, uint8_t level)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            out[i] = scale(in[i], level);
+        }
+    }
+
+    inline void gamma(const RGBColor *in, RGBColor *out, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            out[i] = gamma(in[i]);
+        }
+    }
+
+    inline void rgbToHsb(const RGBColor *in, HSB *out, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            out[i] = rgbToHsb(in[i]);
+        }
+    }
+}
+
+#endif // COLOR_MATH_H
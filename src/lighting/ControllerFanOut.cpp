@@ -0,0 +1,210 @@
+#include "ControllerFanOut.h"
+#include <esp_timer.h>
+#include "../core/Log.h"
+#include "../core/MemoryTelemetry.h"
+
+static const char *const LOG_TAG = "fanout";
+
+ControllerFanOut::ControllerFanOut()
+    : currentJob(nullptr)
+{
+    for (int i = 0; i < LIGHT_MAX_CONTROLLERS; i++)
+    {
+        workers[i] = {this, i, nullptr};
+    }
+    memset(results, 0, sizeof(results));
+    memset(durations, 0, sizeof(durations));
+    memset(stats, 0, sizeof(stats));
+
+    slotDone = xSemaphoreCreateCounting(LIGHT_MAX_CONTROLLERS, 0);
+}
+
+ControllerFanOut::~ControllerFanOut()
+{
+    for (Worker &worker : workers)
+    {
+        if (worker.handle)
+        {
+            MemoryTelemetry::getInstance()->unwatchTask(worker.handle);
+            vTaskDelete(worker.handle);
+            worker.handle = nullptr;
+        }
+    }
+
+    if (slotDone)
+    {
+        vSemaphoreDelete(slotDone);
+    }
+}
+
+ControllerFanOut::Result ControllerFanOut::run(uint8_t slotMask, const std::function<bool(int)> &job)
+{
+    Result result = {0, 0, 0, 0, -1};
+    int64_t startTime = esp_timer_get_time();
+    currentJob = &job;
+
+    int inlineSlot = -1;
+    uint8_t serialMask = 0;
+    int dispatched = 0;
+
+    for (int slot = 0; slot < LIGHT_MAX_CONTROLLERS; slot++)
+    {
+        if (!(slotMask & (1 << slot)))
+        {
+            continue;
+        }
+
+        result.attempted++;
+        if (inlineSlot < 0)
+        {
+            inlineSlot = slot;
+        }
+        else if (slotDone && ensureWorker(slot))
+        {
+            xTaskNotifyGive(workers[slot].handle);
+            dispatched++;
+        }
+        else
+        {
+            // No worker task available - still correct, just not concurrent
+            serialMask |= 1 << slot;
+        }
+    }
+
+    if (inlineSlot >= 0)
+    {
+        execute(inlineSlot);
+    }
+
+    for (int slot = 0; slot < LIGHT_MAX_CONTROLLERS; slot++)
+    {
+        if (serialMask & (1 << slot))
+        {
+            execute(slot);
+        }
+    }
+
+    for (int i = 0; i < dispatched; i++)
+    {
+        xSemaphoreTake(slotDone, portMAX_DELAY);
+    }
+    currentJob = nullptr;
+
+    for (int slot = 0; slot < LIGHT_MAX_CONTROLLERS; slot++)
+    {
+        if (!(slotMask & (1 << slot)))
+        {
+            continue;
+        }
+
+        if (results[slot])
+        {
+            result.succeeded++;
+        }
+
+        if (result.slowestSlot < 0 || durations[slot] > result.slowestMicros)
+        {
+            result.slowestMicros = durations[slot];
+            result.slowestSlot = slot;
+        }
+    }
+
+    result.elapsedMicros = esp_timer_get_time() - startTime;
+    return result;
+}
+
+ControllerFanOut::Stats ControllerFanOut::getStats(int slot)
+{
+    Stats snapshot = {};
+    if (slot < 0 || slot >= LIGHT_MAX_CONTROLLERS)
+    {
+        return snapshot;
+    }
+
+    portENTER_CRITICAL(&statsLock);
+    snapshot = stats[slot];
+    portEXIT_CRITICAL(&statsLock);
+    return snapshot;
+}
+
+void ControllerFanOut::resetStats(int slot)
+{
+    if (slot < 0 || slot >= LIGHT_MAX_CONTROLLERS)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&statsLock);
+    memset(&stats[slot], 0, sizeof(stats[slot]));
+    portEXIT_CRITICAL(&statsLock);
+}
+
+void ControllerFanOut::statsToJson(int slot, JsonObject out)
+{
+    Stats snapshot = getStats(slot);
+
+    out["calls"] = snapshot.calls;
+    out["failures"] = snapshot.failures;
+    out["lastUs"] = snapshot.lastMicros;
+    out["meanUs"] = snapshot.calls > 0 ? (uint32_t)(snapshot.totalMicros / snapshot.calls) : 0;
+    out["maxUs"] = snapshot.maxMicros;
+}
+
+bool ControllerFanOut::ensureWorker(int slot)
+{
+    Worker &worker = workers[slot];
+    if (worker.handle)
+    {
+        return true;
+    }
+
+    char name[16];
+    snprintf(name, sizeof(name), "fanout%d", slot);
+    if (xTaskCreate(workerEntry, name, LIGHT_FANOUT_TASK_STACK_SIZE, &worker,
+                    LIGHTING_TASK_PRIORITY, &worker.handle) != pdPASS)
+    {
+        LOG_W("⚠ Failed to start fan-out worker %d - running its controller serially", slot);
+        worker.handle = nullptr;
+        return false;
+    }
+
+    MemoryTelemetry::getInstance()->watchTask(worker.handle, LIGHT_FANOUT_TASK_STACK_SIZE);
+    return true;
+}
+
+void ControllerFanOut::execute(int slot)
+{
+    int64_t startTime = esp_timer_get_time();
+    bool success = (*currentJob)(slot);
+    uint32_t elapsed = esp_timer_get_time() - startTime;
+
+    results[slot] = success;
+    durations[slot] = elapsed;
+
+    portENTER_CRITICAL(&statsLock);
+    Stats &slotStats = stats[slot];
+    slotStats.calls++;
+    if (!success)
+    {
+        slotStats.failures++;
+    }
+    slotStats.lastMicros = elapsed;
+    slotStats.totalMicros += elapsed;
+    if (elapsed > slotStats.maxMicros)
+    {
+        slotStats.maxMicros = elapsed;
+    }
+    portEXIT_CRITICAL(&statsLock);
+}
+
+void ControllerFanOut::workerEntry(void *parameter)
+{
+    Worker *worker = static_cast<Worker *>(parameter);
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        worker->owner->execute(worker->slot);
+        xSemaphoreGive(worker->owner->slotDone);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef CONTROLLER_FAN_OUT_H
+#define CONTROLLER_FAN_OUT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "../config.h"
+
+/**
+ * Controller Fan-Out
+ * Runs one operation against several controller slots at the same time, so
+ * a palette reaches every lighting system in the time of the slowest one
+ * instead of the sum of all of them. The lowest selected slot runs on the
+ * calling task; each other slot has a long-lived worker task (created on
+ * first use) that is woken per call. run() returns once every slot is done.
+ *
+ * Each slot keeps lifetime latency and failure counters.
+ */
+class ControllerFanOut
+{
+public:
+    struct Result
+    {
+        uint8_t attempted;
+        uint8_t succeeded;
+        uint32_t elapsedMicros; // Wall time for the whole fan-out
+        uint32_t slowestMicros;
+        int8_t slowestSlot; // -1 if nothing ran
+    };
+
+    struct Stats
+    {
+        uint32_t calls;
+        uint32_t failures;
+        uint32_t lastMicros;
+        uint32_t maxMicros;
+        uint64_t totalMicros;
+    };
+
+    ControllerFanOut();
+    ~ControllerFanOut();
+
+    /**
+     * Run job(slot) for every slot in slotMask concurrently and wait for all of them
+     * @param slotMask Bit n selects slot n (0 to LIGHT_MAX_CONTROLLERS - 1)
+     * @param job Operation for one slot; true on success. Must not touch other slots.
+     */
+    Result run(uint8_t slotMask, const std::function<bool(int)> &job);
+
+    Stats getStats(int slot);
+    void resetStats(int slot);
+
+    /**
+     * Write one slot's counters ("calls", "failures", "lastUs", "meanUs", "maxUs")
+     */
+    void statsToJson(int slot, JsonObject out);
+
+private:
+    struct Worker
+    {
+        ControllerFanOut *owner;
+        int slot;
+        TaskHandle_t handle;
+    };
+
+    Worker workers[LIGHT_MAX_CONTROLLERS];
+    SemaphoreHandle_t slotDone; // Counting - one give per finished worker
+    const std::function<bool(int)> *currentJob;
+    bool results[LIGHT_MAX_CONTROLLERS];
+    uint32_t durations[LIGHT_MAX_CONTROLLERS];
+
+    portMUX_TYPE statsLock = portMUX_INITIALIZER_UNLOCKED;
+    Stats stats[LIGHT_MAX_CONTROLLERS];
+
+    bool ensureWorker(int slot);
+    void execute(int slot);
+    static void workerEntry(void *parameter);
+};
+
+#endif // CONTROLLER_FAN_OUT_H
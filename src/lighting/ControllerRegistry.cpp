@@ -0,0 +1,102 @@
+#include "ControllerRegistry.h"
+#include "controllers/NanoleafController.h"
+#include "controllers/WLEDController.h"
+#include "controllers/WS2812Controller.h"
+#include "../core/Log.h"
+
+static const char *const LOG_TAG = "registry";
+
+#if defined(PALPALETTE_DISABLE_NANOLEAF) && defined(PALPALETTE_DISABLE_WLED) && defined(PALPALETTE_DISABLE_WS2812)
+#error "At least one lighting backend must be built in"
+#endif
+
+template <typename Controller>
+static LightController *createController()
+{
+    return new Controller();
+}
+
+static constexpr ControllerRegistration REGISTRY[] = {
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+    {LIGHT_SYSTEM_NANOLEAF, "nanoleaf",
+     LIGHT_CAP_STREAMING | LIGHT_CAP_AUTHENTICATION | LIGHT_CAP_NETWORK | LIGHT_CAP_DISCOVERY,
+     16021, createController<NanoleafController>},
+#endif
+#ifndef PALPALETTE_DISABLE_WLED
+    {LIGHT_SYSTEM_WLED, "wled", LIGHT_CAP_STREAMING | LIGHT_CAP_NETWORK, 80, createController<WLEDController>},
+#endif
+#ifndef PALPALETTE_DISABLE_WS2812
+    {LIGHT_SYSTEM_WS2812, "ws2812", LIGHT_CAP_STREAMING, 0, createController<WS2812Controller>},
+#endif
+};
+
+static constexpr int REGISTRY_SIZE = sizeof(REGISTRY) / sizeof(REGISTRY[0]);
+
+LightSystemType ControllerRegistry::typeFromName(const char *name)
+{
+    if (name == nullptr)
+    {
+        return LIGHT_SYSTEM_NONE;
+    }
+
+    for (const ControllerRegistration &registration : REGISTRY)
+    {
+        if (strcasecmp(name, registration.tag) == 0)
+        {
+            return registration.type;
+        }
+    }
+    return LIGHT_SYSTEM_NONE;
+}
+
+const ControllerRegistration *ControllerRegistry::find(LightSystemType type)
+{
+    for (const ControllerRegistration &registration : REGISTRY)
+    {
+        if (registration.type == type)
+        {
+            return &registration;
+        }
+    }
+    return nullptr;
+}
+
+LightController *ControllerRegistry::create(LightSystemType type)
+{
+    const ControllerRegistration *registration = find(type);
+    if (!registration)
+    {
+        LOG_E("❌ Lighting system type %d is not built into this firmware", type);
+        return nullptr;
+    }
+
+    LOG_I("🏭 Creating %s controller", registration->tag);
+    LightController *controller = registration->create();
+    if (!controller)
+    {
+        LOG_E("❌ Failed to allocate %s controller - insufficient memory", registration->tag);
+    }
+    return controller;
+}
+
+bool ControllerRegistry::hasCapability(LightSystemType type, LightCapability capability)
+{
+    const ControllerRegistration *registration = find(type);
+    return registration && (registration->capabilities & capability);
+}
+
+uint16_t ControllerRegistry::defaultPort(LightSystemType type)
+{
+    const ControllerRegistration *registration = find(type);
+    return registration ? registration->defaultPort : 0;
+}
+
+int ControllerRegistry::count()
+{
+    return REGISTRY_SIZE;
+}
+
+const ControllerRegistration &ControllerRegistry::at(int index)
+{
+    return REGISTRY[constrain(index, 0, REGISTRY_SIZE - 1)];
+}
@@ -0,0 +1,84 @@
+#ifndef CONTROLLER_REGISTRY_H
+#define CONTROLLER_REGISTRY_H
+
+#include "LightController.h"
+#include "../config.h"
+
+/**
+ * Lighting backends known to the firmware
+ * Values are stable - they are only used in memory, never persisted
+ */
+enum LightSystemType : uint8_t
+{
+    LIGHT_SYSTEM_NONE,
+    LIGHT_SYSTEM_NANOLEAF,
+    LIGHT_SYSTEM_WLED,
+    LIGHT_SYSTEM_WS2812
+};
+
+/**
+ * Capability flags of a registered backend
+ */
+enum LightCapability : uint8_t
+{
+    LIGHT_CAP_STREAMING = 1 << 0,      // Per-pixel frames through the AnimationEngine
+    LIGHT_CAP_AUTHENTICATION = 1 << 1, // Needs pairing / an auth token
+    LIGHT_CAP_NETWORK = 1 << 2,        // Reached over the network (needs a host)
+    LIGHT_CAP_DISCOVERY = 1 << 3       // Can find its own host when none is configured
+};
+
+/**
+ * One backend: its type, wire/storage tag, capabilities and factory
+ */
+struct ControllerRegistration
+{
+    LightSystemType type;
+    const char *tag; // "nanoleaf", "wled", ... as used in configuration
+    uint8_t capabilities;
+    uint16_t defaultPort; // 0 = not network-attached
+    LightController *(*create)();
+};
+
+/**
+ * Controller Registry
+ * Compile-time table of the lighting backends built into this image. Each
+ * controller registers a ControllerRegistration in ControllerRegistry.cpp;
+ * backends disabled with -DPALPALETTE_DISABLE_<SYSTEM> (NANOLEAF, WLED,
+ * WS2812) are left out of the table and their translation units compile to
+ * nothing, so the image only carries the controllers it can create. The
+ * tag is matched once, when a configuration is applied - after that
+ * controllers are dispatched by LightSystemType.
+ */
+class ControllerRegistry
+{
+public:
+    /**
+     * Resolve a configuration tag (case-insensitive)
+     * @return LIGHT_SYSTEM_NONE if the backend is unknown or not built in
+     */
+    static LightSystemType typeFromName(const char *name);
+    static LightSystemType typeFromName(const String &name) { return typeFromName(name.c_str()); }
+
+    /**
+     * Registration for a type, or nullptr if it is not built in
+     */
+    static const ControllerRegistration *find(LightSystemType type);
+
+    /**
+     * Create a controller of the given type
+     * @return New controller (caller owns it), or nullptr if unavailable
+     */
+    static LightController *create(LightSystemType type);
+
+    static bool isSupported(const String &name) { return typeFromName(name) != LIGHT_SYSTEM_NONE; }
+    static bool hasCapability(LightSystemType type, LightCapability capability);
+    static uint16_t defaultPort(LightSystemType type);
+
+    /**
+     * Built-in backends, in registration order
+     */
+    static int count();
+    static const ControllerRegistration &at(int index);
+};
+
+#endif // CONTROLLER_REGISTRY_H
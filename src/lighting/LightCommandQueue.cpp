@@ -0,0 +1,173 @@
+#include "LightCommandQueue.h"
+
+LightCommandQueue::LightCommandQueue()
+    : wakeSignal(nullptr), nextSequence(0), paletteSequence(0), hasPendingPalette(false),
+      pendingBrightness(0), brightnessSequence(0), hasPendingBrightness(false), pendingRequests(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+LightCommandQueue::~LightCommandQueue()
+{
+    if (wakeSignal)
+    {
+        vSemaphoreDelete(wakeSignal);
+        wakeSignal = nullptr;
+    }
+}
+
+bool LightCommandQueue::begin()
+{
+    if (!wakeSignal)
+    {
+        wakeSignal = xSemaphoreCreateBinary();
+    }
+
+    return wakeSignal != nullptr;
+}
+
+bool LightCommandQueue::submitPalette(const ColorPalette &palette)
+{
+    if (!wakeSignal || palette.colorCount <= 0)
+    {
+        portENTER_CRITICAL(&lock);
+        stats.dropped++;
+        portEXIT_CRITICAL(&lock);
+        return false;
+    }
+
+    portENTER_CRITICAL(&lock);
+    if (hasPendingPalette)
+    {
+        stats.coalesced++;
+    }
+    pendingPalette = palette;
+    paletteSequence = nextSequence++;
+    hasPendingPalette = true;
+    stats.submitted++;
+    portEXIT_CRITICAL(&lock);
+
+    xSemaphoreGive(wakeSignal);
+    return true;
+}
+
+bool LightCommandQueue::submitBrightness(int brightness)
+{
+    if (!wakeSignal)
+    {
+        portENTER_CRITICAL(&lock);
+        stats.dropped++;
+        portEXIT_CRITICAL(&lock);
+        return false;
+    }
+
+    portENTER_CRITICAL(&lock);
+    if (hasPendingBrightness)
+    {
+        stats.coalesced++;
+    }
+    pendingBrightness = constrain(brightness, 0, 100);
+    brightnessSequence = nextSequence++;
+    hasPendingBrightness = true;
+    stats.submitted++;
+    portEXIT_CRITICAL(&lock);
+
+    xSemaphoreGive(wakeSignal);
+    return true;
+}
+
+bool LightCommandQueue::submitRequests(uint8_t requests)
+{
+    if (!wakeSignal || requests == 0)
+    {
+        portENTER_CRITICAL(&lock);
+        stats.dropped++;
+        portEXIT_CRITICAL(&lock);
+        return false;
+    }
+
+    portENTER_CRITICAL(&lock);
+    if (pendingRequests & requests)
+    {
+        stats.coalesced++;
+    }
+    pendingRequests |= requests;
+    stats.submitted++;
+    portEXIT_CRITICAL(&lock);
+
+    xSemaphoreGive(wakeSignal);
+    return true;
+}
+
+bool LightCommandQueue::waitForCommand(TickType_t timeout)
+{
+    if (!wakeSignal)
+    {
+        vTaskDelay(timeout == portMAX_DELAY ? pdMS_TO_TICKS(1000) : timeout);
+        return false;
+    }
+
+    return xSemaphoreTake(wakeSignal, timeout) == pdTRUE;
+}
+
+bool LightCommandQueue::takePalette(ColorPalette &palette, uint32_t &sequence)
+{
+    bool taken = false;
+
+    portENTER_CRITICAL(&lock);
+    if (hasPendingPalette)
+    {
+        palette = pendingPalette;
+        sequence = paletteSequence;
+        hasPendingPalette = false;
+        stats.delivered++;
+        taken = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    return taken;
+}
+
+bool LightCommandQueue::takeBrightness(int &brightness, uint32_t &sequence)
+{
+    bool taken = false;
+
+    portENTER_CRITICAL(&lock);
+    if (hasPendingBrightness)
+    {
+        brightness = pendingBrightness;
+        sequence = brightnessSequence;
+        hasPendingBrightness = false;
+        stats.delivered++;
+        taken = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    return taken;
+}
+
+bool LightCommandQueue::takeRequests(uint8_t &requests)
+{
+    bool taken = false;
+
+    portENTER_CRITICAL(&lock);
+    if (pendingRequests != 0)
+    {
+        requests = pendingRequests;
+        pendingRequests = 0;
+        stats.delivered++;
+        taken = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    return taken;
+}
+
+LightCommandQueue::Stats LightCommandQueue::getStats() const
+{
+    portENTER_CRITICAL(&lock);
+    Stats snapshot = stats;
+    portEXIT_CRITICAL(&lock);
+
+    return snapshot;
+}
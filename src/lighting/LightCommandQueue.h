@@ -0,0 +1,94 @@
+#ifndef LIGHT_COMMAND_QUEUE_H
+#define LIGHT_COMMAND_QUEUE_H
+
+#include "LightController.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * Latest-wins command mailbox between the network side and the lighting task
+ *
+ * Holds at most one pending palette, one pending brightness value and a
+ * set of pending requests (LightManager::Request bits - configuration
+ * work that must not run on the network task). Submitting while a
+ * command of the same kind is still pending replaces it, so a burst of palettes (group sends, replays after a reconnect)
+ * costs one render of the newest state instead of one per message.
+ * ColorPalette is plain fixed-size data, so it is copied in and out of
+ * the mailbox as-is.
+ */
+class LightCommandQueue
+{
+public:
+    struct Stats
+    {
+        uint32_t submitted; // Commands accepted from producers
+        uint32_t coalesced; // Pending commands replaced by a newer one before delivery
+        uint32_t dropped;   // Commands rejected (queue not started or empty palette)
+        uint32_t delivered; // Commands handed to the lighting task
+    };
+
+    LightCommandQueue();
+    ~LightCommandQueue();
+
+    /**
+     * Allocate the wake-up semaphore
+     * @return true if the queue can accept commands
+     */
+    bool begin();
+
+    bool submitPalette(const ColorPalette &palette);
+    bool submitBrightness(int brightness);
+
+    /**
+     * Add requests to the pending set (a request already pending is coalesced)
+     * @param requests LightManager::Request bits
+     */
+    bool submitRequests(uint8_t requests);
+
+    /**
+     * Block until a command is pending or the timeout expires
+     * @return true if a command may be pending
+     */
+    bool waitForCommand(TickType_t timeout);
+
+    /**
+     * Take the pending palette, if any (consumer side)
+     * @param sequence Set to the submission order of the palette
+     */
+    bool takePalette(ColorPalette &palette, uint32_t &sequence);
+
+    /**
+     * Take the pending brightness, if any (consumer side)
+     * @param sequence Set to the submission order of the brightness value
+     */
+    bool takeBrightness(int &brightness, uint32_t &sequence);
+
+    /**
+     * Whether command a was submitted before command b (wrap-safe)
+     */
+    static bool before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+    /**
+     * Take all pending requests, if any (consumer side)
+     */
+    bool takeRequests(uint8_t &requests);
+
+    Stats getStats() const;
+
+private:
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    SemaphoreHandle_t wakeSignal;
+
+    uint32_t nextSequence; // Stamped on every accepted palette/brightness command
+    ColorPalette pendingPalette;
+    uint32_t paletteSequence;
+    bool hasPendingPalette;
+    int pendingBrightness;
+    uint32_t brightnessSequence;
+    bool hasPendingBrightness;
+    uint8_t pendingRequests;
+
+    Stats stats;
+};
+
+#endif // LIGHT_COMMAND_QUEUE_H
@@ -1,55 +1,5 @@
 #include "LightController.h"
-#include "controllers/NanoleafController.h"
-
-// Static array of supported systems
-static String supportedSystems[] = {
-    "nanoleaf"};
-
-static const int SUPPORTED_SYSTEM_COUNT = sizeof(supportedSystems) / sizeof(supportedSystems[0]);
-
-// Factory implementation
-LightController *LightControllerFactory::createController(const String &systemType)
-{
-    String type = systemType;
-    type.toLowerCase();
-
-    Serial.println("🏭 Creating controller for system: " + type);
-
-    if (type == "nanoleaf")
-    {
-        Serial.println("🍃 Creating Nanoleaf controller");
-        NanoleafController *controller = new NanoleafController();
-        if (!controller)
-        {
-            Serial.println("❌ Failed to allocate NanoleafController - insufficient memory");
-            return nullptr;
-        }
-        return controller;
-    }
-    else
-    {
-        Serial.println("❌ Unknown system type: " + type + " (only 'nanoleaf' is supported)");
-        return nullptr;
-    }
-}
-
-String *LightControllerFactory::getSupportedSystems()
-{
-    return supportedSystems;
-}
-
-int LightControllerFactory::getSupportedSystemCount()
-{
-    return SUPPORTED_SYSTEM_COUNT;
-}
-
-bool LightControllerFactory::isSystemSupported(const String &systemType)
-{
-    String type = systemType;
-    type.toLowerCase();
-
-    return (type == "nanoleaf" || type == "wled" || type == "ws2812");
-}
+#include "ColorMath.h"
 
 // Utility functions for color conversion
 uint32_t LightControllerUtils::rgbToUint32(const RGBColor &color)
@@ -73,80 +23,40 @@ RGBColor LightControllerUtils::interpolateColor(const RGBColor &color1, const RG
     if (factor >= 1.0)
         return color2;
 
-    RGBColor result;
-    result.r = color1.r + (color2.r - color1.r) * factor;
-    result.g = color1.g + (color2.g - color1.g) * factor;
-    result.b = color1.b + (color2.b - color1.b) * factor;
-
-    return result;
+    return ColorMath::interpolate(color1, color2, factor * 65536.0f);
 }
 
-RGBColor LightControllerUtils::hsv2rgb(float h, float s, float v)
+RGBColor LightControllerUtils::blendColor(const RGBColor &color1, const RGBColor &color2, uint8_t amount)
 {
-    RGBColor rgb;
-    float c = v * s;
-    float x = c * (1 - abs(fmod(h / 60.0, 2) - 1));
-    float m = v - c;
-
-    float r, g, b;
-
-    if (h >= 0 && h < 60)
-    {
-        r = c;
-        g = x;
-        b = 0;
-    }
-    else if (h >= 60 && h < 120)
-    {
-        r = x;
-        g = c;
-        b = 0;
-    }
-    else if (h >= 120 && h < 180)
-    {
-        r = 0;
-        g = c;
-        b = x;
-    }
-    else if (h >= 180 && h < 240)
-    {
-        r = 0;
-        g = x;
-        b = c;
-    }
-    else if (h >= 240 && h < 300)
-    {
-        r = x;
-        g = 0;
-        b = c;
-    }
-    else
-    {
-        r = c;
-        g = 0;
-        b = x;
-    }
+    return ColorMath::blend(color1, color2, amount);
+}
 
-    rgb.r = (r + m) * 255;
-    rgb.g = (g + m) * 255;
-    rgb.b = (b + m) * 255;
+RGBColor LightControllerUtils::scaleColor(const RGBColor &color, uint8_t scale)
+{
+    return ColorMath::scale(color, scale);
+}
 
-    return rgb;
+RGBColor LightControllerUtils::hsv2rgb(float h, float s, float v)
+{
+    // Quantize once (hue to 1/256 degree), then the integer kernel does the rest
+    h = fmodf(h, 360.0f);
+    if (h < 0.0f)
+        h += 360.0f;
+    s = constrain(s, 0.0f, 1.0f);
+    v = constrain(v, 0.0f, 1.0f);
+
+    uint32_t hue = (uint32_t)(h * ColorMath::kHueScale + 0.5f) % ColorMath::kHueFull;
+    return ColorMath::hsvToRgbFine(hue, s * 255.0f + 0.5f, v * 255.0f + 0.5f);
 }
 
 RGBColor LightControllerUtils::adjustBrightness(const RGBColor &color, float brightness)
 {
-    if (brightness < 0.0)
-        brightness = 0.0;
-    if (brightness > 1.0)
-        brightness = 1.0;
-
-    RGBColor result;
-    result.r = color.r * brightness;
-    result.g = color.g * brightness;
-    result.b = color.b * brightness;
+    if (brightness <= 0.0)
+        return RGBColor(0, 0, 0);
+    if (brightness >= 1.0)
+        return color;
 
-    return result;
+    return ColorMath::scale16(color, brightness * 65536.0f);
 }
 
 String LightControllerUtils::formatJsonError(const String &error)
@@ -4,9 +4,16 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <functional>
+#include <stdarg.h>
+#include "../core/FixedString.h"
+#include "../core/Log.h"
 
 // Constants
 #define MAX_COLORS 10
+#define PALETTE_NAME_SIZE 48      // "From " + sender name
+#define PALETTE_SENDER_SIZE 40    // Sender display name
+#define PALETTE_ID_SIZE 40        // Message id (UUID, or decimal id of a binary frame)
+#define PALETTE_ANIMATION_SIZE 16 // Animation name ("fade", "pulse", ...)
 
 /**
  * Color structure for RGB values
@@ -20,22 +27,54 @@ struct RGBColor
     RGBColor() : r(0), g(0), b(0) {}
     RGBColor(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
 
-    // Convert from hex string
-    static RGBColor fromHex(const String &hexColor)
+    // Convert from hex string ("#RRGGBB" or "RRGGBB") without allocating
+    // Anything else ("#FFF", "red", 8 digits) is black
+    static RGBColor fromHex(const char *hexColor)
     {
-        String hex = hexColor;
-        if (hex.startsWith("#"))
+        if (hexColor == nullptr)
+        {
+            return RGBColor();
+        }
+
+        if (*hexColor == '#')
         {
-            hex = hex.substring(1);
+            hexColor++;
         }
 
-        long rgb = strtol(hex.c_str(), NULL, 16);
+        for (int i = 0; i < 6; i++)
+        {
+            if (!isxdigit((unsigned char)hexColor[i]))
+            {
+                return RGBColor();
+            }
+        }
+        if (hexColor[6] != '\0')
+        {
+            return RGBColor();
+        }
+
+        long rgb = strtol(hexColor, NULL, 16);
         return RGBColor(
             (rgb >> 16) & 0xFF,
             (rgb >> 8) & 0xFF,
             rgb & 0xFF);
     }
 
+    static RGBColor fromHex(const String &hexColor)
+    {
+        return fromHex(hexColor.c_str());
+    }
+
+    bool operator==(const RGBColor &other) const
+    {
+        return r == other.r && g == other.g && b == other.b;
+    }
+
+    bool operator!=(const RGBColor &other) const
+    {
+        return !(*this == other);
+    }
+
     // Convert to hex string
     String toHex() const
     {
@@ -47,16 +86,18 @@ struct RGBColor
 
 /**
  * Color palette structure
+ * Text fields are fixed-capacity and inline, so palettes are copied and
+ * queued without touching the heap (longer values are truncated)
  */
 struct ColorPalette
 {
     RGBColor colors[10]; // Maximum 10 colors
     int colorCount;
-    String name;
-    String messageId;
-    String senderName;
-    int duration;     // Display duration in milliseconds
-    String animation; // Animation type (fade, pulse, static, etc.)
+    FixedString<PALETTE_NAME_SIZE> name;
+    FixedString<PALETTE_ID_SIZE> messageId;
+    FixedString<PALETTE_SENDER_SIZE> senderName;
+    int duration;                                   // Display duration in milliseconds
+    FixedString<PALETTE_ANIMATION_SIZE> animation; // Animation type (fade, pulse, static, etc.)
 
     ColorPalette() : colorCount(0), duration(5000), animation("fade") {}
 };
@@ -71,6 +112,7 @@ struct LightConfig
     int port;                // Port number
     String authToken;        // Authentication token
     JsonObject customConfig; // System-specific configuration
+    bool isPrimary = true;   // Only the primary system updates device-wide state (last-known-good host)
 };
 
 /**
@@ -162,6 +204,66 @@ public:
         return isInitialized && isAuthenticated;
     }
 
+    /**
+     * Get the number of individually addressable pixels (panels, LEDs, segments)
+     * @return Pixel count, or 0 if per-pixel control is not available
+     */
+    virtual int getPixelCount() const { return 0; }
+
+    /**
+     * Prepare the controller for low-latency per-pixel frames
+     * Controllers that cannot stream keep the default implementation
+     * @return true if streamPixels() can be used
+     */
+    virtual bool beginStreaming() { return false; }
+
+    /**
+     * Push colors for a subset of pixels without blocking
+     * @param pixelIndices Pixel indices to update, or nullptr for 0..count-1
+     * @param colors Color for each listed pixel
+     * @param count Number of pixels in this frame
+     * @param transitionTime Device-side transition in tenths of seconds
+     * @return true if the frame was sent
+     */
+    virtual bool streamPixels(const int *pixelIndices, const RGBColor *colors, int count, int transitionTime)
+    {
+        return false;
+    }
+
+    /**
+     * Spatial position of each pixel along the controller's layout
+     * @return getPixelCount() positions (0..65535, see SpatialMap), or nullptr to use pixel index order
+     */
+    virtual const uint16_t *getPixelPositions() const { return nullptr; }
+
+    /**
+     * Animation tick this controller can sustain
+     * @return Milliseconds between streamed frames, or 0 for ANIMATION_FRAME_INTERVAL
+     */
+    virtual uint16_t getFrameInterval() const { return 0; }
+
+    /**
+     * Periodic housekeeping, called from LightManager::loop()
+     */
+    virtual void loop() {}
+
+    /**
+     * Slow network work that loop() deferred, called from LightManager::loop()
+     * with the controller mutex released. The controller stays alive while
+     * this runs, but only state loop() handed over may be touched.
+     */
+    virtual void loopUnlocked() {}
+
+    /**
+     * Whether loop() has deferred work pending (keeps the lighting task waking)
+     */
+    virtual bool hasBackgroundWork() const { return false; }
+
+    /**
+     * Add controller-specific counters to this controller's metrics entry
+     */
+    virtual void statsToJson(JsonObject out) {}
+
     /**
      * Set callback for user interaction notifications
      * @param callback Function to call when user interaction is needed
@@ -199,47 +301,33 @@ protected:
     }
 
     /**
-     * Log debug information if debugging is enabled
+     * Log debug information (LOG_LEVEL_DEBUG, tagged with the configured system type)
      */
-    void debugLog(const String &message)
+    void debugLog(const char *message)
     {
-#ifdef DEBUG_LIGHT_CONTROLLER
-        Serial.println("[" + getSystemType() + "] " + message);
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+        Log::write(LOG_LEVEL_DEBUG, logTag(), "%s", message);
 #endif
     }
-};
 
-/**
- * Factory class for creating light controllers
- */
-class LightControllerFactory
-{
-public:
     /**
-     * Create a light controller instance based on system type
-     * @param systemType The type of lighting system
-     * @return Pointer to light controller instance, or nullptr if unknown type
+     * printf-style debugLog()
      */
-    static LightController *createController(const String &systemType);
-
-    /**
-     * Get list of supported lighting systems
-     * @return Array of supported system type strings
-     */
-    static String *getSupportedSystems();
-
-    /**
-     * Get number of supported systems
-     * @return Count of supported systems
-     */
-    static int getSupportedSystemCount();
+    void debugLogf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+        va_list args;
+        va_start(args, format);
+        Log::vwrite(LOG_LEVEL_DEBUG, logTag(), format, args);
+        va_end(args);
+#endif
+    }
 
-    /**
-     * Check if a system type is supported
-     * @param systemType The system type to check
-     * @return True if supported, false otherwise
-     */
-    static bool isSystemSupported(const String &systemType);
+    // The configured tag is already in memory - getSystemType() would build a String per line
+    const char *logTag() const
+    {
+        return config.systemType.length() > 0 ? config.systemType.c_str() : "light";
+    }
 };
 
 /**
@@ -255,29 +343,8 @@ public:
      */
     static RGBColor hexToColor(const String &hexColor)
     {
-        RGBColor color;
-        String hex = hexColor;
-
-        // Remove # if present
-        if (hex.startsWith("#"))
-        {
-            hex = hex.substring(1);
-        }
-
-        // Ensure we have 6 characters
-        if (hex.length() == 6)
-        {
-            color.r = strtol(hex.substring(0, 2).c_str(), NULL, 16);
-            color.g = strtol(hex.substring(2, 4).c_str(), NULL, 16);
-            color.b = strtol(hex.substring(4, 6).c_str(), NULL, 16);
-        }
-        else
-        {
-            // Default to black if invalid
-            color.r = color.g = color.b = 0;
-        }
-
-        return color;
+        // Defaults to black unless there are exactly 6 hex digits
+        return RGBColor::fromHex(hexColor.c_str());
     }
 
     /**
@@ -315,6 +382,23 @@ public:
      */
     static RGBColor interpolateColor(const RGBColor &color1, const RGBColor &color2, float factor);
 
+    /**
+     * Blend between two colors using 8-bit fixed point
+     * @param color1 First color
+     * @param color2 Second color
+     * @param amount Blend amount (0 = color1, 255 = color2)
+     * @return Blended color
+     */
+    static RGBColor blendColor(const RGBColor &color1, const RGBColor &color2, uint8_t amount);
+
+    /**
+     * Scale color brightness using 8-bit fixed point
+     * @param color Original color
+     * @param scale Scale factor (0 = off, 255 = unchanged)
+     * @return Scaled color
+     */
+    static RGBColor scaleColor(const RGBColor &color, uint8_t scale);
+
     /**
      * Convert HSV to RGB
      * @param h Hue (0-360)
@@ -1,73 +1,96 @@
 #include "LightManager.h"
 #include "LightController.h"
+#include "ControllerRegistry.h"
 #include "../config.h"
+#include "../core/ConfigStore.h"
+#include "../core/Metrics.h"
+#include "../core/MemoryTelemetry.h"
+#include "../core/Log.h"
 
-// Static constants
-const char *LightManager::PREF_NAMESPACE = "light_config";
-const char *LightManager::PREF_SYSTEM_TYPE = "system_type";
-const char *LightManager::PREF_HOST_ADDRESS = "host_addr";
-const char *LightManager::PREF_PORT = "port";
-const char *LightManager::PREF_AUTH_TOKEN = "auth_token";
-const char *LightManager::PREF_CUSTOM_CONFIG = "custom_config";
+static const char *const LOG_TAG = "light";
 
-LightManager::LightManager() : currentController(nullptr), isInitialized(false)
+LightManager::LightManager()
+    : currentController(nullptr), additionalControllerCount(0), lightingTask(this), isInitialized(false), localPrimaryReady(false),
+      notificationTimeout(0),
+      shuffleEnabled(false), shuffleInterval(PALETTE_SHUFFLE_DEFAULT_INTERVAL), lastShuffleTime(0)
 {
+    publishedSystemType[0] = '\0';
+    for (LightController *&controller : additionalControllers)
+    {
+        controller = nullptr;
+    }
+    controllerMutex = xSemaphoreCreateRecursiveMutex();
+    slotMutex = xSemaphoreCreateMutex();
+    stagingMutex = xSemaphoreCreateMutex();
 }
 
 LightManager::~LightManager()
 {
     cleanupController();
+    cleanupAdditionalControllers();
 }
 
 bool LightManager::begin()
 {
-    Serial.println("🌈 Initializing Light Manager...");
+    ControllerLock lock(this);
+
+    LOG_I("🌈 Initializing Light Manager...");
+
+    // Additional systems come up independently of the primary one
+    loadAdditionalSystems();
+
+    // A local primary is already showing the restored palette - keep it
+    if (localPrimaryReady && currentController)
+    {
+        localPrimaryReady = false;
+        return true;
+    }
 
     // Load configuration from EEPROM
     if (loadConfiguration())
     {
-        Serial.println("📋 Loaded lighting configuration: " + config.systemType);
+        LOG_I("📋 Loaded lighting configuration: %s", config.systemType.c_str());
 
         // Create and initialize controller (but don't authenticate yet)
         if (createController(config.systemType))
         {
-            Serial.println("🔄 Attempting to initialize " + config.systemType + " controller...");
+            LOG_I("🔄 Attempting to initialize %s controller...", config.systemType.c_str());
             if (currentController->initialize(config))
             {
                 isInitialized = true;
-                Serial.println("✅ Light Manager initialized successfully");
+                LOG_I("✅ Light Manager initialized successfully");
 
                 // For systems with saved credentials, try to authenticate immediately
                 if (currentController->requiresAuthentication())
                 {
                     if (config.authToken.length() > 0)
                     {
-                        Serial.println("🔐 Found saved credentials, attempting automatic authentication...");
+                        LOG_I("🔐 Found saved credentials, attempting automatic authentication...");
                         if (currentController->isReady())
                         {
-                            Serial.println("✅ Lighting system authenticated and ready");
+                            LOG_I("✅ Lighting system authenticated and ready");
                         }
                         else
                         {
-                            Serial.println("⚠ Automatic authentication not fully successful");
-                            Serial.println("   System will retry authentication when needed");
+                            LOG_W("⚠ Automatic authentication not fully successful");
+                            LOG_I("   System will retry authentication when needed");
                         }
                     }
                     else
                     {
-                        Serial.println("⚠ Lighting system requires authentication - will authenticate after device pairing");
+                        LOG_W("⚠ Lighting system requires authentication - will authenticate after device pairing");
                     }
                 }
                 else
                 {
-                    Serial.println("ℹ️ Lighting system does not require authentication");
+                    LOG_I("ℹ️ Lighting system does not require authentication");
                 }
 
                 return true;
             }
             else
             {
-                Serial.println("⚠ Lighting controller failed to initialize (hardware may not be connected)");
+                LOG_W("⚠ Lighting controller failed to initialize (hardware may not be connected)");
                 // Don't fail completely - allow system to continue running
                 isInitialized = true; // Mark as initialized but with failed controller
                 return true;
@@ -75,13 +98,13 @@ bool LightManager::begin()
         }
         else
         {
-            Serial.println("❌ Failed to create lighting controller");
+            LOG_E("❌ Failed to create lighting controller");
             return false;
         }
     }
     else
     {
-        Serial.println("📋 No lighting configuration found - waiting for app configuration");
+        LOG_I("📋 No lighting configuration found - waiting for app configuration");
         // Don't auto-configure any lighting system
         isInitialized = true;
         return true;
@@ -92,12 +115,42 @@ bool LightManager::begin()
 
 bool LightManager::beginWithoutConfig()
 {
-    Serial.println("🌈 Initializing Light Manager (no auto-config)...");
+    LOG_I("🌈 Initializing Light Manager (no auto-config)...");
+
+    // Flash only - the last palette can be shown before the network is up
+    paletteHistory.begin();
 
     // Initialize preferences but don't load/create any lighting configuration
     isInitialized = true;
 
-    Serial.println("✅ Light Manager ready - waiting for configuration from mobile app");
+    LOG_I("✅ Light Manager ready - waiting for configuration from mobile app");
+    return true;
+}
+
+bool LightManager::beginLocal()
+{
+    ControllerLock lock(this);
+
+    if (currentController || !loadConfiguration())
+    {
+        return false;
+    }
+
+    if (ControllerRegistry::hasCapability(ControllerRegistry::typeFromName(config.systemType), LIGHT_CAP_NETWORK))
+    {
+        return false; // Waits for WiFi in begin()
+    }
+
+    if (!createController(config.systemType) || !currentController->initialize(config))
+    {
+        LOG_W("⚠ Local lighting system %s not available before WiFi", config.systemType.c_str());
+        cleanupController();
+        return false;
+    }
+
+    isInitialized = true;
+    localPrimaryReady = true;
+    LOG_I("⚡ Local lighting system %s ready before WiFi", config.systemType.c_str());
     return true;
 }
 
@@ -105,8 +158,10 @@ bool LightManager::configure(const String &systemType, const String &hostAddress
                              int port, const String &authToken,
                              const JsonObject &customConfig)
 {
+    ControllerLock lock(this);
 
-    Serial.println("🔧 Configuring lighting system: " + systemType);
+    LOG_I("🔧 Configuring lighting system: %s", systemType.c_str());
+    MemoryScope configureScope(MemoryTelemetry::LIGHT_CONFIGURE);
 
     // Clean up existing controller
     cleanupController();
@@ -116,7 +171,9 @@ bool LightManager::configure(const String &systemType, const String &hostAddress
     config.hostAddress = hostAddress;
     config.port = port;
     config.authToken = authToken;
-    config.customConfig = customConfig;
+    // Keep a copy - the caller's document usually goes away after this call
+    customConfigDoc.set(customConfig);
+    config.customConfig = customConfigDoc.as<JsonObject>();
 
     // Create and initialize new controller
     if (createController(systemType))
@@ -131,76 +188,200 @@ bool LightManager::configure(const String &systemType, const String &hostAddress
             saveConfiguration();
             isInitialized = true;
 
-            Serial.println("✅ Lighting system configured successfully");
-            Serial.println("📊 System: " + systemType);
+            LOG_I("✅ Lighting system configured successfully");
+            LOG_I("📊 System: %s", systemType.c_str());
             if (hostAddress.length() > 0)
             {
-                Serial.println("🌐 Host: " + hostAddress + ":" + String(port));
+                LOG_I("🌐 Host: %s:%d", hostAddress.c_str(), port);
             }
 
             return true;
         }
         else
         {
-            Serial.println("❌ Failed to initialize lighting controller");
+            LOG_E("❌ Failed to initialize lighting controller");
             cleanupController();
             return false;
         }
     }
     else
     {
-        Serial.println("❌ Unknown lighting system type: " + systemType);
+        LOG_E("❌ Unknown lighting system type: %s", systemType.c_str());
         return false;
     }
 }
 
 bool LightManager::displayPalette(const ColorPalette &palette)
 {
+    ControllerLock lock(this);
+
     if (!isInitialized)
     {
-        Serial.println("❌ Light Manager not initialized");
+        LOG_E("❌ Light Manager not initialized");
         return false;
     }
 
-    if (!currentController)
+    // An offline primary does not keep the palette from the additional systems
+    uint8_t readyMask = readyControllerMask();
+    if (readyMask == 0)
     {
-        Serial.println("❌ No lighting controller available");
+        LOG_W("⚠ No lighting system ready (hardware may not be connected)");
         return false;
     }
 
-    if (!currentController->isReady())
+    LOG_I("🎨 Displaying palette: %s", palette.name.c_str());
+    MetricSpan displaySpan(Metrics::DISPLAY_PALETTE);
+    MemoryScope displayScope(MemoryTelemetry::LIGHT_DISPLAY);
+
+    // Every ready system at once - total time is that of the slowest one
+    ControllerFanOut::Result result = fanOut.run(readyMask, [&](int slot)
+                                                 { return showOnSlot(slot, palette); });
+    logFanOut("Palette", result);
+
+    return result.succeeded > 0;
+}
+
+bool LightManager::restoreLastPalette()
+{
+    ColorPalette palette;
+    if (!paletteHistory.latest(palette))
     {
-        Serial.println("⚠ Lighting controller not ready (hardware may not be connected)");
+        LOG_I("📝 No previous palette to restore");
         return false;
     }
 
-    Serial.println("🎨 Displaying palette: " + palette.name);
-    return currentController->displayPalette(palette);
+    LOG_I("♻️ Restoring last palette: %s", palette.name.c_str());
+    return submitPalette(palette);
+}
+
+void LightManager::recordPalette(const ColorPalette &palette)
+{
+    paletteHistory.append(palette);
+
+    if (shuffleEnabled)
+    {
+        LOG_I("🔀 Live palette received - shuffle stopped");
+        shuffleEnabled = false;
+    }
+}
+
+void LightManager::setShuffle(bool enabled, uint32_t intervalMs)
+{
+    shuffleInterval = max(intervalMs, (uint32_t)PALETTE_SHUFFLE_MIN_INTERVAL);
+    shuffleEnabled = enabled;
+    lastShuffleTime = millis() - shuffleInterval; // First palette on the next historyLoop()
+
+    if (enabled)
+    {
+        LOG_I("🔀 Shuffling %d palettes from history every %lu s", paletteHistory.getCount(),
+              (unsigned long)(shuffleInterval / 1000));
+    }
+    else
+    {
+        LOG_I("🔀 Shuffle stopped");
+    }
+}
+
+void LightManager::historyLoop()
+{
+    paletteHistory.flush();
+
+    if (!shuffleEnabled || millis() - lastShuffleTime < shuffleInterval)
+    {
+        return;
+    }
+    lastShuffleTime = millis();
+
+    ColorPalette palette;
+    if (!paletteHistory.nextShuffle(palette))
+    {
+        LOG_I("🔀 Fewer than two palettes in history - shuffle stopped");
+        shuffleEnabled = false;
+        return;
+    }
+
+    LOG_I("🔀 Shuffle: %s", palette.name.c_str());
+    submitPalette(palette);
+}
+
+void LightManager::historyToJson(JsonObject out)
+{
+    paletteHistory.statsToJson(out);
+    out["shuffle"] = shuffleEnabled;
+    out["shuffleIntervalMs"] = shuffleInterval;
+}
+
+bool LightManager::submitPalette(const ColorPalette &palette)
+{
+    if (lightingTask.isRunning())
+    {
+        return lightingTask.submitPalette(palette);
+    }
+
+    return displayPalette(palette);
+}
+
+bool LightManager::submitBrightness(int brightness)
+{
+    if (lightingTask.isRunning())
+    {
+        return lightingTask.submitBrightness(brightness);
+    }
+
+    return setBrightness(brightness);
+}
+
+bool LightManager::startLightingTask()
+{
+    if (!controllerMutex)
+    {
+        LOG_E("❌ Lighting mutex unavailable - lighting stays on the main loop");
+        return false;
+    }
+
+    return lightingTask.begin();
 }
 
 bool LightManager::turnOff()
 {
-    if (!isReady())
+    ControllerLock lock(this);
+
+    uint8_t readyMask = readyControllerMask();
+    if (readyMask == 0)
     {
         return false;
     }
 
-    return currentController->turnOff();
+    // Lights go dark - the next fade starts from black
+    animationEngine.reset();
+
+    ControllerFanOut::Result result = fanOut.run(readyMask, [&](int slot)
+                                                 { return controllerAt(slot)->turnOff(); });
+    logFanOut("Turn off", result);
+    return result.succeeded == result.attempted;
 }
 
 bool LightManager::setBrightness(int brightness)
 {
-    if (!isReady())
+    ControllerLock lock(this);
+
+    uint8_t readyMask = readyControllerMask();
+    if (readyMask == 0)
     {
         return false;
     }
 
-    return currentController->setBrightness(brightness);
+    ControllerFanOut::Result result = fanOut.run(readyMask, [&](int slot)
+                                                 { return controllerAt(slot)->setBrightness(brightness); });
+    logFanOut("Brightness", result);
+    return result.succeeded == result.attempted;
 }
 
 bool LightManager::testConnection()
 {
-    if (!isReady())
+    ControllerLock lock(this);
+
+    if (!isPrimaryReady())
     {
         return false;
     }
@@ -210,7 +391,9 @@ bool LightManager::testConnection()
 
 String LightManager::getStatus()
 {
-    if (!isReady())
+    ControllerLock lock(this);
+
+    if (!isPrimaryReady())
     {
         return "Not Initialized";
     }
@@ -220,7 +403,9 @@ String LightManager::getStatus()
 
 JsonObject LightManager::getCapabilities()
 {
-    if (!isReady())
+    ControllerLock lock(this);
+
+    if (!isPrimaryReady())
     {
         JsonDocument doc;
         JsonObject caps = doc.to<JsonObject>();
@@ -233,7 +418,9 @@ JsonObject LightManager::getCapabilities()
 
 bool LightManager::requiresAuthentication()
 {
-    if (!isReady())
+    ControllerLock lock(this);
+
+    if (!isPrimaryReady())
     {
         return false;
     }
@@ -243,48 +430,50 @@ bool LightManager::requiresAuthentication()
 
 bool LightManager::authenticate()
 {
-    if (!isReady())
+    ControllerLock lock(this);
+
+    if (!isPrimaryReady())
     {
         return false;
     }
 
-    Serial.println("🔐 Starting authentication for " + config.systemType);
+    LOG_I("🔐 Starting authentication for %s", config.systemType.c_str());
     bool success = currentController->authenticate();
 
     if (success)
     {
         // Update auth token in config if available
         LightConfig updatedConfig = currentController->getUpdatedConfig();
-        Serial.println("🔍 Updated config received from authenticate():");
-        Serial.println("  - Host Address: " + updatedConfig.hostAddress);
-        Serial.println("  - Port: " + String(updatedConfig.port));
-        Serial.println("  - Auth Token Length: " + String(updatedConfig.authToken.length()));
+        LOG_I("🔍 Updated config received from authenticate():");
+        LOG_I("  - Host Address: %s", updatedConfig.hostAddress.c_str());
+        LOG_I("  - Port: %d", updatedConfig.port);
+        LOG_I("  - Auth Token Length: %u", (unsigned)updatedConfig.authToken.length());
 
         // Update all configuration fields that may have changed during authentication
         if (updatedConfig.hostAddress.length() > 0)
         {
             config.hostAddress = updatedConfig.hostAddress;
-            Serial.println("💾 Updated host address: " + config.hostAddress);
+            LOG_I("💾 Updated host address: %s", config.hostAddress.c_str());
         }
 
         if (updatedConfig.port > 0)
         {
             config.port = updatedConfig.port;
-            Serial.println("💾 Updated port: " + String(config.port));
+            LOG_I("💾 Updated port: %d", config.port);
         }
 
         if (updatedConfig.authToken.length() > 0)
         {
             config.authToken = updatedConfig.authToken;
-            Serial.println("💾 Updated auth token (length: " + String(config.authToken.length()) + ")");
+            LOG_I("💾 Updated auth token (length: %u)", (unsigned)config.authToken.length());
         }
 
         saveConfiguration();
-        Serial.println("✅ Authentication successful");
+        LOG_I("✅ Authentication successful");
     }
     else
     {
-        Serial.println("❌ Authentication failed");
+        LOG_E("❌ Authentication failed");
     }
 
     return success;
@@ -292,366 +481,594 @@ bool LightManager::authenticate()
 
 bool LightManager::authenticateLightingSystem()
 {
+    ControllerLock lock(this);
+
     if (!currentController)
     {
-        Serial.println("❌ No lighting controller available for authentication");
+        LOG_E("❌ No lighting controller available for authentication");
         return false;
     }
 
     if (!currentController->requiresAuthentication())
     {
-        Serial.println("✅ Lighting system does not require authentication");
+        LOG_I("✅ Lighting system does not require authentication");
         return true;
     }
 
-    Serial.println("🔐 Starting lighting system authentication...");
+    LOG_I("🔐 Starting lighting system authentication...");
 
     if (currentController->authenticate())
     {
-        Serial.println("✅ Lighting system authentication successful");
+        LOG_I("✅ Lighting system authentication successful");
         // Get updated configuration with new auth tokens
         LightConfig updatedConfig = currentController->getUpdatedConfig();
-        Serial.println("🔍 Updated config received:");
-        Serial.println("  - System Type: " + updatedConfig.systemType);
-        Serial.println("  - Host Address: " + updatedConfig.hostAddress);
-        Serial.println("  - Port: " + String(updatedConfig.port));
-        Serial.println("  - Auth Token Length: " + String(updatedConfig.authToken.length()));
+        LOG_I("🔍 Updated config received:");
+        LOG_I("  - System Type: %s", updatedConfig.systemType.c_str());
+        LOG_I("  - Host Address: %s", updatedConfig.hostAddress.c_str());
+        LOG_I("  - Port: %d", updatedConfig.port);
+        LOG_I("  - Auth Token Length: %u", (unsigned)updatedConfig.authToken.length());
 
         // Update all configuration fields that may have changed during authentication
         if (updatedConfig.hostAddress.length() > 0)
         {
             config.hostAddress = updatedConfig.hostAddress;
-            Serial.println("💾 Updated host address in local config: " + config.hostAddress);
+            LOG_I("💾 Updated host address in local config: %s", config.hostAddress.c_str());
         }
 
         if (updatedConfig.port > 0)
         {
             config.port = updatedConfig.port;
-            Serial.println("💾 Updated port in local config: " + String(config.port));
+            LOG_I("💾 Updated port in local config: %d", config.port);
         }
 
         if (updatedConfig.authToken.length() > 0)
         {
             config.authToken = updatedConfig.authToken;
-            Serial.println("💾 Updated auth token in local config (length: " + String(config.authToken.length()) + ")");
+            LOG_I("💾 Updated auth token in local config (length: %u)", (unsigned)config.authToken.length());
         }
 
         // Save updated configuration (may include new auth tokens)
         bool saveResult = saveConfiguration();
-        Serial.println("💾 Save configuration result: " + String(saveResult ? "SUCCESS" : "FAILED"));
+        LOG_I("💾 Save configuration result: %s", saveResult ? "SUCCESS" : "FAILED");
         return true;
     }
     else
     {
-        Serial.println("❌ Lighting system authentication failed");
+        LOG_E("❌ Lighting system authentication failed");
         return false;
     }
 }
 
-bool LightManager::requiresUserAuthentication()
+String LightManager::getCurrentSystemType() const
 {
-    if (!currentController)
-    {
-        return false;
-    }
-
-    return currentController->requiresAuthentication() && !currentController->isReady();
-}
-
-String LightManager::getCurrentSystemType()
-{
-    return config.systemType;
+    char systemType[sizeof(publishedSystemType)];
+    portENTER_CRITICAL(&stateLock);
+    memcpy(systemType, publishedSystemType, sizeof(systemType));
+    portEXIT_CRITICAL(&stateLock);
+    return String(systemType);
 }
 
 bool LightManager::saveConfiguration()
 {
-    Serial.println("💾 Starting to save lighting configuration...");
-    Serial.println("   System Type: " + config.systemType);
-    Serial.println("   Host Address: " + config.hostAddress);
-    Serial.println("   Port: " + String(config.port));
-    Serial.println("   Auth Token Length: " + String(config.authToken.length()));
-    Serial.println("   Auth Token Preview: " + (config.authToken.length() > 0 ? config.authToken.substring(0, min(8, (int)config.authToken.length())) + "..." : "None"));
-
     // Check if we have minimum required data
     if (config.systemType.length() == 0)
     {
-        Serial.println("❌ Cannot save config: System type is empty");
+        LOG_E("❌ Cannot save config: System type is empty");
         return false;
     }
 
-    // Check available flash memory
-    Serial.println("🔍 Flash Memory Info:");
-    Serial.println("  - Free heap: " + String(ESP.getFreeHeap()) + " bytes");
-    Serial.println("  - Flash size: " + String(ESP.getFlashChipSize()) + " bytes");
-
-    preferences.begin(PREF_NAMESPACE, false);
-    Serial.println("🔧 Opened preferences namespace: " + String(PREF_NAMESPACE));
-
-    bool success = true;
-
-    // Save system type
-    if (preferences.putString(PREF_SYSTEM_TYPE, config.systemType))
-    {
-        Serial.println("✅ Saved system type: " + config.systemType);
-    }
-    else
+    // Serialize and save custom config
+    String customConfigStr = serializeCustomConfig(config.customConfig);
+    if (customConfigStr.length() == 0)
     {
-        Serial.println("❌ Failed to save system type: " + config.systemType);
-        success = false;
+        customConfigStr = "{}"; // Use empty JSON object instead of empty string
     }
 
-    // Save host address
-    Serial.println("🔍 Host address to save: '" + config.hostAddress + "' (length: " + String(config.hostAddress.length()) + ")");
-    if (preferences.putString(PREF_HOST_ADDRESS, config.hostAddress))
+    // A truncated copy would no longer parse, so refuse it rather than store it
+    if (customConfigStr.length() >= sizeof(StoredConfig::lightingCustomConfig))
     {
-        Serial.println("✅ Saved host address: " + config.hostAddress);
+        LOG_E("❌ Lighting custom config (%u bytes) does not fit in the config store - not saved",
+              customConfigStr.length());
+        return false;
     }
-    else
-    {
-        Serial.println("❌ Failed to save host address: '" + config.hostAddress + "'");
 
-        // Try to save as empty string if null
-        if (config.hostAddress.length() == 0)
+    // All fields land in one blob write, skipped entirely when nothing changed
+    bool success = ConfigStore::getInstance()->update([&](StoredConfig &stored)
+                                                      {
+        ConfigStore::setField(stored.lightingSystem, config.systemType);
+        ConfigStore::setField(stored.lightingHost, config.hostAddress);
+        stored.lightingPort = config.port;
+        ConfigStore::setField(stored.lightingAuthToken, config.authToken);
+        ConfigStore::setField(stored.lightingCustomConfig, customConfigStr); });
+
+    if (success)
+    {
+        if (config.hostAddress.length() > 0)
         {
-            Serial.println("🔧 Trying to save empty host address...");
-            if (preferences.putString(PREF_HOST_ADDRESS, ""))
-            {
-                Serial.println("✅ Saved empty host address");
-            }
-            else
-            {
-                Serial.println("❌ Failed to save even empty host address");
-                success = false;
-            }
+            LOG_I("✅ Lighting configuration saved: %s @ %s:%d (auth token: %s)", config.systemType.c_str(),
+                  config.hostAddress.c_str(), config.port, config.authToken.length() > 0 ? "yes" : "no");
         }
         else
         {
-            success = false;
+            LOG_I("✅ Lighting configuration saved: %s (auth token: %s)", config.systemType.c_str(),
+                  config.authToken.length() > 0 ? "yes" : "no");
         }
     }
-
-    // Save port
-    if (preferences.putInt(PREF_PORT, config.port))
-    {
-        Serial.println("✅ Saved port: " + String(config.port));
-    }
     else
     {
-        Serial.println("❌ Failed to save port: " + String(config.port));
-        success = false;
+        LOG_E("❌ Failed to save lighting configuration");
     }
 
-    // Save auth token
-    if (preferences.putString(PREF_AUTH_TOKEN, config.authToken))
-    {
-        Serial.println("✅ Saved auth token (length: " + String(config.authToken.length()) + ")");
-    }
-    else
+    return success;
+}
+
+bool LightManager::loadConfiguration()
+{
+    StoredConfig stored = ConfigStore::getInstance()->get();
+
+    if (stored.lightingSystem[0] == '\0')
     {
-        Serial.println("❌ Failed to save auth token (length: " + String(config.authToken.length()) + ")");
-        success = false;
+        return false; // No configuration found
     }
 
-    // Serialize and save custom config
-    String customConfigStr = serializeCustomConfig(config.customConfig);
-    Serial.println("🔍 Custom config string: '" + customConfigStr + "'");
+    config.systemType = stored.lightingSystem;
+    config.hostAddress = stored.lightingHost;
+    config.port = stored.lightingPort;
+    config.authToken = stored.lightingAuthToken;
 
-    // Handle empty custom config
-    if (customConfigStr.length() == 0)
+    // Set default ports based on system type
+    if (config.port == 0)
     {
-        customConfigStr = "{}"; // Use empty JSON object instead of empty string
-        Serial.println("🔧 Using empty JSON object for custom config");
+        config.port = ControllerRegistry::defaultPort(ControllerRegistry::typeFromName(config.systemType));
     }
 
-    if (preferences.putString(PREF_CUSTOM_CONFIG, customConfigStr))
+    // Systems chosen in the setup portal have no custom config yet
+    if (stored.lightingCustomConfig[0] == '\0')
     {
-        Serial.println("✅ Saved custom config (length: " + String(customConfigStr.length()) + ")");
+        config.customConfig = createDefaultCustomConfig(config.systemType);
     }
     else
     {
-        Serial.println("❌ Failed to save custom config (length: " + String(customConfigStr.length()) + ")");
-        Serial.println("❌ Custom config content: '" + customConfigStr + "'");
-        success = false;
+        config.customConfig = parseCustomConfig(stored.lightingCustomConfig);
     }
 
-    preferences.end();
-    Serial.println("🔧 Closed preferences namespace");
+    return true;
+}
+
+void LightManager::resetConfiguration()
+{
+    ControllerLock lock(this);
+
+    LOG_I("🔄 Resetting lighting configuration");
 
-    if (success)
-    {
-        Serial.println("✅ Lighting configuration saved successfully");
+    ConfigStore::getInstance()->update([](StoredConfig &stored)
+                                       {
+        stored.lightingSystem[0] = '\0';
+        stored.lightingHost[0] = '\0';
+        stored.lightingPort = 0;
+        stored.lightingAuthToken[0] = '\0';
+        stored.lightingCustomConfig[0] = '\0';
+        stored.lightingAdditionalSystems[0] = '\0'; });
 
-        // Verify by reading back immediately
-        Serial.println("🔍 Verifying saved configuration...");
-        preferences.begin(PREF_NAMESPACE, true);
-        String verifySystemType = preferences.getString(PREF_SYSTEM_TYPE, "");
-        String verifyAuthToken = preferences.getString(PREF_AUTH_TOKEN, "");
-        preferences.end();
+    cleanupController();
+    cleanupAdditionalControllers();
+    isInitialized = false;
 
-        Serial.println("📋 Verification results:");
-        Serial.println("  - System Type: '" + verifySystemType + "'");
-        Serial.println("  - Auth Token Length: " + String(verifyAuthToken.length()));
+    // Reset to empty config
+    config = LightConfig();
+}
 
-        if (verifySystemType != config.systemType || verifyAuthToken != config.authToken)
+const char *LightManager::getSupportedSystem(int index)
+{
+    return index >= 0 && index < ControllerRegistry::count() ? ControllerRegistry::at(index).tag : nullptr;
+}
+
+int LightManager::getSupportedSystemCount()
+{
+    return ControllerRegistry::count();
+}
+
+LightConfig LightManager::createDefaultConfig(const String &systemType)
+{
+    LightConfig config;
+    config.systemType = systemType;
+    config.port = ControllerRegistry::defaultPort(ControllerRegistry::typeFromName(systemType));
+
+    return config;
+}
+
+void LightManager::loop()
+{
+    {
+        ControllerLock lock(this);
+
+        // Each system on its own readiness - an offline primary must not stall the others
+        if (isPrimaryReady())
         {
-            Serial.println("❌ Verification failed - data not correctly saved!");
-            return false;
+            animationEngine.loop();
+            currentController->loop();
         }
-        else
+
+        for (int i = 0; i < additionalControllerCount; i++)
         {
-            Serial.println("✅ Verification successful - data correctly saved");
+            if (additionalControllers[i]->isReady())
+            {
+                additionalControllers[i]->loop();
+            }
         }
     }
-    else
+
+    // Deferred network requests, with the controller mutex free for other tasks.
+    // slotMutex only excludes deleting or replacing a controller meanwhile.
+    if (!slotMutex || xSemaphoreTake(slotMutex, portMAX_DELAY) != pdTRUE)
     {
-        Serial.println("❌ Failed to save lighting configuration - some preferences failed");
+        return;
     }
 
-    return success;
+    if (currentController)
+    {
+        currentController->loopUnlocked();
+    }
+    for (int i = 0; i < additionalControllerCount; i++)
+    {
+        additionalControllers[i]->loopUnlocked();
+    }
+
+    xSemaphoreGive(slotMutex);
 }
 
-bool LightManager::loadConfiguration()
+bool LightManager::hasBackgroundWork()
 {
-    // First check if there's configuration from WiFi setup (captive portal)
-    Preferences wifiPrefs;
-    wifiPrefs.begin(DEVICE_PREF_NAMESPACE, true);
+    ControllerLock lock(this);
 
-    String systemTypeFromWifi = wifiPrefs.getString("lighting_system", "");
-    if (systemTypeFromWifi.length() > 0)
+    // Only work loop() will actually run, or the lighting task wakes for nothing
+    if (isPrimaryReady() && (isAnimating() || currentController->hasBackgroundWork()))
     {
-        Serial.println("📱 Loading lighting configuration from WiFi setup");
-        config.systemType = systemTypeFromWifi;
-        config.hostAddress = wifiPrefs.getString("lighting_host", "");
-        config.port = wifiPrefs.getInt("lighting_port", 80);
-        config.authToken = ""; // Will be auto-generated for Nanoleaf
+        return true;
+    }
 
-        // Set default ports based on system type
-        if (config.port == 0)
+    for (int i = 0; i < additionalControllerCount; i++)
+    {
+        if (additionalControllers[i]->isReady() && additionalControllers[i]->hasBackgroundWork())
         {
-            if (config.systemType == "nanoleaf")
-            {
-                config.port = 16021;
-            }
+            return true;
         }
+    }
+    return false;
+}
 
-        // Create default custom config based on system type
-        config.customConfig = createDefaultCustomConfig(config.systemType);
-
-        wifiPrefs.end();
-        return true;
+bool LightManager::createController(const String &systemType)
+{
+    // The only string match - from here on the controller is dispatched through its vtable
+    LightController *controller = ControllerRegistry::create(ControllerRegistry::typeFromName(systemType));
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    currentController = controller;
+    xSemaphoreGive(slotMutex);
+    if (!currentController)
+    {
+        LOG_E("❌ Failed to create lighting controller for type: %s", systemType.c_str());
+        LOG_I("💡 This could be due to memory allocation failure or unsupported system type");
+        return false;
     }
-    wifiPrefs.end();
 
-    // Fall back to old lighting-specific preferences
-    preferences.begin(PREF_NAMESPACE, true);
+    LOG_I("✅ Successfully created %s controller", systemType.c_str());
+    return true;
+}
 
-    config.systemType = preferences.getString(PREF_SYSTEM_TYPE, "");
+void LightManager::cleanupController()
+{
+    animationEngine.reset();
+    localPrimaryReady = false;
 
-    if (config.systemType.length() == 0)
+    if (currentController)
     {
-        preferences.end();
-        return false; // No configuration found
+        // Waits out a loopUnlocked() still running on the lighting task
+        xSemaphoreTake(slotMutex, portMAX_DELAY);
+        delete currentController;
+        currentController = nullptr;
+        xSemaphoreGive(slotMutex);
     }
+    isInitialized = false;
+}
 
-    config.hostAddress = preferences.getString(PREF_HOST_ADDRESS, "");
-    config.port = preferences.getInt(PREF_PORT, 80);
-    config.authToken = preferences.getString(PREF_AUTH_TOKEN, "");
-
-    String customConfigStr = preferences.getString(PREF_CUSTOM_CONFIG, "");
-    config.customConfig = parseCustomConfig(customConfigStr);
-
-    preferences.end();
-    return true;
+bool LightManager::isPrimaryReady() const
+{
+    return isInitialized && currentController != nullptr && currentController->isReady();
 }
 
-void LightManager::resetConfiguration()
+void LightManager::publishState() const
 {
-    Serial.println("🔄 Resetting lighting configuration");
+    primaryReady.store(isPrimaryReady());
+    authenticationPending.store(currentController != nullptr && currentController->requiresAuthentication() &&
+                                !currentController->isReady());
+    controllerCount.store((currentController ? 1 : 0) + additionalControllerCount);
+
+    portENTER_CRITICAL(&stateLock);
+    strlcpy(publishedSystemType, config.systemType.c_str(), sizeof(publishedSystemType));
+    portEXIT_CRITICAL(&stateLock);
+}
 
-    preferences.begin(PREF_NAMESPACE, false);
-    preferences.clear();
-    preferences.end();
+LightController *LightManager::controllerAt(int slot)
+{
+    return slot == 0 ? currentController : additionalControllers[slot - 1];
+}
 
-    cleanupController();
-    isInitialized = false;
+uint8_t LightManager::readyControllerMask()
+{
+    uint8_t mask = 0;
+    if (currentController && currentController->isReady())
+    {
+        mask |= 1;
+    }
 
-    // Reset to empty config
-    config = LightConfig();
+    for (int i = 0; i < additionalControllerCount; i++)
+    {
+        if (additionalControllers[i]->isReady())
+        {
+            mask |= 1 << (i + 1);
+        }
+    }
+    return mask;
 }
 
-String *LightManager::getSupportedSystems()
+bool LightManager::showOnSlot(int slot, const ColorPalette &palette)
 {
-    return LightControllerFactory::getSupportedSystems();
+    if (slot != 0)
+    {
+        return additionalControllers[slot - 1]->displayPalette(palette);
+    }
+
+    // Render on-device when the controller accepts per-pixel frames
+    if (animationEngine.start(palette, currentController))
+    {
+        return true;
+    }
+
+    animationEngine.stop();
+    return currentController->displayPalette(palette);
 }
 
-int LightManager::getSupportedSystemCount()
+void LightManager::logFanOut(const char *operation, const ControllerFanOut::Result &result)
 {
-    return LightControllerFactory::getSupportedSystemCount();
+    if (result.attempted <= 1)
+    {
+        return;
+    }
+
+    LOG_I("📡 %s: %d/%d lighting systems in %lu ms (slowest: %s, %lu ms)",
+          operation, result.succeeded, result.attempted,
+          (unsigned long)(result.elapsedMicros / 1000),
+          controllerAt(result.slowestSlot)->getSystemType().c_str(),
+          (unsigned long)(result.slowestMicros / 1000));
 }
 
-LightConfig LightManager::createDefaultConfig(const String &systemType)
+int LightManager::configureAdditionalSystems(JsonArrayConst systems)
 {
-    LightConfig config;
-    config.systemType = systemType;
+    ControllerLock lock(this);
 
-    if (systemType == "nanoleaf")
+    cleanupAdditionalControllers();
+
+    for (JsonObjectConst system : systems)
     {
-        config.port = 16021; // Default Nanoleaf port
+        if (additionalControllerCount >= LIGHT_MAX_CONTROLLERS - 1)
+        {
+            LOG_W("⚠ Only %d additional lighting systems are supported - ignoring the rest", LIGHT_MAX_CONTROLLERS - 1);
+            break;
+        }
+
+        LightConfig systemConfig;
+        systemConfig.systemType = system["systemType"] | "";
+        systemConfig.hostAddress = system["hostAddress"] | "";
+        systemConfig.port = system["port"] | ControllerRegistry::defaultPort(ControllerRegistry::typeFromName(systemConfig.systemType));
+        systemConfig.authToken = system["authToken"] | "";
+        startAdditionalController(systemConfig, system["customConfig"]);
     }
 
-    return config;
+    saveAdditionalSystems();
+
+    int ready = 0;
+    for (int i = 0; i < additionalControllerCount; i++)
+    {
+        if (additionalControllers[i]->isReady())
+        {
+            ready++;
+        }
+    }
+    return ready;
 }
 
-void LightManager::loop()
+void LightManager::controllerStatsToJson(JsonArray out)
 {
-    if (!isReady())
+    // Busy lighting task - report the previous figures rather than wait out its HTTP request
+    ControllerLock lock(this, 0);
+    if (!lock.isHeld())
     {
+        JsonDocument previous;
+        if (statsSnapshot.length() > 0 && !deserializeJson(previous, statsSnapshot))
+        {
+            for (JsonObjectConst entry : previous.as<JsonArrayConst>())
+            {
+                out.add(entry);
+            }
+        }
         return;
     }
 
-    // Nanoleaf doesn't require continuous loop processing
-    // All operations are request-response based
+    for (int slot = 0; slot <= additionalControllerCount; slot++)
+    {
+        LightController *controller = controllerAt(slot);
+        if (!controller)
+        {
+            continue;
+        }
+
+        const LightConfig &slotConfig = slot == 0 ? config : additionalConfigs[slot - 1];
+        JsonObject entry = out.add<JsonObject>();
+        entry["slot"] = slot;
+        entry["systemType"] = slotConfig.systemType;
+        entry["host"] = slotConfig.hostAddress;
+        entry["ready"] = controller->isReady();
+        fanOut.statsToJson(slot, entry);
+        controller->statsToJson(entry);
+    }
+
+    statsSnapshot = "";
+    serializeJson(out, statsSnapshot);
 }
 
-bool LightManager::createController(const String &systemType)
+bool LightManager::startAdditionalController(LightConfig systemConfig, JsonObjectConst customConfig)
 {
-    currentController = LightControllerFactory::createController(systemType);
-    if (!currentController)
+    String label = systemConfig.systemType + (systemConfig.hostAddress.length() > 0 ? " @ " + systemConfig.hostAddress : "");
+
+    // Discovery and pairing are for the primary system - an additional networked one needs its host up front
+    LightSystemType type = ControllerRegistry::typeFromName(systemConfig.systemType);
+    if (ControllerRegistry::hasCapability(type, LIGHT_CAP_NETWORK) && systemConfig.hostAddress.length() == 0)
+    {
+        LOG_W("⚠ Skipping additional lighting system without a host address: %s", label.c_str());
+        return false;
+    }
+
+    int index = additionalControllerCount;
+    additionalCustomConfigs[index].clear();
+    if (!customConfig.isNull())
+    {
+        additionalCustomConfigs[index].set(customConfig);
+    }
+    systemConfig.customConfig = additionalCustomConfigs[index].as<JsonObject>();
+    systemConfig.isPrimary = false;
+
+    LightController *controller = ControllerRegistry::create(type);
+    if (!controller)
     {
-        Serial.println("❌ Failed to create lighting controller for type: " + systemType);
-        Serial.println("💡 This could be due to memory allocation failure or unsupported system type");
+        LOG_E("❌ Failed to create additional lighting controller: %s", label.c_str());
         return false;
     }
 
-    Serial.println("✅ Successfully created " + systemType + " controller");
+    controller->setNotificationCallback([this](const String &action, const String &instructions, int timeout)
+                                        { handleUserNotification(action, instructions, timeout); });
+
+    if (!controller->initialize(systemConfig))
+    {
+        LOG_W("⚠ Additional lighting system failed to initialize: %s", label.c_str());
+    }
+    else if (!controller->isReady())
+    {
+        LOG_W("⚠ Additional lighting system not ready (missing or invalid auth token?): %s", label.c_str());
+    }
+    else
+    {
+        LOG_I("✅ Additional lighting system ready: %s", label.c_str());
+    }
+
+    // Kept even when not ready, so the next save does not drop its configuration
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    additionalControllers[index] = controller;
+    additionalControllerCount++;
+    xSemaphoreGive(slotMutex);
+    additionalConfigs[index] = systemConfig;
+    fanOut.resetStats(index + 1);
     return true;
 }
 
-void LightManager::cleanupController()
+void LightManager::cleanupAdditionalControllers()
 {
-    if (currentController)
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    for (int i = 0; i < additionalControllerCount; i++)
     {
-        delete currentController;
-        currentController = nullptr;
+        delete additionalControllers[i];
+        additionalControllers[i] = nullptr;
+        additionalConfigs[i] = LightConfig();
+        additionalCustomConfigs[i].clear();
     }
-    isInitialized = false;
+    additionalControllerCount = 0;
+    xSemaphoreGive(slotMutex);
 }
 
-JsonObject LightManager::parseCustomConfig(const String &configStr)
+int LightManager::loadAdditionalSystems()
 {
+    cleanupAdditionalControllers();
+
+    StoredConfig stored = ConfigStore::getInstance()->get();
+    if (stored.lightingAdditionalSystems[0] == '\0')
+    {
+        return 0;
+    }
+
     JsonDocument doc;
+    if (deserializeJson(doc, stored.lightingAdditionalSystems))
+    {
+        LOG_W("⚠ Stored additional lighting systems are unreadable - ignoring them");
+        return 0;
+    }
+
+    for (JsonObjectConst system : doc.as<JsonArrayConst>())
+    {
+        if (additionalControllerCount >= LIGHT_MAX_CONTROLLERS - 1)
+        {
+            break;
+        }
+
+        LightConfig systemConfig;
+        systemConfig.systemType = system["systemType"] | "";
+        systemConfig.hostAddress = system["hostAddress"] | "";
+        systemConfig.port = system["port"] | 80;
+        systemConfig.authToken = system["authToken"] | "";
+        startAdditionalController(systemConfig, system["customConfig"]);
+    }
 
+    LOG_I("📋 Loaded %d additional lighting system(s)", additionalControllerCount);
+    return additionalControllerCount;
+}
+
+void LightManager::saveAdditionalSystems()
+{
+    String serialized;
+    if (additionalControllerCount > 0)
+    {
+        JsonDocument doc;
+        JsonArray systems = doc.to<JsonArray>();
+        for (int i = 0; i < additionalControllerCount; i++)
+        {
+            JsonObject system = systems.add<JsonObject>();
+            system["systemType"] = additionalConfigs[i].systemType;
+            system["hostAddress"] = additionalConfigs[i].hostAddress;
+            system["port"] = additionalConfigs[i].port;
+            if (additionalConfigs[i].authToken.length() > 0)
+            {
+                system["authToken"] = additionalConfigs[i].authToken;
+            }
+            if (additionalCustomConfigs[i].size() > 0)
+            {
+                system["customConfig"] = additionalCustomConfigs[i];
+            }
+        }
+        serializeJson(doc, serialized);
+    }
+
+    if (serialized.length() >= sizeof(StoredConfig::lightingAdditionalSystems))
+    {
+        LOG_E("❌ Additional lighting systems do not fit in the config store - not saved");
+        return;
+    }
+
+    ConfigStore::getInstance()->update([&](StoredConfig &stored)
+                                       { ConfigStore::setField(stored.lightingAdditionalSystems, serialized); });
+}
+
+JsonObject LightManager::parseCustomConfig(const String &configStr)
+{
+    // Parsed into the member document so the returned object outlives this call
     if (configStr.length() > 0)
     {
-        DeserializationError error = deserializeJson(doc, configStr);
-        if (!error)
+        DeserializationError error = deserializeJson(customConfigDoc, configStr);
+        if (!error && customConfigDoc.is<JsonObject>())
         {
-            return doc.as<JsonObject>();
+            return customConfigDoc.as<JsonObject>();
         }
     }
 
     // Return empty object if parsing fails
-    return doc.to<JsonObject>();
+    return customConfigDoc.to<JsonObject>();
 }
 
 String LightManager::serializeCustomConfig(const JsonObject &config)
@@ -668,66 +1085,205 @@ String LightManager::serializeCustomConfig(const JsonObject &config)
 
 JsonObject LightManager::createDefaultCustomConfig(const String &systemType)
 {
-    JsonDocument doc;
+    // No backend needs defaults yet - Nanoleaf discovers its layout, WS2812 falls back to DEFAULT_LED_PIN
+    return customConfigDoc.to<JsonObject>();
+}
 
-    if (systemType == "nanoleaf")
+void LightManager::handleUserNotification(const String &action, const String &instructions, int timeout)
+{
+    LOG_I("🔔 User Action Required:");
+    LOG_I("   Action: %s", action.c_str());
+    LOG_I("   Instructions: %s", instructions.c_str());
+    if (timeout > 0)
     {
-        // Nanoleaf config will be auto-discovered
+        LOG_I("   Timeout: %d seconds", timeout);
     }
 
-    return doc.as<JsonObject>();
+    // Raised on the lighting task mid-pairing - forwarded by dispatchEvents() on the network task
+    if (stagingMutex && xSemaphoreTake(stagingMutex, portMAX_DELAY) == pdTRUE)
+    {
+        notificationAction = action;
+        notificationInstructions = instructions;
+        notificationTimeout = timeout;
+        notificationPending = true;
+        xSemaphoreGive(stagingMutex);
+    }
 }
 
-void LightManager::handleUserNotification(const String &action, const String &instructions, int timeout)
+bool LightManager::requestConfigure(const String &systemType, const String &hostAddress,
+                                    int port, const String &authToken, JsonObjectConst customConfig)
 {
-    Serial.println("🔔 User Action Required:");
-    Serial.println("   Action: " + action);
-    Serial.println("   Instructions: " + instructions);
-    if (timeout > 0)
+    if (!stagingMutex || xSemaphoreTake(stagingMutex, portMAX_DELAY) != pdTRUE)
+    {
+        return false;
+    }
+    stagedConfig.systemType = systemType;
+    stagedConfig.hostAddress = hostAddress;
+    stagedConfig.port = port;
+    stagedConfig.authToken = authToken;
+    stagedCustomConfig.clear();
+    if (!customConfig.isNull())
+    {
+        stagedCustomConfig.set(customConfig);
+    }
+    xSemaphoreGive(stagingMutex);
+
+    return postRequests(REQUEST_CONFIGURE);
+}
+
+bool LightManager::requestAuthentication()
+{
+    return postRequests(REQUEST_AUTHENTICATE);
+}
+
+bool LightManager::requestConnectionTest()
+{
+    return postRequests(REQUEST_TEST);
+}
+
+bool LightManager::requestAdditionalSystems(JsonArrayConst systems)
+{
+    if (!stagingMutex || xSemaphoreTake(stagingMutex, portMAX_DELAY) != pdTRUE)
+    {
+        return false;
+    }
+    stagedAdditionalSystems.clear();
+    stagedAdditionalSystems.to<JsonArray>();
+    if (!systems.isNull())
     {
-        Serial.println("   Timeout: " + String(timeout) + " seconds");
+        stagedAdditionalSystems.set(systems);
     }
+    xSemaphoreGive(stagingMutex);
 
-    // Forward to external callback (e.g., WebSocket client for mobile app notification)
-    if (userNotificationCallback)
+    return postRequests(REQUEST_ADDITIONAL);
+}
+
+bool LightManager::postRequests(uint8_t requests)
+{
+    if (lightingTask.isRunning())
     {
-        userNotificationCallback(action, instructions, timeout);
+        return lightingTask.submitRequests(requests);
+    }
+
+    // No lighting task - the caller waits, as it always did
+    runRequests(requests);
+    return true;
+}
+
+void LightManager::runRequests(uint8_t requests)
+{
+    if (requests & REQUEST_CONFIGURE)
+    {
+        LightConfig staged;
+        JsonDocument stagedCustom;
+        xSemaphoreTake(stagingMutex, portMAX_DELAY);
+        staged = stagedConfig;
+        stagedCustom.set(stagedCustomConfig);
+        xSemaphoreGive(stagingMutex);
+
+        bool success = configure(staged.systemType, staged.hostAddress, staged.port, staged.authToken,
+                                 stagedCustom.as<JsonObject>());
+        completeRequest(REQUEST_CONFIGURE, success);
+
+        // A system that pairs does so right after it was set up
+        if (success && ControllerRegistry::hasCapability(ControllerRegistry::typeFromName(staged.systemType),
+                                                         LIGHT_CAP_AUTHENTICATION))
+        {
+            requests |= REQUEST_AUTHENTICATE;
+        }
+    }
+
+    if (requests & REQUEST_ADDITIONAL)
+    {
+        JsonDocument staged;
+        xSemaphoreTake(stagingMutex, portMAX_DELAY);
+        staged.set(stagedAdditionalSystems);
+        xSemaphoreGive(stagingMutex);
+
+        JsonArrayConst systems = staged.as<JsonArrayConst>();
+        int ready = configureAdditionalSystems(systems);
+        LOG_I("📡 Additional lighting systems: %d/%u ready", ready, (unsigned)systems.size());
+        completeRequest(REQUEST_ADDITIONAL, ready == (int)systems.size());
+    }
+
+    if (requests & REQUEST_AUTHENTICATE)
+    {
+        completeRequest(REQUEST_AUTHENTICATE, authenticateLightingSystem());
+    }
+
+    if (requests & REQUEST_TEST)
+    {
+        completeRequest(REQUEST_TEST, testConnection());
+    }
+}
+
+void LightManager::completeRequest(Request request, bool success)
+{
+    completedRequests.fetch_or(request | (success ? request << 8 : 0));
+}
+
+void LightManager::dispatchEvents()
+{
+    if (notificationPending && xSemaphoreTake(stagingMutex, portMAX_DELAY) == pdTRUE)
+    {
+        String action = notificationAction;
+        String instructions = notificationInstructions;
+        int timeout = notificationTimeout;
+        bool pending = notificationPending.exchange(false);
+        xSemaphoreGive(stagingMutex);
+
+        // Forward to external callback (e.g., WebSocket client for mobile app notification)
+        if (pending && userNotificationCallback)
+        {
+            userNotificationCallback(action, instructions, timeout);
+        }
+    }
+
+    uint16_t completed = completedRequests.exchange(0);
+    for (uint8_t request = REQUEST_CONFIGURE; request <= REQUEST_ADDITIONAL; request <<= 1)
+    {
+        if ((completed & request) && requestCallback)
+        {
+            requestCallback(static_cast<Request>(request), (completed >> 8) & request);
+        }
     }
 }
 
 bool LightManager::retryInitialization()
 {
-    if (isInitialized && currentController != nullptr && currentController->isReady())
+    ControllerLock lock(this);
+
+    if (isPrimaryReady())
     {
-        Serial.println("💡 Light controller is already working correctly");
+        LOG_I("💡 Light controller is already working correctly");
         return true;
     }
 
-    Serial.println("🔄 Retrying lighting system initialization...");
+    LOG_I("🔄 Retrying lighting system initialization...");
 
     if (currentController != nullptr && config.systemType.length() > 0)
     {
-        Serial.println("🔄 Attempting to re-initialize " + config.systemType + " controller...");
-        Serial.println("🔍 Config details:");
-        Serial.println("  - System Type: " + config.systemType);
-        Serial.println("  - Host Address: '" + config.hostAddress + "'");
-        Serial.println("  - Port: " + String(config.port));
-        Serial.println(String("  - Auth Token: ") + (config.authToken.length() > 0 ? "Present" : "None"));
+        LOG_I("🔄 Attempting to re-initialize %s controller...", config.systemType.c_str());
+        LOG_I("🔍 Config details:");
+        LOG_I("  - System Type: %s", config.systemType.c_str());
+        LOG_I("  - Host Address: '%s'", config.hostAddress.c_str());
+        LOG_I("  - Port: %d", config.port);
+        LOG_I("  - Auth Token: %s", config.authToken.length() > 0 ? "Present" : "None");
 
         if (currentController->initialize(config))
         {
-            Serial.println("✅ Lighting controller initialized successfully on retry");
+            LOG_I("✅ Lighting controller initialized successfully on retry");
             return true;
         }
         else
         {
-            Serial.println("❌ Lighting controller initialization failed on retry");
+            LOG_E("❌ Lighting controller initialization failed on retry");
             return false;
         }
     }
     else
     {
-        Serial.println("⚠ No controller or configuration available for retry");
+        LOG_W("⚠ No controller or configuration available for retry");
         return false;
     }
 }
@@ -2,32 +2,125 @@
 #define LIGHT_MANAGER_H
 
 #include "LightController.h"
+#include "AnimationEngine.h"
+#include "LightingTask.h"
+#include "ControllerFanOut.h"
+#include "PaletteHistory.h"
 #include <ArduinoJson.h>
-#include <Preferences.h>
+#include <atomic>
 
 /**
  * Light Manager
  * This class manages the lighting system configuration and provides
  * a unified interface for the main application to control lights
  * regardless of the underlying system (Nanoleaf, WLED, WS2812, etc.)
+ *
+ * Besides the primary system, up to LIGHT_MAX_CONTROLLERS - 1 additional
+ * systems can mirror every palette. Palette, brightness and off commands
+ * fan out to all ready systems concurrently (see ControllerFanOut); the
+ * primary keeps on-device animation, the others show the palette their
+ * own way.
+ *
+ * Controllers are only driven under controllerMutex, which the lighting
+ * task holds across device I/O. The network task therefore never takes it
+ * for routine work: readiness, system type, controller count and stats are
+ * published as snapshots, and configuration work (switching systems,
+ * pairing, connection tests) is posted as a Request that the lighting task
+ * runs. Completions and user notifications come back through
+ * dispatchEvents() on the network task. Slow requests a controller defers
+ * from its loop() run in loopUnlocked() with controllerMutex released.
  */
 class LightManager
 {
 private:
     LightController *currentController;
+    LightController *additionalControllers[LIGHT_MAX_CONTROLLERS - 1];
+    LightConfig additionalConfigs[LIGHT_MAX_CONTROLLERS - 1];
+    JsonDocument additionalCustomConfigs[LIGHT_MAX_CONTROLLERS - 1]; // Own additionalConfigs[n].customConfig
+    int additionalControllerCount;
+    ControllerFanOut fanOut; // Slot 0 = currentController, slot n = additionalControllers[n - 1]
+    AnimationEngine animationEngine;
+    LightingTask lightingTask;
+    SemaphoreHandle_t controllerMutex; // Recursive - serializes lighting and network task access
+    SemaphoreHandle_t slotMutex;       // Held around loopUnlocked() and whenever a controller slot changes
     LightConfig config;
-    Preferences preferences;
+    JsonDocument customConfigDoc; // Owns config.customConfig
     bool isInitialized;
+    bool localPrimaryReady; // Primary brought up by beginLocal(), not yet taken over by begin()
+
+    // State as last seen under controllerMutex - read without it
+    mutable std::atomic<bool> primaryReady{false};
+    mutable std::atomic<bool> authenticationPending{false};
+    mutable std::atomic<uint8_t> controllerCount{0};
+    mutable portMUX_TYPE stateLock = portMUX_INITIALIZER_UNLOCKED;
+    mutable char publishedSystemType[24]; // Under stateLock
+    String statsSnapshot;                 // Last controllerStatsToJson() output (network task only)
+
+    // Hand-over between the network task and the lighting task (held only to copy)
+    SemaphoreHandle_t stagingMutex;
+    LightConfig stagedConfig; // For REQUEST_CONFIGURE
+    JsonDocument stagedCustomConfig;
+    JsonDocument stagedAdditionalSystems; // For REQUEST_ADDITIONAL
+    std::atomic<bool> notificationPending{false};
+    String notificationAction;
+    String notificationInstructions;
+    int notificationTimeout;
+    std::atomic<uint16_t> completedRequests{0}; // Low byte: done, high byte: succeeded
+
+    // Received palettes in flash, and the local shuffle over them
+    PaletteHistory paletteHistory;
+    bool shuffleEnabled;
+    uint32_t shuffleInterval;
+    unsigned long lastShuffleTime;
 
-    // Configuration keys for EEPROM storage
-    static const char *PREF_NAMESPACE;
-    static const char *PREF_SYSTEM_TYPE;
-    static const char *PREF_HOST_ADDRESS;
-    static const char *PREF_PORT;
-    static const char *PREF_AUTH_TOKEN;
-    static const char *PREF_CUSTOM_CONFIG;
+    /**
+     * Scoped hold on controllerMutex for methods that touch the controller
+     * Republishes the readiness flags on release, so they follow every change
+     */
+    class ControllerLock
+    {
+    public:
+        explicit ControllerLock(const LightManager *owner, TickType_t wait = portMAX_DELAY)
+            : owner(owner),
+              held(!owner->controllerMutex || xSemaphoreTakeRecursive(owner->controllerMutex, wait) == pdTRUE)
+        {
+        }
+
+        ~ControllerLock()
+        {
+            if (!held)
+            {
+                return;
+            }
+            owner->publishState();
+            if (owner->controllerMutex)
+            {
+                xSemaphoreGiveRecursive(owner->controllerMutex);
+            }
+        }
+
+        bool isHeld() const { return held; } // Only false when a timeout was given
+
+    private:
+        const LightManager *owner;
+        bool held;
+    };
+
+    bool isPrimaryReady() const; // Under controllerMutex
+    void publishState() const;
 
 public:
+    /**
+     * Work posted to the lighting task (bits - several may be pending at once)
+     */
+    enum Request : uint8_t
+    {
+        REQUEST_CONFIGURE = 1 << 0,    // Switch to the staged primary system (pairs it too, if it needs that)
+        REQUEST_AUTHENTICATE = 1 << 1, // authenticateLightingSystem()
+        REQUEST_TEST = 1 << 2,         // testConnection()
+        REQUEST_ADDITIONAL = 1 << 3    // Replace the additional systems with the staged set (succeeds if all are ready)
+    };
+
     LightManager();
     ~LightManager();
 
@@ -43,6 +136,14 @@ public:
      */
     bool beginWithoutConfig();
 
+    /**
+     * Bring up the saved primary system right away if it needs no network
+     * (e.g. a WS2812 strip), so the last palette shows before WiFi is up.
+     * The following begin() keeps it and only adds the additional systems.
+     * @return true if a local primary system is now initialized
+     */
+    bool beginLocal();
+
     /**
      * Configure the lighting system
      * @param systemType Type of lighting system (nanoleaf, wled, ws2812)
@@ -55,11 +156,101 @@ public:
                    int port = 80, const String &authToken = "",
                    const JsonObject &customConfig = JsonObject());
 
+    /**
+     * configure() on the lighting task, followed by authenticateLightingSystem()
+     * when the system pairs - the result arrives through the request callback
+     * (REQUEST_CONFIGURE, then REQUEST_AUTHENTICATE). Runs in place if the
+     * lighting task is not running.
+     */
+    bool requestConfigure(const String &systemType, const String &hostAddress,
+                          int port, const String &authToken, JsonObjectConst customConfig);
+
+    /**
+     * authenticateLightingSystem() / testConnection() on the lighting task
+     * (result through the request callback)
+     */
+    bool requestAuthentication();
+    bool requestConnectionTest();
+
+    /**
+     * configureAdditionalSystems() on the lighting task, so their connection
+     * checks don't run on the caller (result through the request callback)
+     */
+    bool requestAdditionalSystems(JsonArrayConst systems);
+
+    /**
+     * Run posted requests (lighting task)
+     */
+    void runRequests(uint8_t requests);
+
+    /**
+     * Deliver request completions and user notifications to their callbacks
+     * Call from the network task - the callbacks may use the WebSocket
+     */
+    void dispatchEvents();
+
+    /**
+     * Set callback for finished requests (called from dispatchEvents())
+     */
+    void setRequestCallback(std::function<void(Request request, bool success)> callback)
+    {
+        requestCallback = callback;
+    }
+
     /**
      * Display a color palette on the configured lighting system
+     * Streaming-capable controllers render palette.animation on-device
+     * from loop(); others fall back to the controller's own display path
      */
     bool displayPalette(const ColorPalette &palette);
 
+    /**
+     * Hand a palette to the lighting task without blocking the caller
+     * A palette still waiting when a newer one arrives is replaced
+     * Falls back to a synchronous displayPalette() if the task is not running
+     */
+    bool submitPalette(const ColorPalette &palette);
+
+    /**
+     * Hand a brightness change to the lighting task without blocking the caller
+     * Falls back to a synchronous setBrightness() if the task is not running
+     */
+    bool submitBrightness(int brightness);
+
+    /**
+     * Counters for the lighting command queue (submitted, coalesced, dropped, delivered)
+     */
+    LightCommandQueue::Stats getCommandStats() const { return lightingTask.getQueueStats(); }
+
+    /**
+     * Start the dedicated lighting task (call once from setup)
+     * @return true if lighting output now runs on its own task
+     */
+    bool startLightingTask();
+
+    /**
+     * Check if lighting output runs on the dedicated task
+     */
+    bool hasLightingTask() const { return lightingTask.isRunning(); }
+
+    /**
+     * Check if an on-device animation is currently rendering
+     */
+    bool isAnimating() const { return animationEngine.isRunning(); }
+
+    /**
+     * Check if loop() has work to do (animation frames or deferred controller work)
+     */
+    bool hasBackgroundWork();
+
+    /**
+     * How often loop() should run while it has background work (ms)
+     */
+    unsigned long getFrameInterval() const
+    {
+        return animationEngine.isRunning() ? animationEngine.getFrameInterval() : ANIMATION_FRAME_INTERVAL;
+    }
+
     /**
      * Turn off all lights
      */
@@ -101,9 +292,9 @@ public:
     LightConfig getConfig() const { return config; }
 
     /**
-     * Get current system type
+     * Get current system type (lock-free snapshot)
      */
-    String getCurrentSystemType();
+    String getCurrentSystemType() const;
 
     /**
      * Perform authentication for systems that require it
@@ -114,20 +305,20 @@ public:
 
     /**
      * Check if lighting system requires user authentication
+     * Lock-free, like isReady()
      * @return true if user interaction is needed for authentication
      */
-    bool requiresUserAuthentication();
+    bool requiresUserAuthentication() const { return authenticationPending.load(); }
 
     /**
-     * Check if manager is properly initialized
+     * Check if manager is properly initialized and the primary system is ready
+     * Lock-free - never waits behind lighting I/O on the lighting task
      */
-    bool isReady() const
-    {
-        return isInitialized && currentController != nullptr && currentController->isReady();
-    }
+    bool isReady() const { return primaryReady.load(); }
 
     /**
      * Set callback for user notifications (e.g., WebSocket client)
+     * Called from dispatchEvents(), whichever task the controller raised it on
      */
     void setUserNotificationCallback(std::function<void(const String &, const String &, int)> callback)
     {
@@ -150,9 +341,11 @@ public:
     void resetConfiguration();
 
     /**
-     * Get list of supported lighting systems
+     * Get a lighting system built into this firmware
+     * @param index 0 to getSupportedSystemCount() - 1
+     * @return Configuration tag ("nanoleaf", ...), or nullptr if out of range
      */
-    static String *getSupportedSystems();
+    static const char *getSupportedSystem(int index);
 
     /**
      * Get count of supported systems
@@ -164,8 +357,64 @@ public:
      */
     static LightConfig createDefaultConfig(const String &systemType);
 
+    /**
+     * Replace the set of additional systems that mirror the primary one (persisted)
+     * Initializes each system in place - other tasks use requestAdditionalSystems()
+     * @param systems Array of {"systemType", "hostAddress", "port", "authToken", "customConfig"}; empty clears them
+     * @return Number of additional systems now ready
+     */
+    int configureAdditionalSystems(JsonArrayConst systems);
+
+    /**
+     * Number of lighting systems driven (primary included, lock-free)
+     */
+    int getControllerCount() const { return controllerCount.load(); }
+
+    /**
+     * Per-system latency and failure counters from the fan-out, plus each
+     * controller's own counters (e.g. Nanoleaf "payloadCache")
+     * Never waits for the lighting task: while it is busy with a device the
+     * figures from the previous call are reported. Network task only.
+     * @param out One object per system ("slot", "systemType", "host", "ready", "calls", ...)
+     */
+    void controllerStatsToJson(JsonArray out);
+
+    /**
+     * Show the newest palette in the history (e.g. the one received before the last restart)
+     * @return true if a stored palette was handed to the lights
+     */
+    bool restoreLastPalette();
+
+    /**
+     * Log a palette received from the server (no flash access - written later by historyLoop())
+     * A live palette also ends shuffle mode
+     */
+    void recordPalette(const ColorPalette &palette);
+
+    /**
+     * Replay the history locally in random order, without the server
+     * @param enabled Start or stop shuffling
+     * @param intervalMs Time each palette stays up (at least PALETTE_SHUFFLE_MIN_INTERVAL)
+     */
+    void setShuffle(bool enabled, uint32_t intervalMs = PALETTE_SHUFFLE_DEFAULT_INTERVAL);
+    bool isShuffling() const { return shuffleEnabled; }
+
+    /**
+     * Write due history records and advance the shuffle
+     * Call from the main loop task - this is where flash is touched
+     */
+    void historyLoop();
+
+    /**
+     * Write queued history records now (before a restart)
+     */
+    void flushPaletteHistory() { paletteHistory.flush(true); }
+
+    void historyToJson(JsonObject out);
+
     /**
      * Update loop - call this in main loop for animations
+     * Renders at most one animation frame per call and never blocks
      */
     void loop();
 
@@ -178,6 +427,16 @@ public:
 private:
     bool createController(const String &systemType);
     void cleanupController();
+
+    // Additional systems
+    LightController *controllerAt(int slot);
+    uint8_t readyControllerMask();
+    bool showOnSlot(int slot, const ColorPalette &palette);
+    void logFanOut(const char *operation, const ControllerFanOut::Result &result);
+    bool startAdditionalController(LightConfig systemConfig, JsonObjectConst customConfig);
+    void cleanupAdditionalControllers();
+    int loadAdditionalSystems();
+    void saveAdditionalSystems();
     JsonObject parseCustomConfig(const String &configStr);
     String serializeCustomConfig(const JsonObject &config);
     JsonObject createDefaultCustomConfig(const String &systemType);
@@ -185,6 +444,9 @@ private:
     // User notification handling
     void handleUserNotification(const String &action, const String &instructions, int timeout);
     std::function<void(const String &, const String &, int)> userNotificationCallback;
+    std::function<void(Request, bool)> requestCallback;
+    bool postRequests(uint8_t requests);
+    void completeRequest(Request request, bool success);
 };
 
 #endif // LIGHT_MANAGER_H
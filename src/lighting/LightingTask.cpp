@@ -0,0 +1,142 @@
+#include "LightingTask.h"
+#include "LightManager.h"
+#include "../core/Log.h"
+#include "../core/MemoryTelemetry.h"
+
+static const char *const LOG_TAG = "lighttask";
+
+LightingTask::LightingTask(LightManager *lightManager)
+    : lightManager(lightManager), taskHandle(nullptr)
+{
+}
+
+LightingTask::~LightingTask()
+{
+    if (taskHandle)
+    {
+        MemoryTelemetry::getInstance()->unwatchTask(taskHandle);
+        vTaskDelete(taskHandle);
+        taskHandle = nullptr;
+    }
+}
+
+bool LightingTask::begin()
+{
+    if (taskHandle)
+    {
+        return true;
+    }
+
+    if (!commandQueue.begin())
+    {
+        LOG_E("❌ Failed to create lighting command queue");
+        return false;
+    }
+
+#if portNUM_PROCESSORS > 1
+    BaseType_t result = xTaskCreatePinnedToCore(taskEntry, "lighting", LIGHTING_TASK_STACK_SIZE, this,
+                                                LIGHTING_TASK_PRIORITY, &taskHandle, LIGHTING_TASK_CORE);
+#else
+    BaseType_t result = xTaskCreate(taskEntry, "lighting", LIGHTING_TASK_STACK_SIZE, this,
+                                    LIGHTING_TASK_PRIORITY, &taskHandle);
+#endif
+
+    if (result != pdPASS)
+    {
+        LOG_E("❌ Failed to start lighting task");
+        taskHandle = nullptr;
+        return false;
+    }
+
+    MemoryTelemetry::getInstance()->watchTask(taskHandle, LIGHTING_TASK_STACK_SIZE);
+    LOG_I("✅ Lighting task started");
+    return true;
+}
+
+bool LightingTask::submitPalette(const ColorPalette &palette)
+{
+    if (!taskHandle)
+    {
+        return false;
+    }
+
+    return commandQueue.submitPalette(palette);
+}
+
+bool LightingTask::submitBrightness(int brightness)
+{
+    if (!taskHandle)
+    {
+        return false;
+    }
+
+    return commandQueue.submitBrightness(brightness);
+}
+
+bool LightingTask::submitRequests(uint8_t requests)
+{
+    if (!taskHandle)
+    {
+        return false;
+    }
+
+    return commandQueue.submitRequests(requests);
+}
+
+void LightingTask::taskEntry(void *parameter)
+{
+    static_cast<LightingTask *>(parameter)->run();
+}
+
+void LightingTask::run()
+{
+    ColorPalette palette;
+    int brightness;
+    uint8_t requests;
+
+    for (;;)
+    {
+        // Wake for the next frame while animating (or while the controller has deferred work),
+        // otherwise sleep until a command arrives
+        TickType_t wait = lightManager->hasBackgroundWork() ? pdMS_TO_TICKS(lightManager->getFrameInterval()) : portMAX_DELAY;
+        commandQueue.waitForCommand(wait);
+
+        // Configuration first - a palette sent right after a new system was set belongs on it
+        if (commandQueue.takeRequests(requests))
+        {
+            lightManager->runRequests(requests);
+        }
+
+        // Only the newest palette survives a burst - older ones were coalesced away
+        uint32_t paletteSequence = 0;
+        uint32_t brightnessSequence = 0;
+        bool hasPalette = commandQueue.takePalette(palette, paletteSequence);
+        bool hasBrightness = commandQueue.takeBrightness(brightness, brightnessSequence);
+
+        // Both pending: keep the order they were posted in
+        if (hasBrightness && (!hasPalette || LightCommandQueue::before(brightnessSequence, paletteSequence)))
+        {
+            lightManager->setBrightness(brightness);
+            hasBrightness = false;
+        }
+
+        if (hasPalette)
+        {
+            if (lightManager->displayPalette(palette))
+            {
+                LOG_I("✅ Palette successfully displayed on lights");
+            }
+            else
+            {
+                LOG_E("❌ Failed to display palette on lights");
+            }
+        }
+
+        if (hasBrightness)
+        {
+            lightManager->setBrightness(brightness);
+        }
+
+        lightManager->loop();
+    }
+}
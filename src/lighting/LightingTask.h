@@ -0,0 +1,65 @@
+#ifndef LIGHTING_TASK_H
+#define LIGHTING_TASK_H
+
+#include "LightController.h"
+#include "LightCommandQueue.h"
+#include "../config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+class LightManager;
+
+/**
+ * Lighting Task
+ * Dedicated FreeRTOS task that owns lighting output. The network side
+ * (Arduino loop task) only posts commands to a latest-wins
+ * LightCommandQueue, so a slow lighting system never delays WebSocket
+ * polling and a slow TLS read never stalls animation frames. A palette
+ * and a brightness change pending together are applied in the order they
+ * were posted. On dual-core chips the task is pinned to the core the
+ * Arduino loop is not running on.
+ */
+class LightingTask
+{
+public:
+    explicit LightingTask(LightManager *lightManager);
+    ~LightingTask();
+
+    /**
+     * Create the command queue and start the task
+     * @return true if the task is running
+     */
+    bool begin();
+
+    /**
+     * Post a palette without blocking; replaces any palette not yet displayed
+     * @return false if the task is not running
+     */
+    bool submitPalette(const ColorPalette &palette);
+
+    /**
+     * Post a brightness change without blocking; replaces any pending one
+     * @return false if the task is not running
+     */
+    bool submitBrightness(int brightness);
+
+    /**
+     * Post configuration requests (LightManager::Request bits) without blocking
+     * @return false if the task is not running
+     */
+    bool submitRequests(uint8_t requests);
+
+    bool isRunning() const { return taskHandle != nullptr; }
+
+    LightCommandQueue::Stats getQueueStats() const { return commandQueue.getStats(); }
+
+private:
+    LightManager *lightManager;
+    LightCommandQueue commandQueue;
+    TaskHandle_t taskHandle;
+
+    static void taskEntry(void *parameter);
+    void run();
+};
+
+#endif // LIGHTING_TASK_H
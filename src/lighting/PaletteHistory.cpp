@@ -0,0 +1,400 @@
+#include "PaletteHistory.h"
+#include <LittleFS.h>
+#include <stddef.h>
+#include "../core/Log.h"
+
+static const char *const LOG_TAG = "history";
+
+// FNV-1a, chainable
+static uint32_t fnv1a(const void *data, size_t length, uint32_t hash = 2166136261u)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+PaletteHistory::PaletteHistory()
+    : pendingCount(0), nextSequence(1), lastAppendTime(0), mounted(false), shuffleRemaining(0), lastShownHash(0)
+{
+    memset(slots, 0, sizeof(slots));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void PaletteHistory::erase()
+{
+    // Mounting again is a no-op when begin() already did it
+    if (LittleFS.begin(false) && LittleFS.exists(PALETTE_HISTORY_FILE))
+    {
+        if (LittleFS.remove(PALETTE_HISTORY_FILE))
+        {
+            LOG_I("🗑 Palette history erased");
+        }
+        else
+        {
+            LOG_W("⚠ Cannot remove %s", PALETTE_HISTORY_FILE);
+        }
+    }
+}
+
+bool PaletteHistory::begin()
+{
+    // Formats the partition on first use (or when it holds something else)
+    if (!LittleFS.begin(true))
+    {
+        LOG_W("⚠ LittleFS unavailable - palette history kept in RAM only");
+        return false;
+    }
+    mounted = true;
+
+    const size_t fileSize = sizeof(Record) * PALETTE_HISTORY_CAPACITY;
+    File file = LittleFS.open(PALETTE_HISTORY_FILE, FILE_READ);
+    if (!file || file.size() != fileSize)
+    {
+        if (file)
+        {
+            file.close();
+        }
+
+        // Missing, or written with another record layout - start a fresh, preallocated ring
+        file = LittleFS.open(PALETTE_HISTORY_FILE, FILE_WRITE);
+        if (!file)
+        {
+            LOG_E("❌ Cannot create %s", PALETTE_HISTORY_FILE);
+            stats.failures++;
+            mounted = false;
+            return false;
+        }
+
+        Record empty;
+        memset(&empty, 0, sizeof(empty));
+        for (int i = 0; i < PALETTE_HISTORY_CAPACITY; i++)
+        {
+            file.write(reinterpret_cast<const uint8_t *>(&empty), sizeof(empty));
+        }
+        file.close();
+        LOG_I("📚 Palette history created (%d slots, %u bytes)", PALETTE_HISTORY_CAPACITY, (unsigned)fileSize);
+        return true;
+    }
+
+    Record record;
+    uint32_t newest = 0;
+    int valid = 0;
+    for (int i = 0; i < PALETTE_HISTORY_CAPACITY; i++)
+    {
+        if (file.read(reinterpret_cast<uint8_t *>(&record), sizeof(record)) != sizeof(record))
+        {
+            break;
+        }
+
+        // A torn write fails the checksum and just leaves the slot empty
+        if (record.sequence == 0 || record.checksum != checksumOf(record) ||
+            (record.sequence - 1) % PALETTE_HISTORY_CAPACITY != (uint32_t)i)
+        {
+            continue;
+        }
+
+        slots[i].sequence = record.sequence;
+        slots[i].contentHash = contentHashOf(record);
+        newest = max(newest, record.sequence);
+        valid++;
+    }
+    file.close();
+
+    nextSequence = newest + 1;
+    LOG_I("📚 Palette history: %d palettes", valid);
+    return true;
+}
+
+void PaletteHistory::append(const ColorPalette &palette)
+{
+    if (palette.colorCount <= 0)
+    {
+        return;
+    }
+
+    Record record;
+    toRecord(palette, record);
+    uint32_t hash = contentHashOf(record);
+
+    portENTER_CRITICAL(&lock);
+    int newest = newestSlot();
+    uint32_t newestHash = pendingCount > 0 ? contentHashOf(pending[pendingCount - 1])
+                                           : (newest >= 0 ? slots[newest].contentHash : 0);
+    lastShownHash = hash;
+
+    // Re-sending (or restoring) the palette that is already newest must not rewrite flash
+    if ((pendingCount > 0 || newest >= 0) && hash == newestHash)
+    {
+        stats.duplicates++;
+        portEXIT_CRITICAL(&lock);
+        return;
+    }
+
+    if (pendingCount == PALETTE_HISTORY_MAX_PENDING)
+    {
+        memmove(pending, pending + 1, (PALETTE_HISTORY_MAX_PENDING - 1) * sizeof(Record));
+        pendingCount--;
+        stats.dropped++;
+    }
+
+    record.sequence = nextSequence++;
+    record.checksum = checksumOf(record);
+    pending[pendingCount++] = record;
+    lastAppendTime = millis();
+    stats.appended++;
+    portEXIT_CRITICAL(&lock);
+}
+
+void PaletteHistory::flush(bool force)
+{
+    if (!mounted)
+    {
+        return; // Pending records stay in RAM for latest()
+    }
+
+    Record batch[PALETTE_HISTORY_MAX_PENDING];
+    portENTER_CRITICAL(&lock);
+    int batchCount = pendingCount;
+    if (batchCount == 0 || (!force && millis() - lastAppendTime < PALETTE_HISTORY_WRITE_DELAY))
+    {
+        portEXIT_CRITICAL(&lock);
+        return;
+    }
+    memcpy(batch, pending, batchCount * sizeof(Record));
+    pendingCount = 0;
+    portEXIT_CRITICAL(&lock);
+
+    File file = LittleFS.open(PALETTE_HISTORY_FILE, "r+");
+    if (!file)
+    {
+        LOG_W("⚠ Cannot open %s - %d palettes not saved", PALETTE_HISTORY_FILE, batchCount);
+        stats.failures++;
+        return;
+    }
+
+    // One open for the whole batch; each record overwrites its own slot in place
+    int written = 0;
+    for (int i = 0; i < batchCount; i++)
+    {
+        int slot = (batch[i].sequence - 1) % PALETTE_HISTORY_CAPACITY;
+        if (!file.seek(slot * sizeof(Record), SeekSet) ||
+            file.write(reinterpret_cast<const uint8_t *>(&batch[i]), sizeof(Record)) != sizeof(Record))
+        {
+            stats.failures++;
+            continue;
+        }
+
+        portENTER_CRITICAL(&lock);
+        slots[slot].sequence = batch[i].sequence;
+        slots[slot].contentHash = contentHashOf(batch[i]);
+        portEXIT_CRITICAL(&lock);
+        written++;
+    }
+    file.close();
+
+    stats.batches++;
+    stats.written += written;
+    LOG_D("💾 Palette history: %d of %d records written", written, batchCount);
+}
+
+bool PaletteHistory::latest(ColorPalette &out)
+{
+    portENTER_CRITICAL(&lock);
+    if (pendingCount > 0)
+    {
+        Record record = pending[pendingCount - 1];
+        lastShownHash = contentHashOf(record);
+        portEXIT_CRITICAL(&lock);
+        toPalette(record, out);
+        return true;
+    }
+    int slot = newestSlot();
+    portEXIT_CRITICAL(&lock);
+
+    Record record;
+    if (slot < 0 || !readSlot(slot, record))
+    {
+        return false;
+    }
+
+    lastShownHash = slots[slot].contentHash;
+    toPalette(record, out);
+    return true;
+}
+
+bool PaletteHistory::nextShuffle(ColorPalette &out)
+{
+    // At most one refill: a pass can end on the palette that is showing
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (shuffleRemaining == 0)
+        {
+            refillShuffleBag();
+            if (shuffleRemaining < 2)
+            {
+                shuffleRemaining = 0;
+                return false;
+            }
+        }
+
+        while (shuffleRemaining > 0)
+        {
+            int slot = shuffleBag[--shuffleRemaining];
+
+            Record record;
+            if (slots[slot].contentHash == lastShownHash || !readSlot(slot, record))
+            {
+                continue;
+            }
+
+            lastShownHash = slots[slot].contentHash;
+            toPalette(record, out);
+            return true;
+        }
+    }
+    return false;
+}
+
+int PaletteHistory::getCount() const
+{
+    portENTER_CRITICAL(&lock);
+    int count = 0;
+    for (const Slot &slot : slots)
+    {
+        count += slot.sequence != 0;
+    }
+    // Pending records land in empty slots until the ring has wrapped
+    for (int i = 0; i < pendingCount; i++)
+    {
+        count += slots[(pending[i].sequence - 1) % PALETTE_HISTORY_CAPACITY].sequence == 0;
+    }
+    portEXIT_CRITICAL(&lock);
+    return count;
+}
+
+PaletteHistory::Stats PaletteHistory::getStats() const
+{
+    return stats;
+}
+
+void PaletteHistory::statsToJson(JsonObject out) const
+{
+    out["palettes"] = getCount();
+    out["capacity"] = PALETTE_HISTORY_CAPACITY;
+    out["persistent"] = mounted;
+    out["appended"] = stats.appended;
+    out["duplicates"] = stats.duplicates;
+    out["dropped"] = stats.dropped;
+    out["batches"] = stats.batches;
+    out["written"] = stats.written;
+    out["failures"] = stats.failures;
+}
+
+bool PaletteHistory::readSlot(int slot, Record &out)
+{
+    if (!mounted)
+    {
+        return false;
+    }
+
+    File file = LittleFS.open(PALETTE_HISTORY_FILE, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+
+    bool valid = file.seek(slot * sizeof(Record), SeekSet) &&
+                 file.read(reinterpret_cast<uint8_t *>(&out), sizeof(out)) == sizeof(out);
+    file.close();
+
+    return valid && out.sequence == slots[slot].sequence && out.checksum == checksumOf(out);
+}
+
+int PaletteHistory::newestSlot() const
+{
+    int newest = -1;
+    for (int i = 0; i < PALETTE_HISTORY_CAPACITY; i++)
+    {
+        if (slots[i].sequence != 0 && (newest < 0 || slots[i].sequence > slots[newest].sequence))
+        {
+            newest = i;
+        }
+    }
+    return newest;
+}
+
+void PaletteHistory::refillShuffleBag()
+{
+    // One entry per distinct palette - a favorite sent ten times is not ten times as likely
+    shuffleRemaining = 0;
+    for (int i = 0; i < PALETTE_HISTORY_CAPACITY; i++)
+    {
+        if (slots[i].sequence == 0)
+        {
+            continue;
+        }
+
+        bool seen = false;
+        for (int j = 0; j < shuffleRemaining && !seen; j++)
+        {
+            seen = slots[shuffleBag[j]].contentHash == slots[i].contentHash;
+        }
+        if (!seen)
+        {
+            shuffleBag[shuffleRemaining++] = i;
+        }
+    }
+
+    // Fisher-Yates
+    for (int i = shuffleRemaining - 1; i > 0; i--)
+    {
+        int j = esp_random() % (i + 1);
+        uint8_t swap = shuffleBag[i];
+        shuffleBag[i] = shuffleBag[j];
+        shuffleBag[j] = swap;
+    }
+}
+
+void PaletteHistory::toRecord(const ColorPalette &palette, Record &out)
+{
+    memset(&out, 0, sizeof(out));
+    out.colorCount = constrain(palette.colorCount, 0, MAX_COLORS);
+    for (int i = 0; i < out.colorCount; i++)
+    {
+        out.colors[i][0] = palette.colors[i].r;
+        out.colors[i][1] = palette.colors[i].g;
+        out.colors[i][2] = palette.colors[i].b;
+    }
+    out.duration = palette.duration;
+    strlcpy(out.animation, palette.animation.c_str(), sizeof(out.animation));
+    strlcpy(out.name, palette.name.c_str(), sizeof(out.name));
+}
+
+void PaletteHistory::toPalette(const Record &record, ColorPalette &out)
+{
+    out = ColorPalette();
+    out.colorCount = min((int)record.colorCount, MAX_COLORS);
+    for (int i = 0; i < out.colorCount; i++)
+    {
+        out.colors[i] = RGBColor(record.colors[i][0], record.colors[i][1], record.colors[i][2]);
+    }
+    out.duration = record.duration;
+    out.animation = record.animation;
+    out.name = record.name;
+}
+
+uint32_t PaletteHistory::checksumOf(const Record &record)
+{
+    return fnv1a(&record, offsetof(Record, checksum));
+}
+
+uint32_t PaletteHistory::contentHashOf(const Record &record)
+{
+    // What is shown - the sender's name does not make a palette different
+    uint32_t hash = fnv1a(&record.colorCount, sizeof(record.colorCount));
+    hash = fnv1a(record.colors, record.colorCount * sizeof(record.colors[0]), hash);
+    return fnv1a(record.animation, strnlen(record.animation, sizeof(record.animation)), hash);
+}
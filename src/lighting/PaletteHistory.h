@@ -0,0 +1,121 @@
+#ifndef PALETTE_HISTORY_H
+#define PALETTE_HISTORY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "LightController.h"
+#include "../config.h"
+
+/**
+ * Palette History
+ * Flash-backed log of received palettes: a ring of PALETTE_HISTORY_CAPACITY
+ * fixed-size records in one preallocated LittleFS file. A record lives in
+ * slot (sequence - 1) % capacity and carries a checksum, so the newest
+ * valid record is found by sequence after a restart and a torn write only
+ * loses that record.
+ *
+ * append() only copies into RAM; the batch is written by flush() on the
+ * main loop once appends have been quiet for PALETTE_HISTORY_WRITE_DELAY,
+ * so the lighting task never waits on flash. Also serves the last palette
+ * at boot and a local shuffle over everything kept.
+ */
+class PaletteHistory
+{
+public:
+    struct Stats
+    {
+        uint32_t appended;   // Palettes accepted by append()
+        uint32_t duplicates; // Appends skipped because they matched the newest record
+        uint32_t dropped;    // Pending records overwritten before they reached flash
+        uint32_t batches;    // flush() calls that wrote to flash
+        uint32_t written;    // Records written
+        uint32_t failures;   // Failed file opens or short writes
+    };
+
+    PaletteHistory();
+
+    /**
+     * Mount LittleFS and index the existing log (creates it on first use)
+     * @return false if there is no usable file system - appends then stay in RAM
+     */
+    bool begin();
+
+    /**
+     * Queue a received palette for the log (any task, no flash access)
+     */
+    void append(const ColorPalette &palette);
+
+    /**
+     * Write queued records (main loop task)
+     * @param force Write now instead of waiting for the quiet period (restart path)
+     */
+    void flush(bool force = false);
+
+    /**
+     * Newest palette, queued or stored
+     * @return false if the log is empty
+     */
+    bool latest(ColorPalette &out);
+
+    /**
+     * Next palette of a shuffled pass over the log; every distinct palette
+     * comes up once per pass and the one just shown is not repeated
+     * @return false if there are fewer than two palettes to shuffle
+     */
+    bool nextShuffle(ColorPalette &out);
+
+    int getCount() const;
+    Stats getStats() const;
+
+    /**
+     * Delete the log file (factory reset - the device restarts afterwards,
+     * so the RAM index of a running instance is not updated)
+     */
+    static void erase();
+    void statsToJson(JsonObject out) const;
+
+private:
+    // On-flash record (fixed size, native byte order)
+    struct Record
+    {
+        uint32_t sequence; // 0 = empty slot
+        uint8_t colorCount;
+        uint8_t colors[MAX_COLORS][3]; // r, g, b
+        uint8_t reserved;
+        int32_t duration;
+        char animation[PALETTE_ANIMATION_SIZE];
+        char name[PALETTE_NAME_SIZE];
+        uint32_t checksum; // FNV-1a over every byte before it
+    };
+
+    // RAM index of the file - which sequence each slot holds and what it shows
+    struct Slot
+    {
+        uint32_t sequence;
+        uint32_t contentHash;
+    };
+
+    Slot slots[PALETTE_HISTORY_CAPACITY];
+    Record pending[PALETTE_HISTORY_MAX_PENDING]; // Oldest first
+    int pendingCount;
+    uint32_t nextSequence;
+    unsigned long lastAppendTime;
+    bool mounted;
+    Stats stats;
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    // Shuffle pass: slot indices not shown yet
+    uint8_t shuffleBag[PALETTE_HISTORY_CAPACITY];
+    int shuffleRemaining;
+    uint32_t lastShownHash;
+
+    bool readSlot(int slot, Record &out);
+    int newestSlot() const;
+    void refillShuffleBag();
+    static void toRecord(const ColorPalette &palette, Record &out);
+    static void toPalette(const Record &record, ColorPalette &out);
+    static uint32_t checksumOf(const Record &record);
+    static uint32_t contentHashOf(const Record &record);
+};
+
+#endif // PALETTE_HISTORY_H
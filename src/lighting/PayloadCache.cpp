@@ -0,0 +1,132 @@
+#include "PayloadCache.h"
+
+static const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+static const uint32_t FNV_PRIME = 16777619u;
+
+PayloadCache::PayloadCache()
+    : entryCount(0), used(0), useClock(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+const uint8_t *PayloadCache::find(uint32_t contentHash, uint32_t variant, size_t &length)
+{
+    for (int i = 0; i < entryCount; i++)
+    {
+        Entry &entry = entries[i];
+        if (entry.contentHash == contentHash && entry.variant == variant)
+        {
+            entry.lastUsed = ++useClock;
+            length = entry.length;
+            stats.hits++;
+            return storage + entry.offset;
+        }
+    }
+
+    stats.misses++;
+    return nullptr;
+}
+
+bool PayloadCache::store(uint32_t contentHash, uint32_t variant, const uint8_t *data, size_t length)
+{
+    if (length == 0 || length > sizeof(storage))
+    {
+        stats.rejected++;
+        return false;
+    }
+
+    // Replace rather than duplicate (a caller may re-store after a failed send)
+    for (int i = 0; i < entryCount; i++)
+    {
+        if (entries[i].contentHash == contentHash && entries[i].variant == variant)
+        {
+            evict(i);
+            break;
+        }
+    }
+
+    while (entryCount == PAYLOAD_CACHE_MAX_ENTRIES || used + length > sizeof(storage))
+    {
+        evict(leastRecentlyUsed());
+        stats.evictions++;
+    }
+
+    Entry &entry = entries[entryCount++];
+    entry.contentHash = contentHash;
+    entry.variant = variant;
+    entry.lastUsed = ++useClock;
+    entry.offset = used;
+    entry.length = length;
+    memcpy(storage + used, data, length);
+    used += length;
+    return true;
+}
+
+void PayloadCache::clear()
+{
+    entryCount = 0;
+    used = 0;
+}
+
+void PayloadCache::statsToJson(JsonObject out) const
+{
+    uint32_t lookups = stats.hits + stats.misses;
+    out["hits"] = stats.hits;
+    out["misses"] = stats.misses;
+    out["hitRate"] = lookups > 0 ? (uint32_t)(((uint64_t)stats.hits * 100 + lookups / 2) / lookups) : 0; // Percent
+    out["evictions"] = stats.evictions;
+    out["rejected"] = stats.rejected;
+    out["entries"] = entryCount;
+    out["bytes"] = used;
+    out["budget"] = sizeof(storage);
+}
+
+uint32_t PayloadCache::paletteHash(const ColorPalette &palette)
+{
+    uint32_t hash = combine(FNV_OFFSET_BASIS, palette.colorCount);
+    for (int i = 0; i < palette.colorCount; i++)
+    {
+        const RGBColor &color = palette.colors[i];
+        hash = combine(hash, ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b);
+    }
+    return hash;
+}
+
+uint32_t PayloadCache::combine(uint32_t hash, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        hash = (hash ^ (value & 0xFF)) * FNV_PRIME;
+        value >>= 8;
+    }
+    return hash;
+}
+
+void PayloadCache::evict(int index)
+{
+    // Close the gap so free space stays one block at the end
+    Entry removed = entries[index];
+    size_t tailStart = removed.offset + removed.length;
+    memmove(storage + removed.offset, storage + tailStart, used - tailStart);
+    used -= removed.length;
+
+    for (int i = index + 1; i < entryCount; i++)
+    {
+        entries[i - 1] = entries[i];
+        entries[i - 1].offset -= removed.length;
+    }
+    entryCount--;
+}
+
+int PayloadCache::leastRecentlyUsed() const
+{
+    int oldest = 0;
+    for (int i = 1; i < entryCount; i++)
+    {
+        if (entries[i].lastUsed < entries[oldest].lastUsed)
+        {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
@@ -0,0 +1,87 @@
+#ifndef PAYLOAD_CACHE_H
+#define PAYLOAD_CACHE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "LightController.h"
+#include "../config.h"
+
+/**
+ * Payload Cache
+ * Small LRU of fully encoded controller payloads (HTTP bodies, UDP frames)
+ * so a palette that was shown before goes straight to the send. Entries
+ * are keyed by a hash of the palette's colors plus a caller-chosen variant
+ * (payload kind, layout version, transition...), and their bytes are
+ * packed into one inline PAYLOAD_CACHE_BUDGET buffer - evicting compacts
+ * it, so the cache never touches the heap.
+ *
+ * Not thread-safe - owned by a controller and used under its lock.
+ */
+class PayloadCache
+{
+public:
+    struct Stats
+    {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t evictions; // Entries dropped to make room
+        uint32_t rejected;  // Payloads larger than the whole budget
+    };
+
+    PayloadCache();
+
+    /**
+     * Look up a payload and mark it most recently used
+     * @param contentHash paletteHash() of the palette
+     * @param variant Everything else the encoding depends on
+     * @param length Set to the payload length on a hit
+     * @return The cached bytes (valid until the next store() or clear()), or nullptr
+     */
+    const uint8_t *find(uint32_t contentHash, uint32_t variant, size_t &length);
+
+    /**
+     * Keep a copy of a payload, evicting least recently used entries until it fits
+     * @return false if the payload is larger than the budget
+     */
+    bool store(uint32_t contentHash, uint32_t variant, const uint8_t *data, size_t length);
+
+    /**
+     * Drop every entry (e.g. when the layout the payloads were built for changed)
+     */
+    void clear();
+
+    const Stats &getStats() const { return stats; }
+    void statsToJson(JsonObject out) const;
+
+    /**
+     * Hash of a palette's color content (count and RGB values)
+     */
+    static uint32_t paletteHash(const ColorPalette &palette);
+
+    /**
+     * Mix another value into a hash or variant
+     */
+    static uint32_t combine(uint32_t hash, uint32_t value);
+
+private:
+    struct Entry
+    {
+        uint32_t contentHash;
+        uint32_t variant;
+        uint32_t lastUsed; // useClock value at the last hit or store
+        uint16_t offset;   // Into storage; entries are packed in array order
+        uint16_t length;
+    };
+
+    uint8_t storage[PAYLOAD_CACHE_BUDGET];
+    Entry entries[PAYLOAD_CACHE_MAX_ENTRIES];
+    int entryCount;
+    size_t used;
+    uint32_t useClock;
+    Stats stats;
+
+    void evict(int index);
+    int leastRecentlyUsed() const;
+};
+
+#endif // PAYLOAD_CACHE_H
@@ -0,0 +1,75 @@
+#ifndef PAYLOAD_WRITER_H
+#define PAYLOAD_WRITER_H
+
+#include <Arduino.h>
+
+/**
+ * Payload Writer
+ * Formats text payloads (JSON bodies, animData strings) directly into a
+ * caller-owned fixed buffer. Nothing is allocated on the heap; once the
+ * buffer is full further writes are dropped and overflowed() reports it.
+ */
+class PayloadWriter
+{
+public:
+    PayloadWriter(char *buffer, size_t capacity)
+        : buffer(buffer), capacity(capacity), length(0), overflow(false)
+    {
+        if (capacity > 0)
+        {
+            buffer[0] = '\0';
+        }
+    }
+
+    PayloadWriter &append(const char *text)
+    {
+        return append(text, strlen(text));
+    }
+
+    PayloadWriter &append(const char *text, size_t textLength)
+    {
+        if (overflow || length + textLength >= capacity)
+        {
+            overflow = true;
+            return *this;
+        }
+
+        memcpy(buffer + length, text, textLength);
+        length += textLength;
+        buffer[length] = '\0';
+        return *this;
+    }
+
+    PayloadWriter &append(char c)
+    {
+        return append(&c, 1);
+    }
+
+    PayloadWriter &append(int value)
+    {
+        char digits[12];
+        int written = snprintf(digits, sizeof(digits), "%d", value);
+        return append(digits, written);
+    }
+
+    /**
+     * Append a quoted JSON key followed by a colon, e.g. "hue":
+     */
+    PayloadWriter &key(const char *name)
+    {
+        return append('"').append(name).append("\":", 2);
+    }
+
+    const char *c_str() const { return buffer; }
+    const uint8_t *data() const { return reinterpret_cast<const uint8_t *>(buffer); }
+    size_t size() const { return length; }
+    bool overflowed() const { return overflow; }
+
+private:
+    char *buffer;
+    size_t capacity;
+    size_t length;
+    bool overflow;
+};
+
+#endif // PAYLOAD_WRITER_H
@@ -0,0 +1,145 @@
+#include "SpatialMap.h"
+
+SpatialMap::SpatialMap() : count(0), mode(MODE_INDEX)
+{
+}
+
+void SpatialMap::build(const int *xs, const int *ys, int count, Mode mode)
+{
+    this->count = constrain(count, 0, ANIMATION_MAX_PIXELS);
+    this->mode = mode;
+
+    if (this->count == 0)
+    {
+        return;
+    }
+
+    int32_t centerX = 0;
+    int32_t centerY = 0;
+    for (int i = 0; i < this->count; i++)
+    {
+        centerX += xs[i];
+        centerY += ys[i];
+    }
+    centerX /= this->count;
+    centerY /= this->count;
+
+    int32_t keys[ANIMATION_MAX_PIXELS];
+    uint8_t order[ANIMATION_MAX_PIXELS];
+    for (int i = 0; i < this->count; i++)
+    {
+        switch (mode)
+        {
+        case MODE_X:
+            keys[i] = xs[i];
+            break;
+        case MODE_Y:
+            keys[i] = ys[i];
+            break;
+        case MODE_RADIAL:
+        {
+            int32_t dx = xs[i] - centerX;
+            int32_t dy = ys[i] - centerY;
+            keys[i] = dx * dx + dy * dy;
+            break;
+        }
+        case MODE_INDEX:
+        default:
+            keys[i] = i;
+            break;
+        }
+        order[i] = i;
+    }
+
+    // Insertion sort - stable, and the table is small and built once per layout
+    for (int i = 1; i < this->count; i++)
+    {
+        uint8_t current = order[i];
+        int j = i - 1;
+        while (j >= 0 && keys[order[j]] > keys[current])
+        {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = current;
+    }
+
+    // Pixels at the same coordinate share a position (and so a color)
+    int rank = 0;
+    int lastRank = max(this->count - 1, 1);
+    for (int i = 0; i < this->count; i++)
+    {
+        if (i > 0 && keys[order[i]] != keys[order[i - 1]])
+        {
+            rank = i;
+        }
+        positions[order[i]] = ((uint32_t)rank * 65535) / lastRank;
+    }
+}
+
+void SpatialMap::clear()
+{
+    count = 0;
+}
+
+void SpatialMap::fillGradient(const ColorPalette &palette, RGBColor *out) const
+{
+    fillGradient(positions, count, palette, out);
+}
+
+void SpatialMap::fillGradient(const uint16_t *positions, int count, const ColorPalette &palette, RGBColor *out)
+{
+    int colorCount = min(palette.colorCount, MAX_COLORS);
+    if (colorCount <= 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        // 16-bit position -> palette segment + 8-bit blend amount
+        uint32_t scaled = (uint32_t)positions[i] * (colorCount - 1);
+        int segment = scaled / 65535;
+        if (segment >= colorCount - 1)
+        {
+            out[i] = palette.colors[colorCount - 1];
+            continue;
+        }
+
+        uint8_t amount = ((scaled % 65535) * 255) / 65535;
+        out[i] = LightControllerUtils::blendColor(palette.colors[segment], palette.colors[segment + 1], amount);
+    }
+}
+
+SpatialMap::Mode SpatialMap::modeFromName(const String &name)
+{
+    if (name == "x")
+    {
+        return MODE_X;
+    }
+    if (name == "y")
+    {
+        return MODE_Y;
+    }
+    if (name == "radial")
+    {
+        return MODE_RADIAL;
+    }
+    return MODE_INDEX;
+}
+
+const char *SpatialMap::modeToName(Mode mode)
+{
+    switch (mode)
+    {
+    case MODE_X:
+        return "x";
+    case MODE_Y:
+        return "y";
+    case MODE_RADIAL:
+        return "radial";
+    case MODE_INDEX:
+    default:
+        return "index";
+    }
+}
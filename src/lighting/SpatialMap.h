@@ -0,0 +1,72 @@
+#ifndef SPATIAL_MAP_H
+#define SPATIAL_MAP_H
+
+#include "LightController.h"
+#include "../config.h"
+
+/**
+ * Spatial Map
+ * Orders pixels by their physical position once per layout so palettes
+ * can be laid out as gradients across space. build() sorts (O(n^2) on at
+ * most ANIMATION_MAX_PIXELS entries, once per layout); fillGradient()
+ * is a single O(n) pass with no sorting.
+ */
+class SpatialMap
+{
+public:
+    enum Mode
+    {
+        MODE_INDEX,  // Keep device order
+        MODE_X,      // Left to right
+        MODE_Y,      // Bottom to top
+        MODE_RADIAL  // Center outwards
+    };
+
+    SpatialMap();
+
+    /**
+     * Rank pixels along the chosen axis
+     * @param xs X coordinate of each pixel
+     * @param ys Y coordinate of each pixel
+     * @param count Number of pixels (clamped to ANIMATION_MAX_PIXELS)
+     * @param mode Ordering to apply
+     */
+    void build(const int *xs, const int *ys, int count, Mode mode);
+
+    void clear();
+
+    /**
+     * Spread the palette as a gradient along the mapped order
+     * @param palette Source colors (first color at the start of the axis)
+     * @param out Color for each pixel, getCount() entries
+     */
+    void fillGradient(const ColorPalette &palette, RGBColor *out) const;
+
+    /**
+     * Spread the palette as a gradient using a precomputed position table
+     * @param positions Position of each pixel (see getPositions())
+     * @param count Number of pixels
+     * @param palette Source colors
+     * @param out Color for each pixel
+     */
+    static void fillGradient(const uint16_t *positions, int count, const ColorPalette &palette, RGBColor *out);
+
+    /**
+     * Position of each pixel along the axis (0 = first, 65535 = last)
+     * @return Table of getCount() entries, or nullptr if not built
+     */
+    const uint16_t *getPositions() const { return count > 0 ? positions : nullptr; }
+
+    int getCount() const { return count; }
+    Mode getMode() const { return mode; }
+
+    static Mode modeFromName(const String &name);
+    static const char *modeToName(Mode mode);
+
+private:
+    uint16_t positions[ANIMATION_MAX_PIXELS];
+    int count;
+    Mode mode;
+};
+
+#endif // SPATIAL_MAP_H
@@ -1,25 +1,63 @@
 #include "NanoleafController.h"
+
+#ifndef PALPALETTE_DISABLE_NANOLEAF
 #include "../../config.h" // Include for globalFeedWatchdog
+#include "../../core/Metrics.h"
+#include "../ColorMath.h"
+#include <Preferences.h>
+
+const char *NanoleafController::LAYOUT_PREF_NAMESPACE = "nl_layout";
+
+// FNV-1a, used for the layout cache keys
+static uint32_t fnv1a(const void *data, size_t length, uint32_t hash = 2166136261u)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
 
 NanoleafController::NanoleafController()
-    : panelCount(0), isConnected(false), lastHeartbeat(0), discoveredDeviceCount(0)
+    : panelCount(0), isConnected(false), lastHeartbeat(0), deviceKey(0), cachedLayoutHash(0),
+      layoutRevalidationPending(false), layoutCacheLoadTime(0), layoutFetch(FETCH_IDLE),
+      streamingActive(false), layoutVersion(0)
 {
 }
 
 NanoleafController::~NanoleafController()
 {
+    stopStreaming();
+
     if (isConnected)
     {
         disableExternalControl();
     }
+
+    closeConnection();
 }
 
 bool NanoleafController::initialize(const LightConfig &config)
 {
     this->config = config;
 
+    // Palette gradient direction, NANOLEAF_LAYOUT_MODE unless the system config picks one
+    JsonObject customConfig = config.customConfig;
+    SpatialMap::Mode layoutMode = SpatialMap::modeFromName(customConfig["layout"] | NANOLEAF_LAYOUT_MODE);
+    if (layoutMode != nanoleafConfig.layoutMode)
+    {
+        nanoleafConfig.layoutMode = layoutMode;
+        buildSpatialMap();
+        debugLogf("📐 Panel layout mode: %s", SpatialMap::modeToName(layoutMode));
+    }
+
+    // Any previous stream targets the old host
+    stopStreaming();
+
     debugLog("Initializing Nanoleaf controller");
-    debugLog("Host: " + config.hostAddress + ":" + String(config.port));
+    debugLogf("Host: %s:%d", config.hostAddress.c_str(), config.port);
 
     if (!WiFi.isConnected())
     {
@@ -33,6 +71,14 @@ bool NanoleafController::initialize(const LightConfig &config)
     // If no host address provided, mark for discovery but don't fail initialization
     if (config.hostAddress.length() == 0)
     {
+        // Start looking now so results are usually ready by the time authenticate() runs
+        String lastAddress;
+        uint16_t lastPort;
+        if (!NanoleafDiscovery::loadLastKnownGood(lastAddress, lastPort))
+        {
+            discovery.start();
+        }
+
         isInitialized = true;
         return true;
     }
@@ -50,10 +96,11 @@ bool NanoleafController::initialize(const LightConfig &config)
         {
             debugLog("✅ Auth token is valid - device is ready");
             isAuthenticated = true;
+            rememberHost();
             // Get panel layout for immediate use
-            if (getPanelLayout())
+            if (loadPanelLayout())
             {
-                debugLog("✅ Panel layout retrieved - " + String(panelCount) + " display panels ready");
+                debugLogf("✅ Panel layout retrieved - %d display panels ready", panelCount);
             }
         }
         else
@@ -84,7 +131,12 @@ bool NanoleafController::testConnection()
     if (success && response["name"].is<const char *>())
     {
         String deviceName = response["name"];
-        debugLog("Successfully connected to Nanoleaf: " + deviceName);
+        debugLogf("Successfully connected to Nanoleaf: %s", deviceName.c_str());
+
+        // Identifies this device (and firmware) for the panel layout cache
+        const char *serialNo = response["serialNo"] | "";
+        const char *firmwareVersion = response["firmwareVersion"] | "";
+        deviceKey = fnv1a(firmwareVersion, strlen(firmwareVersion), fnv1a(serialNo, strlen(serialNo)));
         isConnected = true;
         lastHeartbeat = millis();
         return true;
@@ -126,14 +178,14 @@ bool NanoleafController::displayPalette(const ColorPalette &palette)
         }
     }
 
-    debugLog("Displaying palette: " + palette.name + " (" + String(palette.colorCount) + " colors)");
+    debugLogf("Displaying palette: %s (%d colors)", palette.name.c_str(), palette.colorCount);
 
     // Ensure we have panel layout information
     if (panelCount == 0)
     {
-        if (getPanelLayout())
+        if (loadPanelLayout())
         {
-            debugLog("✅ Panel layout retrieved - " + String(panelCount) + " display panels found");
+            debugLogf("✅ Panel layout retrieved - %d display panels found", panelCount);
         }
         else
         {
@@ -144,6 +196,18 @@ bool NanoleafController::displayPalette(const ColorPalette &palette)
     // Check if we have panel information for static color distribution
     if (panelCount > 0)
     {
+        // Prefer the UDP stream when external control is allowed - avoids an HTTP round-trip per palette
+        if (startStreaming())
+        {
+            if (streamStaticColors(palette))
+            {
+                return true;
+            }
+
+            debugLog("⚠ UDP stream failed, falling back to HTTP effect");
+            stopStreaming();
+        }
+
         return setStaticColors(palette);
     }
     else
@@ -171,6 +235,8 @@ bool NanoleafController::displayPalette(const ColorPalette &palette)
         String payloadStr;
         serializeJson(payload, payloadStr);
 
+        // Writing an HTTP effect ends external control on the device
+        streamingActive = false;
         return sendHttpRequest("/effects", "PUT", payloadStr);
     }
 }
@@ -182,6 +248,9 @@ bool NanoleafController::turnOff()
         return false;
     }
 
+    // Require external control to be re-negotiated after the panels were switched off
+    stopStreaming();
+
     JsonDocument payload;
     payload["on"]["value"] = false;
 
@@ -210,7 +279,7 @@ bool NanoleafController::setBrightness(int brightness)
     bool success = sendHttpRequest("/state", "PUT", payloadStr);
     if (success)
     {
-        debugLog("Set brightness to " + String(brightness) + "%");
+        debugLogf("Set brightness to %d%%", brightness);
     }
 
     return success;
@@ -262,6 +331,7 @@ bool NanoleafController::authenticate()
     {
         debugLog("Existing auth token is valid");
         isAuthenticated = true;
+        rememberHost();
         getPanelLayout();
         return true;
     }
@@ -272,6 +342,7 @@ bool NanoleafController::authenticate()
     {
         debugLog("✅ Authentication successful");
         isAuthenticated = true;
+        rememberHost();
         getPanelLayout();
 
         // Update config with new token for future use
@@ -327,121 +398,42 @@ JsonObject NanoleafController::getCapabilities()
 
 bool NanoleafController::discoverNanoleaf()
 {
-    debugLog("Starting mDNS discovery for Nanoleaf devices");
-
-    // Clear previous discovery results
-    discoveredDeviceCount = 0;
-
-    // Give WiFi a moment to fully stabilize
-    delay(1000);
-    globalFeedWatchdog(); // Feed watchdog after delay
-
-    // Try multiple times to initialize mDNS
-    bool mdnsStarted = false;
-    for (int attempt = 1; attempt <= 3; attempt++)
+    // The host that worked last time usually still does - no mDNS needed
+    String lastAddress;
+    uint16_t lastPort;
+    if (NanoleafDiscovery::loadLastKnownGood(lastAddress, lastPort))
     {
-        if (MDNS.begin("palpalette"))
-        {
-            mdnsStarted = true;
-            break;
-        }
-        else
+        if (NanoleafDiscovery::probe(lastAddress, lastPort, NANOLEAF_PROBE_TIMEOUT))
         {
-            if (attempt < 3)
-            {
-                delay(2000);          // Wait 2 seconds before retry
-                globalFeedWatchdog(); // Feed watchdog after delay
-            }
+            debugLogf("Reusing last known Nanoleaf host %s:%u", lastAddress.c_str(), lastPort);
+            selectHost(lastAddress, lastPort);
+            return true;
         }
-    }
 
-    if (!mdnsStarted)
-    {
-        debugLog("❌ Failed to start mDNS after 3 attempts");
-        return false;
+        debugLogf("Last known Nanoleaf host %s not responding - running discovery", lastAddress.c_str());
     }
 
-    // Query for Nanoleaf API services with retry mechanism
-    int retryCount = 0;
-    int maxRetries = 5;
-    int retryDelay = 2000;
-    int servicesFound = 0;
-
-    while (retryCount < maxRetries && servicesFound == 0)
+    // Reuse results from a run started in initialize(), otherwise start one now
+    if (discovery.getState() != NanoleafDiscovery::COMPLETE || discovery.getFirstRespondingIndex() < 0)
     {
-        // Feed watchdog before potentially long operation
-        globalFeedWatchdog();
-
-        servicesFound = MDNS.queryService("nanoleafapi", "tcp");
-
-        if (servicesFound > 0)
-        {
-            break;
-        }
-        else
-        {
-            retryCount++;
-            if (retryCount < maxRetries)
-            {
-                delay(retryDelay);
-                globalFeedWatchdog();                             // Feed watchdog after delay
-                retryDelay = min((int)(retryDelay * 1.5), 10000); // Cap at 10 seconds
-            }
-        }
+        discovery.start();
     }
 
-    if (servicesFound == 0)
+    debugLog("Waiting for mDNS discovery of Nanoleaf devices");
+    if (!discovery.waitForCompletion(NANOLEAF_DISCOVERY_TIMEOUT))
     {
         debugLog("❌ No Nanoleaf devices found via mDNS");
         return false;
     }
 
-    debugLog("Found " + String(servicesFound) + " Nanoleaf device(s)");
-
-    // Store all discovered devices
-    for (int i = 0; i < servicesFound && discoveredDeviceCount < 10; i++)
-    {
-        String hostname = MDNS.hostname(i);
-        IPAddress ip = MDNS.IP(i);
-        uint16_t port = MDNS.port(i);
-
-        if (ip == INADDR_NONE)
-        {
-            continue;
-        }
-
-        DiscoveredDevice &device = discoveredDevices[discoveredDeviceCount];
-        device.hostname = hostname;
-        device.ipAddress = ip.toString();
-        device.port = port;
-        device.isResponding = true; // Skip HTTP test, assume responding if found via mDNS
-
-        discoveredDeviceCount++;
-    }
-
-    if (discoveredDeviceCount == 0)
+    int index = discovery.getFirstRespondingIndex();
+    if (index < 0)
     {
-        debugLog("❌ No valid Nanoleaf devices found");
+        debugLog("❌ No responsive Nanoleaf devices found");
         return false;
     }
 
-    // Automatically select the first responding device
-    for (int i = 0; i < discoveredDeviceCount; i++)
-    {
-        if (discoveredDevices[i].isResponding)
-        {
-            config.hostAddress = discoveredDevices[i].ipAddress;
-            config.port = discoveredDevices[i].port;
-            baseUrl = "http://" + config.hostAddress + ":" + String(config.port);
-
-            debugLog("Selected device: " + discoveredDevices[i].hostname + " (" + discoveredDevices[i].ipAddress + ":" + String(discoveredDevices[i].port) + ")");
-
-            return discoverNanoleaf(i);
-        }
-    }
-
-    debugLog("❌ No responsive Nanoleaf devices found");
-    return false;
+    return discoverNanoleaf(index);
 }
 
 bool NanoleafController::requestAuthToken()
@@ -453,7 +445,7 @@ bool NanoleafController::requestAuthToken()
 
     // Build auth URL
     String authUrl = "http://" + config.hostAddress + ":" + String(config.port) + "/api/v1/new";
-    debugLog("Auth URL: " + authUrl);
+    debugLogf("Auth URL: %s", authUrl.c_str());
 
     HTTPClient authHttp;
     authHttp.begin(authUrl);
@@ -477,7 +469,7 @@ bool NanoleafController::requestAuthToken()
         if (httpResponseCode == 200)
         {
             String response = authHttp.getString();
-            debugLog("Received auth response: " + response);
+            debugLogf("Received auth response: %s", response.c_str());
 
             JsonDocument doc;
             DeserializationError error = deserializeJson(doc, response);
@@ -485,7 +477,7 @@ bool NanoleafController::requestAuthToken()
             if (!error && doc["auth_token"].is<const char *>())
             {
                 authToken = doc["auth_token"].as<String>();
-                debugLog("✅ Auth token obtained: " + authToken.substring(0, 8) + "...");
+                debugLogf("✅ Auth token obtained: %.8s...", authToken.c_str());
 
                 // Update base URL for future requests
                 baseUrl = "http://" + config.hostAddress + ":" + String(config.port);
@@ -499,7 +491,7 @@ bool NanoleafController::requestAuthToken()
             else
             {
                 debugLog("❌ Invalid response format");
-                debugLog("Response: " + response);
+                debugLogf("Response: %s", response.c_str());
             }
         }
         else if (httpResponseCode == 403)
@@ -507,18 +499,18 @@ bool NanoleafController::requestAuthToken()
             int remainingTime = (AUTH_TIMEOUT - (millis() - startTime)) / 1000;
             if (attempts % 5 == 1) // Only log every 5th attempt to reduce spam
             {
-                debugLog("Waiting for pairing mode... (" + String(remainingTime) + "s remaining)");
+                debugLogf("Waiting for pairing mode... (%ds remaining)", remainingTime);
                 // Update user with remaining time
                 notifyUserActionProgress(remainingTime);
             }
         }
         else if (httpResponseCode > 0)
         {
-            debugLog("HTTP error: " + String(httpResponseCode));
+            debugLogf("HTTP error: %d", httpResponseCode);
         }
         else
         {
-            debugLog("Network error: " + String(httpResponseCode));
+            debugLogf("Network error: %d", httpResponseCode);
         }
 
         delay(2000);          // Wait 2 seconds before trying again
@@ -526,7 +518,7 @@ bool NanoleafController::requestAuthToken()
     }
 
     authHttp.end();
-    debugLog("⏰ Authentication timeout after " + String(attempts) + " attempts");
+    debugLogf("⏰ Authentication timeout after %d attempts", attempts);
 
     // Notify timeout/failure
     notifyUserActionCompleted(false);
@@ -542,12 +534,18 @@ bool NanoleafController::getPanelLayout()
         return false;
     }
 
+    applyPanelLayout(response);
+    return true;
+}
+
+void NanoleafController::applyPanelLayout(JsonDocument &response)
+{
     JsonArray positionData = response["positionData"];
     int totalPanelsFound = positionData.size();
 
     // Filter out controller panels (shapeType 12) and store only display panels
     panelCount = 0;
-    for (int i = 0; i < totalPanelsFound && panelCount < 50; i++)
+    for (int i = 0; i < totalPanelsFound && panelCount < NANOLEAF_MAX_PANELS; i++)
     {
         JsonObject panel = positionData[i];
         int shapeType = panel["shapeType"];
@@ -568,13 +566,275 @@ bool NanoleafController::getPanelLayout()
         panelCount++;
     }
 
+    buildSpatialMap();
+
+    uint32_t layoutHash = computeLayoutHash();
+    if (layoutHash != cachedLayoutHash)
+    {
+        saveCachedLayout(layoutHash);
+    }
+}
+
+bool NanoleafController::loadPanelLayout()
+{
+    if (loadCachedLayout())
+    {
+        debugLog("⚡ Panel layout loaded from cache - revalidating in background");
+        return true;
+    }
+
+    return getPanelLayout();
+}
+
+bool NanoleafController::loadCachedLayout()
+{
+    Preferences prefs;
+    if (!prefs.begin(LAYOUT_PREF_NAMESPACE, true))
+    {
+        return false;
+    }
+
+    char headerKey[12];
+    char panelsKey[12];
+    layoutCacheKeys(headerKey, panelsKey);
+
+    LayoutCacheHeader header;
+    bool valid = prefs.getBytes(headerKey, &header, sizeof(header)) == sizeof(header) &&
+                 header.version == LAYOUT_CACHE_VERSION &&
+                 header.panelCount > 0 && header.panelCount <= NANOLEAF_MAX_PANELS &&
+                 config.hostAddress == header.hostAddress &&
+                 deviceKey != 0 && deviceKey == header.deviceKey &&
+                 prefs.getBytesLength(panelsKey) == header.panelCount * sizeof(PanelInfo);
+
+    if (valid)
+    {
+        valid = prefs.getBytes(panelsKey, panels, header.panelCount * sizeof(PanelInfo)) == header.panelCount * sizeof(PanelInfo);
+    }
+    prefs.end();
+
+    if (!valid)
+    {
+        return false;
+    }
+
+    panelCount = header.panelCount;
+    cachedLayoutHash = header.layoutHash;
+    buildSpatialMap();
+    layoutRevalidationPending = true;
+    layoutCacheLoadTime = millis();
     return true;
 }
 
+void NanoleafController::saveCachedLayout(uint32_t layoutHash)
+{
+    if (panelCount == 0 || config.hostAddress.length() >= sizeof(LayoutCacheHeader::hostAddress))
+    {
+        return;
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(LAYOUT_PREF_NAMESPACE, false))
+    {
+        return;
+    }
+
+    LayoutCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.version = LAYOUT_CACHE_VERSION;
+    header.panelCount = panelCount;
+    header.deviceKey = deviceKey;
+    header.layoutHash = layoutHash;
+    strlcpy(header.hostAddress, config.hostAddress.c_str(), sizeof(header.hostAddress));
+
+    char headerKey[12];
+    char panelsKey[12];
+    layoutCacheKeys(headerKey, panelsKey);
+
+    // Header last: a torn write leaves a size mismatch that loadCachedLayout() rejects
+    prefs.putBytes(panelsKey, panels, panelCount * sizeof(PanelInfo));
+    prefs.putBytes(headerKey, &header, sizeof(header));
+
+    // Single-slot entries from before the cache was keyed by host
+    if (prefs.isKey("header"))
+    {
+        prefs.remove("header");
+        prefs.remove("panels");
+    }
+    prefs.end();
+
+    cachedLayoutHash = layoutHash;
+    debugLogf("💾 Panel layout cached (%d panels)", panelCount);
+}
+
+void NanoleafController::layoutCacheKeys(char *headerKey, char *panelsKey) const
+{
+    // One entry per host, so several Nanoleaf systems don't evict each other (NVS keys are at most 15 chars)
+    uint32_t hostHash = fnv1a(config.hostAddress.c_str(), config.hostAddress.length());
+    snprintf(headerKey, 12, "h%08lx", (unsigned long)hostHash);
+    snprintf(panelsKey, 12, "p%08lx", (unsigned long)hostHash);
+}
+
+void NanoleafController::rememberHost()
+{
+    // The last-known-good host is shared by the whole device - additional systems keep their own
+    if (config.isPrimary)
+    {
+        NanoleafDiscovery::saveLastKnownGood(config.hostAddress, config.port);
+    }
+}
+
+void NanoleafController::buildSpatialMap()
+{
+    int xs[NANOLEAF_MAX_PANELS];
+    int ys[NANOLEAF_MAX_PANELS];
+    for (int i = 0; i < panelCount; i++)
+    {
+        xs[i] = panels[i].x;
+        ys[i] = panels[i].y;
+    }
+
+    // Orientation (o) rotates a panel in place; with one color per panel it does not affect the order
+    spatialMap.build(xs, ys, panelCount, nanoleafConfig.layoutMode);
+
+    // Cached payloads carry panel ids and the gradient order of the old layout
+    layoutVersion++;
+    payloadCache.clear();
+}
+
+void NanoleafController::mapPaletteToPanels(const ColorPalette &palette, RGBColor *out)
+{
+    if (spatialMap.getCount() == panelCount && panelCount > 0)
+    {
+        spatialMap.fillGradient(palette, out);
+        return;
+    }
+
+    // No map for this layout (more panels than the map holds) - cycle the palette in device order
+    for (int i = 0; i < panelCount; i++)
+    {
+        out[i] = palette.colors[i % palette.colorCount];
+    }
+}
+
+uint32_t NanoleafController::computeLayoutHash() const
+{
+    return fnv1a(panels, panelCount * sizeof(PanelInfo));
+}
+
+uint32_t NanoleafController::payloadVariant(PayloadKind kind, uint32_t parameter) const
+{
+    return PayloadCache::combine(PayloadCache::combine(layoutVersion, kind), parameter);
+}
+
+void NanoleafController::loop()
+{
+    uint8_t fetch = layoutFetch.load();
+    if (fetch == FETCH_DONE || fetch == FETCH_FAILED)
+    {
+        finishLayoutRevalidation(fetch == FETCH_DONE);
+        layoutFetch = FETCH_IDLE;
+        return;
+    }
+
+    // Re-check a layout served from cache once the first palette is out
+    if (fetch != FETCH_IDLE || !layoutRevalidationPending ||
+        millis() - layoutCacheLoadTime < NANOLEAF_LAYOUT_REVALIDATE_DELAY)
+    {
+        return;
+    }
+
+    // The GET itself runs in loopUnlocked(), off the controller mutex
+    layoutRevalidationPending = false;
+    layoutFetchUrl = getApiBase() + "/panelLayout/layout";
+    layoutFetchHost = config.hostAddress;
+    layoutFetch = FETCH_DUE;
+}
+
+void NanoleafController::loopUnlocked()
+{
+    if (layoutFetch != FETCH_DUE)
+    {
+        return;
+    }
+
+    // Its own socket - the keep-alive one belongs to calls made under the mutex
+    WiFiClient layoutClient;
+    HTTPClient layoutHttp;
+    bool fetched = false;
+
+    MetricSpan roundTripSpan(Metrics::NANOLEAF_HTTP);
+    if (layoutHttp.begin(layoutClient, layoutFetchUrl))
+    {
+        layoutHttp.addHeader("User-Agent", "PalPalette-ESP32");
+        if (layoutHttp.GET() == 200)
+        {
+            fetchedLayout = layoutHttp.getString();
+            fetched = fetchedLayout.length() > 0;
+        }
+        layoutHttp.end();
+    }
+    roundTripSpan.end();
+
+    layoutFetch = fetched ? FETCH_DONE : FETCH_FAILED;
+}
+
+void NanoleafController::finishLayoutRevalidation(bool fetched)
+{
+    JsonDocument response;
+    bool valid = fetched && layoutFetchHost == config.hostAddress &&
+                 !deserializeJson(response, fetchedLayout) && response["positionData"].is<JsonArray>();
+    fetchedLayout = String();
+
+    if (!valid)
+    {
+        debugLog("⚠ Panel layout revalidation failed - keeping cached layout");
+        return;
+    }
+
+    uint32_t previousHash = computeLayoutHash();
+    applyPanelLayout(response);
+
+    if (computeLayoutHash() != previousHash)
+    {
+        debugLog("🔄 Panel layout changed since it was cached - updated");
+    }
+    else
+    {
+        debugLog("✅ Cached panel layout confirmed");
+    }
+}
+
 bool NanoleafController::setStaticColors(const ColorPalette &palette)
 {
-    String colorData = createStaticColorData(palette);
-    bool result = sendHttpRequest("/effects", "PUT", colorData);
+    // Writing an HTTP effect ends external control on the device
+    streamingActive = false;
+
+    // A palette shown before on this layout skips the HSB conversion and formatting
+    uint32_t contentHash = PayloadCache::paletteHash(palette);
+    uint32_t variant = payloadVariant(PAYLOAD_STATIC_EFFECT, 0);
+    size_t payloadLength = 0;
+    const uint8_t *payload = payloadCache.find(contentHash, variant, payloadLength);
+
+    if (payload == nullptr)
+    {
+        // Allocation-free - the bench build's staticColorData cases count this
+        payloadLength = createStaticColorData(palette);
+        debugLogf("📦 Static payload: %u bytes", (unsigned)payloadLength);
+
+        if (payloadLength == 0)
+        {
+            return false;
+        }
+
+        payload = (const uint8_t *)payloadBuffer;
+        payloadCache.store(contentHash, variant, payload, payloadLength);
+    }
+    else
+    {
+        debugLogf("⚡ Static payload from cache (%u bytes)", (unsigned)payloadLength);
+    }
+
+    bool result = sendHttpRequest("/effects", "PUT", payload, payloadLength);
 
     if (result)
     {
@@ -597,6 +857,7 @@ bool NanoleafController::setAnimatedColors(const ColorPalette &palette, const St
         anim = FLOW;
 
     String animationData = createColorAnimationData(palette, anim);
+    streamingActive = false;
     return sendHttpRequest("/effects", "PUT", animationData);
 }
 
@@ -622,64 +883,207 @@ bool NanoleafController::disableExternalControl()
     String payloadStr;
     serializeJson(payload, payloadStr);
 
+    streamingActive = false;
     return sendHttpRequest("/effects", "PUT", payloadStr);
 }
 
-bool NanoleafController::sendHttpRequest(const String &endpoint, const String &method, const String &payload, JsonDocument *response)
+bool NanoleafController::startStreaming()
 {
-    // Build URL using working controller pattern: baseUrl + "/api/v1/" + authToken + endpoint
-    String url = baseUrl + "/api/v1";
+    if (streamingActive)
+    {
+        return true;
+    }
 
-    if (authToken.length() > 0)
+    // Covers every caller - palettes and the AnimationEngine alike
+    if (!nanoleafConfig.enableExternalControl || !isAuthenticated || config.hostAddress.length() == 0)
     {
-        url += "/" + authToken;
+        return false;
     }
 
-    url += endpoint;
+    // extControl v2 expects datagrams addressed to the controller IP directly
+    if (!streamAddress.fromString(config.hostAddress))
+    {
+        debugLogf("❌ Cannot stream to non-IP host: %s", config.hostAddress.c_str());
+        return false;
+    }
 
-    // Only log URL for debugging, not every header detail
-    if (endpoint == "/effects" && method == "PUT")
+    if (!enableExternalControl())
     {
-        debugLog("🎨 Sending color data to Nanoleaf");
+        debugLog("❌ Failed to enable external control");
+        return false;
     }
 
-    http.begin(url);
-    http.addHeader("Content-Type", "application/json");
-    http.addHeader("User-Agent", "PalPalette-ESP32");
+    streamingActive = true;
+    debugLogf("📡 UDP streaming enabled (%s:%d)", config.hostAddress.c_str(), NANOLEAF_EXT_CONTROL_PORT);
+    return true;
+}
 
-    int httpResponseCode;
-    if (method == "GET")
+void NanoleafController::stopStreaming()
+{
+    if (streamingActive)
     {
-        httpResponseCode = http.GET();
+        debugLog("📡 UDP streaming stopped");
     }
-    else if (method == "POST")
+
+    udp.stop();
+    streamingActive = false;
+}
+
+bool NanoleafController::streamPanelColors(const int *panelIndices, const RGBColor *colors, int count, int transitionTime)
+{
+    if (!streamingActive || colors == nullptr)
     {
-        httpResponseCode = http.POST(payload);
+        return false;
     }
-    else if (method == "PUT")
+
+    size_t length = buildStreamFrame(panelIndices, colors, count, transitionTime);
+    if (length == 0)
     {
-        httpResponseCode = http.PUT(payload);
+        return true; // Nothing changed - nothing to send
     }
-    else if (method == "DELETE")
+
+    return sendStreamFrame(streamBuffer, length);
+}
+
+size_t NanoleafController::buildStreamFrame(const int *panelIndices, const RGBColor *colors, int count, int transitionTime)
+{
+    count = min(count, panelCount);
+    uint16_t transition = (uint16_t)max(0, transitionTime);
+
+    size_t length = STREAM_HEADER_SIZE;
+    int framePanels = 0;
+
+    for (int i = 0; i < count; i++)
     {
-        httpResponseCode = http.sendRequest("DELETE", payload);
+        int panelIndex = panelIndices ? panelIndices[i] : i;
+        if (panelIndex < 0 || panelIndex >= panelCount)
+        {
+            continue;
+        }
+
+        uint16_t panelId = (uint16_t)panels[panelIndex].panelId;
+        uint8_t *entry = streamBuffer + length;
+        entry[0] = panelId >> 8;
+        entry[1] = panelId & 0xFF;
+        entry[2] = colors[i].r;
+        entry[3] = colors[i].g;
+        entry[4] = colors[i].b;
+        entry[5] = 0; // White channel
+        entry[6] = transition >> 8;
+        entry[7] = transition & 0xFF;
+
+        length += STREAM_PANEL_SIZE;
+        framePanels++;
     }
-    else
+
+    if (framePanels == 0)
     {
-        debugLog("Unsupported HTTP method: " + method);
-        http.end();
+        return 0;
+    }
+
+    streamBuffer[0] = framePanels >> 8;
+    streamBuffer[1] = framePanels & 0xFF;
+    return length;
+}
+
+bool NanoleafController::sendStreamFrame(const uint8_t *frame, size_t length)
+{
+    if (!udp.beginPacket(streamAddress, NANOLEAF_EXT_CONTROL_PORT))
+    {
+        debugLog("❌ Failed to open UDP packet");
+        return false;
+    }
+
+    udp.write(frame, length);
+    return udp.endPacket() == 1;
+}
+
+bool NanoleafController::streamStaticColors(const ColorPalette &palette)
+{
+    if (palette.colorCount <= 0)
+    {
+        return false;
+    }
+
+    if (!streamingActive)
+    {
+        return false;
+    }
+
+    uint32_t contentHash = PayloadCache::paletteHash(palette);
+    uint32_t variant = payloadVariant(PAYLOAD_STREAM_FRAME, nanoleafConfig.transitionTime);
+    size_t length = 0;
+    const uint8_t *frame = payloadCache.find(contentHash, variant, length);
+
+    if (frame == nullptr)
+    {
+        RGBColor frameColors[NANOLEAF_MAX_PANELS];
+        mapPaletteToPanels(palette, frameColors);
+
+        length = buildStreamFrame(nullptr, frameColors, panelCount, nanoleafConfig.transitionTime);
+        if (length == 0)
+        {
+            return true; // No panels to address
+        }
+
+        frame = streamBuffer;
+        payloadCache.store(contentHash, variant, frame, length);
+    }
+
+    bool result = sendStreamFrame(frame, length);
+    if (result)
+    {
+        debugLog("✅ Static colors streamed via UDP");
+    }
+
+    return result;
+}
+
+bool NanoleafController::sendHttpRequest(const String &endpoint, const String &method, const String &payload, JsonDocument *response)
+{
+    return sendHttpRequest(endpoint, method, (const uint8_t *)payload.c_str(), payload.length(), response);
+}
+
+bool NanoleafController::sendHttpRequest(const String &endpoint, const String &method, const uint8_t *body, size_t bodyLength, JsonDocument *response)
+{
+    if (method != "GET" && method != "POST" && method != "PUT" && method != "DELETE")
+    {
+        debugLogf("Unsupported HTTP method: %s", method.c_str());
         return false;
     }
 
+    // Build URL using working controller pattern: baseUrl + "/api/v1/" + authToken + endpoint
+    String url = getApiBase() + endpoint;
+
+    // Only log URL for debugging, not every header detail
+    if (endpoint == "/effects" && method == "PUT")
+    {
+        debugLog("🎨 Sending color data to Nanoleaf");
+    }
+
+    // A kept-alive socket may have been closed by the controller in the meantime
+    MetricSpan roundTripSpan(Metrics::NANOLEAF_HTTP);
+    bool reusingConnection = tcpClient.connected();
+    int httpResponseCode = performHttpRequest(url, method, body, bodyLength);
+
+    if (httpResponseCode < 0 && reusingConnection)
+    {
+        debugLog("🔌 Keep-alive connection dropped, reconnecting");
+        http.end();
+        tcpClient.stop();
+        httpResponseCode = performHttpRequest(url, method, body, bodyLength);
+    }
+    roundTripSpan.end();
+
     if (httpResponseCode < 200 || httpResponseCode >= 300)
     {
-        debugLog("❌ HTTP Error " + String(httpResponseCode));
+        debugLogf("❌ HTTP Error %d", httpResponseCode);
 
         // Get the error response body for more details
         String errorResponse = http.getString();
         if (errorResponse.length() > 0)
         {
-            debugLog("📄 Error response body: " + errorResponse);
+            debugLogf("📄 Error response body: %s", errorResponse.c_str());
         }
 
         // Provide specific error guidance
@@ -697,7 +1101,7 @@ bool NanoleafController::sendHttpRequest(const String &endpoint, const String &m
         }
         else if (httpResponseCode == 404)
         {
-            debugLog("💡 HTTP 404 Not Found - Check endpoint URL: " + url);
+            debugLogf("💡 HTTP 404 Not Found - Check endpoint URL: %s", url.c_str());
         }
     }
 
@@ -710,7 +1114,7 @@ bool NanoleafController::sendHttpRequest(const String &endpoint, const String &m
             DeserializationError error = deserializeJson(*response, responseStr);
             if (error)
             {
-                debugLog("JSON parsing error: " + String(error.c_str()));
+                debugLogf("JSON parsing error: %s", error.c_str());
                 http.end();
                 return false;
             }
@@ -725,6 +1129,64 @@ bool NanoleafController::sendHttpRequest(const String &endpoint, const String &m
     return false;
 }
 
+int NanoleafController::performHttpRequest(const String &url, const String &method, const uint8_t *body, size_t bodyLength)
+{
+    // Reuse the persistent socket - http.end() leaves it open when the controller allows keep-alive
+    http.setReuse(true);
+    http.begin(tcpClient, url);
+    http.addHeader("Content-Type", "application/json");
+    http.addHeader("User-Agent", "PalPalette-ESP32");
+
+    // HTTPClient takes a non-const pointer but only reads the body
+    uint8_t *payload = const_cast<uint8_t *>(body);
+
+    if (method == "GET")
+    {
+        return http.GET();
+    }
+    else if (method == "POST")
+    {
+        return http.POST(payload, bodyLength);
+    }
+    else if (method == "PUT")
+    {
+        return http.PUT(payload, bodyLength);
+    }
+
+    return http.sendRequest("DELETE", payload, bodyLength);
+}
+
+const String &NanoleafController::getApiBase()
+{
+    if (apiBase.length() == 0 || baseUrl != apiBaseUrl || authToken != apiBaseToken)
+    {
+        // A different host cannot share the open socket
+        if (baseUrl != apiBaseUrl)
+        {
+            closeConnection();
+        }
+
+        apiBaseUrl = baseUrl;
+        apiBaseToken = authToken;
+
+        apiBase = baseUrl;
+        apiBase += "/api/v1";
+        if (authToken.length() > 0)
+        {
+            apiBase += "/";
+            apiBase += authToken;
+        }
+    }
+
+    return apiBase;
+}
+
+void NanoleafController::closeConnection()
+{
+    http.end();
+    tcpClient.stop();
+}
+
 String NanoleafController::createColorAnimationData(const ColorPalette &palette, AnimationType animation)
 {
     JsonDocument doc;
@@ -765,51 +1227,53 @@ String NanoleafController::createColorAnimationData(const ColorPalette &palette,
     return result;
 }
 
-String NanoleafController::createStaticColorData(const ColorPalette &palette)
+size_t NanoleafController::createStaticColorData(const ColorPalette &palette)
 {
-    JsonDocument doc;
+    // Worst-case size for this palette and layout; bounded by the preallocated buffer
+    size_t capacity = STATIC_PAYLOAD_BASE_SIZE + palette.colorCount * STATIC_PAYLOAD_COLOR_SIZE + panelCount * STATIC_PAYLOAD_PANEL_SIZE;
+    PayloadWriter writer(payloadBuffer, min(capacity, sizeof(payloadBuffer)));
 
     // Use the correct Nanoleaf API format for static colors - wrap in "write" object
-    doc["write"]["command"] = "display";
-    doc["write"]["animType"] = "static";
-    doc["write"]["animData"] = "";
-    doc["write"]["loop"] = false;
+    writer.append("{\"write\":{\"command\":\"display\",\"animType\":\"static\",");
 
-    // Create HSB palette array
-    JsonArray paletteArray = doc["write"]["palette"].to<JsonArray>();
-    for (int i = 0; i < palette.colorCount; i++)
-    {
-        RGBColor rgbColor = palette.colors[i];
-        HSBColor hsbColor = rgbToHsb(rgbColor);
-
-        JsonObject colorObj = paletteArray.add<JsonObject>();
-        colorObj["hue"] = hsbColor.h;
-        colorObj["saturation"] = hsbColor.s;
-        colorObj["brightness"] = hsbColor.b;
-    }
-    doc["write"]["colorType"] = "HSB";
-
-    // Create animData string in correct format: numPanels; panelId0; numFrames0; RGBWT01; panelId1; numFrames1; RGBWT11; ...
-    String animData = String(panelCount) + " "; // Start with number of panels
+    RGBColor panelColors[NANOLEAF_MAX_PANELS];
+    mapPaletteToPanels(palette, panelColors);
 
+    // animData format: numPanels; panelId0; numFrames0; RGBWT01; panelId1; numFrames1; RGBWT11; ...
+    writer.key("animData").append('"').append(panelCount);
     for (int i = 0; i < panelCount; i++)
     {
-        RGBColor color = palette.colors[i % palette.colorCount];
+        const RGBColor &color = panelColors[i];
 
         // Format: panelId numFrames R G B W T
-        animData += String(panels[i].panelId) + " ";
-        animData += "1 "; // Number of frames
-        animData += String(color.r) + " " + String(color.g) + " " + String(color.b) + " 0 20 ";
+        writer.append(' ').append(panels[i].panelId).append(" 1 ", 3);
+        writer.append(color.r).append(' ').append(color.g).append(' ').append(color.b).append(" 0 20", 5);
     }
+    writer.append("\",\"loop\":false,");
 
-    // Remove trailing space
-    animData.trim();
-    doc["write"]["animData"] = animData;
+    // HSB palette array
+    writer.key("palette").append('[');
+    for (int i = 0; i < palette.colorCount; i++)
+    {
+        HSBColor hsbColor = rgbToHsb(palette.colors[i]);
 
-    String result;
-    serializeJson(doc, result);
+        if (i > 0)
+        {
+            writer.append(',');
+        }
+        writer.append('{').key("hue").append(hsbColor.h);
+        writer.append(',').key("saturation").append(hsbColor.s);
+        writer.append(',').key("brightness").append(hsbColor.b).append('}');
+    }
+    writer.append("],\"colorType\":\"HSB\"}}");
 
-    return result;
+    if (writer.overflowed())
+    {
+        debugLogf("❌ Static color payload exceeds %u bytes", (unsigned)capacity);
+        return 0;
+    }
+
+    return writer.size();
 }
 
 bool NanoleafController::validateAuthToken()
@@ -824,13 +1288,15 @@ bool NanoleafController::validateAuthToken()
 
 void NanoleafController::distributeColorsAcrossPanels(const ColorPalette &palette, JsonArray &panelColors)
 {
+    RGBColor colors[NANOLEAF_MAX_PANELS];
+    mapPaletteToPanels(palette, colors);
+
     for (int i = 0; i < panelCount; i++)
     {
         JsonObject panelColor = panelColors.add<JsonObject>();
         panelColor["panelId"] = panels[i].panelId;
 
-        // Distribute colors evenly across panels
-        RGBColor color = palette.colors[i % palette.colorCount];
+        const RGBColor &color = colors[i];
         panelColor["r"] = color.r;
         panelColor["g"] = color.g;
         panelColor["b"] = color.b;
@@ -860,7 +1326,7 @@ void NanoleafController::notifyUserActionRequired()
     String action = "nanoleaf_pairing";
     String instructions = "Hold the power button on your Nanoleaf for 5-7 seconds until the LED flashes to enter pairing mode";
 
-    debugLog("IMPORTANT: " + instructions);
+    debugLogf("IMPORTANT: %s", instructions.c_str());
 
     if (notificationCallback)
     {
@@ -883,7 +1349,7 @@ void NanoleafController::notifyUserActionCompleted(bool success)
     String action = success ? "nanoleaf_pairing_success" : "nanoleaf_pairing_failed";
     String instructions = success ? "Nanoleaf pairing completed successfully" : "Nanoleaf pairing failed or timed out";
 
-    debugLog(instructions);
+    debugLog(instructions.c_str());
 
     if (notificationCallback)
     {
@@ -893,13 +1359,13 @@ void NanoleafController::notifyUserActionCompleted(bool success)
 
 bool NanoleafController::discoverNanoleaf(int deviceIndex)
 {
-    if (deviceIndex < 0 || deviceIndex >= discoveredDeviceCount)
+    if (deviceIndex < 0 || deviceIndex >= discovery.getDeviceCount())
     {
-        debugLog("Invalid device index: " + String(deviceIndex));
+        debugLogf("Invalid device index: %d", deviceIndex);
         return false;
     }
 
-    DiscoveredDevice &device = discoveredDevices[deviceIndex];
+    const NanoleafDiscovery::Device &device = discovery.getDevice(deviceIndex);
 
     if (!device.isResponding)
     {
@@ -907,30 +1373,35 @@ bool NanoleafController::discoverNanoleaf(int deviceIndex)
         return false;
     }
 
-    config.hostAddress = device.ipAddress;
-    config.port = device.port;
+    selectHost(device.ipAddress, device.port);
+
+    debugLogf("Selected Nanoleaf device: %s (%s:%u)", device.hostname.c_str(), device.ipAddress.c_str(), device.port);
+    debugLogf("🔗 Updated base URL (working pattern): %s", baseUrl.c_str());
+    return true;
+}
+
+void NanoleafController::selectHost(const String &ipAddress, uint16_t port)
+{
+    config.hostAddress = ipAddress;
+    config.port = port;
 
     // Update base URL using working controller pattern (without /api/v1/ - added in sendRequest)
     baseUrl = "http://" + config.hostAddress + ":" + String(config.port);
-
-    debugLog("Selected Nanoleaf device: " + device.hostname + " (" + device.ipAddress + ":" + String(device.port) + ")");
-    debugLog("🔗 Updated base URL (working pattern): " + baseUrl);
-    return true;
 }
 
 int NanoleafController::getDiscoveredDeviceCount()
 {
-    return discoveredDeviceCount;
+    return discovery.getDeviceCount();
 }
 
 String NanoleafController::getDiscoveredDeviceInfo(int index)
 {
-    if (index < 0 || index >= discoveredDeviceCount)
+    if (index < 0 || index >= discovery.getDeviceCount())
     {
         return "Invalid index";
     }
 
-    DiscoveredDevice &device = discoveredDevices[index];
+    const NanoleafDiscovery::Device &device = discovery.getDevice(index);
     String status = device.isResponding ? "Responding" : "Not responding";
 
     return device.hostname + " (" + device.ipAddress + ":" + String(device.port) + ") - " + status;
@@ -938,52 +1409,13 @@ String NanoleafController::getDiscoveredDeviceInfo(int index)
 
 NanoleafController::HSBColor NanoleafController::rgbToHsb(const RGBColor &rgb)
 {
-    HSBColor hsb;
-
-    float r = rgb.r / 255.0f;
-    float g = rgb.g / 255.0f;
-    float b = rgb.b / 255.0f;
-
-    float max = std::max({r, g, b});
-    float min = std::min({r, g, b});
-    float delta = max - min;
-
-    // Brightness (0-100)
-    hsb.b = (int)(max * 100);
-
-    // Saturation (0-100)
-    if (max == 0)
-    {
-        hsb.s = 0;
-    }
-    else
-    {
-        hsb.s = (int)((delta / max) * 100);
-    }
-
-    // Hue (0-360)
-    if (delta == 0)
-    {
-        hsb.h = 0;
-    }
-    else if (max == r)
-    {
-        hsb.h = (int)(60 * (((g - b) / delta) + (g < b ? 6 : 0)));
-    }
-    else if (max == g)
-    {
-        hsb.h = (int)(60 * (((b - r) / delta) + 2));
-    }
-    else // max == b
-    {
-        hsb.h = (int)(60 * (((r - g) / delta) + 4));
-    }
-
-    // Ensure hue is in 0-360 range
-    if (hsb.h < 0)
-        hsb.h += 360;
-    if (hsb.h >= 360)
-        hsb.h -= 360;
+    ColorMath::HSB converted = ColorMath::rgbToHsb(rgb);
 
+    HSBColor hsb;
+    hsb.h = converted.h;
+    hsb.s = converted.s;
+    hsb.b = converted.b;
     return hsb;
 }
+
+#endif // PALPALETTE_DISABLE_NANOLEAF
@@ -2,18 +2,27 @@
 #define NANOLEAF_CONTROLLER_H
 
 #include "../LightController.h"
+#include "../PayloadWriter.h"
+#include "../PayloadCache.h"
+#include "NanoleafDiscovery.h"
+#include "../SpatialMap.h"
+#include "../../config.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
+#include <WiFiUdp.h>
 #include <ArduinoJson.h>
 #include <ESPmDNS.h>
 #include <algorithm>
+#include <atomic>
 
 /**
  * Nanoleaf Aurora/Canvas/Shapes controller implementation
  *
  * This controller interfaces with Nanoleaf panels using their REST API.
+ * Once external control is enabled, per-panel frames are streamed over
+ * UDP (extControl v2) instead of rebuilding an HTTP effect for every palette.
  * It supports:
- * - Automatic panel discovery via mDNS
+ * - Automatic panel discovery via mDNS (background task, last-known-good host cached)
  * - Authentication token management
  * - Color palette display with smooth transitions
  * - Panel-specific animations
@@ -22,8 +31,11 @@
  */
 class NanoleafController : public LightController
 {
+    friend class Benchmarks; // Drives the payload builders with synthetic layouts
+
 private:
     HTTPClient http;
+    WiFiClient tcpClient; // Persistent keep-alive socket shared by all REST calls
     String baseUrl;
     String authToken;
     int panelCount;
@@ -37,6 +49,7 @@ private:
         bool enableExternalControl = true;
         String defaultAnimation = "fade";
         int defaultBrightness = 100;
+        SpatialMap::Mode layoutMode = SpatialMap::modeFromName(NANOLEAF_LAYOUT_MODE);
     } nanoleafConfig;
 
     // Panel information
@@ -47,19 +60,69 @@ private:
         int shapeType; // Shape type (12 = controller, should be excluded)
     };
 
-    PanelInfo panels[50]; // Support up to 50 panels
+    // Cached "<baseUrl>/api/v1/<token>" prefix, rebuilt only when host or token change
+    String apiBase;
+    String apiBaseUrl;
+    String apiBaseToken;
+
+    PanelInfo panels[NANOLEAF_MAX_PANELS]; // Support up to 50 panels
+    SpatialMap spatialMap;                 // Panel order along nanoleafConfig.layoutMode, rebuilt per layout
 
-    // Discovery results storage
-    struct DiscoveredDevice
+    // Persisted panel layout (filtered PanelInfo table), one entry per host, checked against serial/firmware
+    struct LayoutCacheHeader
+    {
+        uint16_t version;
+        uint16_t panelCount;
+        uint32_t deviceKey;  // Hash of serialNo + firmwareVersion
+        uint32_t layoutHash; // Hash of the cached PanelInfo table
+        char hostAddress[40];
+    };
+    static const uint16_t LAYOUT_CACHE_VERSION = 1;
+    static const char *LAYOUT_PREF_NAMESPACE;
+    uint32_t deviceKey; // 0 until testConnection() has read the device info
+    uint32_t cachedLayoutHash;
+    bool layoutRevalidationPending;
+    unsigned long layoutCacheLoadTime;
+
+    // Revalidation GET, handed from loop() to loopUnlocked() and back
+    enum LayoutFetch : uint8_t
+    {
+        FETCH_IDLE,
+        FETCH_DUE,    // layoutFetchUrl set, loopUnlocked() owns the fetch fields
+        FETCH_DONE,   // fetchedLayout holds the response body
+        FETCH_FAILED
+    };
+    std::atomic<uint8_t> layoutFetch;
+    String layoutFetchUrl;
+    String layoutFetchHost; // Host the fetch was for - a re-pointed controller drops the result
+    String fetchedLayout;
+
+    // External control streaming (extControl v2)
+    // Frame layout: nPanels(2) + per panel: panelId(2) R G B W(1 each) transitionTime(2)
+    static const int STREAM_HEADER_SIZE = 2;
+    static const int STREAM_PANEL_SIZE = 8;
+    WiFiUDP udp;
+    IPAddress streamAddress;
+    bool streamingActive;
+    uint8_t streamBuffer[STREAM_HEADER_SIZE + NANOLEAF_MAX_PANELS * STREAM_PANEL_SIZE];
+
+    // Static effect payload, formatted in place (see createStaticColorData)
+    static const int STATIC_PAYLOAD_BASE_SIZE = 160;  // "write" envelope and fixed fields
+    static const int STATIC_PAYLOAD_COLOR_SIZE = 48;  // {"hue":360,"saturation":100,"brightness":100},
+    static const int STATIC_PAYLOAD_PANEL_SIZE = 26;  // " 65535 1 255 255 255 0 20"
+    char payloadBuffer[STATIC_PAYLOAD_BASE_SIZE + MAX_COLORS * STATIC_PAYLOAD_COLOR_SIZE + NANOLEAF_MAX_PANELS * STATIC_PAYLOAD_PANEL_SIZE];
+
+    // Encoded static effects and stream frames of recent palettes; variants carry layoutVersion
+    enum PayloadKind : uint8_t
     {
-        String hostname;
-        String ipAddress;
-        uint16_t port;
-        bool isResponding;
+        PAYLOAD_STATIC_EFFECT = 1, // createStaticColorData() HTTP body
+        PAYLOAD_STREAM_FRAME = 2   // extControl v2 frame of streamStaticColors()
     };
+    PayloadCache payloadCache;
+    uint32_t layoutVersion; // Bumped whenever the panel table or layout mode changes
 
-    DiscoveredDevice discoveredDevices[10]; // Support up to 10 discovered devices
-    int discoveredDeviceCount;
+    // Background mDNS discovery and concurrent probing of candidates
+    NanoleafDiscovery discovery;
 
 public:
     // HSB color structure for Nanoleaf API
@@ -89,6 +152,20 @@ public:
     LightConfig getUpdatedConfig() override;
     JsonObject getCapabilities() override;
     bool isReady() const override;
+    void loop() override;
+    void loopUnlocked() override;
+    bool hasBackgroundWork() const override { return layoutRevalidationPending || layoutFetch != FETCH_IDLE; }
+    void statsToJson(JsonObject out) override { payloadCache.statsToJson(out["payloadCache"].to<JsonObject>()); }
+    const uint16_t *getPixelPositions() const override
+    {
+        return spatialMap.getCount() == panelCount ? spatialMap.getPositions() : nullptr;
+    }
+    int getPixelCount() const override { return panelCount; }
+    bool beginStreaming() override { return startStreaming(); }
+    bool streamPixels(const int *pixelIndices, const RGBColor *colors, int count, int transitionTime) override
+    {
+        return streamPanelColors(pixelIndices, colors, count, transitionTime);
+    }
 
     // Nanoleaf-specific methods
     bool discoverNanoleaf();
@@ -99,6 +176,21 @@ public:
     bool setAnimatedColors(const ColorPalette &palette, const String &animationType);
     bool enableExternalControl();
     bool disableExternalControl();
+
+    // UDP streaming helpers (require external control to be enabled)
+    bool startStreaming();
+    void stopStreaming();
+    bool isStreaming() const { return streamingActive; }
+
+    /**
+     * Stream per-panel colors as a single extControl v2 UDP frame
+     * @param panelIndices Indices into the panel table, or nullptr for 0..count-1
+     * @param colors Color for each listed panel
+     * @param count Number of panels in this frame
+     * @param transitionTime Transition time in tenths of seconds
+     * @return true if the datagram was handed to the network stack
+     */
+    bool streamPanelColors(const int *panelIndices, const RGBColor *colors, int count, int transitionTime);
     void showConnectionSuccess(); // Visual feedback for successful connection
 
     // Discovery helpers
@@ -120,9 +212,30 @@ public:
 
 private:
     bool sendHttpRequest(const String &endpoint, const String &method, const String &payload = "", JsonDocument *response = nullptr);
+    bool sendHttpRequest(const String &endpoint, const String &method, const uint8_t *body, size_t bodyLength, JsonDocument *response = nullptr);
+    int performHttpRequest(const String &url, const String &method, const uint8_t *body, size_t bodyLength);
+    const String &getApiBase();
+    void closeConnection();
     String createColorAnimationData(const ColorPalette &palette, AnimationType animation);
-    String createStaticColorData(const ColorPalette &palette);
+    size_t createStaticColorData(const ColorPalette &palette); // Writes into payloadBuffer, returns length (0 on overflow)
+    bool streamStaticColors(const ColorPalette &palette);
+    size_t buildStreamFrame(const int *panelIndices, const RGBColor *colors, int count, int transitionTime); // Into streamBuffer, 0 = no panels
+    bool sendStreamFrame(const uint8_t *frame, size_t length);
+    uint32_t payloadVariant(PayloadKind kind, uint32_t parameter) const;
     bool validateAuthToken();
+
+    // Panel layout cache
+    bool loadPanelLayout(); // Cache first, network on miss
+    bool loadCachedLayout();
+    void saveCachedLayout(uint32_t layoutHash);
+    void layoutCacheKeys(char *headerKey, char *panelsKey) const; // Both at least 12 bytes
+    void applyPanelLayout(JsonDocument &response);
+    void finishLayoutRevalidation(bool fetched);
+    uint32_t computeLayoutHash() const;
+    void buildSpatialMap();
+    void mapPaletteToPanels(const ColorPalette &palette, RGBColor *out);
+    void selectHost(const String &ipAddress, uint16_t port);
+    void rememberHost();
     String rgbToHsl(const RGBColor &color);
     RGBColor hslToRgb(float h, float s, float l);
     void distributeColorsAcrossPanels(const ColorPalette &palette, JsonArray &panelColors);
@@ -0,0 +1,392 @@
+#include "NanoleafDiscovery.h"
+
+#ifndef PALPALETTE_DISABLE_NANOLEAF
+#include <ESPmDNS.h>
+#include <Preferences.h>
+#include <lwip/sockets.h>
+#include "../../core/Log.h"
+
+static const char *const LOG_TAG = "discovery";
+
+const char *NanoleafDiscovery::PREF_NAMESPACE = "nl_discovery";
+
+NanoleafDiscovery::NanoleafDiscovery()
+    : state(IDLE), doneSignal(nullptr), mdnsStarted(false),
+      taskRunning(false), cancelRequested(false), exitWaiter(nullptr), deviceCount(0)
+{
+}
+
+NanoleafDiscovery::~NanoleafDiscovery()
+{
+    portENTER_CRITICAL(&lock);
+    cancelRequested = true;
+    exitWaiter = xTaskGetCurrentTaskHandle();
+    bool running = taskRunning;
+    portEXIT_CRITICAL(&lock);
+
+    // The task writes into this object and gives doneSignal - neither may go away under it.
+    // A blocking mDNS query only notices the cancel once it returns, so there is no deadline here.
+    while (running)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(250));
+        globalFeedWatchdog();
+
+        portENTER_CRITICAL(&lock);
+        running = taskRunning;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    if (doneSignal)
+    {
+        vSemaphoreDelete(doneSignal);
+        doneSignal = nullptr;
+    }
+}
+
+bool NanoleafDiscovery::start()
+{
+    if (getState() == RUNNING)
+    {
+        return true;
+    }
+
+    if (!doneSignal)
+    {
+        doneSignal = xSemaphoreCreateBinary();
+        if (!doneSignal)
+        {
+            LOG_E("❌ Failed to create discovery semaphore");
+            return false;
+        }
+    }
+
+    // Clear a completion signal nobody waited for
+    xSemaphoreTake(doneSignal, 0);
+
+    portENTER_CRITICAL(&lock);
+    state = RUNNING;
+    taskRunning = true;
+    portEXIT_CRITICAL(&lock);
+
+    if (xTaskCreate(taskEntry, "nl_discovery", NANOLEAF_DISCOVERY_TASK_STACK_SIZE, this, 1, nullptr) != pdPASS)
+    {
+        LOG_E("❌ Failed to start discovery task");
+        portENTER_CRITICAL(&lock);
+        state = FAILED;
+        taskRunning = false;
+        portEXIT_CRITICAL(&lock);
+        return false;
+    }
+
+    LOG_I("🔍 Nanoleaf discovery started in background");
+    return true;
+}
+
+bool NanoleafDiscovery::waitForCompletion(unsigned long timeoutMs)
+{
+    unsigned long startTime = millis();
+
+    while (getState() == RUNNING && millis() - startTime < timeoutMs)
+    {
+        // Short slices keep the watchdog fed while this task sleeps
+        xSemaphoreTake(doneSignal, pdMS_TO_TICKS(250));
+        globalFeedWatchdog();
+    }
+
+    return getState() == COMPLETE;
+}
+
+NanoleafDiscovery::State NanoleafDiscovery::getState() const
+{
+    portENTER_CRITICAL(&lock);
+    State current = state;
+    portEXIT_CRITICAL(&lock);
+    return current;
+}
+
+void NanoleafDiscovery::setState(State newState)
+{
+    portENTER_CRITICAL(&lock);
+    state = newState;
+    portEXIT_CRITICAL(&lock);
+}
+
+int NanoleafDiscovery::getDeviceCount() const
+{
+    return getState() == RUNNING ? 0 : deviceCount;
+}
+
+const NanoleafDiscovery::Device &NanoleafDiscovery::getDevice(int index) const
+{
+    return devices[constrain(index, 0, MAX_DEVICES - 1)];
+}
+
+int NanoleafDiscovery::getFirstRespondingIndex() const
+{
+    int count = getDeviceCount();
+    for (int i = 0; i < count; i++)
+    {
+        if (devices[i].isResponding)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool NanoleafDiscovery::isCancelled() const
+{
+    portENTER_CRITICAL(&lock);
+    bool cancelled = cancelRequested;
+    portEXIT_CRITICAL(&lock);
+    return cancelled;
+}
+
+void NanoleafDiscovery::taskEntry(void *parameter)
+{
+    static_cast<NanoleafDiscovery *>(parameter)->run();
+    vTaskDelete(nullptr);
+}
+
+void NanoleafDiscovery::finish(State result)
+{
+    setState(result);
+    xSemaphoreGive(doneSignal);
+
+    portENTER_CRITICAL(&lock);
+    taskRunning = false;
+    TaskHandle_t waiter = exitWaiter;
+    portEXIT_CRITICAL(&lock);
+
+    // The destructor may free this object from here on - only locals below
+    if (waiter != nullptr)
+    {
+        xTaskNotifyGive(waiter);
+    }
+}
+
+void NanoleafDiscovery::run()
+{
+    deviceCount = 0;
+
+    if (!mdnsStarted)
+    {
+        mdnsStarted = MDNS.begin("palpalette");
+    }
+
+    if (!mdnsStarted)
+    {
+        LOG_E("❌ Failed to start mDNS");
+        finish(FAILED);
+        return;
+    }
+
+    // Each query already waits for responses, so attempts run back to back
+    int servicesFound = 0;
+    for (int attempt = 1; attempt <= NANOLEAF_MDNS_QUERY_ATTEMPTS && servicesFound == 0 && !isCancelled(); attempt++)
+    {
+        servicesFound = MDNS.queryService("nanoleafapi", "tcp");
+    }
+
+    if (isCancelled())
+    {
+        finish(FAILED);
+        return;
+    }
+
+    IPAddress addresses[MAX_DEVICES];
+    uint16_t ports[MAX_DEVICES];
+    bool responding[MAX_DEVICES];
+
+    for (int i = 0; i < servicesFound && deviceCount < MAX_DEVICES; i++)
+    {
+        IPAddress ip = MDNS.IP(i);
+        if ((uint32_t)ip == 0)
+        {
+            continue;
+        }
+
+        Device &device = devices[deviceCount];
+        device.hostname = MDNS.hostname(i);
+        device.ipAddress = ip.toString();
+        device.port = MDNS.port(i);
+        device.isResponding = false;
+
+        addresses[deviceCount] = ip;
+        ports[deviceCount] = device.port;
+        deviceCount++;
+    }
+
+    if (deviceCount > 0)
+    {
+        int respondingCount = probe(addresses, ports, responding, deviceCount, NANOLEAF_PROBE_TIMEOUT);
+        for (int i = 0; i < deviceCount; i++)
+        {
+            devices[i].isResponding = responding[i];
+        }
+
+        LOG_I("🔍 Nanoleaf discovery: %d found, %d responding", deviceCount, respondingCount);
+    }
+    else
+    {
+        LOG_E("❌ No Nanoleaf devices found via mDNS");
+    }
+
+    finish(deviceCount > 0 ? COMPLETE : FAILED);
+}
+
+int NanoleafDiscovery::probe(const IPAddress *addresses, const uint16_t *ports, bool *responding, int count, unsigned long timeoutMs)
+{
+    int sockets[MAX_DEVICES];
+    int pending = 0;
+    int respondingCount = 0;
+
+    count = min(count, MAX_DEVICES);
+
+    // Start every connect at once
+    for (int i = 0; i < count; i++)
+    {
+        responding[i] = false;
+        sockets[i] = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (sockets[i] < 0)
+        {
+            continue;
+        }
+
+        fcntl(sockets[i], F_SETFL, fcntl(sockets[i], F_GETFL, 0) | O_NONBLOCK);
+
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(ports[i]);
+        address.sin_addr.s_addr = (uint32_t)addresses[i];
+
+        int result = connect(sockets[i], (struct sockaddr *)&address, sizeof(address));
+        if (result == 0)
+        {
+            responding[i] = true;
+            respondingCount++;
+            close(sockets[i]);
+            sockets[i] = -1;
+        }
+        else if (errno == EINPROGRESS)
+        {
+            pending++;
+        }
+        else
+        {
+            close(sockets[i]);
+            sockets[i] = -1;
+        }
+    }
+
+    // Wait for the outstanding connects together
+    unsigned long startTime = millis();
+    while (pending > 0 && millis() - startTime < timeoutMs)
+    {
+        fd_set writeSet;
+        FD_ZERO(&writeSet);
+        int maxSocket = -1;
+        for (int i = 0; i < count; i++)
+        {
+            if (sockets[i] >= 0)
+            {
+                FD_SET(sockets[i], &writeSet);
+                maxSocket = max(maxSocket, sockets[i]);
+            }
+        }
+
+        unsigned long remaining = timeoutMs - (millis() - startTime);
+        struct timeval timeout;
+        timeout.tv_sec = remaining / 1000;
+        timeout.tv_usec = (remaining % 1000) * 1000;
+
+        if (select(maxSocket + 1, nullptr, &writeSet, nullptr, &timeout) <= 0)
+        {
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            if (sockets[i] < 0 || !FD_ISSET(sockets[i], &writeSet))
+            {
+                continue;
+            }
+
+            int socketError = 0;
+            socklen_t length = sizeof(socketError);
+            getsockopt(sockets[i], SOL_SOCKET, SO_ERROR, &socketError, &length);
+            if (socketError == 0)
+            {
+                responding[i] = true;
+                respondingCount++;
+            }
+
+            close(sockets[i]);
+            sockets[i] = -1;
+            pending--;
+        }
+    }
+
+    // Candidates that never answered
+    for (int i = 0; i < count; i++)
+    {
+        if (sockets[i] >= 0)
+        {
+            close(sockets[i]);
+        }
+    }
+
+    return respondingCount;
+}
+
+bool NanoleafDiscovery::probe(const String &ipAddress, uint16_t port, unsigned long timeoutMs)
+{
+    IPAddress address;
+    if (!address.fromString(ipAddress))
+    {
+        return false;
+    }
+
+    bool responding = false;
+    probe(&address, &port, &responding, 1, timeoutMs);
+    return responding;
+}
+
+bool NanoleafDiscovery::loadLastKnownGood(String &ipAddress, uint16_t &port)
+{
+    Preferences prefs;
+    if (!prefs.begin(PREF_NAMESPACE, true))
+    {
+        return false;
+    }
+
+    ipAddress = prefs.getString("ip", "");
+    port = prefs.getUShort("port", 0);
+    prefs.end();
+
+    return ipAddress.length() > 0 && port > 0;
+}
+
+void NanoleafDiscovery::saveLastKnownGood(const String &ipAddress, uint16_t port)
+{
+    String storedAddress;
+    uint16_t storedPort;
+    if (loadLastKnownGood(storedAddress, storedPort) && storedAddress == ipAddress && storedPort == port)
+    {
+        return; // Unchanged - spare the flash
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(PREF_NAMESPACE, false))
+    {
+        return;
+    }
+
+    prefs.putString("ip", ipAddress);
+    prefs.putUShort("port", port);
+    prefs.end();
+}
+
+#endif // PALPALETTE_DISABLE_NANOLEAF
@@ -0,0 +1,109 @@
+#ifndef NANOLEAF_DISCOVERY_H
+#define NANOLEAF_DISCOVERY_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "../../config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+/**
+ * Background Nanoleaf discovery
+ *
+ * Runs the mDNS query for _nanoleafapi._tcp on its own FreeRTOS task and
+ * then probes every candidate at once with non-blocking TCP connects
+ * multiplexed through select(), so no caller sleeps through fixed delays.
+ * The last host that worked is persisted and probed first, which lets a
+ * restart reconnect without any mDNS traffic.
+ */
+class NanoleafDiscovery
+{
+public:
+    static const int MAX_DEVICES = 10;
+
+    struct Device
+    {
+        String hostname;
+        String ipAddress;
+        uint16_t port;
+        bool isResponding;
+    };
+
+    enum State
+    {
+        IDLE,
+        RUNNING,
+        COMPLETE, // Finished with at least one candidate
+        FAILED    // mDNS unavailable or no candidates found
+    };
+
+    NanoleafDiscovery();
+
+    /**
+     * Cancels a running query and blocks until the task has exited
+     */
+    ~NanoleafDiscovery();
+
+    /**
+     * Start a discovery run in the background (no-op if one is running)
+     * @return true if a run is in progress
+     */
+    bool start();
+
+    /**
+     * Sleep the calling task until the current run finishes, feeding the watchdog
+     * @return true if the run completed with candidates
+     */
+    bool waitForCompletion(unsigned long timeoutMs);
+
+    State getState() const;
+    int getDeviceCount() const;
+    const Device &getDevice(int index) const;
+
+    /**
+     * Index of the first candidate that accepted a connection, or -1
+     */
+    int getFirstRespondingIndex() const;
+
+    /**
+     * Probe hosts concurrently with non-blocking TCP connects
+     * @param addresses Candidate addresses
+     * @param ports Candidate ports
+     * @param responding Output: whether each candidate accepted the connection
+     * @param count Number of candidates (at most MAX_DEVICES)
+     * @param timeoutMs Budget for the whole batch
+     * @return Number of responding candidates
+     */
+    static int probe(const IPAddress *addresses, const uint16_t *ports, bool *responding, int count, unsigned long timeoutMs);
+    static bool probe(const String &ipAddress, uint16_t port, unsigned long timeoutMs);
+
+    // Last-known-good host, persisted across restarts
+    static bool loadLastKnownGood(String &ipAddress, uint16_t &port);
+    static void saveLastKnownGood(const String &ipAddress, uint16_t port);
+
+private:
+    static const char *PREF_NAMESPACE;
+
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    State state;
+    SemaphoreHandle_t doneSignal;
+    bool mdnsStarted;
+
+    // Guarded by lock - the task owns this object until it clears taskRunning
+    bool taskRunning;
+    bool cancelRequested;
+    TaskHandle_t exitWaiter; // Notified once the task no longer touches this object
+
+    // Written only by the discovery task while RUNNING
+    Device devices[MAX_DEVICES];
+    int deviceCount;
+
+    void setState(State newState);
+    bool isCancelled() const;
+    static void taskEntry(void *parameter);
+    void run();
+    void finish(State result);
+};
+
+#endif // NANOLEAF_DISCOVERY_H
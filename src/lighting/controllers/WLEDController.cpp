@@ -0,0 +1,269 @@
+#include "WLEDController.h"
+
+#ifndef PALPALETTE_DISABLE_WLED
+#include "../ColorMath.h"
+
+WLEDController::WLEDController()
+    : realtimePort(WLED_REALTIME_PORT), ledCount(0), segmentCount(0), brightness(255),
+      framesSent(0), sendFailures(0)
+{
+}
+
+WLEDController::~WLEDController()
+{
+    udp.stop();
+}
+
+bool WLEDController::initialize(const LightConfig &config)
+{
+    this->config = config;
+    isInitialized = false;
+    isAuthenticated = true; // WLED has no pairing step
+
+    if (config.hostAddress.length() == 0)
+    {
+        debugLog("❌ WLED needs a host address");
+        return false;
+    }
+
+    if (!deviceAddress.fromString(config.hostAddress) &&
+        !WiFi.hostByName(config.hostAddress.c_str(), deviceAddress))
+    {
+        debugLogf("❌ Cannot resolve WLED host: %s", config.hostAddress.c_str());
+        return false;
+    }
+
+    if (!probeDevice())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < segmentCount; i++)
+    {
+        segments[i] = RGBColor();
+    }
+
+    isInitialized = true;
+    debugLogf("✅ WLED '%s' (%s): %d LEDs, realtime UDP %s:%u", deviceName.c_str(), firmwareVersion.c_str(),
+              ledCount, deviceAddress.toString().c_str(), realtimePort);
+    return true;
+}
+
+bool WLEDController::probeDevice()
+{
+    HTTPClient http;
+    http.setTimeout(WLED_HTTP_TIMEOUT);
+    http.begin("http://" + config.hostAddress + ":" + String(config.port > 0 ? config.port : 80) + "/json/info");
+    http.addHeader("User-Agent", "PalPalette-ESP32");
+
+    int httpCode = http.GET();
+    if (httpCode != 200)
+    {
+        debugLogf("❌ /json/info failed: HTTP %d", httpCode);
+        http.end();
+        return false;
+    }
+
+    // /json/info is several kB on recent firmware - keep only what we use
+    JsonDocument filter;
+    filter["leds"]["count"] = true;
+    filter["name"] = true;
+    filter["ver"] = true;
+    filter["udpport"] = true;
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, http.getStream(), DeserializationOption::Filter(filter));
+    http.end();
+
+    if (error)
+    {
+        debugLogf("❌ Failed to parse /json/info: %s", error.c_str());
+        return false;
+    }
+
+    int count = doc["leds"]["count"] | 0;
+    if (count <= 0)
+    {
+        debugLog("❌ WLED reports no LEDs");
+        return false;
+    }
+
+    ledCount = min(count, WLED_MAX_LEDS);
+    segmentCount = min(ledCount, ANIMATION_MAX_PIXELS);
+    deviceName = doc["name"] | "WLED";
+    firmwareVersion = doc["ver"] | "unknown";
+    realtimePort = doc["udpport"] | WLED_REALTIME_PORT;
+    return true;
+}
+
+bool WLEDController::testConnection()
+{
+    return probeDevice();
+}
+
+bool WLEDController::displayPalette(const ColorPalette &palette)
+{
+    if (!isInitialized || palette.colorCount <= 0)
+    {
+        return false;
+    }
+
+    // One even block per palette color along the strip
+    int colorCount = min(palette.colorCount, MAX_COLORS);
+    for (int i = 0; i < segmentCount; i++)
+    {
+        segments[i] = palette.colors[(i * colorCount) / segmentCount];
+    }
+
+    return sendFrame();
+}
+
+bool WLEDController::streamPixels(const int *pixelIndices, const RGBColor *colors, int count, int transitionTime)
+{
+    if (!isInitialized)
+    {
+        return false;
+    }
+
+    // Realtime frames are shown as-is - the engine's tick does the smoothing
+    for (int i = 0; i < count; i++)
+    {
+        int index = pixelIndices ? pixelIndices[i] : i;
+        if (index >= 0 && index < segmentCount)
+        {
+            segments[index] = colors[i];
+        }
+    }
+
+    return sendFrame();
+}
+
+bool WLEDController::turnOff()
+{
+    if (!isInitialized)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < segmentCount; i++)
+    {
+        segments[i] = RGBColor();
+    }
+    return sendFrame();
+}
+
+bool WLEDController::setBrightness(int brightness)
+{
+    if (!isInitialized)
+    {
+        return false;
+    }
+
+    this->brightness = (constrain(brightness, 0, 100) * 255) / 100;
+    return sendFrame();
+}
+
+String WLEDController::getStatus()
+{
+    if (!isInitialized)
+    {
+        return "WLED: not initialized";
+    }
+
+    return "WLED '" + deviceName + "' at " + config.hostAddress + ": " + String(ledCount) + " LEDs, " +
+           String(framesSent) + " frames sent (" + String(sendFailures) + " failed)";
+}
+
+String WLEDController::getSystemType()
+{
+    return "wled";
+}
+
+bool WLEDController::authenticate()
+{
+    return true;
+}
+
+bool WLEDController::requiresAuthentication()
+{
+    return false;
+}
+
+JsonObject WLEDController::getCapabilities()
+{
+    JsonDocument doc;
+    JsonObject caps = doc.to<JsonObject>();
+
+    caps["systemType"] = "wled";
+    caps["supportsAnimation"] = true;
+    caps["supportsBrightness"] = true;
+    caps["supportsColorTemperature"] = false;
+    caps["maxColors"] = MAX_COLORS;
+    caps["ledCount"] = ledCount;
+    caps["firmwareVersion"] = firmwareVersion;
+    caps["requiresAuthentication"] = false;
+
+    JsonArray supportedAnimations = caps["supportedAnimations"].to<JsonArray>();
+    supportedAnimations.add("static");
+    supportedAnimations.add("fade");
+    supportedAnimations.add("pulse");
+    supportedAnimations.add("wheel");
+    supportedAnimations.add("flow");
+
+    return caps;
+}
+
+bool WLEDController::sendFrame()
+{
+    // DRGB addresses the whole strip from LED 0; longer strips need DNRGB's start index
+    bool indexed = ledCount > DRGB_MAX_LEDS;
+    int perPacket = indexed ? DNRGB_MAX_LEDS : DRGB_MAX_LEDS;
+    bool success = true;
+
+    for (int start = 0; start < ledCount; start += perPacket)
+    {
+        int count = min(perPacket, ledCount - start);
+        size_t length = 0;
+
+        packet[length++] = indexed ? PROTOCOL_DNRGB : PROTOCOL_DRGB;
+        packet[length++] = WLED_REALTIME_TIMEOUT;
+        if (indexed)
+        {
+            packet[length++] = start >> 8;
+            packet[length++] = start & 0xFF;
+        }
+
+        for (int led = start; led < start + count; led++)
+        {
+            RGBColor color = ColorMath::scale(segments[(led * segmentCount) / ledCount], brightness);
+            packet[length++] = color.r;
+            packet[length++] = color.g;
+            packet[length++] = color.b;
+        }
+
+        if (!udp.beginPacket(deviceAddress, realtimePort))
+        {
+            success = false;
+            break;
+        }
+        udp.write(packet, length);
+        if (udp.endPacket() != 1)
+        {
+            success = false;
+            break;
+        }
+    }
+
+    if (success)
+    {
+        framesSent++;
+    }
+    else
+    {
+        sendFailures++;
+        debugLog("❌ Failed to send realtime frame");
+    }
+    return success;
+}
+
+#endif // PALPALETTE_DISABLE_WLED
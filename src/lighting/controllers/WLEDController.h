@@ -0,0 +1,77 @@
+#ifndef WLED_CONTROLLER_H
+#define WLED_CONTROLLER_H
+
+#include "../LightController.h"
+#include "../../config.h"
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <WiFiUdp.h>
+#include <ArduinoJson.h>
+
+/**
+ * WLED controller implementation
+ *
+ * The JSON API is only used to probe the device: GET /json/info supplies
+ * the LED count, name, version and realtime UDP port. Every frame then
+ * goes out as a single realtime datagram - DRGB for strips of up to 490
+ * LEDs, DNRGB chunks with a start index beyond that - so showing a palette
+ * or streaming an animation frame costs no HTTP round-trip.
+ *
+ * Strips longer than ANIMATION_MAX_PIXELS are driven as that many equal
+ * segments. Brightness is applied on this side, to the frame data.
+ */
+class WLEDController : public LightController
+{
+public:
+    WLEDController();
+    virtual ~WLEDController();
+
+    // Implement LightController interface
+    bool initialize(const LightConfig &config) override;
+    bool testConnection() override;
+    bool displayPalette(const ColorPalette &palette) override;
+    bool turnOff() override;
+    bool setBrightness(int brightness) override;
+    String getStatus() override;
+    String getSystemType() override;
+    bool authenticate() override;
+    bool requiresAuthentication() override;
+    JsonObject getCapabilities() override;
+    int getPixelCount() const override { return segmentCount; }
+    bool beginStreaming() override { return isInitialized; }
+    bool streamPixels(const int *pixelIndices, const RGBColor *colors, int count, int transitionTime) override;
+    uint16_t getFrameInterval() const override { return WLED_FRAME_INTERVAL; }
+
+private:
+    // Realtime protocol identifiers (first byte of each datagram)
+    static const uint8_t PROTOCOL_DRGB = 2;
+    static const uint8_t PROTOCOL_DNRGB = 4;
+    static const int DRGB_MAX_LEDS = 490;
+    static const int DNRGB_MAX_LEDS = 489;
+
+    WiFiUDP udp;
+    IPAddress deviceAddress;
+    uint16_t realtimePort;
+    int ledCount;
+    int segmentCount; // Pixels exposed to the animation engine (<= ANIMATION_MAX_PIXELS)
+    uint8_t brightness; // 0-255, applied to frame data
+    String deviceName;
+    String firmwareVersion;
+    uint32_t framesSent;
+    uint32_t sendFailures;
+
+    RGBColor segments[ANIMATION_MAX_PIXELS];
+    uint8_t packet[2 + DRGB_MAX_LEDS * 3]; // Largest datagram of either format (1472 bytes)
+
+    /**
+     * Read LED count, name, version and realtime port from /json/info
+     */
+    bool probeDevice();
+
+    /**
+     * Send the current segments as one DRGB datagram or a run of DNRGB ones
+     */
+    bool sendFrame();
+};
+
+#endif // WLED_CONTROLLER_H
@@ -0,0 +1,387 @@
+#include "WS2812Controller.h"
+
+#ifndef PALPALETTE_DISABLE_WS2812
+#include "../ColorMath.h"
+#include "../../core/Log.h"
+#include <new>
+
+static const char *const LOG_TAG = "ws2812";
+
+// WS2812B bit timings (ns): high/low time for a 0 bit and a 1 bit
+static const uint32_t T0H_NS = 400;
+static const uint32_t T0L_NS = 850;
+static const uint32_t T1H_NS = 800;
+static const uint32_t T1L_NS = 450;
+
+// 24 bits per LED at 1.25 us each, plus the latch gap the strip needs between frames
+static const uint32_t LED_WIRE_MICROS = 30;
+static const uint32_t RESET_MICROS = 300;
+
+rmt_item32_t WS2812Controller::bitZero;
+rmt_item32_t WS2812Controller::bitOne;
+portMUX_TYPE WS2812Controller::channelLock = portMUX_INITIALIZER_UNLOCKED;
+uint8_t WS2812Controller::channelsInUse = 0;
+
+WS2812Controller::WS2812Controller()
+    : channel(RMT_CHANNEL_MAX), pin(DEFAULT_LED_PIN), ledCount(0), segmentCount(0),
+      rgbOrder(false), brightness(255), driverInstalled(false), framePending(false),
+      framesSent(0), framesDeferred(0), frontBuffer(0), lastSendMicros(0)
+{
+    buffers[0] = nullptr;
+    buffers[1] = nullptr;
+}
+
+WS2812Controller::~WS2812Controller()
+{
+    releaseDriver();
+}
+
+bool WS2812Controller::initialize(const LightConfig &config)
+{
+    this->config = config;
+    releaseDriver();
+
+    JsonObject customConfig = config.customConfig;
+    pin = customConfig["pin"] | DEFAULT_LED_PIN;
+    ledCount = constrain((int)(customConfig["numLEDs"] | DEFAULT_NUM_LEDS), 1, WS2812_MAX_LEDS);
+    rgbOrder = strcmp(customConfig["colorOrder"] | "grb", "rgb") == 0;
+    segmentCount = min(ledCount, ANIMATION_MAX_PIXELS);
+
+    debugLogf("Initializing %d LEDs on GPIO %d (%d segments)", ledCount, pin, segmentCount);
+
+    buffers[0] = new (std::nothrow) uint8_t[ledCount * 3];
+    buffers[1] = new (std::nothrow) uint8_t[ledCount * 3];
+    if (!buffers[0] || !buffers[1])
+    {
+        LOG_E("❌ Failed to allocate WS2812 frame buffers - insufficient memory");
+        releaseDriver();
+        return false;
+    }
+    memset(buffers[0], 0, ledCount * 3);
+    memset(buffers[1], 0, ledCount * 3);
+
+    channel = claimChannel();
+    if (channel == RMT_CHANNEL_MAX)
+    {
+        LOG_E("❌ No free RMT channel - at most %d WS2812 strips can be driven", WS2812_RMT_CHANNELS);
+        releaseDriver();
+        return false;
+    }
+
+    rmt_config_t rmtConfig = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, channel);
+    rmtConfig.clk_div = WS2812_RMT_CLOCK_DIV;
+
+    if (rmt_config(&rmtConfig) != ESP_OK || rmt_driver_install(channel, 0, 0) != ESP_OK)
+    {
+        LOG_E("❌ Failed to set up RMT channel %d for WS2812 output", (int)channel);
+        releaseDriver();
+        return false;
+    }
+    driverInstalled = true;
+
+    // The first strip sets the shared pulse timings; later ones run from the same clock
+    portENTER_CRITICAL(&channelLock);
+    bool firstStrip = channelsInUse == (1 << channel);
+    portEXIT_CRITICAL(&channelLock);
+    if (firstStrip)
+    {
+        uint32_t counterHz = 0;
+        rmt_get_counter_clock(channel, &counterHz);
+        uint32_t ticksPerUs = counterHz / 1000000;
+
+        bitZero.level0 = 1;
+        bitZero.duration0 = T0H_NS * ticksPerUs / 1000;
+        bitZero.level1 = 0;
+        bitZero.duration1 = T0L_NS * ticksPerUs / 1000;
+        bitOne.level0 = 1;
+        bitOne.duration0 = T1H_NS * ticksPerUs / 1000;
+        bitOne.level1 = 0;
+        bitOne.duration1 = T1L_NS * ticksPerUs / 1000;
+    }
+
+    if (rmt_translator_init(channel, translate) != ESP_OK)
+    {
+        LOG_E("❌ Failed to register WS2812 RMT translator");
+        releaseDriver();
+        return false;
+    }
+
+    isInitialized = true;
+    isAuthenticated = true; // Local hardware - nothing to pair with
+
+    // Start from a known dark strip
+    for (int i = 0; i < segmentCount; i++)
+    {
+        segments[i] = RGBColor();
+    }
+    flush();
+
+    debugLog("WS2812 output ready");
+    return true;
+}
+
+bool WS2812Controller::testConnection()
+{
+    // No feedback line on a WS2812 strip - a working RMT channel is all we can check
+    return driverInstalled;
+}
+
+bool WS2812Controller::displayPalette(const ColorPalette &palette)
+{
+    if (!isInitialized || palette.colorCount <= 0)
+    {
+        return false;
+    }
+
+    // One even block per palette color along the strip
+    int colorCount = min(palette.colorCount, MAX_COLORS);
+    for (int i = 0; i < segmentCount; i++)
+    {
+        segments[i] = palette.colors[(i * colorCount) / segmentCount];
+    }
+
+    return flush();
+}
+
+bool WS2812Controller::streamPixels(const int *pixelIndices, const RGBColor *colors, int count, int transitionTime)
+{
+    if (!isInitialized)
+    {
+        return false;
+    }
+
+    // transitionTime is a device-side smoothing hint for networked systems - frames here are already 60 fps
+    for (int i = 0; i < count; i++)
+    {
+        int index = pixelIndices ? pixelIndices[i] : i;
+        if (index >= 0 && index < segmentCount)
+        {
+            segments[index] = colors[i];
+        }
+    }
+
+    return flush();
+}
+
+bool WS2812Controller::turnOff()
+{
+    if (!isInitialized)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < segmentCount; i++)
+    {
+        segments[i] = RGBColor();
+    }
+    return flush();
+}
+
+bool WS2812Controller::setBrightness(int brightness)
+{
+    if (!isInitialized)
+    {
+        return false;
+    }
+
+    this->brightness = (constrain(brightness, 0, 100) * 255) / 100;
+    return flush();
+}
+
+String WS2812Controller::getStatus()
+{
+    if (!isInitialized)
+    {
+        return "WS2812: not initialized";
+    }
+
+    return "WS2812: " + String(ledCount) + " LEDs on GPIO " + String(pin) +
+           ", " + String(framesSent) + " frames sent (" + String(framesDeferred) + " deferred)";
+}
+
+String WS2812Controller::getSystemType()
+{
+    return "ws2812";
+}
+
+bool WS2812Controller::authenticate()
+{
+    return true;
+}
+
+bool WS2812Controller::requiresAuthentication()
+{
+    return false;
+}
+
+JsonObject WS2812Controller::getCapabilities()
+{
+    JsonDocument doc;
+    JsonObject caps = doc.to<JsonObject>();
+
+    caps["systemType"] = "ws2812";
+    caps["supportsAnimation"] = true;
+    caps["supportsBrightness"] = true;
+    caps["supportsColorTemperature"] = false;
+    caps["maxColors"] = MAX_COLORS;
+    caps["ledCount"] = ledCount;
+    caps["pin"] = pin;
+    caps["requiresAuthentication"] = false;
+
+    JsonArray supportedAnimations = caps["supportedAnimations"].to<JsonArray>();
+    supportedAnimations.add("static");
+    supportedAnimations.add("fade");
+    supportedAnimations.add("pulse");
+    supportedAnimations.add("wheel");
+    supportedAnimations.add("flow");
+
+    return caps;
+}
+
+void WS2812Controller::loop()
+{
+    if (framePending)
+    {
+        sendPending();
+    }
+}
+
+bool WS2812Controller::flush()
+{
+    if (!driverInstalled)
+    {
+        return false;
+    }
+
+    // The front buffer may still be on the wire - only the back one is touched here
+    if (framePending)
+    {
+        framesDeferred++;
+    }
+    encode(buffers[1 - frontBuffer]);
+    framePending = true;
+
+    return sendPending();
+}
+
+bool WS2812Controller::sendPending()
+{
+    uint32_t busyMicros = ledCount * LED_WIRE_MICROS + RESET_MICROS;
+    if (micros() - lastSendMicros < busyMicros || rmt_wait_tx_done(channel, 0) != ESP_OK)
+    {
+        return true; // Still transmitting - loop() sends the newest frame once the strip has latched
+    }
+
+    int back = 1 - frontBuffer;
+    if (rmt_write_sample(channel, buffers[back], ledCount * 3, false) != ESP_OK)
+    {
+        debugLog("RMT write failed");
+        return false;
+    }
+
+    frontBuffer = back;
+    framePending = false;
+    lastSendMicros = micros();
+    framesSent++;
+    return true;
+}
+
+void WS2812Controller::encode(uint8_t *out)
+{
+    for (int i = 0; i < ledCount; i++)
+    {
+        RGBColor color = ColorMath::scale(segments[(i * segmentCount) / ledCount], brightness);
+        if (rgbOrder)
+        {
+            *out++ = color.r;
+            *out++ = color.g;
+        }
+        else
+        {
+            *out++ = color.g;
+            *out++ = color.r;
+        }
+        *out++ = color.b;
+    }
+}
+
+void WS2812Controller::releaseDriver()
+{
+    if (driverInstalled)
+    {
+        rmt_wait_tx_done(channel, pdMS_TO_TICKS(50));
+        rmt_driver_uninstall(channel);
+        driverInstalled = false;
+    }
+
+    if (channel != RMT_CHANNEL_MAX)
+    {
+        releaseChannel(channel);
+        channel = RMT_CHANNEL_MAX;
+    }
+
+    delete[] buffers[0];
+    delete[] buffers[1];
+    buffers[0] = nullptr;
+    buffers[1] = nullptr;
+
+    isInitialized = false;
+    isAuthenticated = false;
+    framePending = false;
+}
+
+rmt_channel_t WS2812Controller::claimChannel()
+{
+    rmt_channel_t claimed = RMT_CHANNEL_MAX;
+
+    portENTER_CRITICAL(&channelLock);
+    for (int candidate = 0; candidate < WS2812_RMT_CHANNELS; candidate++)
+    {
+        if (!(channelsInUse & (1 << candidate)))
+        {
+            channelsInUse |= 1 << candidate;
+            claimed = (rmt_channel_t)candidate;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&channelLock);
+
+    return claimed;
+}
+
+void WS2812Controller::releaseChannel(rmt_channel_t channel)
+{
+    portENTER_CRITICAL(&channelLock);
+    channelsInUse &= ~(1 << channel);
+    portEXIT_CRITICAL(&channelLock);
+}
+
+void IRAM_ATTR WS2812Controller::translate(const void *source, rmt_item32_t *dest, size_t sourceSize,
+                                           size_t wantedItems, size_t *translatedSize, size_t *itemCount)
+{
+    if (source == nullptr || dest == nullptr)
+    {
+        *translatedSize = 0;
+        *itemCount = 0;
+        return;
+    }
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(source);
+    size_t size = 0;
+    size_t items = 0;
+
+    // The driver asks for whole RMT memory blocks, always a multiple of 8 items
+    while (size < sourceSize && items + 8 <= wantedItems)
+    {
+        uint8_t value = bytes[size++];
+        for (int bit = 7; bit >= 0; bit--)
+        {
+            dest[items++].val = (value & (1 << bit)) ? bitOne.val : bitZero.val;
+        }
+    }
+
+    *translatedSize = size;
+    *itemCount = items;
+}
+
+#endif // PALPALETTE_DISABLE_WS2812
@@ -0,0 +1,89 @@
+#ifndef WS2812_CONTROLLER_H
+#define WS2812_CONTROLLER_H
+
+#include "../LightController.h"
+#include "../../config.h"
+#include <driver/rmt.h>
+
+/**
+ * WS2812 / NeoPixel strip controller on a local GPIO
+ *
+ * Frames are encoded by the RMT peripheral: the driver's translator turns
+ * GRB bytes into pulse items from its ISR, so transmitting a frame costs
+ * the CPU nothing beyond queuing it. Two pixel buffers alternate - the next
+ * frame is rendered into the back buffer while the front one is still on
+ * the wire, and a frame that arrives mid-transmission is sent as soon as
+ * the current one completes (from loop()), so output never blocks.
+ *
+ * The strip streams through the AnimationEngine at WS2812_FRAME_INTERVAL.
+ * Strips longer than ANIMATION_MAX_PIXELS are driven as that many equal
+ * segments. Each strip claims its own RMT TX channel, so up to
+ * WS2812_RMT_CHANNELS strips can run side by side.
+ *
+ * customConfig: "pin" (GPIO), "numLEDs", "colorOrder" ("grb" or "rgb")
+ */
+class WS2812Controller : public LightController
+{
+public:
+    WS2812Controller();
+    virtual ~WS2812Controller();
+
+    // Implement LightController interface
+    bool initialize(const LightConfig &config) override;
+    bool testConnection() override;
+    bool displayPalette(const ColorPalette &palette) override;
+    bool turnOff() override;
+    bool setBrightness(int brightness) override;
+    String getStatus() override;
+    String getSystemType() override;
+    bool authenticate() override;
+    bool requiresAuthentication() override;
+    JsonObject getCapabilities() override;
+    void loop() override;
+    bool hasBackgroundWork() const override { return framePending; }
+    int getPixelCount() const override { return segmentCount; }
+    bool beginStreaming() override { return isInitialized; }
+    bool streamPixels(const int *pixelIndices, const RGBColor *colors, int count, int transitionTime) override;
+    uint16_t getFrameInterval() const override { return WS2812_FRAME_INTERVAL; }
+
+private:
+    rmt_channel_t channel; // RMT_CHANNEL_MAX while none is claimed
+    int pin;
+    int ledCount;
+    int segmentCount;    // Pixels exposed to the animation engine (<= ANIMATION_MAX_PIXELS)
+    bool rgbOrder;       // false = GRB (WS2812B default)
+    uint8_t brightness;  // 0-255, applied while encoding
+    bool driverInstalled;
+    bool framePending;   // Back buffer holds an encoded frame not yet sent
+    uint32_t framesSent;
+    uint32_t framesDeferred; // Frames replaced by a newer one before they reached the wire
+
+    RGBColor segments[ANIMATION_MAX_PIXELS];
+    uint8_t *buffers[2]; // ledCount * 3 bytes each, in wire order
+    int frontBuffer;     // Buffer currently owned by the RMT driver
+    uint32_t lastSendMicros;
+
+    /**
+     * Encode segments into the back buffer and start transmitting it
+     * Leaves framePending set if the previous frame is still on the wire
+     */
+    bool flush();
+    bool sendPending();
+    void encode(uint8_t *out);
+    void releaseDriver();
+
+    // TX channels claimed by live strips (bit n = channel n)
+    static portMUX_TYPE channelLock;
+    static uint8_t channelsInUse;
+    static rmt_channel_t claimChannel();
+    static void releaseChannel(rmt_channel_t channel);
+
+    // RMT translator: wire bytes -> pulse items (runs in the RMT ISR)
+    // Shared by all channels - they run from the same clock divider, and are set only while no strip transmits
+    static rmt_item32_t bitZero;
+    static rmt_item32_t bitOne;
+    static void IRAM_ATTR translate(const void *source, rmt_item32_t *dest, size_t sourceSize,
+                                    size_t wantedItems, size_t *translatedSize, size_t *itemCount);
+};
+
+#endif // WS2812_CONTROLLER_H
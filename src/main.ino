@@ -20,9 +20,21 @@
 #include "core/WiFiManager.h"
 #include "core/DeviceManager.h"
 #include "core/WSClient.h"
+#include "core/TaskScheduler.h"
+#include "core/StatusChannel.h"
+#include "core/ConfigStore.h"
+#include "core/Metrics.h"
+#include "core/MemoryTelemetry.h"
+#include "core/Backoff.h"
+#include "core/Log.h"
 #include "lighting/LightManager.h"
+#ifdef PALPALETTE_BENCHMARKS
+#include "diagnostics/Benchmarks.h"
+#endif
 #include "root_ca.h"
 
+static const char *const LOG_TAG = "main";
+
 // Error Handling System
 class ErrorHandler
 {
@@ -42,7 +54,8 @@ public:
             if (!instance)
             {
                 // Critical failure - cannot allocate error handler
-                Serial.println("💀 CRITICAL: Failed to allocate ErrorHandler - system cannot continue");
+                LOG_E("💀 CRITICAL: Failed to allocate ErrorHandler - system cannot continue");
+                Log::flush();
                 ESP.restart();
             }
         }
@@ -60,20 +73,13 @@ public:
         lastErrorTime = millis();
         totalErrorCount++;
         errorCounts[static_cast<uint8_t>(code)]++;
+        Metrics::getInstance()->recordError(static_cast<uint8_t>(code));
 
-        String errorMsg = "❌ ERROR [" + String(static_cast<uint8_t>(code)) + "] " + getErrorName(code);
-        if (message.length() > 0)
-        {
-            errorMsg += ": " + message;
-        }
-        if (location.length() > 0)
-        {
-            errorMsg += " (at: " + location + ")";
-        }
-
-        Serial.println(errorMsg);
-        Serial.println("📊 Total errors: " + String(totalErrorCount) +
-                       ", This error count: " + String(errorCounts[static_cast<uint8_t>(code)]));
+        bool located = location.length() > 0;
+        LOG_E("❌ ERROR [%u] %s%s%s%s%s%s", static_cast<uint8_t>(code), getErrorName(code).c_str(),
+              message.length() > 0 ? ": " : "", message.c_str(),
+              located ? " (at: " : "", location.c_str(), located ? ")" : "");
+        LOG_E("📊 Total errors: %u, This error count: %u", totalErrorCount, errorCounts[static_cast<uint8_t>(code)]);
     }
 
     RecoveryStrategy getRecoveryStrategy(ErrorCode code)
@@ -150,67 +156,16 @@ public:
 
 ErrorHandler *ErrorHandler::instance = nullptr;
 
-// Exponential Backoff System for Network Retries
-class ExponentialBackoff
-{
-private:
-    unsigned long initialDelay;
-    unsigned long maxDelay;
-    unsigned long currentDelay;
-    unsigned int multiplier;
-    unsigned long lastAttemptTime;
-    int attemptCount;
-
-public:
-    ExponentialBackoff(unsigned long initial = INITIAL_RETRY_DELAY,
-                       unsigned long maximum = MAX_RETRY_DELAY,
-                       unsigned int mult = BACKOFF_MULTIPLIER)
-        : initialDelay(initial), maxDelay(maximum), multiplier(mult),
-          currentDelay(initial), lastAttemptTime(0), attemptCount(0) {}
-
-    bool shouldRetry()
-    {
-        unsigned long now = millis();
-        if (now - lastAttemptTime >= currentDelay)
-        {
-            return true;
-        }
-        return false;
-    }
-
-    void recordAttempt()
-    {
-        lastAttemptTime = millis();
-        attemptCount++;
-
-        // Calculate next delay with exponential backoff
-        currentDelay = min(currentDelay * multiplier, maxDelay);
-
-        Serial.println("📡 Network attempt #" + String(attemptCount) +
-                       ", next retry in " + String(currentDelay / 1000) + " seconds");
-    }
-
-    void reset()
-    {
-        currentDelay = initialDelay;
-        lastAttemptTime = 0;
-        attemptCount = 0;
-    }
-
-    int getAttemptCount() { return attemptCount; }
-    unsigned long getCurrentDelay() { return currentDelay; }
-};
-
 // Global objects
 WiFiManager wifiManager;
 DeviceManager deviceManager;
 LightManager lightManager;
+StatusChannel statusChannel(&deviceManager, &lightManager);
 WSClient *wsClient = nullptr;
+TaskScheduler scheduler;
 
-// Network retry backoff instances
-ExponentialBackoff wifiRetryBackoff(2000, 30000, 2);    // WiFi: 2s -> 4s -> 8s -> 16s -> 30s
-ExponentialBackoff wsRetryBackoff(1000, 60000, 2);      // WebSocket: 1s -> 2s -> 4s -> 8s -> 16s -> 32s -> 60s
-ExponentialBackoff registrationBackoff(3000, 45000, 2); // Registration: 3s -> 6s -> 12s -> 24s -> 45s
+// Network retry backoff (the WebSocket client keeps its own in its ConnectionSupervisor)
+Backoff wifiRetryBackoff("WiFi", 2000, 30000, 2); // WiFi: up to 2s -> 4s -> 8s -> 16s -> 30s, jittered
 
 // State management
 enum DeviceState
@@ -227,15 +182,36 @@ enum DeviceState
 DeviceState currentState = STATE_INIT;
 unsigned long stateChangeTime = 0;
 
-// Timing variables
-unsigned long lastStatusUpdate = 0;
-unsigned long lastWiFiCheck = 0;
-unsigned long lastWatchdogFeed = 0;
-const unsigned long WIFI_CHECK_INTERVAL = 10000; // 10 seconds
+// Scheduled task intervals
+const unsigned long WIFI_CHECK_INTERVAL = 10000;     // 10 seconds
+const unsigned long STATUS_CHECK_INTERVAL = 5000;    // 5 seconds (DeviceManager decides when an update is due)
+const unsigned long WS_HEALTH_CHECK_INTERVAL = 5000; // 5 seconds
+
+// Scheduler task ids whose interval changes at runtime
+int stateMachineTaskId = TaskScheduler::INVALID_TASK;
+int wsReconnectTaskId = TaskScheduler::INVALID_TASK;
+int wsHeartbeatTaskId = TaskScheduler::INVALID_TASK;
 
 // Watchdog timer variables
 bool watchdogInitialized = false;
 
+// Last palette already shown from flash before WiFi (local lighting system)
+bool paletteRestoredOffline = false;
+
+// Fast boot: a provisioned device skips HTTP registration and reconnects straight to the WebSocket
+bool fastBoot = false;
+
+// Boot timeline - time since reset at the end of each startup phase
+struct BootPhase
+{
+    const char *name;
+    unsigned long at;
+};
+const int MAX_BOOT_PHASES = 8;
+BootPhase bootPhases[MAX_BOOT_PHASES];
+int bootPhaseCount = 0;
+bool bootTimelinePrinted = false;
+
 // Helper function for repeating strings
 String repeatString(const String &str, int count)
 {
@@ -248,24 +224,11 @@ String repeatString(const String &str, int count)
     return result;
 }
 
-// Memory health checking function
-bool isMemoryHealthy()
-{
-    size_t freeHeap = ESP.getFreeHeap();
-    const size_t MIN_SAFE_HEAP = 10000; // 10KB minimum for safe operation
-
-    if (freeHeap < MIN_SAFE_HEAP)
-    {
-        Serial.println("⚠️ LOW MEMORY WARNING: " + String(freeHeap) + " bytes free (minimum: " + String(MIN_SAFE_HEAP) + ")");
-        return false;
-    }
-    return true;
-}
-
 // Global watchdog feeding function - can be called from anywhere
 void globalFeedWatchdog()
 {
-    if (watchdogInitialized)
+    // Only the loop task is subscribed; the lighting task reaches this through controller code
+    if (watchdogInitialized && esp_task_wdt_status(NULL) == ESP_OK)
     {
         esp_task_wdt_reset();
         // Optional: Add yield() to let other tasks run
@@ -276,15 +239,18 @@ void globalFeedWatchdog()
 // Global cleanup function for emergency shutdowns and resets
 void performGlobalCleanup()
 {
-    Serial.println("🧹 Performing global system cleanup...");
+    LOG_I("🧹 Performing global system cleanup...");
 
     // Disable watchdog to prevent reset during cleanup
     disableWatchdog();
 
+    // Queued history records would be lost with the restart
+    lightManager.flushPaletteHistory();
+
     // Clean up WebSocket client
     if (wsClient != nullptr)
     {
-        Serial.println("  - Cleaning up WebSocket client");
+        LOG_I("- Cleaning up WebSocket client");
         delete wsClient;
         wsClient = nullptr;
     }
@@ -292,29 +258,29 @@ void performGlobalCleanup()
     // Stop WiFi AP mode if active
     if (wifiManager.isInAPMode())
     {
-        Serial.println("  - Stopping WiFi AP mode");
+        LOG_I("- Stopping WiFi AP mode");
         wifiManager.stopAPMode();
     }
 
     // Disconnect WiFi
     if (wifiManager.isConnected())
     {
-        Serial.println("  - Disconnecting WiFi");
+        LOG_I("- Disconnecting WiFi");
         WiFi.disconnect(true);
     }
 
-    Serial.println("✅ Global cleanup completed");
+    LOG_I("✅ Global cleanup completed");
 } // Watchdog Timer Management Functions
 bool initializeWatchdog()
 {
-    Serial.println("🐕 Initializing watchdog timer...");
+    LOG_I("🐕 Initializing watchdog timer...");
 
     // Configure watchdog timer
     esp_err_t result = esp_task_wdt_init(WATCHDOG_TIMEOUT / 1000, true); // Convert to seconds
 
     if (result != ESP_OK)
     {
-        Serial.println("❌ Failed to initialize watchdog timer: " + String(result));
+        LOG_E("❌ Failed to initialize watchdog timer: %d", result);
         return false;
     }
 
@@ -322,15 +288,14 @@ bool initializeWatchdog()
     result = esp_task_wdt_add(NULL);
     if (result != ESP_OK)
     {
-        Serial.println("❌ Failed to add task to watchdog: " + String(result));
+        LOG_E("❌ Failed to add task to watchdog: %d", result);
         return false;
     }
 
     watchdogInitialized = true;
-    lastWatchdogFeed = millis();
 
-    Serial.println("✅ Watchdog timer initialized successfully");
-    Serial.println("🐕 Timeout: " + String(WATCHDOG_TIMEOUT) + "ms, Feed interval: " + String(WATCHDOG_FEED_INTERVAL) + "ms");
+    LOG_I("✅ Watchdog timer initialized successfully");
+    LOG_I("🐕 Timeout: %dms, Feed interval: %dms", WATCHDOG_TIMEOUT, WATCHDOG_FEED_INTERVAL);
 
     return true;
 }
@@ -342,19 +307,16 @@ void feedWatchdog()
         return;
     }
 
+    // Called by the scheduler every WATCHDOG_FEED_INTERVAL
+    esp_task_wdt_reset();
+
+    // Only log occasionally to avoid spam
+    static unsigned long lastWatchdogLog = 0;
     unsigned long currentTime = millis();
-    if (currentTime - lastWatchdogFeed >= WATCHDOG_FEED_INTERVAL)
+    if (currentTime - lastWatchdogLog > 30000) // Log every 30 seconds
     {
-        esp_task_wdt_reset();
-        lastWatchdogFeed = currentTime;
-
-        // Only log occasionally to avoid spam
-        static unsigned long lastWatchdogLog = 0;
-        if (currentTime - lastWatchdogLog > 30000) // Log every 30 seconds
-        {
-            Serial.println("🐕 Watchdog fed (system healthy)");
-            lastWatchdogLog = currentTime;
-        }
+        LOG_D("🐕 Watchdog fed (system healthy)");
+        lastWatchdogLog = currentTime;
     }
 }
 
@@ -362,7 +324,7 @@ void disableWatchdog()
 {
     if (watchdogInitialized)
     {
-        Serial.println("🐕 Disabling watchdog timer for cleanup...");
+        LOG_I("🐕 Disabling watchdog timer for cleanup...");
         esp_task_wdt_delete(NULL);
         esp_task_wdt_deinit();
         watchdogInitialized = false;
@@ -372,13 +334,20 @@ void disableWatchdog()
 void setup()
 {
     Serial.begin(115200);
-    delay(1000);
+    delay(BOOT_SERIAL_DELAY);
 
-    Serial.println("\n" + repeatString("=", 50));
-    Serial.println("🎨 PalPalette ESP32 Controller Starting...");
-    Serial.println("📦 Firmware Version: " + String(FIRMWARE_VERSION));
-    Serial.println("🏗 Architecture: Modular Self-Setup");
-    Serial.println(repeatString("=", 50));
+    // Create the registries before any task can record into them
+    Metrics::getInstance();
+    MemoryTelemetry::getInstance()->watchTask(xTaskGetCurrentTaskHandle(), getArduinoLoopTaskStackSize());
+
+    // From here on log records reach Serial from the drain task, not the caller
+    Log::begin();
+
+    LOG_I("==================================================");
+    LOG_I("🎨 PalPalette ESP32 Controller Starting...");
+    LOG_I("📦 Firmware Version: %s", FIRMWARE_VERSION);
+    LOG_I("🏗 Architecture: Modular Self-Setup");
+    LOG_I("==================================================");
 
     // Initialize watchdog timer early in setup
     if (!initializeWatchdog())
@@ -386,49 +355,79 @@ void setup()
         ErrorHandler::getInstance()->reportError(ErrorCode::WATCHDOG_INITIALIZATION_FAILED,
                                                  "Watchdog timer initialization failed",
                                                  "setup");
-        Serial.println("⚠ Continuing without watchdog protection");
+        LOG_W("⚠ Continuing without watchdog protection");
     }
 
     // Initialize managers
-    Serial.println("\n🔧 Initializing system components...");
+    LOG_I("🔧 Initializing system components...");
 
     wifiManager.begin();
     deviceManager.begin();
 
     // Initialize lighting system (WiFi-independent setup only)
-    Serial.println("💡 Preparing lighting system...");
+    LOG_I("💡 Preparing lighting system...");
 
     // Only load configuration, don't attempt network connections yet
     if (lightManager.beginWithoutConfig())
     {
-        Serial.println("✅ Lighting system ready - network initialization will occur after WiFi connection");
+        LOG_I("✅ Lighting system ready - network initialization will occur after WiFi connection");
     }
     else
     {
-        Serial.println("❌ Lighting system initialization failed");
-    } // Print device information
+        LOG_E("❌ Lighting system initialization failed");
+    }
+
+    // Lighting output gets its own task; the loop task stays free for network I/O
+    if (!lightManager.startLightingTask())
+    {
+        LOG_W("⚠ Lighting task unavailable - lighting runs on the main loop");
+    }
+
+    // A strip wired to the board needs no network - show the last palette before WiFi is up
+    if (lightManager.beginLocal() && lightManager.restoreLastPalette())
+    {
+        paletteRestoredOffline = true;
+        markBootPhase("palette");
+    }
+
+    // Print device information
     DeviceInfo deviceInfo = deviceManager.getDeviceInfo();
-    Serial.println("\n📱 Device Information:");
-    Serial.println("🆔 Device ID: " + deviceInfo.deviceId);
-    Serial.println("📡 MAC Address: " + deviceInfo.macAddress);
-    Serial.println("🔧 Firmware: " + deviceInfo.firmwareVersion);
+    LOG_I("📱 Device Information:");
+    LOG_I("🆔 Device ID: %s", deviceInfo.deviceId.c_str());
+    LOG_I("📡 MAC Address: %s", deviceInfo.macAddress.c_str());
+    LOG_I("🔧 Firmware: %s", deviceInfo.firmwareVersion.c_str());
 
     if (deviceInfo.isProvisioned)
     {
-        Serial.println("✅ Status: Provisioned");
+        LOG_I("✅ Status: Provisioned");
     }
     else
     {
-        Serial.println("⚠ Status: Not provisioned");
-        Serial.println("🔑 Pairing Code: " + deviceInfo.pairingCode);
-        Serial.println("📱 Use this code in the mobile app to claim this device");
+        LOG_W("⚠ Status: Not provisioned");
+        LOG_I("🔑 Pairing Code: %s", deviceInfo.pairingCode.c_str());
+        LOG_I("📱 Use this code in the mobile app to claim this device");
     }
 
+    fastBoot = deviceManager.canFastBoot();
+    if (fastBoot)
+    {
+        LOG_I("⚡ Fast boot: provisioned device, HTTP registration will be skipped");
+    }
+
+    // Register periodic work with the scheduler
+    registerScheduledTasks();
+
     // Start state machine
     setState(STATE_WIFI_SETUP);
 
-    Serial.println("\n🚀 System initialization complete!");
-    Serial.println("🔄 Starting main operation loop...\n");
+    markBootPhase("setup");
+
+#ifdef PALPALETTE_BENCHMARKS
+    Benchmarks::runAll();
+#endif
+
+    LOG_I("🚀 System initialization complete!");
+    LOG_I("🔄 Starting main operation loop...");
 }
 
 // Get optimal loop delay based on current device state
@@ -462,30 +461,64 @@ unsigned long getOptimalLoopDelay()
     }
 }
 
-void loop()
+void registerScheduledTasks()
 {
-    // Feed watchdog timer to prevent resets
-    feedWatchdog();
-
-    // Update all managers
-    wifiManager.loop();
-    lightManager.loop();
-    if (wsClient)
+    scheduler.addTask("watchdog", WATCHDOG_FEED_INTERVAL, feedWatchdog);
+    scheduler.addTask("wifiLoop", WIFI_LOOP_INTERVAL, []()
+                      { wifiManager.loop(); });
+    if (!lightManager.hasLightingTask())
     {
-        wsClient->loop();
+        scheduler.addTask("lightLoop", ANIMATION_FRAME_INTERVAL, []()
+                          { lightManager.loop(); });
     }
+    stateMachineTaskId = scheduler.addTask("stateMachine", getOptimalLoopDelay(), handleStateMachine);
+    scheduler.addTask("wifiCheck", WIFI_CHECK_INTERVAL, checkWiFiConnection);
+    scheduler.addTask("statusUpdate", STATUS_CHECK_INTERVAL, updateDeviceStatus);
+    scheduler.addTask("memoryCheck", MEMORY_CHECK_INTERVAL, checkMemoryHealth);
+    scheduler.addTask("paletteHistory", PALETTE_HISTORY_TICK_INTERVAL, []()
+                      { lightManager.historyLoop(); });
+
+    // WebSocket work - each task is a no-op until the client exists
+    scheduler.addTask("wsPoll", WS_POLL_INTERVAL, []()
+                      {
+        if (wsClient)
+        {
+            wsClient->poll();
+        } });
+    wsHeartbeatTaskId = scheduler.addTask("wsHeartbeat", HEARTBEAT_INTERVAL, []()
+                                          {
+        if (wsClient && wsClient->isClientConnected())
+        {
+            wsClient->sendHeartbeat();
+            scheduler.setInterval(wsHeartbeatTaskId, wsClient->getHeartbeatInterval());
+        } });
+    scheduler.addTask("wsHealth", WS_HEALTH_CHECK_INTERVAL, []()
+                      {
+        if (wsClient)
+        {
+            wsClient->checkConnectionHealth();
+        } });
+    wsReconnectTaskId = scheduler.addTask("wsReconnect", REGISTRATION_RETRY_INTERVAL, []()
+                                          {
+        if (wsClient)
+        {
+            wsClient->attemptReconnect();
+            scheduler.setInterval(wsReconnectTaskId, wsClient->getReconnectDelay());
+        } });
 
-    // Handle state machine
-    handleStateMachine();
-
-    // Periodic tasks
-    handlePeriodicTasks();
-
-    // Allow other tasks to run and prevent blocking
-    yield();
+    LOG_I("⏱ Scheduler ready with %d tasks", scheduler.getTaskCount());
+}
 
-    // Dynamic delay based on current state to optimize performance
-    unsigned long loopDelay = getOptimalLoopDelay();
+void loop()
+{
+    // Run whatever is due (watchdog, managers, state machine, periodic tasks)
+    MetricSpan iterationSpan(Metrics::LOOP_ITERATION);
+    scheduler.runDueTasks();
+    iterationSpan.end();
+
+    // Sleep until the next deadline instead of spinning; the state-dependent
+    // delay caps how long the loop stays idle
+    scheduler.sleepUntilNextDeadline(getOptimalLoopDelay());
 }
 
 void setState(DeviceState newState)
@@ -495,9 +528,49 @@ void setState(DeviceState newState)
         currentState = newState;
         stateChangeTime = millis();
 
+        // Poll the new state at its own pace, starting right away
+        scheduler.setInterval(stateMachineTaskId, getOptimalLoopDelay());
+        scheduler.triggerNow(stateMachineTaskId);
+
         String stateName = getStateName(newState);
-        Serial.println("🔄 State changed to: " + stateName);
+        LOG_I("🔄 State changed to: %s", stateName.c_str());
+
+        if (newState == STATE_OPERATIONAL || newState == STATE_WAITING_FOR_CLAIM)
+        {
+            printBootTimeline();
+        }
+    }
+}
+
+void markBootPhase(const char *name)
+{
+    if (bootTimelinePrinted || bootPhaseCount >= MAX_BOOT_PHASES)
+    {
+        return;
     }
+
+    bootPhases[bootPhaseCount].name = name;
+    bootPhases[bootPhaseCount].at = millis();
+    bootPhaseCount++;
+}
+
+// Printed once, when the device first becomes reachable from the app
+void printBootTimeline()
+{
+    if (bootTimelinePrinted)
+    {
+        return;
+    }
+    bootTimelinePrinted = true;
+
+    LOG_I("⏱ Boot timeline (%s boot):", fastBoot ? "fast" : "full");
+    unsigned long previous = 0;
+    for (int i = 0; i < bootPhaseCount; i++)
+    {
+        LOG_I("  %-8s +%5lu ms  (at %5lu ms)", bootPhases[i].name, bootPhases[i].at - previous, bootPhases[i].at);
+        previous = bootPhases[i].at;
+    }
+    LOG_I("  ready    at %lu ms", millis());
 }
 
 String getStateName(DeviceState state)
@@ -563,7 +636,7 @@ void handleWiFiSetup()
     // Check if we have stored WiFi credentials
     if (wifiManager.hasStoredCredentials())
     {
-        Serial.println("📶 Found stored WiFi credentials, attempting connection...");
+        LOG_I("📶 Found stored WiFi credentials, attempting connection...");
         setState(STATE_WIFI_CONNECTING);
     }
     else
@@ -571,16 +644,16 @@ void handleWiFiSetup()
         // Start captive portal if not already running
         if (!wifiManager.isInAPMode())
         {
-            Serial.println("📶 No WiFi credentials found, starting setup mode...");
-            Serial.println("🌐 Please connect to the WiFi network to configure this device:");
+            LOG_I("📶 No WiFi credentials found, starting setup mode...");
+            LOG_I("🌐 Please connect to the WiFi network to configure this device:");
 
             String macAddr = WiFi.macAddress();
             macAddr.replace(":", "");
             String apSSID = String(DEFAULT_AP_SSID) + "-" + macAddr.substring(6);
 
-            Serial.println("📶 Network: " + apSSID);
-            Serial.println("🔐 Password: " + String(DEFAULT_AP_PASSWORD));
-            Serial.println("🌐 Open a web browser to configure WiFi settings");
+            LOG_I("📶 Network: %s", apSSID.c_str());
+            LOG_I("🔐 Password: %s", DEFAULT_AP_PASSWORD);
+            LOG_I("🌐 Open a web browser to configure WiFi settings");
 
             wifiManager.startAPMode();
         }
@@ -598,7 +671,7 @@ void handleWiFiConnecting()
         connectStartTime = millis();
         attemptInProgress = true;
         wifiRetryBackoff.recordAttempt();
-        Serial.println("📶 Attempting WiFi connection (attempt #" + String(wifiRetryBackoff.getAttemptCount()) + ")...");
+        LOG_I("📶 Attempting WiFi connection (attempt #%d)...", wifiRetryBackoff.getAttemptCount());
     }
 
     if (wifiManager.connectToWiFi())
@@ -606,45 +679,52 @@ void handleWiFiConnecting()
         // Success! Reset backoff and proceed
         wifiRetryBackoff.reset();
         attemptInProgress = false;
+        markBootPhase("wifi");
+
+        // Lights come first - they need the LAN, not the clock or the backend
+        LOG_I("🔄 WiFi connected - initializing lighting system with saved configuration...");
+        if (lightManager.begin())
+        {
+            LOG_I("✅ Lighting system initialized with saved configuration");
+        }
+        else
+        {
+            LOG_I("📝 No saved lighting configuration found - will wait for mobile app setup");
+        }
+        markBootPhase("lights");
+
+        // Also reaches additional systems that only came up now; a local primary just sees the same palette again
+        if (lightManager.isReady() && lightManager.restoreLastPalette() && !paletteRestoredOffline)
+        {
+            markBootPhase("palette");
+        }
 
         // Synchronize time with NTP servers for SSL certificate validation
-        Serial.println("⏰ Synchronizing time with NTP servers...");
+        LOG_I("⏰ Synchronizing time with NTP servers...");
         configTime(0, 0, "pool.ntp.org", "time.nist.gov");
 
-        // Wait for time to be set
+        // Returns as soon as SNTP answers; short slices keep the watchdog fed
         struct tm timeinfo;
-        int attempts = 0;
-        while (!getLocalTime(&timeinfo) && attempts < 10)
+        unsigned long syncStart = millis();
+        bool timeSynced = false;
+        while (!timeSynced && millis() - syncStart < NTP_SYNC_TIMEOUT)
         {
-            Serial.print(".");
-            delay(1000);
-            attempts++;
+            timeSynced = getLocalTime(&timeinfo, 250);
+            feedWatchdog();
         }
 
-        if (getLocalTime(&timeinfo))
+        if (timeSynced)
         {
-            Serial.println();
-            Serial.printf("✅ Time synchronized: %s", asctime(&timeinfo));
+            LOG_I("✅ Time synchronized: %.24s", asctime(&timeinfo));
         }
         else
         {
-            Serial.println();
-            Serial.println("⚠️ Failed to synchronize time, but continuing...");
+            LOG_W("⚠️ Failed to synchronize time, but continuing...");
         }
+        markBootPhase("clock");
 
         // Root certificate is embedded, no download needed
-        Serial.println("🔐 Using embedded root certificate for secure connections...");
-
-        // Now that WiFi is connected, initialize lighting system with saved configuration
-        Serial.println("🔄 WiFi connected - initializing lighting system with saved configuration...");
-        if (lightManager.begin())
-        {
-            Serial.println("✅ Lighting system initialized with saved configuration");
-        }
-        else
-        {
-            Serial.println("📝 No saved lighting configuration found - will wait for mobile app setup");
-        }
+        LOG_I("🔐 Using embedded root certificate for secure connections...");
 
         setState(STATE_DEVICE_REGISTRATION);
     }
@@ -695,24 +775,38 @@ void handleDeviceRegistration()
 
     if (!registrationAttempted)
     {
-        Serial.println("📡 Starting minimal device registration process...");
-
-        // First perform minimal registration with HTTP API (only MAC address)
         String serverUrl = wifiManager.getServerURL();
-        if (deviceManager.registerMinimalWithServer(serverUrl))
+
+        // A provisioned device already has its identity; the WebSocket registration refreshes the rest
+        bool registered = fastBoot;
+        if (fastBoot)
+        {
+            LOG_I("⚡ Fast boot: skipping HTTP registration for device %s", deviceManager.getDeviceId().c_str());
+        }
+        else
+        {
+            // First perform minimal registration with HTTP API (only MAC address)
+            LOG_I("📡 Starting minimal device registration process...");
+            registered = deviceManager.registerMinimalWithServer(serverUrl);
+            if (registered)
+            {
+                LOG_I("✅ Device registered minimally with HTTP API");
+            }
+        }
+
+        if (registered)
         {
-            Serial.println("✅ Device registered minimally with HTTP API");
 
             // Initialize WebSocket client with proper cleanup
             if (wsClient != nullptr)
             {
-                Serial.println("🔄 Cleaning up existing WebSocket client");
+                LOG_I("🔄 Cleaning up existing WebSocket client");
                 delete wsClient;
                 wsClient = nullptr;
             }
 
-            // Check memory health before allocation
-            if (!isMemoryHealthy())
+            // Check memory health before allocation (the client embeds its message arena)
+            if (!MemoryTelemetry::getInstance()->isHealthy(MEMORY_MIN_FREE_HEAP, sizeof(WSClient)))
             {
                 ErrorHandler::getInstance()->reportError(ErrorCode::MEMORY_ALLOCATION_FAILED,
                                                          "Insufficient memory for WebSocket client allocation",
@@ -733,28 +827,33 @@ void handleDeviceRegistration()
                 return;
             }
 
+            wsClient->setStatusChannel(&statusChannel);
             wsClient->begin(serverUrl);
 
             // Attempt WebSocket connection
             if (wsClient->connect())
             {
-                Serial.println("✅ WebSocket connection established");
+                LOG_I("✅ WebSocket connection established");
                 registrationSuccessful = true; // Mark as successful
+                markBootPhase("backend");
 
                 // Check provisioning status after registration response
                 if (deviceManager.isProvisioned())
                 {
-                    Serial.println("🎉 Device is already claimed - transitioning to operational mode");
+                    LOG_I("🎉 Device is already claimed - transitioning to operational mode");
                     setState(STATE_OPERATIONAL);
                 }
                 else
                 {
-                    Serial.println("📝 Device is not yet claimed - waiting for user pairing");
+                    LOG_I("📝 Device is not yet claimed - waiting for user pairing");
                     setState(STATE_WAITING_FOR_CLAIM);
                 }
             }
             else
             {
+                // The server may no longer know this device - register properly next time
+                fastBoot = false;
+
                 ErrorHandler::getInstance()->reportError(ErrorCode::WEBSOCKET_CONNECTION_FAILED,
                                                          "WebSocket connection failed after successful device registration",
                                                          "handleDeviceRegistration");
@@ -775,7 +874,7 @@ void handleDeviceRegistration()
     // Only reset registration attempt flag after delay if it failed (not successful)
     if (!registrationSuccessful && millis() - stateChangeTime > REGISTRATION_RETRY_INTERVAL)
     {
-        Serial.println("⏰ Retrying device registration after failure...");
+        LOG_I("⏰ Retrying device registration after failure...");
         registrationAttempted = false;
     }
 }
@@ -789,12 +888,12 @@ void handleWaitingForClaim()
     if (millis() - lastPairingInfo > PAIRING_INFO_INTERVAL)
     {
         DeviceInfo deviceInfo = deviceManager.getDeviceInfo();
-        Serial.println("\n📱 ===== DEVICE WAITING FOR CLAIM =====");
-        Serial.println("🆔 Device ID: " + deviceInfo.deviceId);
-        Serial.println("🔑 Pairing Code: " + deviceInfo.pairingCode);
-        Serial.println("📱 Open the PalPalette mobile app and use this pairing code");
-        Serial.println("⏰ Waiting for user to claim this device...");
-        Serial.println("=====================================\n");
+        LOG_I("📱 ===== DEVICE WAITING FOR CLAIM =====");
+        LOG_I("🆔 Device ID: %s", deviceInfo.deviceId.c_str());
+        LOG_I("🔑 Pairing Code: %s", deviceInfo.pairingCode.c_str());
+        LOG_I("📱 Open the PalPalette mobile app and use this pairing code");
+        LOG_I("⏰ Waiting for user to claim this device...");
+        LOG_I("=====================================");
 
         lastPairingInfo = millis();
     }
@@ -802,7 +901,7 @@ void handleWaitingForClaim()
     // Check if device was claimed (this will be handled by WebSocket message)
     if (deviceManager.isProvisioned())
     {
-        Serial.println("🎉 Device has been claimed! Transitioning to operational mode.");
+        LOG_I("🎉 Device has been claimed! Transitioning to operational mode.");
         setState(STATE_OPERATIONAL);
     }
 }
@@ -815,14 +914,14 @@ void handleOperational()
 
     if (millis() - lastOperationalInfo > OPERATIONAL_INFO_INTERVAL)
     {
-        Serial.println("✅ Device operational - Ready to receive color palettes");
+        LOG_I("✅ Device operational - Ready to receive color palettes");
         lastOperationalInfo = millis();
     }
 
     // Check if device lost provisioning (shouldn't happen normally)
     if (!deviceManager.isProvisioned())
     {
-        Serial.println("⚠ Device lost provisioning, returning to waiting state");
+        LOG_W("⚠ Device lost provisioning, returning to waiting state");
         setState(STATE_WAITING_FOR_CLAIM);
     }
 }
@@ -840,12 +939,12 @@ void handleError()
     ErrorCode lastError = errorHandler->getLastError();
     RecoveryStrategy strategy = errorHandler->getRecoveryStrategy(lastError);
 
-    Serial.println("🔧 Executing recovery strategy: " + String(static_cast<uint8_t>(strategy)));
+    LOG_I("🔧 Executing recovery strategy: %u", static_cast<uint8_t>(strategy));
 
     switch (strategy)
     {
     case RecoveryStrategy::RETRY_OPERATION:
-        Serial.println("🔄 Retrying operation...");
+        LOG_I("🔄 Retrying operation...");
         // Try to recover based on current state
         if (currentState == STATE_WIFI_CONNECTING)
         {
@@ -862,7 +961,7 @@ void handleError()
         break;
 
     case RecoveryStrategy::RESTART_COMPONENT:
-        Serial.println("🔄 Restarting affected component...");
+        LOG_I("🔄 Restarting affected component...");
         if (lastError == ErrorCode::WIFI_CONNECTION_FAILED)
         {
             wifiManager.stopAPMode();
@@ -884,33 +983,36 @@ void handleError()
         break;
 
     case RecoveryStrategy::SOFT_RESTART:
-        Serial.println("🔄 Performing soft restart...");
+        LOG_I("🔄 Performing soft restart...");
         performGlobalCleanup();
         delay(2000);
+        Log::flush();
         ESP.restart();
         break;
 
     case RecoveryStrategy::HARD_RESTART:
-        Serial.println("💀 Critical errors detected - performing hard restart with factory reset");
+        LOG_E("💀 Critical errors detected - performing hard restart with factory reset");
         errorHandler->reportError(ErrorCode::UNKNOWN_ERROR, "Too many critical errors", "handleError");
         performGlobalCleanup();
         deviceManager.resetDevice();
         wifiManager.clearWiFiCredentials();
         delay(3000);
+        Log::flush();
         ESP.restart();
         break;
 
     case RecoveryStrategy::FACTORY_RESET:
-        Serial.println("🏭 Performing factory reset...");
+        LOG_I("🏭 Performing factory reset...");
         performGlobalCleanup();
         deviceManager.resetDevice();
         wifiManager.clearWiFiCredentials();
         delay(3000);
+        Log::flush();
         ESP.restart();
         break;
 
     default:
-        Serial.println("⚠ Unknown recovery strategy, defaulting to soft restart");
+        LOG_W("⚠ Unknown recovery strategy, defaulting to soft restart");
         setState(STATE_WIFI_SETUP);
         break;
     }
@@ -918,41 +1020,50 @@ void handleError()
     errorHandler->clearError();
 }
 
-void handlePeriodicTasks()
+void checkMemoryHealth()
 {
-    // Check WiFi connection periodically
-    if (millis() - lastWiFiCheck > WIFI_CHECK_INTERVAL)
+    if (!MemoryTelemetry::getInstance()->check())
     {
-        if (currentState >= STATE_DEVICE_REGISTRATION && !wifiManager.isConnected())
-        {
-            ErrorHandler::getInstance()->reportError(ErrorCode::WIFI_CONNECTION_FAILED,
-                                                     "WiFi connection lost during operation",
-                                                     "handlePeriodicTasks");
-            setState(STATE_ERROR);
-        }
-        lastWiFiCheck = millis();
+        return;
     }
 
+    // An open WSS session keeps its buffers; restart before the next handshake fails inside mbedTLS instead
+    bool handshakePending = wsClient == nullptr || !wsClient->isClientConnected();
+    if (handshakePending && currentState != STATE_WIFI_SETUP && currentState != STATE_ERROR)
+    {
+        // MEMORY_ALLOCATION_FAILED recovers by soft restart - counted so a restart loop gives up
+        MemoryTelemetry::getInstance()->recordFragmentationRestart();
+        ErrorHandler::getInstance()->reportError(ErrorCode::MEMORY_ALLOCATION_FAILED,
+                                                 "Heap too fragmented for a TLS handshake",
+                                                 "checkMemoryHealth");
+        setState(STATE_ERROR);
+    }
+}
+
+void checkWiFiConnection()
+{
+    if (currentState >= STATE_DEVICE_REGISTRATION && !wifiManager.isConnected())
+    {
+        ErrorHandler::getInstance()->reportError(ErrorCode::WIFI_CONNECTION_FAILED,
+                                                 "WiFi connection lost during operation",
+                                                 "checkWiFiConnection");
+        deviceManager.closeBackendConnection();
+        setState(STATE_ERROR);
+    }
+}
+
+void updateDeviceStatus()
+{
     // Update device status periodically (if registered and connected)
     // Add grace period after registration to allow backend to process
     const unsigned long REGISTRATION_GRACE_PERIOD = 10000; // 10 seconds
     bool pastGracePeriod = (currentState > STATE_DEVICE_REGISTRATION) ||
                            (millis() - stateChangeTime > REGISTRATION_GRACE_PERIOD);
 
-    if (currentState >= STATE_DEVICE_REGISTRATION && pastGracePeriod && deviceManager.shouldUpdateStatus())
+    // Deltas over the WebSocket while it is up, HTTPS every STATUS_UPDATE_INTERVAL otherwise
+    if (currentState >= STATE_DEVICE_REGISTRATION && pastGracePeriod && wifiManager.isConnected())
     {
-        if (wifiManager.isConnected())
-        {
-            String serverUrl = wifiManager.getServerURL();
-            if (deviceManager.updateStatus(serverUrl, &lightManager))
-            {
-                Serial.println("📊 Device status updated successfully");
-            }
-            else
-            {
-                Serial.println("⚠ Device status update failed - backend may not be ready yet");
-            }
-        }
+        statusChannel.update(wsClient, wifiManager.getServerURL());
     }
 }
 
@@ -968,14 +1079,14 @@ void printSystemStatus()
 
     // Device info
     DeviceInfo deviceInfo = deviceManager.getDeviceInfo();
-    Serial.println("🆔 Device ID: " + deviceInfo.deviceId);
-    Serial.println("📡 MAC Address: " + deviceInfo.macAddress);
-    Serial.println("🔧 Firmware: " + deviceInfo.firmwareVersion);
+    LOG_I("🆔 Device ID: %s", deviceInfo.deviceId.c_str());
+    LOG_I("📡 MAC Address: %s", deviceInfo.macAddress.c_str());
+    LOG_I("🔧 Firmware: %s", deviceInfo.firmwareVersion.c_str());
     Serial.println("✅ Provisioned: " + String(deviceInfo.isProvisioned ? "Yes" : "No"));
 
     if (!deviceInfo.isProvisioned)
     {
-        Serial.println("🔑 Pairing Code: " + deviceInfo.pairingCode);
+        LOG_I("🔑 Pairing Code: %s", deviceInfo.pairingCode.c_str());
     }
 
     // Network info
@@ -983,18 +1094,39 @@ void printSystemStatus()
     Serial.println("📍 IP Address: " + wifiManager.getLocalIP());
     Serial.println("🔗 WiFi Connected: " + String(wifiManager.isConnected() ? "Yes" : "No"));
 
+    StatusChannel::Stats statusStats = statusChannel.getStats();
+    Serial.println("📊 Status reports: " + String(statusStats.fullReports) + " full, " +
+                   String(statusStats.deltaReports) + " delta, " + String(statusStats.acks) + " acked, " +
+                   String(statusStats.restFallbacks) + " via HTTPS");
+    SecureTransport::Stats transportStats = deviceManager.getTransportStats();
+    Serial.println("🔒 Backend HTTPS: " + String(transportStats.requests) + " requests, " +
+                   String(transportStats.handshakes) + " handshakes, " + String(transportStats.retries) + " retries");
+
     // WebSocket info
     if (wsClient)
     {
         Serial.println("🔌 WebSocket: " + String(wsClient->isClientConnected() ? "Connected" : "Disconnected"));
+        Serial.println("🏓 RTT: " + String(wsClient->getSmoothedRtt()) + "ms, heartbeat every " +
+                       String(wsClient->getHeartbeatInterval() / 1000) + "s");
     }
     else
     {
         Serial.println("🔌 WebSocket: Not initialized");
     }
 
+    // Lighting command queue
+    if (lightManager.hasLightingTask())
+    {
+        LightCommandQueue::Stats stats = lightManager.getCommandStats();
+        Serial.println("💡 Light commands: " + String(stats.submitted) + " submitted, " +
+                       String(stats.coalesced) + " coalesced, " + String(stats.dropped) + " dropped, " +
+                       String(stats.delivered) + " delivered");
+    }
+
     // System info
-    Serial.println("🧠 Free Heap: " + String(ESP.getFreeHeap()) + " bytes");
+    MemoryTelemetry::HeapSnapshot heap = MemoryTelemetry::sample();
+    Serial.println("🧠 Free Heap: " + String(heap.freeHeap) + " bytes (largest block " + String(heap.largestBlock) +
+                   ", minimum " + String(heap.minimumFree) + ", " + String(heap.fragmentation) + "% fragmented)");
     Serial.println("⏰ Uptime: " + String(millis() / 1000) + " seconds");
     Serial.println("🔄 Current State: " + getStateName(currentState));
 
@@ -1022,6 +1154,7 @@ void serialEvent()
             deviceManager.resetDevice();
             wifiManager.clearWiFiCredentials();
             delay(1000); // Give time for cleanup
+            Log::flush();
             ESP.restart();
         }
         else if (command == "restart")
@@ -1029,6 +1162,7 @@ void serialEvent()
             Serial.println("🔄 Restarting device with cleanup...");
             performGlobalCleanup();
             delay(1000); // Give time for cleanup
+            Log::flush();
             ESP.restart();
         }
         else if (command == "wifi")
@@ -1041,24 +1175,17 @@ void serialEvent()
         else if (command == "prefs")
         {
             Serial.println("🗂 Preferences Debug:");
-            Preferences debugPrefs;
-
-            // Check palpalette namespace (main device preferences)
-            debugPrefs.begin("palpalette", true);
-            Serial.println("📋 Namespace: 'palpalette'");
-            Serial.println("  lighting_system: '" + debugPrefs.getString("lighting_system", "") + "'");
-            Serial.println("  lighting_host: '" + debugPrefs.getString("lighting_host", "") + "'");
-            Serial.println("  lighting_port: " + String(debugPrefs.getInt("lighting_port", 0)));
-            Serial.println("  wifi_ssid: '" + debugPrefs.getString("wifi_ssid", "") + "'");
-            debugPrefs.end();
-
-            // Check light_config namespace (legacy lighting preferences)
-            debugPrefs.begin("light_config", true);
-            Serial.println("📋 Namespace: 'light_config'");
-            Serial.println("  system_type: '" + debugPrefs.getString("system_type", "") + "'");
-            Serial.println("  host_addr: '" + debugPrefs.getString("host_addr", "") + "'");
-            Serial.println("  port: " + String(debugPrefs.getInt("port", 0)));
-            debugPrefs.end();
+            StoredConfig stored = ConfigStore::getInstance()->get();
+
+            Serial.println("📋 Config store: '" + String(CONFIG_STORE_NAMESPACE) + "' (" + String(ConfigStore::getInstance()->getWriteCount()) + " writes this boot)");
+            Serial.println("  device_id: '" + String(stored.deviceId) + "'");
+            Serial.println("  provisioned: " + String(stored.isProvisioned ? "Yes" : "No"));
+            Serial.println("  wifi_ssid: '" + String(stored.wifiSsid) + "'");
+            Serial.println("  server_url: '" + String(stored.serverUrl) + "'");
+            Serial.println("  lighting_system: '" + String(stored.lightingSystem) + "'");
+            Serial.println("  lighting_host: '" + String(stored.lightingHost) + "'");
+            Serial.println("  lighting_port: " + String(stored.lightingPort));
+            Serial.println("  auth_token: " + String(strlen(stored.lightingAuthToken) > 0 ? "set" : "none"));
         }
         else if (command == "lights")
         {
@@ -1093,6 +1220,42 @@ void serialEvent()
                 Serial.println("💡 Try 'lights' command to reinitialize lighting system");
             }
         }
+        else if (command == "shuffle" || command.startsWith("shuffle "))
+        {
+            // "shuffle" toggles, "shuffle <seconds>" starts with that interval, "shuffle off" stops
+            String argument = command.substring(7);
+            argument.trim();
+            if (argument == "off" || (argument.length() == 0 && lightManager.isShuffling()))
+            {
+                lightManager.setShuffle(false);
+            }
+            else
+            {
+                uint32_t seconds = argument.toInt();
+                lightManager.setShuffle(true, seconds > 0 ? seconds * 1000 : PALETTE_SHUFFLE_DEFAULT_INTERVAL);
+            }
+        }
+        else if (command == "metrics")
+        {
+            JsonDocument doc;
+            Metrics::getInstance()->toJson(doc.to<JsonObject>());
+            MemoryTelemetry::getInstance()->toJson(doc["memory"].to<JsonObject>());
+            if (wsClient)
+            {
+                wsClient->connectionStatsToJson(doc["connection"].to<JsonObject>());
+            }
+            lightManager.controllerStatsToJson(doc["controllers"].to<JsonArray>());
+            lightManager.historyToJson(doc["paletteHistory"].to<JsonObject>());
+            Serial.println("⏱ Metrics:");
+            serializeJsonPretty(doc, Serial);
+            Serial.println();
+        }
+#ifdef PALPALETTE_BENCHMARKS
+        else if (command == "bench")
+        {
+            Benchmarks::runAll();
+        }
+#endif
         else if (command == "help")
         {
             Serial.println("🆘 Available Commands:");
@@ -1101,6 +1264,11 @@ void serialEvent()
             Serial.println("  prefs    - Show preferences debug info");
             Serial.println("  lights   - Reinitialize lighting system");
             Serial.println("  nanoleaf - Test Nanoleaf discovery and connection");
+            Serial.println("  metrics  - Show latency spans and error counters");
+            Serial.println("  shuffle  - Toggle replay of stored palettes ('shuffle 30' = every 30 s)");
+#ifdef PALPALETTE_BENCHMARKS
+            Serial.println("  bench    - Run the on-device benchmarks");
+#endif
             Serial.println("  reset    - Reset device settings");
             Serial.println("  restart  - Restart the device");
             Serial.println("  help     - Show this help message");
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <HTTPClient.h>
+#include "core/Log.h"
 
 // Root CA certificate for HTTPS connections
 // Dynamically downloaded from Let's Encrypt to ensure it's always up to date
@@ -47,13 +48,16 @@ emyPxgcYxn/eR44/KJ4EBs+lVDR3veyJm+kXQ99b21/+jh5Xos1AnX5iItreGCc=
 // Download the latest root certificate from Let's Encrypt
 static bool downloadRootCertificate()
 {
-    Serial.println("🔐 Using fallback root certificate...");
+    // Shadows the including file's tag for the LOG_* macros below
+    [[maybe_unused]] static const char *const LOG_TAG = "tls";
+
+    LOG_I("🔐 Using fallback root certificate...");
 
     // For security and reliability, we'll use the fallback certificate
     // instead of downloading over an insecure HTTP connection
     root_ca = String(fallback_root_ca);
 
-    Serial.println("✅ Root certificate loaded successfully (" + String(root_ca.length()) + " bytes)");
+    LOG_I("✅ Root certificate loaded successfully (%u bytes)", root_ca.length());
     return true;
 }
 